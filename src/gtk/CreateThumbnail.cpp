@@ -25,6 +25,11 @@ using namespace LibRomData;
 #include "libromdata/img/TCreateThumbnail.cpp"
 using LibRomData::TCreateThumbnail;
 
+#ifdef RP_GTK_USE_CAIRO
+#  include "gtk3/RpCairoBackend.hpp"
+#  include "librpthreads/pthread_once.h"
+#endif /* RP_GTK_USE_CAIRO */
+
 // NetworkManager D-Bus interface to determine if the connection is metered.
 #include <glib-object.h>
 #include "NetworkManager.h"
@@ -87,18 +92,6 @@ public:
 		PIMGTYPE_unref(imgClass);
 	}
 
-	/**
-	 * Rescale an ImgClass using the specified scaling method.
-	 * @param imgClass ImgClass object.
-	 * @param sz New size.
-	 * @param method Scaling method.
-	 * @return Rescaled ImgClass.
-	 */
-	inline PIMGTYPE rescaleImgClass(const PIMGTYPE &imgClass, ImgSize sz, ScalingMethod method = ScalingMethod::Nearest) const final
-	{
-		return PIMGTYPE_scale(imgClass, sz.width, sz.height, (method == ScalingMethod::Bilinear));
-	}
-
 	/**
 	 * Get the size of the specified ImgClass.
 	 * @param imgClass	[in] ImgClass object.
@@ -165,6 +158,21 @@ public:
 
 /** CreateThumbnail **/
 
+#ifdef RP_GTK_USE_CAIRO
+static pthread_once_t rp_cairo_backend_once_control = PTHREAD_ONCE_INIT;
+
+/**
+ * Register the Cairo rp_image backend.
+ * Called by pthread_once().
+ */
+static void register_rp_cairo_backend(void)
+{
+	// Store rp_image data in cairo_surface_t, so the thumbnail
+	// can be written to PNG without converting it first.
+	rp_image::setBackendCreatorFn(RpCairoBackend::creator_fn);
+}
+#endif /* RP_GTK_USE_CAIRO */
+
 /**
  * Create a RomData object from a filename or URI.
  * @param source_file	[in] Source filename or URI
@@ -201,21 +209,14 @@ static RomDataPtr openFromFilenameOrURI(const char *source_file, string &s_uri,
 			}
 
 			if (likely(!FileSystem::is_directory(source_filename))) {
-				// File: Open the file and call RomDataFactory::create() with the opened file.
-
-				// Attempt to open the ROM file.
-				const IRpFilePtr file = std::make_shared<RpFile>(source_filename, RpFile::FM_OPEN_READ_GZ);
-				if (!file) {
-					// Could not open the file.
-					if (p_err) {
-						*p_err = RPCT_ERROR_CANNOT_OPEN_SOURCE_FILE;
-					}
-					return {};
-				}
+				// File: Call RomDataFactory::create() with the filename.
+				// The RomData cache is checked first, so the file might not
+				// need to be opened at all.
 
 				// Get the appropriate RomData class for this ROM.
 				// RomData class *must* support at least one image type.
-				romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+				romData = RomDataFactory::create(source_filename,
+					RomDataFactory::RDA_HAS_THUMBNAIL | RomDataFactory::RDA_USE_CACHE);
 			} else {
 				const Config *const config = Config::instance();
 				if (!config->getBoolConfigOption(Config::BoolConfig::Options_ThumbnailDirectoryPackages)) {
@@ -293,21 +294,14 @@ static RomDataPtr openFromFilenameOrURI(const char *source_file, string &s_uri,
 		}
 
 		if (likely(!FileSystem::is_directory(source_file))) {
-			// File: Open the file and call RomDataFactory::create() with the opened file.
-
-			// Attempt to open the ROM file.
-			const IRpFilePtr file = std::make_shared<RpFile>(source_file, RpFile::FM_OPEN_READ_GZ);
-			if (!file) {
-				// Could not open the file.
-				if (p_err) {
-					*p_err = RPCT_ERROR_CANNOT_OPEN_SOURCE_FILE;
-				}
-				return {};
-			}
+			// File: Call RomDataFactory::create() with the filename.
+			// The RomData cache is checked first, so the file might not
+			// need to be opened at all.
 
 			// Get the appropriate RomData class for this ROM.
 			// RomData class *must* support at least one image type.
-			romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+			romData = RomDataFactory::create(source_file,
+				RomDataFactory::RDA_HAS_THUMBNAIL | RomDataFactory::RDA_USE_CACHE);
 		} else {
 			const Config *const config = Config::instance();
 			if (!config->getBoolConfigOption(Config::BoolConfig::Options_ThumbnailDirectoryPackages)) {
@@ -354,6 +348,9 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail2(
 	// Validate flags.
 	if ((flags & ~RPCT_FLAG_VALID_MASK) != 0) {
 		return RPCT_ERROR_INVALID_FLAGS;
+	} else if ((flags & (RPCT_FLAG_FAST_PNG | RPCT_FLAG_SMALL_PNG)) == (RPCT_FLAG_FAST_PNG | RPCT_FLAG_SMALL_PNG)) {
+		// Can't favor both speed and size.
+		return RPCT_ERROR_INVALID_FLAGS;
 	}
 
 	// Make sure glib is initialized.
@@ -362,6 +359,12 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail2(
 	g_type_init();
 #endif
 
+#ifdef RP_GTK_USE_CAIRO
+	// Register the Cairo backend once. Thumbnails may be
+	// created by multiple threads at the same time.
+	pthread_once(&rp_cairo_backend_once_control, register_rp_cairo_backend);
+#endif /* RP_GTK_USE_CAIRO */
+
 	// NOTE: TCreateThumbnail() has wrappers for opening the
 	// ROM file and getting RomData*, but we're doing it here
 	// in order to return better error codes.
@@ -408,6 +411,13 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail2(
 		ret = RPCT_ERROR_OUTPUT_FILE_FAILED;
 		goto cleanup;
 	}
+	if (flags & RPCT_FLAG_FAST_PNG) {
+		// Favor encoding speed over file size.
+		pngWriter->setProfile(RpPngWriter::Profile::Fastest);
+	} else if (flags & RPCT_FLAG_SMALL_PNG) {
+		// Favor file size over encoding speed.
+		pngWriter->setProfile(RpPngWriter::Profile::Smallest);
+	}
 
 	/** tEXt chunks. **/
 	// NOTE: These are written before IHDR in order to put the
@@ -509,11 +519,10 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail2(
 #if defined(RP_GTK_USE_GDKTEXTURE)
 	// GdkTexture doesn't allow direct access to pixels.
 	// We'll need to download it to a local memory buffer.
-	// FIXME: Downscaling isn't working for GdkTexture yet, so we have to use the full image size.
-	//rowstride = outParams.thumbSize.width * sizeof(uint32_t);
-	//pixels = static_cast<guchar*>(malloc(rowstride * outParams.thumbSize.height));
-	rowstride = outParams.fullSize.width * sizeof(uint32_t);
-	texdata = static_cast<guchar*>(g_malloc(rowstride * outParams.fullSize.height));
+	// NOTE: The image is rescaled as an rp_image before conversion,
+	// so the texture is always thumbSize.
+	rowstride = outParams.thumbSize.width * sizeof(uint32_t);
+	texdata = static_cast<guchar*>(g_malloc(rowstride * outParams.thumbSize.height));
 	// FIXME: Using GdkTextureDownloader to convert to GDK_MEMORY_B8G8R8A8
 	// causes a heap overflow. (R8G8B8A8 works, as does B8G8R8A8_PREMULTIPLIED.)
 	// TODO: Un-premultiply the texture.
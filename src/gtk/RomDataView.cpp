@@ -36,6 +36,7 @@ using namespace LibRpTexture;
 #include <dlfcn.h>
 
 // C++ STL classes
+#include <atomic>
 using std::set;
 using std::string;
 using std::unique_ptr;
@@ -81,6 +82,9 @@ static void	rp_rom_data_view_desc_format_type_changed(RpRomDataView *page,
 static void	rp_rom_data_view_init_header_row(RpRomDataView	*page);
 static gboolean	rp_rom_data_view_update_display	(RpRomDataView	*page);
 static gboolean	rp_rom_data_view_load_rom_data	(RpRomDataView	*page);
+static void	rp_rom_data_view_start_loading	(RpRomDataView	*page,
+						 const RomDataPtr &romData);
+static void	rp_rom_data_view_cancel_loading	(RpRomDataView	*page);
 static void	rp_rom_data_view_delete_tabs	(RpRomDataView	*page);
 
 /** Signal handlers **/
@@ -368,6 +372,9 @@ rp_rom_data_view_dispose(GObject *object)
 	// Unregister changed_idle.
 	g_clear_handle_id(&page->changed_idle, g_source_remove);
 
+	// Cancel asynchronous loading, if it's still running.
+	rp_rom_data_view_cancel_loading(page);
+
 	// Delete the icon frames and tabs.
 	rp_rom_data_view_delete_tabs(page);
 
@@ -413,18 +420,14 @@ rp_rom_data_view_new_with_romData(const gchar *uri, const RomDataPtr &romData, R
 	page->desc_format_type = desc_format_type;
 	if (uri) {
 		page->uri = g_strdup(uri);
-		if (romData) {
-			page->cxx->romData = romData;
-			// NOTE: Not emitting this notification here...
-			//g_object_notify_by_pspec(G_OBJECT(page), props[PROP_SHOWING_DATA]);
-		}
 	}
 
 	if (G_LIKELY((bool)romData)) {
 		// NOTE: Don't call rp_rom_data_view_load_rom_data() because that will
 		// close and reopen romData, which wastes CPU cycles.
-		// Call rp_rom_data_view_update_display() instead.
-		page->changed_idle = g_idle_add(G_SOURCE_FUNC(rp_rom_data_view_update_display), page);
+		// Load the fields and images from the existing RomData object instead.
+		// NOTE: page->cxx->romData will be set once loading has finished.
+		rp_rom_data_view_start_loading(page, romData);
 		page->hasCheckedAchievements = false;
 	} else if (G_LIKELY(uri != nullptr)) {
 		// URI is specified, but not RomData.
@@ -527,6 +530,7 @@ rp_rom_data_view_set_uri(RpRomDataView	*page,
 		page->uri = nullptr;
 
 		// Unreference the existing RomData object.
+		rp_rom_data_view_cancel_loading(page);
 		page->cxx->romData.reset();
 		page->hasCheckedAchievements = false;
 
@@ -596,6 +600,13 @@ rp_rom_data_view_is_showing_data(RpRomDataView *page)
 	return (bool)page->cxx->romData;
 }
 
+gboolean
+rp_rom_data_view_is_loading(RpRomDataView *page)
+{
+	g_return_val_if_fail(RP_IS_ROM_DATA_VIEW(page), false);
+	return (page->changed_idle != 0 || page->cxx->loaderJob != nullptr);
+}
+
 static void
 rp_rom_data_view_init_header_row(RpRomDataView *page)
 {
@@ -1658,38 +1669,167 @@ rp_rom_data_view_load_rom_data(RpRomDataView *page)
 		g_object_notify_by_pspec(G_OBJECT(page), props[PROP_SHOWING_DATA]);
 	}
 
-	// Load the specified URI.
-	RomDataPtr romData = rp_gtk_open_uri(page->uri);
-	if (romData) {
-		page->cxx->romData = std::move(romData);
-		page->hasCheckedAchievements = false;
+	// Load the specified URI on a worker thread.
+	rp_rom_data_view_start_loading(page, RomDataPtr());
+
+	// Clear the timeout.
+	page->changed_idle = 0;
+	return G_SOURCE_REMOVE;
+}
+
+/** Asynchronous loading **/
+
+/**
+ * Asynchronous RomData loader job.
+ * Created and freed on the GUI thread.
+ */
+struct RomDataLoaderJob {
+	RpRomDataView *page;		// RomDataView (ref'd until the job is freed)
+	gchar *uri;			// URI to open if romData isn't set
+	RomDataPtr romData;		// RomData object
+	std::atomic<bool> cancelled;	// Set by rp_rom_data_view_cancel_loading()
+
+	RomDataLoaderJob(RpRomDataView *page, const RomDataPtr &romData)
+		: page(static_cast<RpRomDataView*>(g_object_ref(page)))
+		, uri(g_strdup(page->uri))
+		, romData(romData)
+		, cancelled(false)
+	{}
+
+	~RomDataLoaderJob()
+	{
+		g_free(uri);
+		g_object_unref(page);
 	}
 
-	if (page->cxx->romData) {
-		// Update the display widgets.
-		// TODO: If already mapped, check achievements again.
-		// NOTE: This will clear page->changed_idle.
-		rp_rom_data_view_update_display(page);
+	RP_DISABLE_COPY(RomDataLoaderJob)
+};
+
+/**
+ * Asynchronous RomData loader: Loading has finished.
+ * This is run on the GUI thread using g_idle_add().
+ * @param job RomDataLoaderJob
+ * @return G_SOURCE_REMOVE
+ */
+static gboolean
+rp_rom_data_view_loader_done(RomDataLoaderJob *job)
+{
+	RpRomDataView *const page = job->page;
+
+	if (!job->cancelled.load(std::memory_order_relaxed)) {
+		assert(page->cxx->loaderJob == job);
+		page->cxx->loaderJob = nullptr;
+
+		if (job->romData) {
+			page->cxx->romData = job->romData;
+			page->hasCheckedAchievements = false;
+
+			// Update the display widgets.
+			// TODO: If already mapped, check achievements again.
+			rp_rom_data_view_update_display(page);
+
+			// Send a notification for PROP_SHOWING_DATA here,
+			// since the data is now actually being shown.
+			g_object_notify_by_pspec(G_OBJECT(page), props[PROP_SHOWING_DATA]);
+		}
+
+		// Animation timer will be started when the page
+		// receives the "map" signal.
+		if (gtk_widget_get_mapped(GTK_WIDGET(page))) {
+			rp_rom_data_view_map_signal_handler(page, 0);
+		}
+	}
 
+	if (job->romData) {
 		// Make sure the underlying file handle is closed,
 		// since we don't need it once the RomData has been
 		// loaded by RomDataView.
-		page->cxx->romData->close();
+		job->romData->close();
+	}
 
-		// Send a notification for PROP_SHOWING_DATA here,
-		// since the data is now actually being shown.
-		g_object_notify_by_pspec(G_OBJECT(page), props[PROP_SHOWING_DATA]);
+	delete job;
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * Asynchronous RomData loader thread function.
+ * @param job RomDataLoaderJob
+ * @return nullptr
+ */
+static gpointer
+rp_rom_data_view_loader_thread_run(RomDataLoaderJob *job)
+{
+	// NOTE: Check for cancellation between each step, since
+	// the user may have closed the dialog in the meantime.
+	if (!job->romData && !job->cancelled.load(std::memory_order_relaxed)) {
+		job->romData = rp_gtk_open_uri(job->uri);
 	}
 
-	// Animation timer will be started when the page
-	// receives the "map" signal.
-	if (gtk_widget_get_mapped(GTK_WIDGET(page))) {
-		rp_rom_data_view_map_signal_handler(page, 0);
+	// Load everything that RomDataView needs.
+	// RomData caches the results, so the GUI thread won't
+	// need to read from the file again.
+	const RomDataPtr &romData = job->romData;
+	if (romData && !job->cancelled.load(std::memory_order_relaxed)) {
+		romData->fields();
+	}
+	if (romData && !job->cancelled.load(std::memory_order_relaxed)) {
+		romData->metaData();
+	}
+	if (romData && !job->cancelled.load(std::memory_order_relaxed)) {
+		const uint32_t imgbf = romData->supportedImageTypes();
+		if (imgbf & RomData::IMGBF_INT_BANNER) {
+			romData->image(RomData::IMG_INT_BANNER);
+		}
+		if ((imgbf & RomData::IMGBF_INT_ICON) && !job->cancelled.load(std::memory_order_relaxed)) {
+			romData->image(RomData::IMG_INT_ICON);
+			romData->iconAnimData();
+		}
 	}
 
-	// Clear the timeout.
-	page->changed_idle = 0;
-	return G_SOURCE_REMOVE;
+	// Pass the results back to the GUI thread.
+	g_idle_add(G_SOURCE_FUNC(rp_rom_data_view_loader_done), job);
+	return nullptr;
+}
+
+/**
+ * Start loading a RomData object on a worker thread.
+ * Any existing loader job will be cancelled.
+ * @param page RomDataView
+ * @param romData RomData object, or nullptr to open page->uri.
+ */
+static void
+rp_rom_data_view_start_loading(RpRomDataView *page, const RomDataPtr &romData)
+{
+	rp_rom_data_view_cancel_loading(page);
+
+	RomDataLoaderJob *const job = new RomDataLoaderJob(page, romData);
+	GThread *const thread = g_thread_try_new("RomDataLoader",
+		(GThreadFunc)rp_rom_data_view_loader_thread_run, job, nullptr);
+	if (G_UNLIKELY(!thread)) {
+		// Unable to create a thread. Load the RomData object synchronously.
+		page->cxx->loaderJob = job;
+		rp_rom_data_view_loader_thread_run(job);
+		return;
+	}
+
+	// The thread will exit on its own.
+	g_thread_unref(thread);
+	page->cxx->loaderJob = job;
+}
+
+/**
+ * Cancel asynchronous RomData loading, if it's running.
+ * The loader job will be freed once the worker thread is done.
+ * @param page RomDataView
+ */
+static void
+rp_rom_data_view_cancel_loading(RpRomDataView *page)
+{
+	RomDataLoaderJob *const job = page->cxx->loaderJob;
+	if (job) {
+		job->cancelled.store(true, std::memory_order_relaxed);
+		page->cxx->loaderJob = nullptr;
+	}
 }
 
 /**
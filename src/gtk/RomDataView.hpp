@@ -40,6 +40,7 @@ void		rp_rom_data_view_set_desc_format_type(RpRomDataView *page,
 						   RpDescFormatType desc_format_type);
 
 gboolean	rp_rom_data_view_is_showing_data(RpRomDataView	*page);
+gboolean	rp_rom_data_view_is_loading	(RpRomDataView	*page);
 
 G_END_DECLS
 
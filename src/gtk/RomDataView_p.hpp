@@ -71,6 +71,9 @@ struct Data_ListDataMulti_t {
 };
 #endif /* GTK_CHECK_VERSION(4,0,0) */
 
+// Asynchronous RomData loader job (see RomDataView.cpp)
+struct RomDataLoaderJob;
+
 // C++ objects
 struct _RpRomDataViewCxx {
 	LibRpBase::RomDataPtr	romData;	// RomData
@@ -95,6 +98,9 @@ struct _RpRomDataViewCxx {
 
 	// Default language code for multi-language.
 	uint32_t def_lc;
+
+	// Asynchronous RomData loader job, if one is running.
+	RomDataLoaderJob *loaderJob;
 };
 
 // GTK+ property page instance
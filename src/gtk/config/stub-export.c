@@ -246,9 +246,11 @@ rp_RomDataView_app_activate(GtkApplication *app, const gchar *uri)
 #endif /* GTK_CHECK_VERSION(4,0,0) */
 
 	// NOTE: Need to run the idle process in order for RomDataView to process the URI.
+	// RomDataView loads the RomData object on a worker thread, so keep
+	// iterating the main loop until it's done.
 	// TODO: Create the RomData object here instead? (would need to convert to .cpp)
 	// Also, we'd be able to check for RomData without having to create everything first...
-	while (g_main_context_pending(NULL)) {
+	while (g_main_context_pending(NULL) || rp_rom_data_view_is_loading(RP_ROM_DATA_VIEW(romDataView))) {
 		g_main_context_iteration(NULL, TRUE);
 	}
 	if (!rp_rom_data_view_is_showing_data(RP_ROM_DATA_VIEW(romDataView))) {
@@ -8,6 +8,7 @@
 
 #include "stdafx.h"
 #include "CairoImageConv.hpp"
+#include "RpCairoBackend.hpp"
 
 // C++ STL classes
 using std::array;
@@ -18,11 +19,52 @@ using namespace LibRpTexture;
 
 namespace CairoImageConv {
 
+/**
+ * Get the cairo_surface_t from an rp_image that uses RpCairoBackend.
+ * @param img		[in] rp_image.
+ * @param premultiply	[in] If true, premultiply.
+ * @return cairo_surface_t, or nullptr if the image doesn't use RpCairoBackend.
+ */
+static cairo_surface_t *rp_image_get_cairo_surface_t(const rp_image *img, bool premultiply)
+{
+	if (img->format() != rp_image::Format::ARGB32)
+		return nullptr;
+
+	const RpCairoBackend *const backend = dynamic_cast<const RpCairoBackend*>(img->backend());
+	if (!backend)
+		return nullptr;
+
+	if (premultiply) {
+		// Premultiplication isn't needed if the image doesn't have
+		// an alpha channel, since all alpha values are 0xFF.
+		rp_image::sBIT_t sBIT;
+		if (img->get_sBIT(&sBIT) != 0 || sBIT.alpha != 0) {
+			// Premultiply a copy of the image.
+			// The copy also uses RpCairoBackend, so its surface can be
+			// returned directly. The surface keeps the image data alive
+			// after the copied rp_image is deleted.
+			const rp_image_ptr img_prex = img->dup();
+			if (!img_prex || img_prex->premultiply() != 0)
+				return nullptr;
+			const RpCairoBackend *const backend_prex =
+				dynamic_cast<const RpCairoBackend*>(img_prex->backend());
+			return (backend_prex ? backend_prex->getCairoSurface() : nullptr);
+		}
+	}
+
+	// Use the image data directly.
+	return backend->getCairoSurface();
+}
+
 /**
  * Convert an rp_image to cairo_surface_t.
+ *
+ * If the rp_image uses RpCairoBackend, the backend's surface is
+ * returned directly if no premultiplication is needed.
+ *
  * @param img		[in] rp_image.
  * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
- * @return GdkPixbuf, or nullptr on error.
+ * @return cairo_surface_t, or nullptr on error.
  */
 cairo_surface_t *rp_image_to_cairo_surface_t(const rp_image *img, bool premultiply)
 {
@@ -30,6 +72,12 @@ cairo_surface_t *rp_image_to_cairo_surface_t(const rp_image *img, bool premultip
 	if (unlikely(!img || !img->isValid()))
 		return nullptr;
 
+	// Check if the image data is already stored in a cairo_surface_t.
+	cairo_surface_t *surface = rp_image_get_cairo_surface_t(img, premultiply);
+	if (surface) {
+		return surface;
+	}
+
 	// NOTE: cairo_image_surface_create_for_data() doesn't do a
 	// deep copy, so we can't use it.
 	// NOTE 2: cairo_image_surface_create() always returns a valid
@@ -37,7 +85,7 @@ cairo_surface_t *rp_image_to_cairo_surface_t(const rp_image *img, bool premultip
 	// it failed to create a surface. We'll still check for nullptr.
 	const int width = img->width();
 	const int height = img->height();
-	cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+	surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
 	// cairo_image_surface_create() always returns a valid pointer.
 	assert(cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS);
 	if (unlikely(cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)) {
@@ -8,8 +8,9 @@
 
 #pragma once
 
-// NOTE: Cairo doesn't natively support 8bpp. Because of this,
-// we can't simply make a cairo_surface_t rp_image backend.
+// NOTE: Cairo doesn't natively support 8bpp, so RpCairoBackend
+// only stores ARGB32 images in a cairo_surface_t. CI8 images
+// still need to be converted.
 
 #include "common.h"
 
@@ -22,6 +23,10 @@ namespace CairoImageConv {
 
 /**
  * Convert an rp_image to cairo_surface_t.
+ *
+ * If the rp_image uses RpCairoBackend, the backend's surface is
+ * returned directly if no premultiplication is needed.
+ *
  * @param img		[in] rp_image.
  * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
  * @return cairo_surface_t, or nullptr on error.
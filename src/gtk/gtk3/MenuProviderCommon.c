@@ -14,10 +14,56 @@
 
 #include "tcharx.h"	// for DIR_SEP_CHR
 
+// sysconf()
+#include <unistd.h>
+
 // Supported MIME types
 // TODO: Consolidate with the KF5 service menu?
 #include "mime-types.convert-to-png.h"
 
+// Maximum number of worker threads for "Convert to PNG".
+#define MAX_WORKER_THREADS 16
+
+// Minimum interval between progress notification updates, in microseconds.
+#define PROGRESS_UPDATE_INTERVAL_US (250 * 1000)
+
+// Application action used to cancel a conversion job.
+#define CANCEL_ACTION_NAME "rp-convert-to-png-cancel"
+
+/**
+ * "Convert to PNG" job.
+ * Reference-counted, since it's used by both the worker
+ * threads and the main thread.
+ */
+typedef struct _RpConvertToPngJob {
+	volatile gint ref_count;
+	guint id;			// Job ID (for notifications)
+
+	gchar **source_uris;		// Source URIs (NULL-terminated)
+	guint total;			// Number of source URIs
+	gboolean fast;			// Favor PNG encoding speed
+
+	volatile gint next;		// Next URI index to convert
+	volatile gint completed;	// Number of URIs processed (including skipped)
+	volatile gint failed;		// Number of URIs that failed
+	volatile gint progress_pending;	// Set if a progress update is queued
+
+	GCancellable *cancellable;
+	gint64 last_update;		// Last progress update (main thread only)
+} RpConvertToPngJob;
+
+// Shared worker pool and active jobs.
+// NOTE: These are only accessed on the main thread.
+static GThreadPool *convert_pool = NULL;
+static GHashTable *active_jobs = NULL;	// value: job (holds a reference)
+static guint last_job_id = 0;
+
+#if GLIB_CHECK_VERSION(2,40,0)
+// Set if we added the "Cancel" action to the GApplication.
+// It's removed once all jobs have finished.
+static gboolean cancel_action_added = FALSE;
+#endif /* GLIB_CHECK_VERSION(2,40,0) */
+
 /**
  * Is a URI using the file:// scheme?
  * @param uri URI
@@ -42,9 +88,10 @@ gboolean rp_is_file_uri(const gchar *uri)
 /**
  * Convert the source URI to a PNG image.
  * @param source_uri URI
+ * @param fast If TRUE, favor PNG encoding speed over file size.
  * @return 0 on success; non-zero on error.
  */
-int rp_menu_provider_convert_to_png(const gchar *source_uri)
+int rp_menu_provider_convert_to_png(const gchar *source_uri, gboolean fast)
 {
 	// FIXME: We don't support writing to non-local files right now.
 	// Only allow file:// protocol.
@@ -88,12 +135,274 @@ int rp_menu_provider_convert_to_png(const gchar *source_uri)
 
 	// Convert the file using rp_create_thumbnail2().
 	// TODO: Check for errors?
-	int ret = rp_create_thumbnail2(source_uri, output_file, 0, RPCT_FLAG_NO_XDG_THUMBNAIL_METADATA);
+	unsigned int flags = RPCT_FLAG_NO_XDG_THUMBNAIL_METADATA;
+	if (fast) {
+		flags |= RPCT_FLAG_FAST_PNG;
+	}
+	int ret = rp_create_thumbnail2(source_uri, output_file, 0, flags);
 	g_free(output_file_esc);
 	g_free(output_file);
 	return ret;
 }
 
+/** "Convert to PNG" jobs **/
+
+static RpConvertToPngJob*
+rp_convert_to_png_job_ref(RpConvertToPngJob *job)
+{
+	g_atomic_int_inc(&job->ref_count);
+	return job;
+}
+
+static void
+rp_convert_to_png_job_unref(RpConvertToPngJob *job)
+{
+	if (g_atomic_int_dec_and_test(&job->ref_count)) {
+		g_strfreev(job->source_uris);
+		g_object_unref(job->cancellable);
+		g_free(job);
+	}
+}
+
+/**
+ * Update the progress notification for a job.
+ * Must be called on the main thread.
+ * @param job Job
+ * @param finished TRUE if the job has finished.
+ */
+static void
+rp_convert_to_png_job_notify(RpConvertToPngJob *job, gboolean finished)
+{
+	if (job->total <= 1) {
+		// Single file. Don't bother with notifications.
+		return;
+	}
+
+	const guint completed = (guint)g_atomic_int_get(&job->completed);
+	const guint failed = (guint)g_atomic_int_get(&job->failed);
+	const gboolean cancelled = g_cancellable_is_cancelled(job->cancellable);
+
+#if GLIB_CHECK_VERSION(2,40,0)
+	GApplication *const app = g_application_get_default();
+	if (app && g_application_get_is_registered(app)) {
+		gchar *const notification_id = g_strdup_printf("rp-convert-to-png-%u", job->id);
+		GNotification *const notification = g_notification_new(finished
+			? C_("ServiceMenu", "Conversion to PNG finished")
+			: C_("ServiceMenu", "Converting to PNG"));
+
+		gchar *body;
+		if (!finished) {
+			body = g_strdup_printf(C_("ServiceMenu", "%u of %u files processed."), completed, job->total);
+			g_notification_add_button_with_target(notification,
+				C_("ServiceMenu", "Cancel"), "app." CANCEL_ACTION_NAME, "u", job->id);
+		} else if (cancelled) {
+			body = g_strdup(C_("ServiceMenu", "Conversion was cancelled."));
+		} else if (failed > 0) {
+			body = g_strdup_printf(C_("ServiceMenu", "%u of %u files could not be converted."), failed, job->total);
+		} else {
+			body = g_strdup_printf(NC_("ServiceMenu",
+				"%u file was converted.", "%u files were converted.", job->total), job->total);
+		}
+		g_notification_set_body(notification, body);
+		g_free(body);
+
+		g_application_send_notification(app, notification_id, notification);
+		g_object_unref(notification);
+		g_free(notification_id);
+		return;
+	}
+#endif /* GLIB_CHECK_VERSION(2,40,0) */
+
+	// No notification support. Log the progress instead.
+	if (finished) {
+		g_debug("Convert to PNG job %u: %u of %u files processed, %u failed%s",
+			job->id, completed, job->total, failed, (cancelled ? " (cancelled)" : ""));
+	}
+}
+
+/**
+ * Progress update. (GSourceFunc; called on the main thread)
+ * @param job Job (reference is released)
+ * @return G_SOURCE_REMOVE
+ */
+static gboolean
+rp_convert_to_png_job_progress_idle(RpConvertToPngJob *job)
+{
+	g_atomic_int_set(&job->progress_pending, 0);
+
+	// Throttle notification updates.
+	const gint64 now = g_get_monotonic_time();
+	if (now - job->last_update >= PROGRESS_UPDATE_INTERVAL_US &&
+	    g_hash_table_contains(active_jobs, GUINT_TO_POINTER(job->id)))
+	{
+		job->last_update = now;
+		rp_convert_to_png_job_notify(job, FALSE);
+	}
+
+	rp_convert_to_png_job_unref(job);
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * Job finished. (GSourceFunc; called on the main thread)
+ * @param job Job (reference is released)
+ * @return G_SOURCE_REMOVE
+ */
+static gboolean
+rp_convert_to_png_job_finished_idle(RpConvertToPngJob *job)
+{
+	// NOTE: This releases active_jobs's reference.
+	g_hash_table_remove(active_jobs, GUINT_TO_POINTER(job->id));
+	rp_convert_to_png_job_notify(job, TRUE);
+
+#if GLIB_CHECK_VERSION(2,40,0)
+	if (cancel_action_added && g_hash_table_size(active_jobs) == 0) {
+		// No more jobs. Remove the "Cancel" action so it
+		// doesn't stay in the host application's action map.
+		GApplication *const app = g_application_get_default();
+		if (app) {
+			g_action_map_remove_action(G_ACTION_MAP(app), CANCEL_ACTION_NAME);
+		}
+		cancel_action_added = FALSE;
+	}
+#endif /* GLIB_CHECK_VERSION(2,40,0) */
+
+	rp_convert_to_png_job_unref(job);
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * Convert one file from a job. (GFunc; called on a worker thread)
+ *
+ * The job is pushed to the thread pool once per file, and each
+ * worker takes the next unconverted URI. Each push holds its own
+ * job reference, which is released once the worker is done with
+ * the job, so the job can't be freed by the main thread while
+ * a worker is still using it.
+ *
+ * @param data Job (reference is released)
+ * @param user_data Unused
+ */
+static void
+rp_convert_to_png_job_worker(gpointer data, gpointer user_data)
+{
+	RP_UNUSED(user_data);
+	RpConvertToPngJob *const job = (RpConvertToPngJob*)data;
+
+	const guint idx = (guint)g_atomic_int_add(&job->next, 1);
+	if (idx < job->total && !g_cancellable_is_cancelled(job->cancellable)) {
+		if (rp_menu_provider_convert_to_png(job->source_uris[idx], job->fast) != 0) {
+			g_atomic_int_inc(&job->failed);
+		}
+	}
+
+	const guint completed = (guint)g_atomic_int_add(&job->completed, 1) + 1;
+	if (completed >= job->total) {
+		// All files have been processed.
+		g_idle_add((GSourceFunc)rp_convert_to_png_job_finished_idle, rp_convert_to_png_job_ref(job));
+	} else if (g_atomic_int_compare_and_exchange(&job->progress_pending, 0, 1)) {
+		g_idle_add((GSourceFunc)rp_convert_to_png_job_progress_idle, rp_convert_to_png_job_ref(job));
+	}
+
+	// Release this push's reference.
+	rp_convert_to_png_job_unref(job);
+}
+
+#if GLIB_CHECK_VERSION(2,40,0)
+/**
+ * "Cancel" action was activated.
+ * @param action Action
+ * @param parameter Job ID
+ * @param user_data Unused
+ */
+static void
+rp_convert_to_png_cancel_activated(GSimpleAction *action, GVariant *parameter, gpointer user_data)
+{
+	RP_UNUSED(action);
+	RP_UNUSED(user_data);
+
+	const guint id = g_variant_get_uint32(parameter);
+	RpConvertToPngJob *const job = (RpConvertToPngJob*)g_hash_table_lookup(active_jobs, GUINT_TO_POINTER(id));
+	if (job) {
+		g_cancellable_cancel(job->cancellable);
+	}
+}
+#endif /* GLIB_CHECK_VERSION(2,40,0) */
+
+/**
+ * Convert multiple source URIs to PNG images in the background.
+ *
+ * The files are converted on a shared worker pool that's sized to
+ * the number of CPUs. If more than one file is being converted,
+ * progress is shown using a desktop notification, which includes
+ * a "Cancel" button.
+ *
+ * This function must be called from the main thread.
+ *
+ * @param source_uris NULL-terminated array of URIs (transfer full)
+ */
+void rp_menu_provider_convert_to_png_async(gchar **source_uris)
+{
+	const guint total = (source_uris ? g_strv_length(source_uris) : 0);
+	if (total == 0) {
+		g_strfreev(source_uris);
+		return;
+	}
+
+	if (!convert_pool) {
+		// Create the shared worker pool.
+		// NOTE: g_get_num_processors() requires glib-2.36.
+		const long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+		gint max_threads = (nprocs > 0) ? (gint)nprocs : 1;
+		if (max_threads > MAX_WORKER_THREADS) {
+			max_threads = MAX_WORKER_THREADS;
+		}
+
+		GError *error = NULL;
+		convert_pool = g_thread_pool_new(rp_convert_to_png_job_worker, NULL, max_threads, FALSE, &error);
+		if (error) {
+			g_critical("Error creating the Convert to PNG thread pool: %s", error->message);
+			g_error_free(error);
+			g_strfreev(source_uris);
+			return;
+		}
+
+		active_jobs = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+			NULL, (GDestroyNotify)rp_convert_to_png_job_unref);
+	}
+
+#if GLIB_CHECK_VERSION(2,40,0)
+	// Register the "Cancel" action for progress notifications.
+	GApplication *const app = g_application_get_default();
+	if (app && !g_action_map_lookup_action(G_ACTION_MAP(app), CANCEL_ACTION_NAME)) {
+		GSimpleAction *const action = g_simple_action_new(CANCEL_ACTION_NAME, G_VARIANT_TYPE_UINT32);
+		g_signal_connect(action, "activate", G_CALLBACK(rp_convert_to_png_cancel_activated), NULL);
+		g_action_map_add_action(G_ACTION_MAP(app), G_ACTION(action));
+		g_object_unref(action);
+		cancel_action_added = TRUE;
+	}
+#endif /* GLIB_CHECK_VERSION(2,40,0) */
+
+	RpConvertToPngJob *const job = g_new0(RpConvertToPngJob, 1);
+	job->ref_count = 1;	// held by active_jobs
+	job->id = ++last_job_id;
+	job->source_uris = source_uris;
+	job->total = total;
+	// Use the faster PNG encoder settings for bulk conversions.
+	job->fast = (total > 1);
+	job->cancellable = g_cancellable_new();
+	job->last_update = g_get_monotonic_time();
+	g_hash_table_insert(active_jobs, GUINT_TO_POINTER(job->id), job);
+
+	rp_convert_to_png_job_notify(job, FALSE);
+
+	// Push the job once for each file.
+	// Each push holds a reference, which is released by the worker.
+	for (guint i = 0; i < total; i++) {
+		g_thread_pool_push(convert_pool, rp_convert_to_png_job_ref(job), NULL);
+	}
+}
+
 /**
  * Comparator function for rp_menu_provider_is_mime_type_supported().
  *
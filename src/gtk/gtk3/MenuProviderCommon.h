@@ -22,9 +22,24 @@ gboolean rp_is_file_uri(const gchar *uri);
 /**
  * Convert the source URI to a PNG image.
  * @param source_uri URI
+ * @param fast If TRUE, favor PNG encoding speed over file size.
  * @return 0 on success; non-zero on error.
  */
-int rp_menu_provider_convert_to_png(const gchar *source_uri);
+int rp_menu_provider_convert_to_png(const gchar *source_uri, gboolean fast);
+
+/**
+ * Convert multiple source URIs to PNG images in the background.
+ *
+ * The files are converted on a shared worker pool that's sized to
+ * the number of CPUs. If more than one file is being converted,
+ * progress is shown using a desktop notification, which includes
+ * a "Cancel" button.
+ *
+ * This function must be called from the main thread.
+ *
+ * @param source_uris NULL-terminated array of URIs (transfer full)
+ */
+void rp_menu_provider_convert_to_png_async(gchar **source_uris);
 
 /**
  * Is a MIME type supported for "Convert to PNG"?
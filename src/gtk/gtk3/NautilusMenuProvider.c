@@ -96,24 +96,6 @@ rp_nautilus_menu_provider_page_provider_init(NautilusMenuProviderInterface *ifac
 	iface->get_file_items = rp_nautilus_menu_provider_get_file_items;
 }
 
-static gpointer
-rp_item_convert_to_png_ThreadFunc(GList *files)
-{
-	for (GList *file = files; file != NULL; file = file->next) {
-		gchar *const source_uri = nautilus_file_info_get_uri(NAUTILUS_FILE_INFO(file->data));
-		if (G_UNLIKELY(!source_uri))
-			continue;
-
-		// TODO: Check for errors.
-		rp_menu_provider_convert_to_png(source_uri);
-
-		g_free(source_uri);
-	}
-
-	nautilus_file_info_list_free(files);
-	return NULL;
-}
-
 static void
 rp_item_convert_to_png(NautilusMenuItem *item, gpointer user_data)
 {
@@ -123,13 +105,21 @@ rp_item_convert_to_png(NautilusMenuItem *item, gpointer user_data)
 	if (G_UNLIKELY(!files))
 		return;
 
-	// Process the files in a separate thread.
-	char thread_name[64];
-	snprintf(thread_name, sizeof(thread_name), "rp-convert-to-png-%p", files);
-	GThread *const thread = g_thread_new(thread_name, (GThreadFunc)rp_item_convert_to_png_ThreadFunc, files);
+	// Get the URIs here, since the file info objects
+	// shouldn't be used on the worker threads.
+	GPtrArray *const source_uris = g_ptr_array_new();
+	for (GList *file = files; file != NULL; file = file->next) {
+		gchar *const source_uri = nautilus_file_info_get_uri(NAUTILUS_FILE_INFO(file->data));
+		if (G_LIKELY(source_uri)) {
+			g_ptr_array_add(source_uris, source_uri);
+		}
+	}
+	g_ptr_array_add(source_uris, NULL);
+	nautilus_file_info_list_free(files);
 
-	// TODO: Do we want to keep a handle to the thread somewhere?
-	g_thread_unref(thread);
+	// Process the files on the worker pool.
+	// TODO: Check for errors.
+	rp_menu_provider_convert_to_png_async((gchar**)g_ptr_array_free(source_uris, FALSE));
 }
 
 static GList*
@@ -14,6 +14,10 @@
 #include "NautilusMenuProvider.h"
 #include "NautilusPropertyPageProvider.hpp"
 #include "plugin-helper.h"
+#include "RpCairoBackend.hpp"
+
+// librptexture
+using LibRpTexture::rp_image;
 
 static GType type_list[2];
 
@@ -93,6 +97,9 @@ prefix##_module_initialize(GTypeModule *module) \
 \
 	/* Symbols loaded. Register our types. */ \
 	rp_nautilus_register_types(module); \
+\
+	/* Store rp_image data in cairo_surface_t. */ \
+	rp_image::setBackendCreatorFn(RpCairoBackend::creator_fn); \
 \
 	/* Register AchGDBus if it's available. */ \
 	REGISTER_ACHDBUS(); \
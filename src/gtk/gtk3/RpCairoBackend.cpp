@@ -0,0 +1,238 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ 3.x)                         *
+ * RpCairoBackend.cpp: rp_image_backend using cairo_surface_t.             *
+ *                                                                         *
+ * Copyright (c) 2017-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RpCairoBackend.hpp"
+
+// librpbase, librptexture
+#include "aligned_malloc.h"
+#include "librptexture/ImageSizeCalc.hpp"
+using namespace LibRpTexture;
+
+// User data key for the surface's image data buffer.
+static cairo_user_data_key_t rp_cairo_data_key;
+
+/**
+ * Create a CAIRO_FORMAT_ARGB32 image surface with 16-byte row alignment.
+ *
+ * cairo_image_surface_create() only uses 4-byte row alignment,
+ * so we'll need to allocate our own memory buffer.
+ * The surface takes ownership of the buffer.
+ *
+ * @param width Width
+ * @param height Height
+ * @param stride Stride (must be a multiple of 16)
+ * @return Image surface, or nullptr on error.
+ */
+static cairo_surface_t *rp_cairo_surface_create_aligned(int width, int height, int stride)
+{
+	assert(stride >= cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width));
+	uint8_t *const data = static_cast<uint8_t*>(aligned_malloc(16,
+		ImageSizeCalc::T_calcImageSize(stride, height)));
+	if (!data) {
+		// Error allocating the memory buffer.
+		return nullptr;
+	}
+
+	cairo_surface_t *const surface = cairo_image_surface_create_for_data(
+		data, CAIRO_FORMAT_ARGB32, width, height, stride);
+	if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+		cairo_surface_destroy(surface);
+		aligned_free(data);
+		return nullptr;
+	}
+
+	// The memory buffer will be freed when the surface is destroyed.
+	if (cairo_surface_set_user_data(surface, &rp_cairo_data_key, data, aligned_free) != CAIRO_STATUS_SUCCESS) {
+		cairo_surface_destroy(surface);
+		aligned_free(data);
+		return nullptr;
+	}
+
+	return surface;
+}
+
+RpCairoBackend::RpCairoBackend(int width, int height, rp_image::Format format)
+	: super(width, height, format)
+	, m_surface(nullptr)
+	, m_ci8_data(nullptr)
+	, m_palette(nullptr)
+{
+	if (this->width == 0 || this->height == 0) {
+		// Error initializing the backend.
+		// (Width, height, or format is probably broken.)
+		return;
+	}
+
+	switch (format) {
+		case rp_image::Format::CI8: {
+			m_ci8_data = static_cast<uint8_t*>(aligned_malloc(16,
+				ImageSizeCalc::T_calcImageSize(this->stride, height)));
+			m_palette = static_cast<uint32_t*>(aligned_malloc(16, 256*sizeof(*m_palette)));
+			if (!m_ci8_data || !m_palette) {
+				// Failed to allocate memory.
+				aligned_free(m_ci8_data);
+				aligned_free(m_palette);
+				m_ci8_data = nullptr;
+				m_palette = nullptr;
+				clear_properties();
+				return;
+			}
+
+			// Palette is initialized to 0 to ensure
+			// there's no weird artifacts if the caller
+			// is converting a lower-color image.
+			memset(m_palette, 0, 256*sizeof(*m_palette));
+			break;
+		}
+
+		case rp_image::Format::ARGB32:
+			// We're using the full stride for the last row
+			// to make it easier to manage. (Cairo does this as well.)
+			m_surface = rp_cairo_surface_create_aligned(width, height, this->stride);
+			if (!m_surface) {
+				// Error creating the surface.
+				clear_properties();
+				return;
+			}
+
+			// Make sure we have the correct stride.
+			assert(this->stride == cairo_image_surface_get_stride(m_surface));
+			break;
+
+		default:
+			assert(!"Unsupported rp_image::Format.");
+			clear_properties();
+			break;
+	}
+}
+
+RpCairoBackend::~RpCairoBackend()
+{
+	if (m_surface) {
+		cairo_surface_destroy(m_surface);
+	}
+	aligned_free(m_ci8_data);
+	aligned_free(m_palette);
+}
+
+/**
+ * Creator function for rp_image::setBackendCreatorFn().
+ */
+rp_image_backend *RpCairoBackend::creator_fn(int width, int height, rp_image::Format format)
+{
+	return new RpCairoBackend(width, height, format);
+}
+
+void *RpCairoBackend::data(void)
+{
+	if (m_surface) {
+		return cairo_image_surface_get_data(m_surface);
+	}
+	return m_ci8_data;
+}
+
+const void *RpCairoBackend::data(void) const
+{
+	if (m_surface) {
+		return cairo_image_surface_get_data(m_surface);
+	}
+	return m_ci8_data;
+}
+
+size_t RpCairoBackend::data_len(void) const
+{
+	if (!m_surface && !m_ci8_data)
+		return 0;
+	return ImageSizeCalc::T_calcImageSize(this->stride, this->height);
+}
+
+uint32_t *RpCairoBackend::palette(void)
+{
+	return m_palette;
+}
+
+const uint32_t *RpCairoBackend::palette(void) const
+{
+	return m_palette;
+}
+
+unsigned int RpCairoBackend::palette_len(void) const
+{
+	return (m_palette ? 256U : 0U);
+}
+
+/**
+ * Shrink image dimensions.
+ * @param width New width.
+ * @param height New height.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpCairoBackend::shrink(int width, int height)
+{
+	assert(width > 0);
+	assert(height > 0);
+	assert(this->width > 0);
+	assert(this->height > 0);
+	assert(width <= this->width);
+	assert(height <= this->height);
+	if (width <= 0 || height <= 0 ||
+	    this->width <= 0 || this->height <= 0 ||
+	    width > this->width || height > this->height)
+	{
+		return -EINVAL;
+	}
+
+	if (width == this->width && height == this->height) {
+		// Attempting to resize to the same size...
+		return 0;
+	}
+
+	if (m_surface) {
+		// cairo_surface_t doesn't support changing width/height in-place,
+		// so we'll need to copy it to a new surface.
+		// NOTE: The stride is kept as-is so the rows can be copied all at once.
+		cairo_surface_t *const new_surface = rp_cairo_surface_create_aligned(width, height, this->stride);
+		if (!new_surface) {
+			return -ENOMEM;
+		}
+		cairo_surface_flush(m_surface);
+		memcpy(cairo_image_surface_get_data(new_surface),
+			cairo_image_surface_get_data(m_surface),
+			ImageSizeCalc::T_calcImageSize(this->stride, height));
+		cairo_surface_mark_dirty(new_surface);
+		cairo_surface_destroy(m_surface);
+		m_surface = new_surface;
+	}
+
+	// CI8: Only the dimensions need to be changed.
+	this->width = width;
+	this->height = height;
+	return 0;
+}
+
+/**
+ * Get the underlying cairo_surface_t.
+ *
+ * NOTE: The surface shares its image data with the rp_image.
+ * rp_image uses straight alpha, so the surface must be
+ * premultiplied before it's displayed, unless the image
+ * doesn't have an alpha channel.
+ *
+ * @return New reference to the cairo_surface_t, or nullptr if the image isn't ARGB32.
+ */
+cairo_surface_t *RpCairoBackend::getCairoSurface(void) const
+{
+	if (!m_surface) {
+		return nullptr;
+	}
+
+	// The image data may have been modified directly.
+	cairo_surface_mark_dirty(m_surface);
+	return cairo_surface_reference(m_surface);
+}
@@ -0,0 +1,82 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ 3.x)                         *
+ * RpCairoBackend.hpp: rp_image_backend using cairo_surface_t.             *
+ *                                                                         *
+ * Copyright (c) 2017-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+// librptexture
+#include "librptexture/img/rp_image_backend.hpp"
+
+// Cairo
+#include <cairo.h>
+
+/**
+ * rp_image data storage class.
+ *
+ * ARGB32 images are stored in a CAIRO_FORMAT_ARGB32 image surface,
+ * so they can be used by GTK without copying the image data.
+ *
+ * Cairo doesn't natively support 8bpp, so CI8 images are stored
+ * in a regular memory buffer and must be converted using
+ * CairoImageConv::rp_image_to_cairo_surface_t().
+ */
+class RpCairoBackend : public LibRpTexture::rp_image_backend
+{
+public:
+	RpCairoBackend(int width, int height, LibRpTexture::rp_image::Format format);
+	~RpCairoBackend() final;
+
+private:
+	typedef LibRpTexture::rp_image_backend super;
+	RP_DISABLE_COPY(RpCairoBackend)
+
+public:
+	/**
+	 * Creator function for rp_image::setBackendCreatorFn().
+	 */
+	static LibRpTexture::rp_image_backend *creator_fn(int width, int height, LibRpTexture::rp_image::Format format);
+
+	// Image data.
+	void *data(void) final;
+	const void *data(void) const final;
+	size_t data_len(void) const final;
+
+	// Image palette.
+	uint32_t *palette(void) final;
+	const uint32_t *palette(void) const final;
+	unsigned int palette_len(void) const final;
+
+public:
+	/**
+	 * Shrink image dimensions.
+	 * @param width New width.
+	 * @param height New height.
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int shrink(int width, int height) final;
+
+public:
+	/**
+	 * Get the underlying cairo_surface_t.
+	 *
+	 * NOTE: The surface shares its image data with the rp_image.
+	 * rp_image uses straight alpha, so the surface must be
+	 * premultiplied before it's displayed, unless the image
+	 * doesn't have an alpha channel.
+	 *
+	 * @return New reference to the cairo_surface_t, or nullptr if the image isn't ARGB32.
+	 */
+	cairo_surface_t *getCairoSurface(void) const;
+
+protected:
+	// ARGB32: Image surface. (owns the image data)
+	cairo_surface_t *m_surface;
+
+	// CI8: Image data and palette.
+	uint8_t *m_ci8_data;
+	uint32_t *m_palette;
+};
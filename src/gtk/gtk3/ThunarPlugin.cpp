@@ -12,6 +12,7 @@
 
 #include "AchGDBus.hpp"
 #include "plugin-helper.h"
+#include "RpCairoBackend.hpp"
 #include "ThunarMenuProvider.h"
 #include "ThunarPropertyPageProvider.hpp"
 
@@ -121,6 +122,9 @@ thunar_extension_initialize(ThunarxProviderPlugin *plugin)
 
 	// Symbols loaded. Register our types.
 	rp_thunar_register_types(plugin);
+
+	// Store rp_image data in cairo_surface_t.
+	LibRpTexture::rp_image::setBackendCreatorFn(RpCairoBackend::creator_fn);
 }
 
 /** Common shutdown and list_types functions. **/
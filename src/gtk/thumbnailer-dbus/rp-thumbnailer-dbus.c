@@ -21,6 +21,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 // from tumbler-utils.h
 #define g_dbus_async_return_val_if_fail(expr, invocation, val) \
@@ -69,7 +70,10 @@ static void	rp_thumbnailer_get_property	(GObject	*object,
 						 GParamSpec	*pspec);
 
 static gboolean	rp_thumbnailer_timeout		(RpThumbnailer	*thumbnailer);
-static gboolean	rp_thumbnailer_process		(RpThumbnailer	*thumbnailer);
+static void	rp_thumbnailer_dispatch		(RpThumbnailer	*thumbnailer);
+static void	rp_thumbnailer_process		(gpointer	 data,
+						 gpointer	 user_data);
+static gboolean	rp_thumbnailer_request_done	(gpointer	 data);
 
 // D-Bus methods.
 static gboolean	rp_thumbnailer_queue		(SpecializedThumbnailer1 *skeleton,
@@ -93,21 +97,35 @@ struct _RpThumbnailerClass {
 
 #define SHUTDOWN_TIMEOUT_SECONDS 30U
 
+// Maximum number of worker threads.
+#define MAX_WORKER_THREADS 8U
+
 // Thumbnail request information.
 struct request_info {
+	RpThumbnailer *thumbnailer;	// Owning RpThumbnailer (ref'd while the request is active)
 	gchar *uri;
 	guint32 handle;
 	bool large;	// False for 'normal' (128x128); true for 'large' (256x256)
 	bool urgent;	// 'urgent' value
+
+	/** Results (set by the worker thread) **/
+
+	const char *err_msg;	// Error message (static string), or NULL on success
+	int err_code;		// Error code for the D-Bus Error signal
 };
 
 struct _RpThumbnailer {
 	GObject __parent__;
 	SpecializedThumbnailer1 *skeleton;
 
-	GQueue request_queue;	// Request queue (element is struct request_info*)
+	// Request queue (element is struct request_info*)
+	// Urgent requests are kept in front of non-urgent requests.
+	// NOTE: Only accessed by the main thread.
+	GQueue request_queue;
+	GThreadPool *thread_pool;	// Worker threads
+	guint max_active;	// Maximum number of active requests (== worker threads)
+	guint active_count;	// Number of requests being processed by worker threads
 	guint timeout_id;	// Shutdown timeout
-	guint idle_process;	// Idle function for processing
 	guint32 last_handle;	// Last handle value
 
 	/** Status **/
@@ -124,6 +142,17 @@ struct _RpThumbnailer {
 	PFN_RP_CREATE_THUMBNAIL2 pfn_rp_create_thumbnail2;
 };
 
+/**
+ * Free a request_info struct.
+ * @param req request_info
+ */
+static inline void
+request_info_free(struct request_info *req)
+{
+	g_free(req->uri);
+	g_free(req);
+}
+
 G_DEFINE_TYPE_EXTENDED(RpThumbnailer, rp_thumbnailer,
 	G_TYPE_OBJECT, (GTypeFlags)0, {});
 
@@ -200,6 +229,25 @@ rp_thumbnailer_constructed(GObject *object)
 		return;
 	}
 
+	// Create the worker threads.
+	// NOTE: g_get_num_processors() requires glib-2.36.
+	const long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+	thumbnailer->max_active = (nprocs > 0) ? (guint)nprocs : 1U;
+	if (thumbnailer->max_active > MAX_WORKER_THREADS) {
+		thumbnailer->max_active = MAX_WORKER_THREADS;
+	}
+	thumbnailer->thread_pool = g_thread_pool_new(rp_thumbnailer_process, thumbnailer,
+		(gint)thumbnailer->max_active, false, &error);
+	if (error) {
+		g_critical("Error creating the RpThumbnailer thread pool: %s", error->message);
+		g_error_free(error);
+		g_dbus_interface_skeleton_unexport(G_DBUS_INTERFACE_SKELETON(thumbnailer->skeleton));
+		thumbnailer->exported = false;
+		// NOTE: Probably not really changed, but notify anyway.
+		g_object_notify_by_pspec(G_OBJECT(thumbnailer), props[PROP_EXPORTED]);
+		return;
+	}
+
 	// Connect signals to the relevant functions.
 	g_signal_connect(thumbnailer->skeleton, "handle-queue",
 		G_CALLBACK(rp_thumbnailer_queue), thumbnailer);
@@ -229,7 +277,15 @@ rp_thumbnailer_dispose(GObject *object)
 
 	// Unregister timer sources.
 	g_clear_handle_id(&thumbnailer->timeout_id, g_source_remove);
-	g_clear_handle_id(&thumbnailer->idle_process, g_source_remove);
+
+	// Wait for the worker threads to finish.
+	// NOTE: Active requests hold a reference to the RpThumbnailer,
+	// so this will only wait for anything if g_object_run_dispose()
+	// was called while requests were being processed.
+	if (thumbnailer->thread_pool) {
+		g_thread_pool_free(thumbnailer->thread_pool, true, true);
+		thumbnailer->thread_pool = NULL;
+	}
 
 	/** Properties **/
 	g_clear_object(&thumbnailer->connection);
@@ -247,9 +303,7 @@ rp_thumbnailer_finalize(GObject *object)
 	// Delete any remaining requests and free the queue.
 	for (GList *p = thumbnailer->request_queue.head; p != NULL; p = p->next) {
 		if (p->data) {
-			struct request_info *const req = (struct request_info*)p->data;
-			g_free(req->uri);
-			g_free(req);
+			request_info_free((struct request_info*)p->data);
 		}
 	}
 	g_queue_clear(&thumbnailer->request_queue);
@@ -389,21 +443,34 @@ rp_thumbnailer_queue(SpecializedThumbnailer1 *skeleton,
 
 	// Add the URI to the queue.
 	// NOTE: Currently handling all flavors that aren't "large" as "normal".
-	struct request_info *const req = g_malloc(sizeof(struct request_info));
+	struct request_info *const req = g_malloc0(sizeof(struct request_info));
 	req->uri = g_strdup(uri);
 	req->handle = handle;
 	req->large = flavor && (g_ascii_strcasecmp(flavor, "large") == 0);
 	req->urgent = urgent;
-	// TODO Put 'urgent' requests at the front of the queue?
-	g_queue_push_tail(&thumbnailer->request_queue, req);
 
-	// Make sure the idle process is started.
-	// TODO: Make it multi-threaded? (needs atomic compare and/or mutex...)
-	if (thumbnailer->idle_process == 0) {
-		thumbnailer->idle_process = g_idle_add(G_SOURCE_FUNC(rp_thumbnailer_process), thumbnailer);
+	if (urgent) {
+		// Urgent request: Insert it after any other urgent requests,
+		// but before all non-urgent requests.
+		GList *p = thumbnailer->request_queue.head;
+		while (p != NULL && ((const struct request_info*)p->data)->urgent) {
+			p = p->next;
+		}
+		if (p) {
+			g_queue_insert_before(&thumbnailer->request_queue, p, req);
+		} else {
+			g_queue_push_tail(&thumbnailer->request_queue, req);
+		}
+	} else {
+		g_queue_push_tail(&thumbnailer->request_queue, req);
 	}
 
+	// Return the handle before starting the request, since the
+	// client needs it in order to handle the Ready/Error signals.
 	specialized_thumbnailer1_complete_queue(skeleton, invocation, handle);
+
+	// Start processing requests if any worker threads are available.
+	rp_thumbnailer_dispatch(thumbnailer);
 	return true;
 }
 
@@ -437,7 +504,7 @@ static gboolean
 rp_thumbnailer_timeout(RpThumbnailer *thumbnailer)
 {
 	g_return_val_if_fail(RP_IS_THUMBNAILER(thumbnailer), false);
-	if (!g_queue_is_empty(&thumbnailer->request_queue)) {
+	if (!g_queue_is_empty(&thumbnailer->request_queue) || thumbnailer->active_count > 0) {
 		// Still processing stuff.
 		return true;
 	}
@@ -451,42 +518,77 @@ rp_thumbnailer_timeout(RpThumbnailer *thumbnailer)
 }
 
 /**
- * Process a thumbnail.
+ * Start processing queued requests on the worker threads.
+ * Requests are started in queue order until all worker threads are busy.
+ * NOTE: Must be called from the main thread.
  * @param thumbnailer RpThumbnailer object.
  */
-static gboolean
-rp_thumbnailer_process(RpThumbnailer *thumbnailer)
+static void
+rp_thumbnailer_dispatch(RpThumbnailer *thumbnailer)
 {
-	gchar *cache_dir = NULL;	// cache directory (g_strdup_printf())
-	gchar *md5_string = NULL;	// MD5 of the original filename (owned by us)
-	gchar *cache_filename = NULL;	// full cache filename (g_strdup_printf())
-	int ret;
+	g_return_if_fail(RP_IS_THUMBNAILER(thumbnailer));
+
+	// NOTE: Only max_active requests are pushed to the thread pool at once.
+	// The rest stay in request_queue, which handles 'urgent' ordering.
+	while (thumbnailer->active_count < thumbnailer->max_active) {
+		struct request_info *const req = (struct request_info*)g_queue_pop_head(&thumbnailer->request_queue);
+		if (!req) {
+			// Nothing in the queue.
+			break;
+		}
 
-	g_return_val_if_fail(RP_IS_THUMBNAILER(thumbnailer), FALSE);
+		// NOTE: cache_dir and pfn_rp_create_thumbnail2 should NOT be NULL
+		// at this point, but we're checking it anyway.
+		const char *err_msg = NULL;
+		if (!thumbnailer->cache_dir || thumbnailer->cache_dir[0] == 0) {
+			// No cache directory...
+			err_msg = "Thumbnail cache directory is empty.";
+		} else if (!thumbnailer->pfn_rp_create_thumbnail2) {
+			// No thumbnailer function.
+			err_msg = "No thumbnailer function is available.";
+		} else if (!thumbnailer->thread_pool) {
+			// No worker threads.
+			err_msg = "No worker threads are available.";
+		}
+		if (err_msg) {
+			specialized_thumbnailer1_emit_error(
+				thumbnailer->skeleton, req->handle, "", 0, err_msg);
+			specialized_thumbnailer1_emit_finished(
+				thumbnailer->skeleton, req->handle);
+			request_info_free(req);
+			continue;
+		}
 
-	// Process one thumbnail.
-	const struct request_info *req = (struct request_info*)g_queue_pop_head(&thumbnailer->request_queue);
-	if (req == NULL) {
-		// Nothing in the queue.
-		goto cleanup;
+		// Process the request on a worker thread.
+		// The request holds a reference to the RpThumbnailer
+		// until rp_thumbnailer_request_done() is called.
+		req->thumbnailer = g_object_ref(thumbnailer);
+		thumbnailer->active_count++;
+		g_thread_pool_push(thumbnailer->thread_pool, req, NULL);
 	}
+}
 
-	// NOTE: cache_dir and pfn_rp_create_thumbnail2 should NOT be NULL
-	// at this point, but we're checking it anyway.
-	if (!thumbnailer->cache_dir || thumbnailer->cache_dir[0] == 0) {
-		// No cache directory...
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, "",
-			0, "Thumbnail cache directory is empty.");
-		goto finished;
-	}
-	if (!thumbnailer->pfn_rp_create_thumbnail2) {
-		// No thumbnailer function.
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, "",
-			0, "No thumbnailer function is available.");
-		goto finished;
-	}
+/**
+ * Process a thumbnail. (worker thread)
+ *
+ * This function runs on a worker thread, so it must not touch
+ * anything other than the request and the RpThumbnailer's
+ * construct-only properties. The D-Bus signals are emitted
+ * by rp_thumbnailer_request_done() on the main thread.
+ *
+ * @param data request_info
+ * @param user_data RpThumbnailer object.
+ */
+static void
+rp_thumbnailer_process(gpointer data, gpointer user_data)
+{
+	struct request_info *const req = (struct request_info*)data;
+	RpThumbnailer *const thumbnailer = RP_THUMBNAILER(user_data);
+
+	gchar *cache_dir = NULL;	// cache directory (g_strdup_printf())
+	gchar *md5_string = NULL;	// MD5 of the original filename (owned by us)
+	gchar *cache_filename = NULL;	// full cache filename (g_strdup_printf())
+	int ret;
 
 	// TODO: Make sure the URI to thumbnail is not in the cache directory.
 
@@ -495,16 +597,12 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 		thumbnailer->cache_dir, (req->large ? "large" : "normal"));
 	if (!cache_dir) {
 		// g_strdup_printf() failed.
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "Cannot g_strdup_printf() the thumbnail cache directory.");
+		req->err_msg = "Cannot g_strdup_printf() the thumbnail cache directory.";
 		goto finished;
 	}
 
 	if (g_mkdir_with_parents(cache_dir, 0777) != 0) {
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "Cannot mkdir() the thumbnail cache directory.");
+		req->err_msg = "Cannot mkdir() the thumbnail cache directory.";
 		goto finished;
 	}
 
@@ -512,9 +610,7 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	md5_string = g_compute_checksum_for_data(G_CHECKSUM_MD5, (const guchar*)req->uri, strlen(req->uri));
 	if (!md5_string) {
 		// Cannot compute the checksum...
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "g_compute_checksum_for_data() failed.");
+		req->err_msg = "g_compute_checksum_for_data() failed.";
 		goto finished;
 	}
 
@@ -522,9 +618,7 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	cache_filename = g_strdup_printf("%s/%s.png", cache_dir, md5_string);
 	if (!cache_filename) {
 		// g_strdup_printf() failed.
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "Cannot g_strdup_printf() the thumbnail cache filename.");
+		req->err_msg = "Cannot g_strdup_printf() the thumbnail cache filename.";
 		goto finished;
 	}
 
@@ -533,45 +627,65 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	if (ret == 0) {
 		// Image thumbnailed successfully.
 		g_debug("rom-properties thumbnail: %s -> %s [OK]", req->uri, cache_filename);
-		specialized_thumbnailer1_emit_ready(
-			thumbnailer->skeleton, req->handle, req->uri);
 	} else {
 		// Error thumbnailing the image...
 		g_debug("rom-properties thumbnail: %s -> %s [ERR=%d]", req->uri, cache_filename, ret);
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			2, "Image thumbnailing failed... (TODO: return code)");
+		req->err_code = 2;
+		req->err_msg = "Image thumbnailing failed... (TODO: return code)";
 	}
 
 finished:
-	// Request is finished. Emit the finished signal.
-	specialized_thumbnailer1_emit_finished(
-		thumbnailer->skeleton, req->handle);
-
-cleanup:
 	// Free allocated things.
 	g_free(cache_filename);
 	g_free(md5_string);
 	g_free(cache_dir);
 
-	// req was allocated using g_malloc() before it was
-	// added to the queue. We'll need to free it here.
-	g_free((gpointer)req);
+	// Emit the D-Bus signals on the main thread.
+	g_idle_add(rp_thumbnailer_request_done, req);
+}
 
-	// Return TRUE if we still have more thumbnails queued.
-	const bool isEmpty = g_queue_is_empty(&thumbnailer->request_queue);
-	if (isEmpty) {
-		// Clear the idle process.
-		// FIXME: Atomic compare and/or mutex? (assuming multi-threaded...)
-		thumbnailer->idle_process = 0;
+/**
+ * A request has been processed by a worker thread. (main thread)
+ * Emit the D-Bus signals and start the next request.
+ * @param data request_info
+ * @return G_SOURCE_REMOVE
+ */
+static gboolean
+rp_thumbnailer_request_done(gpointer data)
+{
+	struct request_info *const req = (struct request_info*)data;
+	RpThumbnailer *const thumbnailer = req->thumbnailer;
 
+	if (!req->err_msg) {
+		specialized_thumbnailer1_emit_ready(
+			thumbnailer->skeleton, req->handle, req->uri);
+	} else {
+		specialized_thumbnailer1_emit_error(
+			thumbnailer->skeleton, req->handle, req->uri,
+			req->err_code, req->err_msg);
+	}
+
+	// Request is finished. Emit the finished signal.
+	specialized_thumbnailer1_emit_finished(
+		thumbnailer->skeleton, req->handle);
+	request_info_free(req);
+
+	// Start the next request.
+	g_assert(thumbnailer->active_count > 0);
+	thumbnailer->active_count--;
+	rp_thumbnailer_dispatch(thumbnailer);
+
+	if (thumbnailer->active_count == 0 && g_queue_is_empty(&thumbnailer->request_queue)) {
 		// Restart the inactivity timeout.
 		if (G_LIKELY(thumbnailer->timeout_id == 0)) {
 			thumbnailer->timeout_id = g_timeout_add_seconds(SHUTDOWN_TIMEOUT_SECONDS,
 				G_SOURCE_FUNC(rp_thumbnailer_timeout), thumbnailer);
 		}
 	}
-	return !isEmpty;
+
+	// Release the request's reference to the RpThumbnailer.
+	g_object_unref(thumbnailer);
+	return G_SOURCE_REMOVE;
 }
 
 /**
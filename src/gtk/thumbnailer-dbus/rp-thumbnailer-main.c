@@ -164,6 +164,10 @@ int main(int argc, char *argv[])
 			g_main_loop_run(main_loop);
 		}
 	}
+
+	// Make sure the worker threads are finished before
+	// unloading the ROM Properties Page library.
+	g_object_run_dispose(G_OBJECT(thumbnailer));
 	dlclose(pDll);
 	return 0;
 }
@@ -81,7 +81,7 @@ int rpt_do_security_options(void)
 		// glib / D-Bus
 		SCMP_SYS(eventfd2),
 		SCMP_SYS(fcntl), SCMP_SYS(fcntl64),
-		SCMP_SYS(getdents), SCMP_SYS(getdents64)	// g_file_new_for_uri() [rp_create_thumbnail()]
+		SCMP_SYS(getdents), SCMP_SYS(getdents64),	// g_file_new_for_uri() [rp_create_thumbnail()]
 		SCMP_SYS(getegid), SCMP_SYS(geteuid), SCMP_SYS(poll),
 		SCMP_SYS(recvfrom), SCMP_SYS(sendmsg), SCMP_SYS(socket),
 		SCMP_SYS(socketcall),	// FIXME: Enhanced filtering? [cURL+GnuTLS only?]
@@ -97,6 +97,48 @@ int rpt_do_security_options(void)
 		// TODO: Parameter filtering for prctl().
 		SCMP_SYS(prctl),	// pthread_setname_np() [g_thread_proxy(), start_thread()]
 
+		// RomDataCache (RomDataFactory::RDA_USE_CACHE)
+		// NOTE: os-secure_linux.c only allows getdents() and unlink() for clang builds.
+		SCMP_SYS(getdents), SCMP_SYS(getdents64),	// opendir()/readdir() [RomDataCache eviction]
+		SCMP_SYS(rename), SCMP_SYS(renameat), SCMP_SYS(renameat2),	// rename() [RomDataCache::store()]
+		SCMP_SYS(unlink), SCMP_SYS(unlinkat),	// LibRpFile::FileSystem::delete_file()
+		SCMP_SYS(utime), SCMP_SYS(utimensat),	// LibRpFile::FileSystem::set_mtime()
+
+		// LibRpFile::RpFile::prefetch()
+		SCMP_SYS(madvise),	// posix_madvise() [memory-mapped files]
+		SCMP_SYS(fadvise64), SCMP_SYS(fadvise64_64),	// posix_fadvise()
+		SCMP_SYS(arm_fadvise64_64),	// posix_fadvise() [32-bit ARM]
+
+		// ExecRpDownload_posix.cpp
+		// FIXME: Need to fix the clone() check in librpsecure/os-secure_linux.c.
+		SCMP_SYS(clock_nanosleep), SCMP_SYS(clone), SCMP_SYS(fork),
+		SCMP_SYS(vfork),	// posix_spawn() [older glibc]
+		SCMP_SYS(execve), SCMP_SYS(wait4),
+		SCMP_SYS(close), SCMP_SYS(dup2), SCMP_SYS(dup3),	// socket handling, child stdin/stdout
+		SCMP_SYS(kill),		// terminate rp-download on error or timeout
+		SCMP_SYS(socketpair), SCMP_SYS(shutdown),
+		SCMP_SYS(socketcall),	// socketpair(), shutdown(), send() on i386
+		SCMP_SYS(poll), SCMP_SYS(ppoll),	// reader thread
+#if defined(__SNR_ppoll_time64)
+		SCMP_SYS(ppoll_time64),	// 32-bit with 64-bit time_t
+#elif defined(__NR_ppoll_time64)
+		__NR_ppoll_time64,	// 32-bit with 64-bit time_t
+#endif /* __SNR_ppoll_time64 || __NR_ppoll_time64 */
+
+		// ExecRpDownload_posix.cpp: reader thread [pthread_create()]
+		SCMP_SYS(futex), SCMP_SYS(set_robust_list),
+#if defined(__SNR_clone3)
+		SCMP_SYS(clone3),	// pthread_create() with glibc-2.34
+#elif defined(__NR_clone3)
+		__NR_clone3,		// pthread_create() with glibc-2.34
+#endif /* __SNR_clone3 || __NR_clone3 */
+#if defined(__SNR_rseq)
+		SCMP_SYS(rseq),		// restartable sequences, glibc-2.35
+#elif defined(__NR_rseq)
+		__NR_rseq,		// restartable sequences, glibc-2.35
+#endif /* __SNR_rseq || __NR_rseq */
+		// NOTE: madvise() is also needed on thread exit. [advise_stack_range()]
+
 		-1	// End of whitelist
 	};
 	param.syscall_wl = syscall_wl;
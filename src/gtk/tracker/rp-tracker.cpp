@@ -263,7 +263,11 @@ tracker_extract_get_metadata(TrackerExtractInfo *info, GError **error)
 	}
 
 	// Attempt to open the file using RomDataFactory.
-	RomDataPtr romData = RomDataFactory::create(filename);
+	// The RomData cache is checked first, so the file might not
+	// need to be opened at all.
+	// NOTE: Only metadata is needed, so fields and images are skipped.
+	RomDataPtr romData = RomDataFactory::create(filename,
+		RomDataFactory::RDA_USE_CACHE | RomDataFactory::RDA_METADATA_ONLY);
 	g_free(filename);
 	if (!romData) {
 		// No RomData was created.
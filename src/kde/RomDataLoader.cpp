@@ -0,0 +1,95 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (KDE)                              *
+ * RomDataLoader.cpp: Asynchronous RomData loader for RomDataView.         *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RomDataLoader.hpp"
+#include "RomDataView.hpp"
+
+#include <QtCore/QThreadPool>
+
+using namespace LibRpBase;
+
+RomDataLoader::RomDataLoader(const RomDataPtr &romData, RomDataView *view)
+	: super(nullptr)
+	, m_romData(romData)
+	, m_view(view)
+	, m_cancelled(false)
+{
+	// The loader is deleted on the GUI thread by loadFinished().
+	setAutoDelete(false);
+}
+
+/**
+ * Start loading the RomData object on the global QThreadPool.
+ */
+void RomDataLoader::start(void)
+{
+	QThreadPool::globalInstance()->start(this);
+}
+
+/**
+ * Cancel loading.
+ * The RomDataView will not be notified.
+ * NOTE: Must be called from the GUI thread.
+ */
+void RomDataLoader::cancel(void)
+{
+	m_cancelled.store(true, std::memory_order_relaxed);
+	m_view.clear();
+}
+
+/**
+ * Load the RomData object.
+ * This is run on a QThreadPool thread.
+ */
+void RomDataLoader::run(void)
+{
+	// Load everything that RomDataView needs.
+	// RomData caches the results, so the GUI thread won't
+	// need to read from the file again.
+	// NOTE: Check for cancellation between each step, since
+	// the user may have closed the dialog in the meantime.
+	if (!isCancelled()) {
+		m_romData->fields();
+	}
+	if (!isCancelled()) {
+		m_romData->metaData();
+	}
+	if (!isCancelled()) {
+		const uint32_t imgbf = m_romData->supportedImageTypes();
+		if (imgbf & RomData::IMGBF_INT_BANNER) {
+			m_romData->image(RomData::IMG_INT_BANNER);
+		}
+		if (!isCancelled() && (imgbf & RomData::IMGBF_INT_ICON)) {
+			m_romData->image(RomData::IMG_INT_ICON);
+			m_romData->iconAnimData();
+		}
+	}
+
+	// Pass the RomData object back to the GUI thread.
+	QMetaObject::invokeMethod(this, "loadFinished", Qt::QueuedConnection);
+}
+
+/**
+ * Loading has finished.
+ * This is run on the GUI thread.
+ */
+void RomDataLoader::loadFinished(void)
+{
+	if (!isCancelled() && m_view) {
+		m_view->setRomData(m_romData);
+	}
+
+	// Close the file.
+	// Keeping the file open may prevent the user from
+	// changing the file.
+	m_romData->close();
+	m_romData.reset();
+
+	deleteLater();
+}
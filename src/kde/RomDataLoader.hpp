@@ -0,0 +1,83 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (KDE)                              *
+ * RomDataLoader.hpp: Asynchronous RomData loader for RomDataView.         *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QRunnable>
+
+#include "librpbase/RomData.hpp"
+
+// C++ includes
+#include <atomic>
+
+class RomDataView;
+
+/**
+ * Load the RomData fields, metadata, and internal images on a
+ * QThreadPool thread, then pass the RomData object to a RomDataView
+ * on the GUI thread.
+ *
+ * The loader object lives on the GUI thread and deletes itself
+ * once the loaded RomData object has been handed off, or after
+ * cancel() has been called and the worker has finished.
+ */
+class RomDataLoader : public QObject, public QRunnable
+{
+Q_OBJECT
+
+public:
+	RomDataLoader(const LibRpBase::RomDataPtr &romData, RomDataView *view);
+
+private:
+	typedef QObject super;
+	Q_DISABLE_COPY(RomDataLoader)
+
+public:
+	/**
+	 * Start loading the RomData object on the global QThreadPool.
+	 */
+	void start(void);
+
+	/**
+	 * Cancel loading.
+	 * The RomDataView will not be notified.
+	 * NOTE: Must be called from the GUI thread.
+	 */
+	void cancel(void);
+
+	/**
+	 * Has loading been cancelled?
+	 * @return True if cancelled; false if not.
+	 */
+	inline bool isCancelled(void) const
+	{
+		return m_cancelled.load(std::memory_order_relaxed);
+	}
+
+	/** QRunnable **/
+
+	/**
+	 * Load the RomData object.
+	 * This is run on a QThreadPool thread.
+	 */
+	void run(void) final;
+
+private slots:
+	/**
+	 * Loading has finished.
+	 * This is run on the GUI thread.
+	 */
+	void loadFinished(void);
+
+protected:
+	LibRpBase::RomDataPtr m_romData;
+	QPointer<RomDataView> m_view;
+	std::atomic<bool> m_cancelled;
+};
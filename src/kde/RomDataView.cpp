@@ -13,6 +13,7 @@
 #include "RomDataFormat.hpp"
 
 #include "AchQtDBus.hpp"
+#include "RomDataLoader.hpp"
 #include "RpQImageBackend.hpp"
 
 // Other rom-properties libraries
@@ -50,14 +51,27 @@ RomDataViewPrivate::RomDataViewPrivate(RomDataView *q, const RomDataPtr &romData
 	, cboLanguage(nullptr)
 	, def_lc(0)
 	, hasCheckedAchievements(false)
+	, loader(nullptr)
 {}
 
 RomDataViewPrivate::~RomDataViewPrivate()
 {
+	cancelLoading();
 	ui.lblIcon->clearRp();
 	ui.lblBanner->clearRp();
 }
 
+/**
+ * Cancel asynchronous RomData loading, if it's running.
+ */
+void RomDataViewPrivate::cancelLoading(void)
+{
+	if (loader) {
+		loader->cancel();
+		loader.clear();
+	}
+}
+
 /**
  * Create the "Options" button in the parent window.
  */
@@ -1105,8 +1119,12 @@ RomDataView::RomDataView(QWidget *parent)
 }
 
 RomDataView::RomDataView(const RomDataPtr &romData, QWidget *parent)
+	: RomDataView(romData, false, parent)
+{ }
+
+RomDataView::RomDataView(const RomDataPtr &romData, bool loadAsync, QWidget *parent)
 	: super(parent)
-	, d_ptr(new RomDataViewPrivate(this, romData))
+	, d_ptr(new RomDataViewPrivate(this, nullptr))
 {
 	Q_D(RomDataView);
 	d->ui.setupUi(this);
@@ -1114,8 +1132,19 @@ RomDataView::RomDataView(const RomDataPtr &romData, QWidget *parent)
 	// Create the "Options" button in the parent window.
 	d->createOptionsButton();
 
-	// Initialize the display widgets.
-	d->initDisplayWidgets();
+	if (romData && loadAsync) {
+		// Local file: Load the RomData object asynchronously.
+		// The display widgets will be initialized once loading is done.
+		d->initDisplayWidgets();
+		d->loader = new RomDataLoader(romData, this);
+		d->loader->start();
+	} else {
+		// Remote file or no RomData object.
+		// NOTE: RpFile_kio requires the GUI thread, so this is
+		// loaded synchronously.
+		d->romData = romData;
+		d->initDisplayWidgets();
+	}
 }
 
 RomDataView::~RomDataView()
@@ -1301,6 +1330,10 @@ void RomDataView::setRomData(const RomDataPtr &romData)
 	if (d->romData == romData)
 		return;
 
+	// Cancel asynchronous loading, if it's still running.
+	// (If this was called by RomDataLoader, it's already done.)
+	d->cancelLoading();
+
 	const bool prevAnimTimerRunning = d->ui.lblIcon->isAnimTimerRunning();
 	if (prevAnimTimerRunning) {
 		// Animation is running.
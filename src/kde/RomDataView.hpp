@@ -25,6 +25,15 @@ Q_OBJECT
 public:
 	explicit RomDataView(QWidget *parent = nullptr);
 	explicit RomDataView(const LibRpBase::RomDataPtr &romData, QWidget *parent = nullptr);
+
+	/**
+	 * Create a RomDataView for the specified RomData object.
+	 * @param romData RomData object
+	 * @param loadAsync If true, load the RomData object on a worker thread.
+	 *                  Only use this for local files! (RpFile_kio requires the GUI thread.)
+	 * @param parent Parent widget
+	 */
+	RomDataView(const LibRpBase::RomDataPtr &romData, bool loadAsync, QWidget *parent);
 	~RomDataView() override;
 
 private:
@@ -39,6 +39,12 @@ namespace LibRpBase {
 // C++ includes
 #include <vector>
 
+// Qt includes
+#include <QtCore/QPointer>
+
+// Asynchronous RomData loader
+class RomDataLoader;
+
 // Custom widgets
 class LanguageComboBox;
 class OptionsMenuButton;
@@ -110,6 +116,15 @@ public:
 public:
 	bool hasCheckedAchievements;
 
+	// Asynchronous RomData loader.
+	// Deletes itself once loading has finished.
+	QPointer<RomDataLoader> loader;
+
+	/**
+	 * Cancel asynchronous RomData loading, if it's running.
+	 */
+	void cancelLoading(void);
+
 public:
 	/**
 	 * Initialize the header row widgets.
@@ -214,7 +214,8 @@ Q_DECL_EXPORT int RP_C_API rp_show_RomDataView_dialog(int argc, char *argv[])
 		romData = RomDataFactory::create(s_local_filename.c_str());
 		if (romData) {
 			// Create a RomDataView object.
-			RomDataView *const romDataView = new RomDataView(romData, dialog);
+			// NOTE: Local files only, so this can be loaded asynchronously.
+			RomDataView *const romDataView = new RomDataView(romData, true, dialog);
 			romDataView->setObjectName(QLatin1String("romDataView"));
 			tabWidget->addTab(romDataView, QLatin1String("ROM Properties"));
 		}
@@ -199,7 +199,7 @@ void ExtractorPlugin::extract(ExtractionResult *result)
 	switch (flags & mask) {
 		case ExtractionResult::ExtractMetaData:
 			// Only extract metadata.
-			attrs = RomDataFactory::RDA_HAS_METADATA;
+			attrs = RomDataFactory::RDA_METADATA_ONLY;
 			break;
 #if KCOREADDONS_VERSION >= QT_VERSION_CHECK(5,76,0)
 		case ExtractionResult::ExtractImageData:
@@ -39,6 +39,9 @@ using std::string;
 RomDataView *RomPropertiesDialogPlugin::createRomDataView(const KFileItem &fileItem, KPropertiesDialog *props)
 {
 	RomDataPtr romData;
+	// RomData objects can only be loaded asynchronously if the
+	// underlying file is local. (RpFile_kio requires the GUI thread.)
+	bool isLocal = false;
 
 	if (likely(!fileItem.isDir())) {
 		// File: Open the file and call RomDataFactory::create() with the opened file.
@@ -50,6 +53,10 @@ RomDataView *RomPropertiesDialogPlugin::createRomDataView(const KFileItem &fileI
 			return nullptr;
 		}
 
+		// NOTE: openQUrl() uses RpFile for URLs that can be localized.
+		const QUrl localUrl = localizeQUrl(fileItem.url());
+		isLocal = (!localUrl.isEmpty() && (localUrl.scheme().isEmpty() || localUrl.isLocalFile()));
+
 		// Get the appropriate RomData class for this ROM.
 		romData = RomDataFactory::create(file);
 	} else {
@@ -69,6 +76,7 @@ RomDataView *RomPropertiesDialogPlugin::createRomDataView(const KFileItem &fileI
 		}
 
 		if (likely(!s_local_filename.empty())) {
+			isLocal = true;
 			romData = RomDataFactory::create(s_local_filename.c_str());
 		}
 	}
@@ -79,13 +87,11 @@ RomDataView *RomPropertiesDialogPlugin::createRomDataView(const KFileItem &fileI
 	}
 
 	// ROM is supported. Show the properties.
-	RomDataView *const romDataView = new RomDataView(romData, props);
+	RomDataView *const romDataView = new RomDataView(romData, isLocal, props);
 	romDataView->setObjectName(QLatin1String("romDataView"));
 
-	// Make sure the underlying file handle is closed,
-	// since we don't need it once the RomData has been
-	// loaded by RomDataView.
-	romData->close();
+	// NOTE: RomDataView closes the underlying file handle
+	// once it has finished loading the RomData object.
 
 	return romDataView;
 }
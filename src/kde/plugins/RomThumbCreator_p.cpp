@@ -17,45 +17,6 @@
 
 /** TCreateThumbnail functions **/
 
-/**
- * Rescale an ImgClass using the specified scaling method.
- * @param imgClass ImgClass object.
- * @param sz New size.
- * @param method Scaling method.
- * @return Rescaled ImgClass.
- */
-QImage RomThumbCreatorPrivate::rescaleImgClass(const QImage &imgClass, ImgSize sz, ScalingMethod method) const
-{
-	Qt::TransformationMode mode;
-	switch (method) {
-		case ScalingMethod::Nearest:
-			mode = Qt::FastTransformation;
-			break;
-		case ScalingMethod::Bilinear:
-			mode = Qt::SmoothTransformation;
-			break;
-		default:
-			assert(!"Invalid scaling method.");
-			mode = Qt::FastTransformation;
-			break;
-	}
-
-	QImage img = imgClass.scaled(sz.width, sz.height, Qt::IgnoreAspectRatio, mode);
-
-	// NOTE: Rescaling an ARGB32 image sometimes results in the format
-	// being changes to QImage::Format_ARGB32_Premultiplied.
-	// Convert it back to plain ARGB32 if that happens.
-	if (img.format() == QImage::Format_ARGB32_Premultiplied) {
-#if QT_VERSION >= QT_VERSION_CHECK(5,13,0)
-		img.convertTo(QImage::Format_ARGB32);
-#else /* QT_VERSION < QT_VERSION_CHECK(5,13,0) */
-		img = img.convertToFormat(QImage::Format_ARGB32);
-#endif /* QT_VERSION >= QT_VERSION_CHECK(5,13,0) */
-	}
-
-	return img;
-}
-
 /**
  * Is the system using a metered connection?
  *
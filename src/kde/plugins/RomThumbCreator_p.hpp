@@ -72,15 +72,6 @@ public:
 		Q_UNUSED(imgClass)
 	}
 
-	/**
-	 * Rescale an ImgClass using the specified scaling method.
-	 * @param imgClass ImgClass object.
-	 * @param sz New size.
-	 * @param method Scaling method.
-	 * @return Rescaled ImgClass.
-	 */
-	QImage rescaleImgClass(const QImage &imgClass, ImgSize sz, ScalingMethod method = ScalingMethod::Nearest) const final;
-
 	/**
 	 * Get the size of the specified ImgClass.
 	 * @param imgClass	[in] ImgClass object.
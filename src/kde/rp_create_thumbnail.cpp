@@ -43,6 +43,9 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail2(const char *source_file, const c
 	// Validate flags.
 	if ((flags & ~RPCT_FLAG_VALID_MASK) != 0) {
 		return RPCT_ERROR_INVALID_FLAGS;
+	} else if ((flags & (RPCT_FLAG_FAST_PNG | RPCT_FLAG_SMALL_PNG)) == (RPCT_FLAG_FAST_PNG | RPCT_FLAG_SMALL_PNG)) {
+		// Can't favor both speed and size.
+		return RPCT_ERROR_INVALID_FLAGS;
 	}
 
 	// Register RpQImageBackend.
@@ -130,6 +133,13 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail2(const char *source_file, const c
 		// Could not open the PNG writer.
 		return RPCT_ERROR_OUTPUT_FILE_FAILED;
 	}
+	if (flags & RPCT_FLAG_FAST_PNG) {
+		// Favor encoding speed over file size.
+		pngWriter->setProfile(RpPngWriter::Profile::Fastest);
+	} else if (flags & RPCT_FLAG_SMALL_PNG) {
+		// Favor file size over encoding speed.
+		pngWriter->setProfile(RpPngWriter::Profile::Smallest);
+	}
 
 	const bool doXDG = !(flags & RPCT_FLAG_NO_XDG_THUMBNAIL_METADATA);
 	kv.reserve(doXDG ? 5 : 1);
@@ -39,6 +39,9 @@ using namespace LibRpTexture;
 // WiiTicket for EncryptionKeys
 #include "WiiTicket.hpp"
 
+// RomChecksum for verification result fields
+#include "utils/RomChecksum.hpp"
+
 // for strnlen() if it's not available in <string.h>
 #include "librptext/libc.h"
 
@@ -198,6 +201,31 @@ public:
 	 * @return nullptr if partition is readable; error message if not.
 	 */
 	const char *wii_getCryptoStatus(const WiiPartition *partition);
+
+public:
+	/**
+	 * Hash tree verification progress.
+	 * Converts per-partition progress to progress for the whole disc.
+	 */
+	struct HashTreeProgress {
+		RomData::RomOpParams *pParams;
+		uint64_t base;		// Clusters verified in previous partitions
+		uint64_t total;		// Total clusters in all partitions
+
+		/**
+		 * Progress callback. (WiiPartition::VerifyProgressFn)
+		 * @param userdata	[in] HashTreeProgress
+		 * @param done		[in] Number of clusters verified in this partition
+		 * @param total		[in] Total number of clusters in this partition
+		 * @return True to continue; false to cancel.
+		 */
+		static bool progress(void *userdata, uint32_t done, uint32_t total)
+		{
+			RP_UNUSED(total);
+			const HashTreeProgress *const htp = static_cast<const HashTreeProgress*>(userdata);
+			return htp->pParams->progressFn(htp->pParams->progressUserData, htp->base + done, htp->total);
+		}
+	};
 };
 
 ROMDATA_IMPL(GameCube)
@@ -1787,6 +1815,10 @@ int GameCube::loadMetaData(void)
 	do {
 		if ((d->discType & GameCubePrivate::DISC_SYSTEM_MASK) == GameCubePrivate::DISC_SYSTEM_TRIFORCE)
 			break;
+		if (!d->discReader) {
+			// WIA/RVZ isn't fully supported, so we can't load opening.bnr.
+			break;
+		}
 
 		if (!d->opening_bnr.romData) {
 			d->loadOpeningBnr();
@@ -2129,4 +2161,150 @@ int GameCube::checkViewedAchievements(void) const
 	return ret;
 }
 
+/**
+ * Get the list of operations that can be performed on this ROM.
+ * Internal function; called by RomData::romOps().
+ * @return List of operations.
+ */
+vector<RomData::RomOp> GameCube::romOps_int(void) const
+{
+	RP_D(const GameCube);
+	vector<RomOp> ops;
+
+	// Only Wii discs with hashed partitions have a hash tree.
+	// SHA-1 is only available if decryption is enabled.
+#ifdef ENABLE_DECRYPTION
+	if ((d->discType & GameCubePrivate::DISC_SYSTEM_MASK) == GameCubePrivate::DISC_SYSTEM_WII &&
+	    d->discHeader.hash_verify == 0)
+	{
+		ops.emplace_back(C_("RomData|RomOps", "Verify &Hash Tree"), RomOp::ROF_ENABLED | RomOp::ROF_VERIFY);
+	}
+#else /* !ENABLE_DECRYPTION */
+	RP_UNUSED(d);
+#endif /* ENABLE_DECRYPTION */
+	return ops;
+}
+
+/**
+ * Perform a ROM operation.
+ * Internal function; called by RomData::doRomOp().
+ * @param id		[in] Operation index.
+ * @param pParams	[in/out] Parameters and results. (for e.g. UI updates)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GameCube::doRomOp_int(int id, RomOpParams *pParams)
+{
+	RP_D(GameCube);
+
+	// Currently only one ROM operation.
+	if (id != 0) {
+		pParams->status = -EINVAL;
+		pParams->msg = C_("RomData", "ROM operation ID is invalid for this object.");
+		return -EINVAL;
+	}
+
+	// Make sure the fields are loaded, since the results are added to them.
+	// This also loads the Wii partition tables.
+	if (d->fields.empty()) {
+		loadFieldData();
+	}
+	if (d->loadWiiPartitionTables() != 0 || d->wiiPtbl.empty()) {
+		pParams->status = -EIO;
+		pParams->msg = C_("GameCube", "Unable to load the Wii partition tables.");
+		return -EIO;
+	}
+
+	// Total number of clusters, for progress reporting.
+	GameCubePrivate::HashTreeProgress htp;
+	htp.pParams = pParams;
+	htp.base = 0;
+	htp.total = 0;
+	for (const auto &entry : d->wiiPtbl) {
+		htp.total += static_cast<uint64_t>(entry.partition->size()) / 0x8000;
+	}
+
+	// Verify each partition.
+	string s_status;
+	bool allValid = true;
+	for (const auto &entry : d->wiiPtbl) {
+		WiiPartition::HashTreeResult result;
+		int ret = entry.partition->verifyHashTree(result,
+			(pParams->progressFn ? GameCubePrivate::HashTreeProgress::progress : nullptr), &htp);
+		if (ret == -ECANCELED) {
+			pParams->status = ret;
+			pParams->msg = C_("GameCube", "Hash tree verification was cancelled.");
+			return ret;
+		}
+		htp.base += static_cast<uint64_t>(entry.partition->size()) / 0x8000;
+
+		if (!s_status.empty()) {
+			s_status += '\n';
+		}
+		s_status += rp_sprintf("%dp%d: ", entry.vg, entry.pt);
+
+		if (ret != 0) {
+			// Partition could not be verified.
+			allValid = false;
+			if (entry.partition->verifyResult() != KeyManager::VerifyResult::OK) {
+				s_status += d->wii_getCryptoStatus(entry.partition.get());
+			} else {
+				s_status += rp_sprintf(C_("GameCube", "Unable to verify: %s"), strerror(-ret));
+			}
+			continue;
+		}
+
+		if (result.badClusters.empty() && result.h3Valid) {
+			s_status += rp_sprintf(C_("GameCube", "OK (%u clusters)"), result.clusters);
+			continue;
+		}
+
+		allValid = false;
+		if (!result.h3Valid) {
+			s_status += C_("GameCube", "H3 table does not match the TMD.");
+		}
+		if (!result.badClusters.empty()) {
+			uint32_t badCount = 0;
+			for (const auto &range : result.badClusters) {
+				badCount += range.count;
+			}
+			if (!result.h3Valid) {
+				s_status += ' ';
+			}
+			s_status += rp_sprintf_p(C_("GameCube", "%1$u of %2$u clusters are corrupted:"),
+				badCount, result.clusters);
+
+			// Only list the first few ranges.
+			static constexpr size_t MAX_RANGES = 8;
+			const size_t rangeCount = std::min(result.badClusters.size(), MAX_RANGES);
+			for (size_t i = 0; i < rangeCount; i++) {
+				const WiiPartition::BadClusterRange &range = result.badClusters[i];
+				if (range.count == 1) {
+					s_status += rp_sprintf(" 0x%X", range.first);
+				} else {
+					s_status += rp_sprintf(" 0x%X-0x%X", range.first, range.first + range.count - 1);
+				}
+			}
+			if (result.badClusters.size() > rangeCount) {
+				s_status += " ...";
+			}
+		}
+	}
+
+	// Result field is added to the last tab.
+	// NOTE: Fields must be ordered by tab index.
+	d->fields.setTabIndex(d->fields.tabCount() - 1);
+	pParams->fieldIdx.clear();
+	RomChecksum::setResultField(d->fields, C_("GameCube", "Hash Tree"), s_status, pParams->fieldIdx);
+
+	// Status message. The partition results are included,
+	// since the UI frontends can only update existing fields.
+	pParams->status = 0;
+	pParams->msg = (allValid)
+		? C_("GameCube", "Hash tree is valid.")
+		: C_("GameCube", "Hash tree has ERRORS.");
+	pParams->msg += '\n';
+	pParams->msg += s_status;
+	return 0;
+}
+
 }
@@ -14,6 +14,7 @@
 #include "MegaDriveRegions.hpp"
 #include "CopierFormats.h"
 #include "utils/SuperMagicDrive.hpp"
+#include "utils/RomChecksum.hpp"
 
 // Other rom-properties libraries
 #include "librpbase/Achievements.hpp"
@@ -1885,4 +1886,66 @@ int MegaDrive::checkViewedAchievements(void) const
 	return ret;
 }
 
+/**
+ * Get the list of operations that can be performed on this ROM.
+ * Internal function; called by RomData::romOps().
+ * @return List of operations.
+ */
+vector<RomData::RomOp> MegaDrive::romOps_int(void) const
+{
+	RP_D(const MegaDrive);
+	vector<RomOp> ops;
+
+	// Only cartridge ROM images have a ROM checksum.
+	const int rfmt = (d->romType & MegaDrivePrivate::ROM_FORMAT_MASK);
+	if (rfmt != MegaDrivePrivate::ROM_FORMAT_CART_BIN &&
+	    rfmt != MegaDrivePrivate::ROM_FORMAT_CART_SMD)
+	{
+		return ops;
+	}
+
+	ops.emplace_back(C_("RomData|RomOps", "&Verify Checksums"), RomOp::ROF_ENABLED | RomOp::ROF_VERIFY);
+	return ops;
+}
+
+/**
+ * Perform a ROM operation.
+ * Internal function; called by RomData::doRomOp().
+ * @param id		[in] Operation index.
+ * @param pParams	[in/out] Parameters and results. (for e.g. UI updates)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int MegaDrive::doRomOp_int(int id, RomOpParams *pParams)
+{
+	RP_D(MegaDrive);
+
+	// Currently only one ROM operation.
+	if (id != 0) {
+		pParams->status = -EINVAL;
+		pParams->msg = C_("RomData", "ROM operation ID is invalid for this object.");
+		return -EINVAL;
+	}
+
+	// Make sure the fields are loaded, since the results are added to them.
+	if (d->fields.empty()) {
+		loadFieldData();
+	}
+
+	RomChecksum::Params params;
+	params.algorithm = RomChecksum::Algorithm::MegaDrive;
+	if ((d->romType & MegaDrivePrivate::ROM_FORMAT_MASK) == MegaDrivePrivate::ROM_FORMAT_CART_SMD) {
+		// SMD format: Skip the SMD header and deinterleave the data.
+		params.flags = RomChecksum::RCF_SMD_INTERLEAVED;
+		params.offset = 512;
+	}
+	if (d->pRomHeaderLockOn) {
+		// S&K with a locked-on ROM: Only the S&K ROM is checksummed.
+		params.size = 2*1024*1024;
+	}
+	params.expected[0] = (d->checkIfEarlyRomHeader(&d->romHeader))
+		? be16_to_cpu(d->romHeader.early.checksum)
+		: be16_to_cpu(d->romHeader.checksum);
+	return RomChecksum::doVerifyRomOp(d->file, params, d->fields, pParams);
+}
+
 }
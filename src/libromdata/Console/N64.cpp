@@ -9,6 +9,7 @@
 #include "stdafx.h"
 #include "N64.hpp"
 #include "n64_structs.h"
+#include "utils/RomChecksum.hpp"
 
 // Other rom-properties libraries
 using namespace LibRpBase;
@@ -17,6 +18,7 @@ using namespace LibRpText;
 
 // C++ STL classes
 using std::string;
+using std::vector;
 
 namespace LibRomData {
 
@@ -369,4 +371,62 @@ int N64::loadMetaData(void)
 	return static_cast<int>(d->metaData->count());
 }
 
+/**
+ * Get the list of operations that can be performed on this ROM.
+ * Internal function; called by RomData::romOps().
+ * @return List of operations.
+ */
+vector<RomData::RomOp> N64::romOps_int(void) const
+{
+	vector<RomOp> ops;
+	ops.emplace_back(C_("RomData|RomOps", "&Verify Checksums"), RomOp::ROF_ENABLED | RomOp::ROF_VERIFY);
+	return ops;
+}
+
+/**
+ * Perform a ROM operation.
+ * Internal function; called by RomData::doRomOp().
+ * @param id		[in] Operation index.
+ * @param pParams	[in/out] Parameters and results. (for e.g. UI updates)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int N64::doRomOp_int(int id, RomOpParams *pParams)
+{
+	RP_D(N64);
+
+	// Currently only one ROM operation.
+	if (id != 0) {
+		pParams->status = -EINVAL;
+		pParams->msg = C_("RomData", "ROM operation ID is invalid for this object.");
+		return -EINVAL;
+	}
+
+	// Make sure the fields are loaded, since the results are added to them.
+	if (d->fields.empty()) {
+		loadFieldData();
+	}
+
+	RomChecksum::Params params;
+	params.algorithm = RomChecksum::Algorithm::N64;
+	switch (d->romType) {
+		default:
+		case N64Private::RomType::Z64:
+			break;
+		case N64Private::RomType::V64:
+			params.flags = RomChecksum::RCF_N64_V64;
+			break;
+		case N64Private::RomType::SWAP2:
+			params.flags = RomChecksum::RCF_N64_SWAP2;
+			break;
+		case N64Private::RomType::LE32:
+			params.flags = RomChecksum::RCF_N64_LE32;
+			break;
+	}
+
+	// NOTE: CRCs were byteswapped in the constructor.
+	params.expected[0] = d->romHeader.crc[0];
+	params.expected[1] = d->romHeader.crc[1];
+	return RomChecksum::doVerifyRomOp(d->file, params, d->fields, pParams);
+}
+
 }
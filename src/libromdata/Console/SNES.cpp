@@ -11,6 +11,7 @@
 #include "data/NintendoPublishers.hpp"
 #include "snes_structs.h"
 #include "CopierFormats.h"
+#include "utils/RomChecksum.hpp"
 
 // Other rom-properties libraries
 #include "librpbase/SystemRegion.hpp"
@@ -1642,4 +1643,54 @@ int SNES::extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int size) const
 	return 0;
 }
 
+/**
+ * Get the list of operations that can be performed on this ROM.
+ * Internal function; called by RomData::romOps().
+ * @return List of operations.
+ */
+vector<RomData::RomOp> SNES::romOps_int(void) const
+{
+	vector<RomOp> ops;
+	ops.emplace_back(C_("RomData|RomOps", "&Verify Checksums"), RomOp::ROF_ENABLED | RomOp::ROF_VERIFY);
+	return ops;
+}
+
+/**
+ * Perform a ROM operation.
+ * Internal function; called by RomData::doRomOp().
+ * @param id		[in] Operation index.
+ * @param pParams	[in/out] Parameters and results. (for e.g. UI updates)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int SNES::doRomOp_int(int id, RomOpParams *pParams)
+{
+	RP_D(SNES);
+
+	// Currently only one ROM operation.
+	if (id != 0) {
+		pParams->status = -EINVAL;
+		pParams->msg = C_("RomData", "ROM operation ID is invalid for this object.");
+		return -EINVAL;
+	}
+
+	// Make sure the fields are loaded, since the results are added to them.
+	if (d->fields.empty()) {
+		loadFieldData();
+	}
+
+	RomChecksum::Params params;
+	if (d->header_address == 0x7FB0+512 || d->header_address == 0xFFB0+512) {
+		// Skip the copier header.
+		params.offset = 512;
+	}
+	if (d->romType == SNESPrivate::RomType::SNES) {
+		params.algorithm = RomChecksum::Algorithm::SNES;
+		params.expected[0] = le16_to_cpu(d->romHeader.snes.checksum);
+	} else {
+		// BS-X ROM checksums aren't supported, so only calculate the hashes.
+		params.algorithm = RomChecksum::Algorithm::None;
+	}
+	return RomChecksum::doVerifyRomOp(d->file, params, d->fields, pParams);
+}
+
 }
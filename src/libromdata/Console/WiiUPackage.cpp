@@ -15,6 +15,10 @@
 
 // Other rom-properties libraries
 #include "librpbase/disc/PartitionFile.hpp"
+#ifdef ENABLE_DECRYPTION
+#  include "librpbase/crypto/Hash.hpp"
+#endif /* ENABLE_DECRYPTION */
+#include "utils/RomChecksum.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
 using namespace LibRpText;
@@ -121,48 +125,71 @@ void WiiUPackagePrivate::reset(void)
 }
 
 /**
- * Open a content file.
+ * Open a raw file for a content entry.
+ * Both lowercase and uppercase hex filenames are tried.
  * @param idx Content index (TMD index)
- * @return Content file, or nullptr on error.
+ * @param ext File extension, e.g. ".app" or ".h3"
+ * @return File, or nullptr on error.
  */
-IDiscReaderPtr WiiUPackagePrivate::openContentFile(unsigned int idx)
+IRpFilePtr WiiUPackagePrivate::openContentRawFile(unsigned int idx, const TCHAR *ext)
 {
-	assert(idx < contentsReaders.size());
-	if (idx >= contentsReaders.size())
+	assert(idx < contentsTable.size());
+	if (idx >= contentsTable.size())
 		return {};
 
-	if (contentsReaders[idx]) {
-		// Content is already open.
-		return contentsReaders[idx];
-	}
-
-#ifdef ENABLE_DECRYPTION
-	// Attempt to open the content.
-	const WUP_Content_Entry &entry = contentsTable[idx];
+	const uint32_t content_id = be32_to_cpu(contentsTable[idx].content_id);
 	tstring s_path(this->path);
 	s_path += DIR_SEP_CHR;
+	const size_t dir_len = s_path.size();
 
 	// Try with lowercase hex first.
-	const uint32_t content_id = be32_to_cpu(entry.content_id);
 	TCHAR fnbuf[16];
-	_sntprintf(fnbuf, ARRAY_SIZE(fnbuf), _T("%08x.app"), content_id);
+	_sntprintf(fnbuf, ARRAY_SIZE(fnbuf), _T("%08x%s"), content_id, ext);
 	s_path += fnbuf;
 
 	IRpFilePtr subfile = std::make_shared<RpFile>(s_path.c_str(), RpFile::FM_OPEN_READ);
 	if (!subfile->isOpen()) {
 		// Try with uppercase hex.
-		_sntprintf(fnbuf, ARRAY_SIZE(fnbuf), _T("%08X.app"), content_id);
-		s_path.resize(s_path.size()-12);
+		_sntprintf(fnbuf, ARRAY_SIZE(fnbuf), _T("%08X%s"), content_id, ext);
+		s_path.resize(dir_len);
 		s_path += fnbuf;
 
 		subfile = std::make_shared<RpFile>(s_path.c_str(), RpFile::FM_OPEN_READ);
 		if (!subfile->isOpen()) {
-			// Unable to open the content file.
+			// Unable to open the file.
 			// TODO: Error code?
 			return {};
 		}
 	}
 
+	return subfile;
+}
+
+/**
+ * Open a content file.
+ * @param idx Content index (TMD index)
+ * @return Content file, or nullptr on error.
+ */
+IDiscReaderPtr WiiUPackagePrivate::openContentFile(unsigned int idx)
+{
+	assert(idx < contentsReaders.size());
+	if (idx >= contentsReaders.size())
+		return {};
+
+	if (contentsReaders[idx]) {
+		// Content is already open.
+		return contentsReaders[idx];
+	}
+
+#ifdef ENABLE_DECRYPTION
+	// Attempt to open the content.
+	const WUP_Content_Entry &entry = contentsTable[idx];
+	IRpFilePtr subfile = openContentRawFile(idx, _T(".app"));
+	if (!subfile) {
+		// Unable to open the content file.
+		return {};
+	}
+
 	// Create a disc reader.
 	// TODO: Bitfield constants for 'type'?
 	IDiscReaderPtr discReader;
@@ -194,6 +221,145 @@ IDiscReaderPtr WiiUPackagePrivate::openContentFile(unsigned int idx)
 #endif /* ENABLE_DECRYPTION */
 }
 
+#ifdef ENABLE_DECRYPTION
+/**
+ * Verify a content file.
+ * H3-hashed contents are checked using the .h3 file and the hash tree.
+ * Other contents are checked using a SHA-1 of the decrypted data.
+ * @param idx		[in] Content index (TMD index)
+ * @param vp		[in/out] VerifyProgress
+ * @param s_status	[out] Status line for this content (appended)
+ * @return 1 if the content is valid; 0 if not; negative POSIX error code on error.
+ */
+int WiiUPackagePrivate::verifyContent(unsigned int idx, VerifyProgress &vp, string &s_status)
+{
+	const WUP_Content_Entry &entry = contentsTable[idx];
+	s_status += rp_sprintf("%08x: ", be32_to_cpu(entry.content_id));
+
+	const IDiscReaderPtr discReader = openContentFile(idx);
+	if (!discReader) {
+		s_status += C_("WiiUPackage", "Unable to open the content file.");
+		return 0;
+	}
+
+	Hash sha1(Hash::Algorithm::SHA1);
+	if (!sha1.isUsable()) {
+		return -ENOTSUP;
+	}
+	uint8_t digest[20];
+
+	if (!(entry.type & cpu_to_be16(0x0002))) {
+		// Content is not H3-hashed.
+		// The TMD has a SHA-1 of the decrypted content.
+		// NOTE: Only entry.size bytes are hashed; the file may be padded.
+		static constexpr size_t BUF_SIZE = 1024U * 1024U;
+		unique_ptr<uint8_t[]> buf(new uint8_t[BUF_SIZE]);
+		uint64_t remain = be64_to_cpu(entry.size);
+		uint64_t done = 0;
+		if (discReader->seek(0) != 0) {
+			s_status += C_("WiiUPackage", "Unable to read the content file.");
+			return 0;
+		}
+		while (remain > 0) {
+			const size_t read_sz = static_cast<size_t>(std::min(remain, static_cast<uint64_t>(BUF_SIZE)));
+			if (discReader->read(buf.get(), read_sz) != read_sz) {
+				s_status += C_("WiiUPackage", "Unable to read the content file.");
+				return 0;
+			}
+			sha1.process(buf.get(), read_sz);
+			remain -= read_sz;
+			done += read_sz;
+
+			if (!VerifyProgress::progress(&vp, static_cast<uint32_t>(done / WUP_H3_SECTOR_SIZE_ENCRYPTED), 0)) {
+				return -ECANCELED;
+			}
+		}
+		vp.base += (be64_to_cpu(entry.size) + WUP_H3_SECTOR_SIZE_ENCRYPTED - 1) / WUP_H3_SECTOR_SIZE_ENCRYPTED;
+
+		sha1.getHash(digest, sizeof(digest));
+		if (memcmp(digest, entry.sha1_hash, sizeof(digest)) != 0) {
+			s_status += C_("WiiUPackage", "SHA-1 does not match the TMD.");
+			return 0;
+		}
+		s_status += C_("WiiUPackage", "OK");
+		return 1;
+	}
+
+	// Content is H3-hashed.
+	// The TMD has a SHA-1 of the H3 table, which is stored in a separate file.
+	const off64_t h3_blocks = discReader->size() / WUP_H3_SECTOR_SIZE_DECRYPTED;
+	const IRpFilePtr h3File = openContentRawFile(idx, _T(".h3"));
+	if (!h3File) {
+		vp.base += h3_blocks;
+		s_status += C_("WiiUPackage", "Unable to open the H3 file.");
+		return 0;
+	}
+	const off64_t h3_size = h3File->size();
+	if (h3_size <= 0 || h3_size > 1048576 || (h3_size % 20) != 0) {
+		vp.base += h3_blocks;
+		s_status += C_("WiiUPackage", "H3 file is invalid.");
+		return 0;
+	}
+	rp::uvector<uint8_t> h3;
+	h3.resize(static_cast<size_t>(h3_size));
+	if (h3File->seekAndRead(0, h3.data(), h3.size()) != h3.size()) {
+		vp.base += h3_blocks;
+		s_status += C_("WiiUPackage", "Unable to read the H3 file.");
+		return 0;
+	}
+
+	// H4: SHA-1 of the H3 table.
+	sha1.process(h3.data(), h3.size());
+	sha1.getHash(digest, sizeof(digest));
+	if (memcmp(digest, entry.sha1_hash, sizeof(digest)) != 0) {
+		vp.base += h3_blocks;
+		s_status += C_("WiiUPackage", "H3 table does not match the TMD.");
+		return 0;
+	}
+
+	// Verify the hash tree.
+	WiiUH3Reader *const h3Reader = static_cast<WiiUH3Reader*>(discReader.get());
+	WiiUH3Reader::HashTreeResult result;
+	int ret = h3Reader->verifyHashTree(h3.data(), h3.size(), result, VerifyProgress::progress, &vp);
+	if (ret == -ECANCELED) {
+		return ret;
+	}
+	vp.base += h3_blocks;
+	if (ret != 0) {
+		s_status += rp_sprintf(C_("WiiUPackage", "Unable to verify: %s"), strerror(-ret));
+		return 0;
+	}
+
+	if (result.badBlocks.empty()) {
+		s_status += rp_sprintf(C_("WiiUPackage", "OK (%u blocks)"), result.blocks);
+		return 1;
+	}
+
+	uint32_t badCount = 0;
+	for (const auto &range : result.badBlocks) {
+		badCount += range.count;
+	}
+	s_status += rp_sprintf_p(C_("WiiUPackage", "%1$u of %2$u blocks are corrupted:"),
+		badCount, result.blocks);
+
+	// Only list the first few ranges.
+	static constexpr size_t MAX_RANGES = 8;
+	const size_t rangeCount = std::min(result.badBlocks.size(), MAX_RANGES);
+	for (size_t i = 0; i < rangeCount; i++) {
+		const WiiUH3Reader::BadBlockRange &range = result.badBlocks[i];
+		if (range.count == 1) {
+			s_status += rp_sprintf(" 0x%X", range.first);
+		} else {
+			s_status += rp_sprintf(" 0x%X-0x%X", range.first, range.first + range.count - 1);
+		}
+	}
+	if (result.badBlocks.size() > rangeCount) {
+		s_status += " ...";
+	}
+	return 0;
+}
+#endif /* ENABLE_DECRYPTION */
+
 /**
  * Open a file from the contents using the FST.
  * @param filename Filename
@@ -772,4 +938,124 @@ int WiiUPackage::loadInternalImage(ImageType imageType, rp_image_const_ptr &pIma
 		d->loadIcon);	// func
 }
 
+/**
+ * Get the list of operations that can be performed on this ROM.
+ * Internal function; called by RomData::romOps().
+ * @return List of operations.
+ */
+vector<RomData::RomOp> WiiUPackage::romOps_int(void) const
+{
+	RP_D(const WiiUPackage);
+	vector<RomOp> ops;
+
+	// Contents can only be verified if the title key was decrypted.
+	// SHA-1 is only available if decryption is enabled.
+#ifdef ENABLE_DECRYPTION
+	if (!d->contentsTable.empty()) {
+		ops.emplace_back(C_("RomData|RomOps", "Verify &Contents"), RomOp::ROF_ENABLED | RomOp::ROF_VERIFY);
+	}
+#else /* !ENABLE_DECRYPTION */
+	RP_UNUSED(d);
+#endif /* ENABLE_DECRYPTION */
+	return ops;
+}
+
+/**
+ * Perform a ROM operation.
+ * Internal function; called by RomData::doRomOp().
+ * @param id		[in] Operation index.
+ * @param pParams	[in/out] Parameters and results. (for e.g. UI updates)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WiiUPackage::doRomOp_int(int id, RomOpParams *pParams)
+{
+	// Currently only one ROM operation.
+	if (id != 0) {
+		pParams->status = -EINVAL;
+		pParams->msg = C_("RomData", "ROM operation ID is invalid for this object.");
+		return -EINVAL;
+	}
+
+#ifdef ENABLE_DECRYPTION
+	RP_D(WiiUPackage);
+
+	// Make sure the fields are loaded, since the results are added to them.
+	if (d->fields.empty()) {
+		loadFieldData();
+	}
+
+	// Total number of blocks, for progress reporting.
+	// NOTE: Contents that can't be opened are skipped here.
+	WiiUPackagePrivate::VerifyProgress vp;
+	vp.pParams = pParams;
+	vp.base = 0;
+	vp.total = 0;
+	const unsigned int contentCount = static_cast<unsigned int>(d->contentsTable.size());
+	for (unsigned int i = 0; i < contentCount; i++) {
+		const IDiscReaderPtr discReader = d->openContentFile(i);
+		if (!discReader)
+			continue;
+		if (d->contentsTable[i].type & cpu_to_be16(0x0002)) {
+			vp.total += discReader->size() / WUP_H3_SECTOR_SIZE_DECRYPTED;
+		} else {
+			vp.total += (be64_to_cpu(d->contentsTable[i].size) + WUP_H3_SECTOR_SIZE_ENCRYPTED - 1) / WUP_H3_SECTOR_SIZE_ENCRYPTED;
+		}
+	}
+
+	// Verify each content.
+	// Only failed contents are listed, since packages
+	// can have hundreds of contents.
+	string s_status;
+	unsigned int badCount = 0;
+	for (unsigned int i = 0; i < contentCount; i++) {
+		string s_content;
+		const int ret = d->verifyContent(i, vp, s_content);
+		if (ret == -ECANCELED) {
+			pParams->status = ret;
+			pParams->msg = C_("WiiUPackage", "Content verification was cancelled.");
+			return ret;
+		} else if (ret < 0) {
+			pParams->status = ret;
+			pParams->msg = rp_sprintf(C_("WiiUPackage", "Unable to verify the contents: %s"), strerror(-ret));
+			return ret;
+		} else if (ret == 0) {
+			badCount++;
+			if (!s_status.empty()) {
+				s_status += '\n';
+			}
+			s_status += s_content;
+		}
+	}
+
+	string s_summary;
+	if (badCount == 0) {
+		s_summary = rp_sprintf(NC_("WiiUPackage",
+			"%u content is valid.", "All %u contents are valid.", contentCount), contentCount);
+	} else {
+		s_summary = rp_sprintf_p(NC_("WiiUPackage",
+			"%1$u of %2$u content has ERRORS.", "%1$u of %2$u contents have ERRORS.", contentCount),
+			badCount, contentCount);
+		s_summary += '\n';
+		s_summary += s_status;
+	}
+
+	// Result field is added to the last tab.
+	// NOTE: Fields must be ordered by tab index.
+	d->fields.setTabIndex(d->fields.tabCount() - 1);
+	pParams->fieldIdx.clear();
+	RomChecksum::setResultField(d->fields, C_("WiiUPackage", "Contents"), s_summary, pParams->fieldIdx);
+
+	// Status message. The content results are included,
+	// since the UI frontends can only update existing fields.
+	pParams->status = 0;
+	pParams->msg = s_summary;
+	return 0;
+#else /* !ENABLE_DECRYPTION */
+	// SHA-1 is not available.
+	pParams->status = -ENOTSUP;
+	pParams->msg = C_("RomData", "ROM operation ID is invalid for this object.");
+	return -ENOTSUP;
+#endif /* ENABLE_DECRYPTION */
+}
+
 }
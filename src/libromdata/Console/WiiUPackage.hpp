@@ -16,6 +16,7 @@ ROMDATA_DECL_BEGIN(WiiUPackage)
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGINT()
+ROMDATA_DECL_ROMOPS()
 
 public:
 	/**
@@ -33,6 +33,7 @@
 #include "tcharx.h"
 
 // C++ STL includes
+#include <string>
 #include <vector>
 
 // TinyXML2
@@ -91,6 +92,15 @@ public:
 	 */
 	void reset(void);
 
+	/**
+	 * Open a raw file for a content entry.
+	 * Both lowercase and uppercase hex filenames are tried.
+	 * @param idx Content index (TMD index)
+	 * @param ext File extension, e.g. ".app" or ".h3"
+	 * @return File, or nullptr on error.
+	 */
+	LibRpFile::IRpFilePtr openContentRawFile(unsigned int idx, const TCHAR *ext);
+
 	/**
 	 * Open a content file.
 	 * @param idx Content index (TMD index)
@@ -98,6 +108,46 @@ public:
 	 */
 	LibRpBase::IDiscReaderPtr openContentFile(unsigned int idx);
 
+#ifdef ENABLE_DECRYPTION
+	/**
+	 * Content verification progress.
+	 * Converts per-content progress to progress for the whole package.
+	 * Progress is measured in 64 KB blocks.
+	 */
+	struct VerifyProgress {
+		LibRpBase::RomData::RomOpParams *pParams;
+		uint64_t base;		// Blocks verified in previous contents
+		uint64_t total;		// Total blocks in all contents
+
+		/**
+		 * Progress callback. (WiiUH3Reader::VerifyProgressFn)
+		 * @param userdata	[in] VerifyProgress
+		 * @param done		[in] Number of blocks verified in this content
+		 * @param total		[in] Total number of blocks in this content
+		 * @return True to continue; false to cancel.
+		 */
+		static bool progress(void *userdata, uint32_t done, uint32_t total)
+		{
+			RP_UNUSED(total);
+			const VerifyProgress *const vp = static_cast<const VerifyProgress*>(userdata);
+			if (!vp->pParams->progressFn)
+				return true;
+			return vp->pParams->progressFn(vp->pParams->progressUserData, vp->base + done, vp->total);
+		}
+	};
+
+	/**
+	 * Verify a content file.
+	 * H3-hashed contents are checked using the .h3 file and the hash tree.
+	 * Other contents are checked using a SHA-1 of the decrypted data.
+	 * @param idx		[in] Content index (TMD index)
+	 * @param vp		[in/out] VerifyProgress
+	 * @param s_status	[out] Status line for this content (appended)
+	 * @return 1 if the content is valid; 0 if not; negative POSIX error code on error.
+	 */
+	int verifyContent(unsigned int idx, VerifyProgress &vp, std::string &s_status);
+#endif /* ENABLE_DECRYPTION */
+
 	/**
 	 * Open a file from the contents using the FST.
 	 * @param filename Filename
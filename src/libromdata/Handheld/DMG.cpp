@@ -12,6 +12,7 @@
 #include "data/NintendoPublishers.hpp"
 #include "data/DMGSpecialCases.hpp"
 #include "dmg_structs.h"
+#include "utils/RomChecksum.hpp"
 
 // Other rom-properties libraries
 #include "librpbase/config/Config.hpp"
@@ -1566,4 +1567,59 @@ int DMG::extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int size) const
 	return 0;
 }
 
+/**
+ * Get the list of operations that can be performed on this ROM.
+ * Internal function; called by RomData::romOps().
+ * @return List of operations.
+ */
+vector<RomData::RomOp> DMG::romOps_int(void) const
+{
+	vector<RomOp> ops;
+	ops.emplace_back(C_("RomData|RomOps", "&Verify Checksums"), RomOp::ROF_ENABLED | RomOp::ROF_VERIFY);
+	return ops;
+}
+
+/**
+ * Perform a ROM operation.
+ * Internal function; called by RomData::doRomOp().
+ * @param id		[in] Operation index.
+ * @param pParams	[in/out] Parameters and results. (for e.g. UI updates)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int DMG::doRomOp_int(int id, RomOpParams *pParams)
+{
+	RP_D(DMG);
+
+	// Currently only one ROM operation.
+	if (id != 0) {
+		pParams->status = -EINVAL;
+		pParams->msg = C_("RomData", "ROM operation ID is invalid for this object.");
+		return -EINVAL;
+	}
+
+	// Make sure the fields are loaded, since the results are added to them.
+	if (d->fields.empty()) {
+		loadFieldData();
+	}
+
+	RomChecksum::Params params;
+	// Skip the copier header and GBX footer, if present.
+	off64_t size = d->file->size() - d->copier_offset;
+	if (d->gbxFooter.magic == cpu_to_be32(GBX_MAGIC)) {
+		size -= sizeof(GBX_Footer);
+	}
+	params.offset = d->copier_offset;
+	params.size = size;
+
+	if (!d->is_mmm01_multicart) {
+		params.algorithm = RomChecksum::Algorithm::GameBoy;
+		params.expected[0] = be16_to_cpu(d->romHeader.rom_checksum);
+	} else {
+		// MMM01 multicarts don't have a global checksum
+		// for the entire ROM, so only calculate the hashes.
+		params.algorithm = RomChecksum::Algorithm::None;
+	}
+	return RomChecksum::doVerifyRomOp(d->file, params, d->fields, pParams);
+}
+
 }
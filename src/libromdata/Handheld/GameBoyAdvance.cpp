@@ -10,6 +10,7 @@
 #include "GameBoyAdvance.hpp"
 #include "data/NintendoPublishers.hpp"
 #include "gba_structs.h"
+#include "utils/RomChecksum.hpp"
 
 // Other rom-properties libraries
 using namespace LibRpBase;
@@ -590,4 +591,45 @@ int GameBoyAdvance::extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int s
 	return 0;
 }
 
+/**
+ * Get the list of operations that can be performed on this ROM.
+ * Internal function; called by RomData::romOps().
+ * @return List of operations.
+ */
+vector<RomData::RomOp> GameBoyAdvance::romOps_int(void) const
+{
+	vector<RomOp> ops;
+	ops.emplace_back(C_("RomData|RomOps", "&Calculate Hashes"), RomOp::ROF_ENABLED | RomOp::ROF_VERIFY);
+	return ops;
+}
+
+/**
+ * Perform a ROM operation.
+ * Internal function; called by RomData::doRomOp().
+ * @param id		[in] Operation index.
+ * @param pParams	[in/out] Parameters and results. (for e.g. UI updates)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GameBoyAdvance::doRomOp_int(int id, RomOpParams *pParams)
+{
+	RP_D(GameBoyAdvance);
+
+	// Currently only one ROM operation.
+	if (id != 0) {
+		pParams->status = -EINVAL;
+		pParams->msg = C_("RomData", "ROM operation ID is invalid for this object.");
+		return -EINVAL;
+	}
+
+	// Make sure the fields are loaded, since the results are added to them.
+	if (d->fields.empty()) {
+		loadFieldData();
+	}
+
+	RomChecksum::Params params;
+	// GBA ROMs only have a header checksum, so only calculate the hashes.
+	params.algorithm = RomChecksum::Algorithm::None;
+	return RomChecksum::doVerifyRomOp(d->file, params, d->fields, pParams);
+}
+
 }
@@ -68,6 +68,7 @@ NintendoDSPrivate::NintendoDSPrivate(const IRpFilePtr &file, bool cia)
 	, romSize(0)
 	, secData(0)
 	, secArea(NDS_SECAREA_UNKNOWN)
+	, secInfoLoaded(false)
 	, nds_icon_title_loaded(false)
 	, cia(cia)
 	, fieldIdx_secData(-1)
@@ -652,9 +653,9 @@ void NintendoDS::init(void)
 		return;
 	}
 
-	// Check the secure area status.
-	d->secData = d->checkNDSSecurityData();
-	d->secArea = d->checkNDSSecureArea();
+	// NOTE: The secure area status is checked on demand
+	// by loadSecurityInfo(), since it's not needed for
+	// metadata and requires reading 12 KB of security data.
 
 	// Set the MIME type. (unofficial)
 	d->mimeType = (d->romType == NintendoDSPrivate::RomType::DSi_Exclusive)
@@ -1016,6 +1017,7 @@ int NintendoDS::loadFieldData(void)
 		romHeader->rom_version, RomFields::Base::Dec, 2);
 
 	// Is the security data present?
+	d->loadSecurityInfo();
 	static const char *const nds_security_data_names[] = {
 		NOP_C_("NintendoDS|SecurityData", "Blowfish Tables"),
 		NOP_C_("NintendoDS|SecurityData", "Static Data"),
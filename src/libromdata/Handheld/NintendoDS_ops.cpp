@@ -149,6 +149,26 @@ NintendoDSPrivate::NDS_SecureArea NintendoDSPrivate::checkNDSSecureArea(void)
 	return ret;
 }
 
+/**
+ * Load the security data and Secure Area status, if it isn't loaded already.
+ * This reads from the ROM, so the ROM must be open.
+ * Only needed for fields and ROM operations, not for metadata.
+ */
+void NintendoDSPrivate::loadSecurityInfo(void)
+{
+	if (secInfoLoaded) {
+		// Security information is already loaded.
+		return;
+	} else if (!file || !file->isOpen()) {
+		// File isn't open.
+		return;
+	}
+
+	secData = checkNDSSecurityData();
+	secArea = checkNDSSecureArea();
+	secInfoLoaded = true;
+}
+
 /**
  * Get the localized string identifying the NDS Secure Area type.
  * This uses the cached secArea value.
@@ -225,6 +245,7 @@ vector<RomData::RomOp> NintendoDS::romOps_int(void) const
 #ifdef ENABLE_DECRYPTION
 	// Encrypt/Decrypt ROM
 	bool showEncrypt = false;
+	const_cast<NintendoDSPrivate*>(d)->loadSecurityInfo();
 	switch (d->secArea) {
 		case NintendoDSPrivate::NDS_SECAREA_DECRYPTED:
 			showEncrypt = true;
@@ -376,6 +397,7 @@ int NintendoDS::doRomOp_int(int id, RomOpParams *pParams)
 		case 1: {
 			// Encrypt/Decrypt ROM.
 			bool doEncrypt;
+			d->loadSecurityInfo();
 			if (d->secArea == NintendoDSPrivate::NDS_SECAREA_DECRYPTED) {
 				// Encrypt the secure area.
 				doEncrypt = true;
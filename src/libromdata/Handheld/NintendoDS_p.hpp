@@ -109,8 +109,10 @@ public:
 	off64_t romSize;
 
 	// Secure Area status
+	// NOTE: Loaded on demand by loadSecurityInfo().
 	uint32_t secData;
 	NDS_SecureArea secArea;
+	bool secInfoLoaded;
 
 	// Icon/title data from the ROM header.
 	// NOTE: Must be byteswapped on access.
@@ -200,6 +202,13 @@ public:
 	 */
 	NDS_SecureArea checkNDSSecureArea(void);
 
+	/**
+	 * Load the security data and Secure Area status, if it isn't loaded already.
+	 * This reads from the ROM, so the ROM must be open.
+	 * Only needed for fields and ROM operations, not for metadata.
+	 */
+	void loadSecurityInfo(void);
+
 	/**
 	 * Get the localized string identifying the NDS Secure Area type.
 	 * This uses the cached secArea value.
@@ -10,6 +10,7 @@
 #include "WonderSwan.hpp"
 #include "data/WonderSwanPublishers.hpp"
 #include "ws_structs.h"
+#include "utils/RomChecksum.hpp"
 
 // Other rom-properties libraries
 using namespace LibRpBase;
@@ -758,4 +759,46 @@ int WonderSwan::extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int size)
 	return 0;
 }
 
+/**
+ * Get the list of operations that can be performed on this ROM.
+ * Internal function; called by RomData::romOps().
+ * @return List of operations.
+ */
+vector<RomData::RomOp> WonderSwan::romOps_int(void) const
+{
+	vector<RomOp> ops;
+	ops.emplace_back(C_("RomData|RomOps", "&Verify Checksums"), RomOp::ROF_ENABLED | RomOp::ROF_VERIFY);
+	return ops;
+}
+
+/**
+ * Perform a ROM operation.
+ * Internal function; called by RomData::doRomOp().
+ * @param id		[in] Operation index.
+ * @param pParams	[in/out] Parameters and results. (for e.g. UI updates)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WonderSwan::doRomOp_int(int id, RomOpParams *pParams)
+{
+	RP_D(WonderSwan);
+
+	// Currently only one ROM operation.
+	if (id != 0) {
+		pParams->status = -EINVAL;
+		pParams->msg = C_("RomData", "ROM operation ID is invalid for this object.");
+		return -EINVAL;
+	}
+
+	// Make sure the fields are loaded, since the results are added to them.
+	if (d->fields.empty()) {
+		loadFieldData();
+	}
+
+	RomChecksum::Params params;
+	// NOTE: WonderWitch ROMs have a checksum of 0.
+	params.algorithm = RomChecksum::Algorithm::WonderSwan;
+	params.expected[0] = le16_to_cpu(d->romFooter.checksum);
+	return RomChecksum::doVerifyRomOp(d->file, params, d->fields, pParams);
+}
+
 }
@@ -17,6 +17,7 @@ ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
 ROMDATA_DECL_IMGEXT()
+ROMDATA_DECL_ROMOPS()
 ROMDATA_DECL_END()
 
 }
@@ -0,0 +1,1624 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * RomDataCache.cpp: Persistent RomData cache.                             *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.libromdata.h"
+#include "config.version.h"
+#include "RomDataCache.hpp"
+#include "RomDataFactory.hpp"
+
+// Other rom-properties libraries
+#include "libcachecommon/CacheDir.hpp"
+#include "librpbase/RomData_p.hpp"
+#include "librpbase/SystemRegion.hpp"
+#include "librpbase/config/Config.hpp"
+#include "librpbase/img/RpPng.hpp"
+#include "librpbase/img/RpPngWriter.hpp"
+#include "librpfile/FileSystem.hpp"
+#include "librpfile/MemFile.hpp"
+#include "librpfile/RpFile.hpp"
+#include "librpfile/VectorFile.hpp"
+#include "librpthreads/Mutex.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+using namespace LibRpTexture;
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+#ifndef _WIN32
+// C includes
+#  include <dirent.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  include <cinttypes>
+#endif /* !_WIN32 */
+
+// C++ STL classes
+using std::array;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace RomDataCache {
+
+namespace Private {
+
+// Cache entry magic number and format version.
+// Increment CACHE_VERSION if the serialization format changes.
+static const char CACHE_MAGIC[8] = {'R','P','R','D','C','A','C','H'};
+static constexpr uint32_t CACHE_VERSION = 2;
+
+// Cache entry subdirectory and file extension.
+static const char CACHE_SUBDIR[] = "romdata";
+static const char CACHE_EXT[] = ".rpcache";
+
+// Length value used to indicate nullptr strings and vectors.
+static constexpr uint32_t NULL_LEN = ~0U;
+
+// Number of system name variants.
+// (3 types * 2 regions)
+static constexpr unsigned int SYSNAME_COUNT = 6;
+
+// Cache statistics.
+static Stats stats;
+static Mutex stats_mutex;
+
+// Total size of the cache directory, in bytes.
+// -1 if the cache directory hasn't been scanned yet.
+static off64_t cache_size = -1;
+static off64_t cache_max_size = DEFAULT_MAX_SIZE;
+static Mutex cache_mutex;
+
+/**
+ * Increment a statistics counter.
+ * @param pCounter Counter to increment
+ */
+static inline void inc_stat(uint32_t *pCounter)
+{
+	MutexLocker mutexLocker(stats_mutex);
+	(*pCounter)++;
+}
+
+/**
+ * Serialized data writer.
+ * NOTE: Values are written in host byte order.
+ */
+class Writer
+{
+public:
+	explicit Writer(vector<uint8_t> &buf)
+		: buf(buf)
+	{}
+
+private:
+	RP_DISABLE_COPY(Writer)
+
+public:
+	inline void write(const void *data, size_t size)
+	{
+		const uint8_t *const p = static_cast<const uint8_t*>(data);
+		buf.insert(buf.end(), p, p + size);
+	}
+
+	inline void u8(uint8_t val)	{ buf.push_back(val); }
+	inline void u16(uint16_t val)	{ write(&val, sizeof(val)); }
+	inline void u32(uint32_t val)	{ write(&val, sizeof(val)); }
+	inline void i32(int32_t val)	{ write(&val, sizeof(val)); }
+	inline void i64(int64_t val)	{ write(&val, sizeof(val)); }
+	inline void u64(uint64_t val)	{ write(&val, sizeof(val)); }
+	inline void dbl(double val)	{ write(&val, sizeof(val)); }
+
+	/**
+	 * Write a string.
+	 * @param str String (may be nullptr)
+	 */
+	void str(const char *str)
+	{
+		if (!str) {
+			u32(NULL_LEN);
+			return;
+		}
+		const size_t len = strlen(str);
+		u32(static_cast<uint32_t>(len));
+		write(str, len);
+	}
+
+	/**
+	 * Write a string.
+	 * @param str String
+	 */
+	void str(const string &str)
+	{
+		u32(static_cast<uint32_t>(str.size()));
+		write(str.data(), str.size());
+	}
+
+	/**
+	 * Write a vector of strings.
+	 * @param vec Vector of strings (may be nullptr)
+	 */
+	void str_vec(const vector<string> *vec)
+	{
+		if (!vec) {
+			u32(NULL_LEN);
+			return;
+		}
+		u32(static_cast<uint32_t>(vec->size()));
+		for (const string &s : *vec) {
+			str(s);
+		}
+	}
+
+	/**
+	 * Write an image as PNG.
+	 * @param img Image (may be nullptr)
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int image(const rp_image_const_ptr &img)
+	{
+		if (!img || !img->isValid()) {
+			u32(NULL_LEN);
+			return 0;
+		}
+
+		shared_ptr<VectorFile> pngData = std::make_shared<VectorFile>();
+		{
+			RpPngWriter pngWriter(pngData, img);
+			if (!pngWriter.isOpen()) {
+				// Unable to open the PNG writer.
+				return -EIO;
+			}
+			int ret = pngWriter.write_IHDR();
+			if (ret != 0)
+				return ret;
+			ret = pngWriter.write_IDAT();
+			if (ret != 0)
+				return ret;
+			// RpPngWriter will finalize the PNG on delete.
+		}
+
+		const vector<uint8_t> &vec = pngData->vector();
+		u32(static_cast<uint32_t>(vec.size()));
+		write(vec.data(), vec.size());
+		return 0;
+	}
+
+private:
+	vector<uint8_t> &buf;
+};
+
+/**
+ * Serialized data reader.
+ * If a read goes past the end of the buffer, the error flag is set,
+ * and all subsequent reads will return zero or empty values.
+ */
+class Reader
+{
+public:
+	Reader(const uint8_t *buf, size_t size)
+		: p(buf)
+		, p_end(buf + size)
+		, err(false)
+	{}
+
+private:
+	RP_DISABLE_COPY(Reader)
+
+public:
+	/**
+	 * Has an error occurred?
+	 * @return True if an error occurred; false if not.
+	 */
+	inline bool hasError(void) const { return err; }
+
+	/**
+	 * Read data from the buffer.
+	 * @param data	[out] Output buffer
+	 * @param size	[in] Size to read
+	 * @return True on success; false on error.
+	 */
+	bool read(void *data, size_t size)
+	{
+		if (err || static_cast<size_t>(p_end - p) < size) {
+			err = true;
+			memset(data, 0, size);
+			return false;
+		}
+		memcpy(data, p, size);
+		p += size;
+		return true;
+	}
+
+	template<typename T>
+	inline T val(void)
+	{
+		T v;
+		read(&v, sizeof(v));
+		return v;
+	}
+
+	inline uint8_t u8(void)		{ return val<uint8_t>(); }
+	inline uint16_t u16(void)	{ return val<uint16_t>(); }
+	inline uint32_t u32(void)	{ return val<uint32_t>(); }
+	inline int32_t i32(void)	{ return val<int32_t>(); }
+	inline int64_t i64(void)	{ return val<int64_t>(); }
+	inline uint64_t u64(void)	{ return val<uint64_t>(); }
+	inline double dbl(void)		{ return val<double>(); }
+
+	/**
+	 * Read a count value.
+	 * Counts are checked against the remaining buffer size
+	 * to prevent excessive allocations for corrupted entries.
+	 * @param elemSize Minimum size of each element
+	 * @return Count, or NULL_LEN if the original value was nullptr.
+	 */
+	uint32_t count(size_t elemSize = 1)
+	{
+		const uint32_t len = u32();
+		if (len == NULL_LEN)
+			return len;
+		if (elemSize > 0 && static_cast<size_t>(p_end - p) / elemSize < len) {
+			err = true;
+			return 0;
+		}
+		return len;
+	}
+
+	/**
+	 * Read a string.
+	 * @param pIsNull	[out,opt] Set to true if the string was nullptr
+	 * @return String
+	 */
+	string str(bool *pIsNull = nullptr)
+	{
+		const uint32_t len = count();
+		if (pIsNull) {
+			*pIsNull = (len == NULL_LEN);
+		}
+		if (len == NULL_LEN || err)
+			return {};
+
+		string s(reinterpret_cast<const char*>(p), len);
+		p += len;
+		return s;
+	}
+
+	/**
+	 * Read a vector of strings.
+	 * @return Vector of strings, or nullptr if the original value was nullptr.
+	 */
+	vector<string> *str_vec(void)
+	{
+		const uint32_t len = count(sizeof(uint32_t));
+		if (len == NULL_LEN || err)
+			return nullptr;
+
+		vector<string> *const vec = new vector<string>();
+		vec->reserve(len);
+		for (uint32_t i = 0; i < len && !err; i++) {
+			vec->push_back(str());
+		}
+		return vec;
+	}
+
+	/**
+	 * Read a PNG image.
+	 * @return Image, or nullptr if the original value was nullptr or on error.
+	 */
+	rp_image_ptr image(void)
+	{
+		const uint32_t len = count();
+		if (len == NULL_LEN || err)
+			return nullptr;
+
+		shared_ptr<MemFile> pngData = std::make_shared<MemFile>(p, len);
+		p += len;
+		return RpPng::load(pngData);
+	}
+
+private:
+	const uint8_t *p;
+	const uint8_t *const p_end;
+	bool err;
+};
+
+/** CachedRomData **/
+
+class CachedRomData;
+class CachedRomDataPrivate final : public RomDataPrivate
+{
+public:
+	CachedRomDataPrivate();
+
+private:
+	typedef RomDataPrivate super;
+	RP_DISABLE_COPY(CachedRomDataPrivate)
+
+public:
+	/** RomDataInfo **/
+	static const char *const exts[];
+	static const char *const mimeTypes[];
+	RomDataInfo romDataInfo;
+
+public:
+	string s_className;
+	string s_mimeType;
+	array<string, SYSNAME_COUNT> systemNames;
+	uint8_t systemNames_valid;	// Bitfield
+	bool hasDangerousPermissions;
+
+	// Images
+	uint32_t imgbf;
+	array<uint32_t, RomData::IMG_EXT_MAX + 1> imgpf;
+	array<rp_image_const_ptr, RomData::IMG_INT_MAX + 1> images;
+
+	// External image URLs
+	struct ExtImage {
+		vector<string> sizeNames;
+		vector<RomData::ImageSizeDef> sizeDefs;
+		vector<vector<RomData::ExtURL> > extURLs;	// One list per sizeDef
+	};
+	array<ExtImage, RomData::IMG_EXT_MAX - RomData::IMG_EXT_MIN + 1> extImages;
+};
+
+const char *const CachedRomDataPrivate::exts[] = { nullptr };
+const char *const CachedRomDataPrivate::mimeTypes[] = { nullptr };
+
+CachedRomDataPrivate::CachedRomDataPrivate()
+	: super(nullptr, &romDataInfo)
+	, systemNames_valid(0)
+	, hasDangerousPermissions(false)
+	, imgbf(0)
+{
+	romDataInfo.className = nullptr;
+	romDataInfo.exts = exts;
+	romDataInfo.mimeTypes = mimeTypes;
+	imgpf.fill(0);
+}
+
+class CachedRomData final : public RomData
+{
+public:
+	CachedRomData()
+		: super(new CachedRomDataPrivate())
+	{}
+
+private:
+	typedef RomData super;
+	friend class CachedRomDataPrivate;
+	RP_DISABLE_COPY(CachedRomData)
+
+public:
+	/**
+	 * Load the cached data.
+	 * @param filename	[in,opt] ROM filename
+	 * @param reader	[in] Reader
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int load(const char *filename, Reader &reader);
+
+public:
+	int isRomSupported(const DetectInfo *info) const final
+	{
+		RP_UNUSED(info);
+		return -1;
+	}
+
+	const char *systemName(unsigned int type) const final
+	{
+		RP_D(const CachedRomData);
+		if (!d->isValid || !isSystemNameTypeValid(type))
+			return nullptr;
+
+		// Index: type bits 0-1, region bit 2
+		const unsigned int idx = (type & SYSNAME_TYPE_MASK) +
+			((type & SYSNAME_REGION_MASK) ? 3 : 0);
+		return (d->systemNames_valid & (1U << idx))
+			? d->systemNames[idx].c_str()
+			: nullptr;
+	}
+
+	uint32_t supportedImageTypes(void) const final
+	{
+		RP_D(const CachedRomData);
+		return d->imgbf;
+	}
+
+	vector<ImageSizeDef> supportedImageSizes(ImageType imageType) const final
+	{
+		ASSERT_supportedImageSizes(imageType);
+		RP_D(const CachedRomData);
+		if (imageType < IMG_EXT_MIN) {
+			const rp_image_const_ptr &img = d->images[imageType];
+			if (!img)
+				return {};
+			return {{nullptr, static_cast<uint16_t>(img->width()), static_cast<uint16_t>(img->height()), 0}};
+		}
+		return d->extImages[imageType - IMG_EXT_MIN].sizeDefs;
+	}
+
+	uint32_t imgpf(ImageType imageType) const final
+	{
+		ASSERT_imgpf(imageType);
+		RP_D(const CachedRomData);
+		return d->imgpf[imageType];
+	}
+
+	int loadFieldData(void) final
+	{
+		RP_D(const CachedRomData);
+		return d->fields.count();
+	}
+
+	int loadMetaData(void) final
+	{
+		RP_D(const CachedRomData);
+		return (d->metaData ? d->metaData->count() : -ENOENT);
+	}
+
+	int loadInternalImage(ImageType imageType, rp_image_const_ptr &pImage) final
+	{
+		ASSERT_loadInternalImage(imageType, pImage);
+		RP_D(const CachedRomData);
+		pImage = d->images[imageType];
+		return (pImage ? 0 : -ENOENT);
+	}
+
+	int extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int size) const final
+	{
+		ASSERT_extURLs(imageType, pExtURLs);
+		pExtURLs->clear();
+
+		RP_D(const CachedRomData);
+		const CachedRomDataPrivate::ExtImage &extImage = d->extImages[imageType - IMG_EXT_MIN];
+		if (extImage.extURLs.empty()) {
+			return -ENOENT;
+		}
+
+		// Select the URLs for the best image size.
+		// If the RomData subclass didn't have any image sizes,
+		// a single URL list is cached.
+		size_t idx = 0;
+		if (!extImage.sizeDefs.empty()) {
+			const ImageSizeDef *const sizeDef = RomDataPrivate::selectBestSize(extImage.sizeDefs, size);
+			if (!sizeDef) {
+				return -ENOENT;
+			}
+			idx = static_cast<size_t>(sizeDef - extImage.sizeDefs.data());
+		}
+		assert(idx < extImage.extURLs.size());
+		if (idx >= extImage.extURLs.size()) {
+			return -ENOENT;
+		}
+
+		*pExtURLs = extImage.extURLs[idx];
+		return 0;
+	}
+
+	bool hasDangerousPermissions(void) const final
+	{
+		RP_D(const CachedRomData);
+		return d->hasDangerousPermissions;
+	}
+};
+
+/** Field serialization **/
+
+/**
+ * Serialize list data.
+ * @param w Writer
+ * @param list_data List data (may be nullptr)
+ */
+static void writeListData(Writer &w, const RomFields::ListData_t *list_data)
+{
+	if (!list_data) {
+		w.u32(NULL_LEN);
+		return;
+	}
+
+	w.u32(static_cast<uint32_t>(list_data->size()));
+	for (const vector<string> &row : *list_data) {
+		w.str_vec(&row);
+	}
+}
+
+/**
+ * Deserialize list data.
+ * @param r Reader
+ * @return List data, or nullptr if the original value was nullptr.
+ */
+static RomFields::ListData_t *readListData(Reader &r)
+{
+	const uint32_t rows = r.count(sizeof(uint32_t));
+	if (rows == NULL_LEN || r.hasError())
+		return nullptr;
+
+	RomFields::ListData_t *const list_data = new RomFields::ListData_t();
+	list_data->resize(rows);
+	for (vector<string> &row : *list_data) {
+		vector<string> *const vec = r.str_vec();
+		if (vec) {
+			row = std::move(*vec);
+			delete vec;
+		}
+	}
+	return list_data;
+}
+
+/**
+ * Serialize a RomFields object.
+ * @param w Writer
+ * @param fields RomFields
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int writeFields(Writer &w, const RomFields *fields)
+{
+	w.u32(fields->defaultLanguageCode());
+
+	const int tabCount = fields->tabCount();
+	w.u32(static_cast<uint32_t>(tabCount));
+	for (int i = 0; i < tabCount; i++) {
+		w.str(fields->tabName(i));
+	}
+
+	w.u32(static_cast<uint32_t>(fields->count()));
+	const auto fields_cend = fields->cend();
+	for (auto iter = fields->cbegin(); iter != fields_cend; ++iter) {
+		const RomFields::Field &field = *iter;
+		w.str(field.name);
+		w.u8(field.type);
+		w.u8(field.tabIdx);
+		w.u32(field.flags);
+
+		switch (field.type) {
+			case RomFields::RFT_INVALID:
+			default:
+				break;
+
+			case RomFields::RFT_STRING:
+				w.str(field.data.str);
+				break;
+
+			case RomFields::RFT_BITFIELD:
+				w.str_vec(field.desc.bitfield.names);
+				w.i32(field.desc.bitfield.elemsPerRow);
+				w.u32(field.data.bitfield);
+				break;
+
+			case RomFields::RFT_LISTDATA: {
+				const RomFields::ListDataColAttrs_t &col_attrs = field.desc.list_data.col_attrs;
+				w.str_vec(field.desc.list_data.names);
+				w.i32(field.desc.list_data.rows_visible);
+				w.u16(col_attrs.align_headers);
+				w.u16(col_attrs.align_data);
+				w.u16(col_attrs.sizing);
+				w.u16(col_attrs.sorting);
+				w.u8(static_cast<uint8_t>(col_attrs.sort_col));
+				w.u8(col_attrs.sort_dir);
+				w.u8(col_attrs.is_timestamp);
+				w.u8(col_attrs.dtflags);
+
+				if (field.flags & RomFields::RFT_LISTDATA_MULTI) {
+					const RomFields::ListDataMultiMap_t *const multi = field.data.list_data.data.multi;
+					if (!multi) {
+						w.u32(NULL_LEN);
+					} else {
+						w.u32(static_cast<uint32_t>(multi->size()));
+						for (const auto &pair : *multi) {
+							w.u32(pair.first);
+							writeListData(w, &pair.second);
+						}
+					}
+				} else {
+					writeListData(w, field.data.list_data.data.single);
+				}
+
+				if (field.flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
+					w.u32(field.data.list_data.mxd.checkboxes);
+				} else if (field.flags & RomFields::RFT_LISTDATA_ICONS) {
+					const RomFields::ListDataIcons_t *const icons = field.data.list_data.mxd.icons;
+					if (!icons) {
+						w.u32(NULL_LEN);
+					} else {
+						w.u32(static_cast<uint32_t>(icons->size()));
+						for (const rp_image_const_ptr &icon : *icons) {
+							int ret = w.image(icon);
+							if (ret != 0)
+								return ret;
+						}
+					}
+				}
+				break;
+			}
+
+			case RomFields::RFT_DATETIME:
+				w.i64(static_cast<int64_t>(field.data.date_time));
+				break;
+
+			case RomFields::RFT_AGE_RATINGS: {
+				const RomFields::age_ratings_t *const age_ratings = field.data.age_ratings;
+				w.u8(age_ratings != nullptr);
+				if (age_ratings) {
+					w.write(age_ratings->data(), sizeof(*age_ratings));
+				}
+				break;
+			}
+
+			case RomFields::RFT_DIMENSIONS:
+				w.i32(field.data.dimensions[0]);
+				w.i32(field.data.dimensions[1]);
+				w.i32(field.data.dimensions[2]);
+				break;
+
+			case RomFields::RFT_STRING_MULTI: {
+				const RomFields::StringMultiMap_t *const str_multi = field.data.str_multi;
+				if (!str_multi) {
+					w.u32(NULL_LEN);
+				} else {
+					w.u32(static_cast<uint32_t>(str_multi->size()));
+					for (const auto &pair : *str_multi) {
+						w.u32(pair.first);
+						w.str(pair.second);
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Deserialize a RomFields object.
+ * @param r Reader
+ * @param fields RomFields (must be empty)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int readFields(Reader &r, RomFields *fields)
+{
+	const uint32_t def_lc = r.u32();
+
+	const uint32_t tabCount = r.count(sizeof(uint32_t));
+	if (tabCount == NULL_LEN || r.hasError())
+		return -EIO;
+	if (tabCount > 0) {
+		fields->reserveTabs(static_cast<int>(tabCount));
+		for (uint32_t i = 0; i < tabCount; i++) {
+			bool isNull;
+			const string tabName = r.str(&isNull);
+			fields->setTabName(static_cast<int>(i), isNull ? nullptr : tabName.c_str());
+		}
+	}
+
+	const uint32_t fieldCount = r.count(sizeof(uint32_t) * 2);
+	if (fieldCount == NULL_LEN || r.hasError())
+		return -EIO;
+	if (fieldCount > 0) {
+		fields->reserve(static_cast<int>(fieldCount));
+	}
+
+	for (uint32_t i = 0; i < fieldCount && !r.hasError(); i++) {
+		const string name = r.str();
+		const RomFields::RomFieldType type = static_cast<RomFields::RomFieldType>(r.u8());
+		const uint8_t tabIdx = r.u8();
+		const unsigned int flags = r.u32();
+		fields->setTabIndex(tabIdx);
+
+		switch (type) {
+			default:
+				// Unsupported field type.
+				return -EIO;
+
+			case RomFields::RFT_STRING: {
+				bool isNull;
+				const string str = r.str(&isNull);
+				fields->addField_string(name.c_str(), isNull ? nullptr : str.c_str(), flags);
+				break;
+			}
+
+			case RomFields::RFT_BITFIELD: {
+				const vector<string> *const names = r.str_vec();
+				const int elemsPerRow = r.i32();
+				const uint32_t bitfield = r.u32();
+				if (!names)
+					return -EIO;
+				fields->addField_bitfield(name.c_str(), names, elemsPerRow, bitfield);
+				break;
+			}
+
+			case RomFields::RFT_LISTDATA: {
+				RomFields::AFLD_PARAMS params(flags, 0);
+				params.headers = r.str_vec();
+				params.rows_visible = r.i32();
+				params.col_attrs.align_headers = r.u16();
+				params.col_attrs.align_data = r.u16();
+				params.col_attrs.sizing = r.u16();
+				params.col_attrs.sorting = r.u16();
+				params.col_attrs.sort_col = static_cast<int8_t>(r.u8());
+				params.col_attrs.sort_dir = static_cast<RomFields::ColSortOrder>(r.u8());
+				params.col_attrs.is_timestamp = r.u8();
+				params.col_attrs.dtflags = static_cast<RomFields::DateTimeFlags>(r.u8());
+				params.def_lc = def_lc;
+
+				if (flags & RomFields::RFT_LISTDATA_MULTI) {
+					const uint32_t count = r.count(sizeof(uint32_t) * 2);
+					if (count != NULL_LEN && !r.hasError()) {
+						RomFields::ListDataMultiMap_t *const multi = new RomFields::ListDataMultiMap_t();
+						for (uint32_t j = 0; j < count && !r.hasError(); j++) {
+							const uint32_t lc = r.u32();
+							RomFields::ListData_t *const list_data = readListData(r);
+							if (list_data) {
+								multi->emplace(lc, std::move(*list_data));
+								delete list_data;
+							}
+						}
+						params.data.multi = multi;
+					}
+				} else {
+					params.data.single = readListData(r);
+				}
+
+				if (flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
+					params.mxd.checkboxes = r.u32();
+				} else if (flags & RomFields::RFT_LISTDATA_ICONS) {
+					const uint32_t count = r.count(sizeof(uint32_t));
+					if (count != NULL_LEN && !r.hasError()) {
+						RomFields::ListDataIcons_t *const icons = new RomFields::ListDataIcons_t();
+						icons->reserve(count);
+						for (uint32_t j = 0; j < count && !r.hasError(); j++) {
+							icons->push_back(r.image());
+						}
+						params.mxd.icons = icons;
+					}
+				}
+
+				// NOTE: RomFields takes ownership of the vectors.
+				fields->addField_listData(name.c_str(), &params);
+				break;
+			}
+
+			case RomFields::RFT_DATETIME:
+				fields->addField_dateTime(name.c_str(), static_cast<time_t>(r.i64()), flags);
+				break;
+
+			case RomFields::RFT_AGE_RATINGS: {
+				if (r.u8()) {
+					RomFields::age_ratings_t age_ratings;
+					r.read(age_ratings.data(), sizeof(age_ratings));
+					fields->addField_ageRatings(name.c_str(), age_ratings);
+				}
+				break;
+			}
+
+			case RomFields::RFT_DIMENSIONS: {
+				const int dimX = r.i32();
+				const int dimY = r.i32();
+				const int dimZ = r.i32();
+				fields->addField_dimensions(name.c_str(), dimX, dimY, dimZ);
+				break;
+			}
+
+			case RomFields::RFT_STRING_MULTI: {
+				const uint32_t count = r.count(sizeof(uint32_t) * 2);
+				RomFields::StringMultiMap_t *str_multi = nullptr;
+				if (count != NULL_LEN && !r.hasError()) {
+					str_multi = new RomFields::StringMultiMap_t();
+					for (uint32_t j = 0; j < count && !r.hasError(); j++) {
+						const uint32_t lc = r.u32();
+						str_multi->emplace(lc, r.str());
+					}
+				}
+				fields->addField_string_multi(name.c_str(), str_multi, def_lc, flags);
+				break;
+			}
+		}
+	}
+
+	return (r.hasError() ? -EIO : 0);
+}
+
+/** Metadata serialization **/
+
+/**
+ * Serialize a RomMetaData object.
+ * @param w Writer
+ * @param metaData RomMetaData (may be nullptr)
+ */
+static void writeMetaData(Writer &w, const RomMetaData *metaData)
+{
+	if (!metaData) {
+		w.u32(NULL_LEN);
+		return;
+	}
+
+	w.u32(static_cast<uint32_t>(metaData->count()));
+	const auto metaData_cend = metaData->cend();
+	for (auto iter = metaData->cbegin(); iter != metaData_cend; ++iter) {
+		const RomMetaData::MetaData &prop = *iter;
+		w.i32(static_cast<int32_t>(prop.name));
+		w.u8(static_cast<uint8_t>(prop.type));
+		switch (prop.type) {
+			default:
+				break;
+			case PropertyType::Integer:
+				w.i32(prop.data.ivalue);
+				break;
+			case PropertyType::UnsignedInteger:
+				w.u32(prop.data.uvalue);
+				break;
+			case PropertyType::String:
+				w.str(prop.data.str ? prop.data.str->c_str() : nullptr);
+				break;
+			case PropertyType::Timestamp:
+				w.i64(static_cast<int64_t>(prop.data.timestamp));
+				break;
+			case PropertyType::Double:
+				w.dbl(prop.data.dvalue);
+				break;
+		}
+	}
+}
+
+/**
+ * Deserialize a RomMetaData object.
+ * @param r Reader
+ * @return RomMetaData, or nullptr if the original value was nullptr or on error.
+ */
+static RomMetaData *readMetaData(Reader &r)
+{
+	const uint32_t count = r.count(sizeof(int32_t) + 1);
+	if (count == NULL_LEN || r.hasError())
+		return nullptr;
+
+	RomMetaData *const metaData = new RomMetaData();
+	if (count > 0) {
+		metaData->reserve(static_cast<int>(count));
+	}
+	for (uint32_t i = 0; i < count && !r.hasError(); i++) {
+		const Property name = static_cast<Property>(r.i32());
+		const PropertyType type = static_cast<PropertyType>(r.u8());
+		switch (type) {
+			default:
+				break;
+			case PropertyType::Integer:
+				metaData->addMetaData_integer(name, r.i32());
+				break;
+			case PropertyType::UnsignedInteger:
+				metaData->addMetaData_uint(name, r.u32());
+				break;
+			case PropertyType::String: {
+				bool isNull;
+				const string str = r.str(&isNull);
+				if (!isNull) {
+					metaData->addMetaData_string(name, str);
+				}
+				break;
+			}
+			case PropertyType::Timestamp:
+				metaData->addMetaData_timestamp(name, static_cast<time_t>(r.i64()));
+				break;
+			case PropertyType::Double:
+				metaData->addMetaData_double(name, r.dbl());
+				break;
+		}
+	}
+
+	if (r.hasError()) {
+		delete metaData;
+		return nullptr;
+	}
+	return metaData;
+}
+
+/** External image URLs **/
+
+/**
+ * Serialize a list of external image URLs.
+ * @param w Writer
+ * @param extURLs External image URLs
+ */
+static void writeExtURLs(Writer &w, const vector<RomData::ExtURL> &extURLs)
+{
+	w.u32(static_cast<uint32_t>(extURLs.size()));
+	for (const RomData::ExtURL &extURL : extURLs) {
+		w.str(extURL.url);
+		w.str(extURL.cache_key);
+		w.u16(extURL.width);
+		w.u16(extURL.height);
+		w.u8(extURL.high_res);
+	}
+}
+
+/**
+ * Deserialize a list of external image URLs.
+ * @param r Reader
+ * @return External image URLs
+ */
+static vector<RomData::ExtURL> readExtURLs(Reader &r)
+{
+	vector<RomData::ExtURL> extURLs;
+	const uint32_t count = r.count(sizeof(uint32_t) * 2);
+	if (count == NULL_LEN || r.hasError())
+		return extURLs;
+
+	extURLs.resize(count);
+	for (RomData::ExtURL &extURL : extURLs) {
+		extURL.url = r.str();
+		extURL.cache_key = r.str();
+		extURL.width = r.u16();
+		extURL.height = r.u16();
+		extURL.high_res = (r.u8() != 0);
+	}
+	return extURLs;
+}
+
+/**
+ * Load the cached data.
+ * @param filename	[in,opt] ROM filename
+ * @param reader	[in] Reader
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CachedRomData::load(const char *filename, Reader &r)
+{
+	RP_D(CachedRomData);
+	if (filename) {
+		d->filename = strdup(filename);
+	}
+
+	d->s_className = r.str();
+	d->romDataInfo.className = d->s_className.c_str();
+	bool isNull;
+	d->s_mimeType = r.str(&isNull);
+	d->mimeType = (isNull ? nullptr : d->s_mimeType.c_str());
+	d->fileType = static_cast<FileType>(r.u8());
+	if (d->fileType >= FileType::Max) {
+		return -EIO;
+	}
+	d->hasDangerousPermissions = (r.u8() != 0);
+
+	for (unsigned int i = 0; i < SYSNAME_COUNT; i++) {
+		d->systemNames[i] = r.str(&isNull);
+		if (!isNull) {
+			d->systemNames_valid |= (1U << i);
+		}
+	}
+
+	// Images
+	d->imgbf = r.u32();
+	for (uint32_t &imgpf : d->imgpf) {
+		imgpf = r.u32();
+	}
+	for (int i = IMG_INT_MIN; i <= IMG_INT_MAX; i++) {
+		if (d->imgbf & (1U << i)) {
+			d->images[i] = r.image();
+			if (!d->images[i]) {
+				// Image is missing.
+				d->imgbf &= ~(1U << i);
+			}
+		}
+	}
+
+	// External image URLs
+	for (int i = IMG_EXT_MIN; i <= IMG_EXT_MAX; i++) {
+		if (!(d->imgbf & (1U << i)))
+			continue;
+
+		CachedRomDataPrivate::ExtImage &extImage = d->extImages[i - IMG_EXT_MIN];
+		const uint32_t sizeCount = r.count(sizeof(uint32_t) + sizeof(uint16_t) * 3);
+		if (sizeCount == NULL_LEN || r.hasError())
+			return -EIO;
+
+		// Read the names first so the ImageSizeDef pointers are stable.
+		extImage.sizeNames.resize(sizeCount);
+		extImage.sizeDefs.resize(sizeCount);
+		vector<bool> nameIsNull(sizeCount);
+		for (uint32_t j = 0; j < sizeCount; j++) {
+			bool b;
+			extImage.sizeNames[j] = r.str(&b);
+			nameIsNull[j] = b;
+			ImageSizeDef &sizeDef = extImage.sizeDefs[j];
+			sizeDef.width = r.u16();
+			sizeDef.height = r.u16();
+			sizeDef.index = r.u16();
+		}
+		for (uint32_t j = 0; j < sizeCount; j++) {
+			extImage.sizeDefs[j].name = (nameIsNull[j] ? nullptr : extImage.sizeNames[j].c_str());
+		}
+
+		// One URL list per size, or a single list if there are no sizes.
+		const uint32_t listCount = (sizeCount > 0 ? sizeCount : 1);
+		extImage.extURLs.resize(listCount);
+		for (vector<ExtURL> &extURLs : extImage.extURLs) {
+			extURLs = readExtURLs(r);
+		}
+	}
+	if (r.hasError())
+		return -EIO;
+
+	// Fields
+	int ret = readFields(r, &d->fields);
+	if (ret != 0)
+		return ret;
+
+	// Metadata
+	d->metaData = readMetaData(r);
+	if (r.hasError())
+		return -EIO;
+
+	d->isValid = true;
+	return 0;
+}
+
+/** Cache entries **/
+
+#ifndef _WIN32
+/**
+ * Get the cache entry directory.
+ * @return Cache entry directory (with trailing slash), or empty string on error.
+ */
+static string getCacheEntryDir(void)
+{
+	const string &cache_dir = LibCacheCommon::getCacheDirectory();
+	if (cache_dir.empty())
+		return {};
+
+	string entry_dir = cache_dir;
+	if (entry_dir.at(entry_dir.size()-1) != '/') {
+		entry_dir += '/';
+	}
+	entry_dir += CACHE_SUBDIR;
+	entry_dir += '/';
+	return entry_dir;
+}
+
+/**
+ * Get the cache entry filename for a file.
+ * @param entry_dir Cache entry directory
+ * @param sb stat buffer
+ * @return Cache entry filename
+ */
+static string getCacheEntryFilename(const string &entry_dir, const struct stat &sb)
+{
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%016" PRIx64 "-%016" PRIx64 "%s",
+		static_cast<uint64_t>(sb.st_dev), static_cast<uint64_t>(sb.st_ino), CACHE_EXT);
+	return entry_dir + buf;
+}
+
+/**
+ * Get the nanoseconds portion of a file's mtime.
+ * @param sb stat buffer
+ * @return Nanoseconds, or 0 if not supported by this system.
+ */
+static inline int32_t get_mtime_nsec(const struct stat &sb)
+{
+#if defined(HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC)
+	return static_cast<int32_t>(sb.st_mtim.tv_nsec);
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC_TV_NSEC)
+	return static_cast<int32_t>(sb.st_mtimespec.tv_nsec);
+#else
+	// Only second resolution is available.
+	RP_UNUSED(sb);
+	return 0;
+#endif
+}
+
+/**
+ * Write the cache entry header.
+ * @param w Writer
+ * @param filename ROM filename
+ * @param sb stat buffer for the ROM file
+ * @param attrs RomDataAttr bitfield
+ */
+static void writeHeader(Writer &w, const char *filename, const struct stat &sb, unsigned int attrs)
+{
+	w.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	w.u32(CACHE_VERSION);
+	w.str(RP_VERSION_STRING);
+	w.u64(static_cast<uint64_t>(sb.st_dev));
+	w.u64(static_cast<uint64_t>(sb.st_ino));
+	w.i64(static_cast<int64_t>(sb.st_size));
+	w.i64(static_cast<int64_t>(sb.st_mtime));
+	w.u32(static_cast<uint32_t>(get_mtime_nsec(sb)));
+	w.u32(SystemRegion::getLanguageCode());
+	w.u32(attrs);
+	w.str(filename);
+}
+
+/**
+ * Check the cache entry header.
+ * @param r Reader
+ * @param filename ROM filename
+ * @param sb stat buffer for the ROM file
+ * @param attrs Required RomDataAttr bitfield
+ * @return True if the cache entry is valid for this file; false if not.
+ */
+static bool checkHeader(Reader &r, const char *filename, const struct stat &sb, unsigned int attrs)
+{
+	char magic[sizeof(CACHE_MAGIC)];
+	r.read(magic, sizeof(magic));
+	if (memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 || r.u32() != CACHE_VERSION)
+		return false;
+	if (r.str() != RP_VERSION_STRING)
+		return false;
+
+	if (r.u64() != static_cast<uint64_t>(sb.st_dev) ||
+	    r.u64() != static_cast<uint64_t>(sb.st_ino) ||
+	    r.i64() != static_cast<int64_t>(sb.st_size) ||
+	    r.i64() != static_cast<int64_t>(sb.st_mtime) ||
+	    r.u32() != static_cast<uint32_t>(get_mtime_nsec(sb)))
+	{
+		// File has changed.
+		return false;
+	}
+
+	// Some fields depend on the system language.
+	if (r.u32() != SystemRegion::getLanguageCode())
+		return false;
+
+	// RomData subclass must have the required attributes.
+	// Metadata-only entries can only be used for metadata-only lookups,
+	// but full entries can be used for any lookup.
+	const unsigned int entry_attrs = r.u32();
+	if ((entry_attrs & RomDataFactory::RDA_METADATA_ONLY) && !(attrs & RomDataFactory::RDA_METADATA_ONLY))
+		return false;
+	const unsigned int req_attrs = attrs & ~RomDataFactory::RDA_METADATA_ONLY;
+	if ((entry_attrs & req_attrs) != req_attrs)
+		return false;
+
+	// Make sure the filename matches.
+	// (RomData::filename() must return the correct filename.)
+	if (r.str() != filename)
+		return false;
+
+	return !r.hasError();
+}
+
+/**
+ * Scan the cache entry directory.
+ * @param entry_dir	[in] Cache entry directory
+ * @param pEntries	[out,opt] Cache entries: (mtime, size, filename)
+ * @return Total size of all cache entries.
+ */
+static off64_t scanCacheEntries(const string &entry_dir, vector<std::tuple<time_t, off64_t, string> > *pEntries)
+{
+	DIR *const pdir = opendir(entry_dir.c_str());
+	if (!pdir)
+		return 0;
+
+	off64_t total = 0;
+	const size_t ext_len = sizeof(CACHE_EXT) - 1;
+	struct dirent *dirent;
+	while ((dirent = readdir(pdir)) != nullptr) {
+		const size_t len = strlen(dirent->d_name);
+		if (len <= ext_len || strcmp(&dirent->d_name[len - ext_len], CACHE_EXT) != 0)
+			continue;
+
+		string entry_filename = entry_dir + dirent->d_name;
+		struct stat sb;
+		if (stat(entry_filename.c_str(), &sb) != 0 || !S_ISREG(sb.st_mode))
+			continue;
+
+		total += sb.st_size;
+		if (pEntries) {
+			pEntries->emplace_back(sb.st_mtime, sb.st_size, std::move(entry_filename));
+		}
+	}
+	closedir(pdir);
+	return total;
+}
+
+/**
+ * Evict the least-recently used cache entries.
+ * Entries are evicted until the cache is at 75% of the maximum size.
+ * cache_mutex must be locked by the caller.
+ * @param entry_dir Cache entry directory
+ * @param keep_filename Cache entry that must not be evicted
+ */
+static void evictCacheEntries(const string &entry_dir, const string &keep_filename)
+{
+	vector<std::tuple<time_t, off64_t, string> > entries;
+	cache_size = scanCacheEntries(entry_dir, &entries);
+	const off64_t target_size = cache_max_size - (cache_max_size / 4);
+	if (cache_size <= target_size)
+		return;
+
+	// Sort by mtime, oldest first.
+	// NOTE: The mtime is updated on cache hits.
+	std::sort(entries.begin(), entries.end());
+
+	for (const auto &entry : entries) {
+		if (cache_size <= target_size)
+			break;
+
+		const string &entry_filename = std::get<2>(entry);
+		if (entry_filename == keep_filename)
+			continue;
+
+		if (FileSystem::delete_file(entry_filename) == 0) {
+			cache_size -= std::get<1>(entry);
+			inc_stat(&stats.evictions);
+		}
+	}
+}
+#endif /* !_WIN32 */
+
+} // namespace Private
+
+/**
+ * Look up a ROM image in the RomData cache.
+ * The ROM image will not be opened.
+ * @param filename ROM filename (UTF-8)
+ * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @return Cached RomData object, or nullptr if not cached.
+ */
+RomDataPtr lookup(const char *filename, unsigned int attrs)
+{
+	assert(filename != nullptr);
+	if (!filename || filename[0] == '\0')
+		return nullptr;
+
+#ifndef _WIN32
+	// Only regular files are cached.
+	struct stat sb;
+	if (stat(filename, &sb) != 0 || !S_ISREG(sb.st_mode)) {
+		return nullptr;
+	}
+
+	const string entry_dir = Private::getCacheEntryDir();
+	if (entry_dir.empty()) {
+		return nullptr;
+	}
+	const string entry_filename = Private::getCacheEntryFilename(entry_dir, sb);
+
+	// Read the cache entry.
+	vector<uint8_t> buf;
+	{
+		RpFile file(entry_filename, RpFile::FM_OPEN_READ);
+		if (!file.isOpen()) {
+			// No cache entry.
+			Private::inc_stat(&Private::stats.misses);
+			return nullptr;
+		}
+		const off64_t size = file.size();
+		if (size <= 0 || size > Private::cache_max_size) {
+			Private::inc_stat(&Private::stats.misses);
+			return nullptr;
+		}
+		buf.resize(static_cast<size_t>(size));
+		if (file.read(buf.data(), buf.size()) != buf.size()) {
+			Private::inc_stat(&Private::stats.errors);
+			return nullptr;
+		}
+	}
+
+	Private::Reader r(buf.data(), buf.size());
+	if (!Private::checkHeader(r, filename, sb, attrs)) {
+		// Cache entry is stale or doesn't have the required attributes.
+		Private::inc_stat(&Private::stats.misses);
+		return nullptr;
+	}
+
+	Private::CachedRomData *const romData = new Private::CachedRomData();
+	if (romData->load(filename, r) != 0) {
+		// Cache entry is corrupted.
+		delete romData;
+		FileSystem::delete_file(entry_filename);
+		Private::inc_stat(&Private::stats.errors);
+		return nullptr;
+	}
+
+	// Update the cache entry's mtime for LRU eviction.
+	FileSystem::set_mtime(entry_filename, time(nullptr));
+
+	Private::inc_stat(&Private::stats.hits);
+	return RomDataPtr(romData);
+#else /* _WIN32 */
+	// TODO: Use GetFileInformationByHandle() for the file ID.
+	RP_UNUSED(attrs);
+	return nullptr;
+#endif /* !_WIN32 */
+}
+
+/**
+ * Store a RomData object in the RomData cache.
+ *
+ * Field data, metadata, and thumbnail images will be loaded
+ * from the RomData object if they haven't been loaded yet.
+ * If attrs has RDA_METADATA_ONLY, only metadata will be stored.
+ *
+ * @param filename ROM filename (UTF-8)
+ * @param romData RomData object
+ * @param attrs RomDataAttr bitfield for the RomData subclass.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int store(const char *filename, const RomDataPtr &romData, unsigned int attrs)
+{
+	assert(filename != nullptr);
+	assert(romData != nullptr);
+	if (!filename || filename[0] == '\0' || !romData || !romData->isValid())
+		return -EINVAL;
+
+#ifndef _WIN32
+	struct stat sb;
+	if (stat(filename, &sb) != 0) {
+		return -errno;
+	} else if (!S_ISREG(sb.st_mode)) {
+		// Only regular files are cached.
+		return -ENOTSUP;
+	}
+
+	const string entry_dir = Private::getCacheEntryDir();
+	if (entry_dir.empty()) {
+		return -ENOENT;
+	}
+
+	vector<uint8_t> buf;
+	buf.reserve(16384);
+	Private::Writer w(buf);
+	Private::writeHeader(w, filename, sb, attrs);
+	int ret = serialize(romData, buf, (attrs & RomDataFactory::RDA_METADATA_ONLY) != 0);
+	if (ret != 0) {
+		Private::inc_stat(&Private::stats.errors);
+		return ret;
+	}
+
+	if (FileSystem::rmkdir(entry_dir) != 0) {
+		Private::inc_stat(&Private::stats.errors);
+		return -EIO;
+	}
+
+	// Write to a temporary file, then rename it.
+	// This prevents other processes from reading a partial entry.
+	const string entry_filename = Private::getCacheEntryFilename(entry_dir, sb);
+	char pid_buf[24];
+	snprintf(pid_buf, sizeof(pid_buf), ".%u.tmp", static_cast<unsigned int>(getpid()));
+	const string tmp_filename = entry_filename + pid_buf;
+	{
+		RpFile file(tmp_filename, RpFile::FM_CREATE_WRITE);
+		if (!file.isOpen()) {
+			Private::inc_stat(&Private::stats.errors);
+			return -file.lastError();
+		}
+		if (file.write(buf.data(), buf.size()) != buf.size()) {
+			file.close();
+			FileSystem::delete_file(tmp_filename);
+			Private::inc_stat(&Private::stats.errors);
+			return -EIO;
+		}
+	}
+
+	struct stat sb_old;
+	const off64_t old_size = (stat(entry_filename.c_str(), &sb_old) == 0) ? sb_old.st_size : 0;
+	if (rename(tmp_filename.c_str(), entry_filename.c_str()) != 0) {
+		ret = -errno;
+		FileSystem::delete_file(tmp_filename);
+		Private::inc_stat(&Private::stats.errors);
+		return ret;
+	}
+	Private::inc_stat(&Private::stats.stores);
+
+	// Update the total cache size and evict old entries if necessary.
+	MutexLocker mutexLocker(Private::cache_mutex);
+	if (Private::cache_size < 0) {
+		// Cache directory hasn't been scanned yet.
+		Private::cache_size = Private::scanCacheEntries(entry_dir, nullptr);
+	} else {
+		Private::cache_size += static_cast<off64_t>(buf.size()) - old_size;
+	}
+	if (Private::cache_size > Private::cache_max_size) {
+		Private::evictCacheEntries(entry_dir, entry_filename);
+	}
+	return 0;
+#else /* _WIN32 */
+	// TODO: Use GetFileInformationByHandle() for the file ID.
+	RP_UNUSED(attrs);
+	return -ENOTSUP;
+#endif /* !_WIN32 */
+}
+
+/**
+ * Get the cache statistics.
+ * @param pStats	[out] Cache statistics
+ */
+void getStats(Stats *pStats)
+{
+	assert(pStats != nullptr);
+	MutexLocker mutexLocker(Private::stats_mutex);
+	*pStats = Private::stats;
+}
+
+/**
+ * Reset the cache statistics.
+ */
+void resetStats(void)
+{
+	MutexLocker mutexLocker(Private::stats_mutex);
+	memset(&Private::stats, 0, sizeof(Private::stats));
+}
+
+/**
+ * Set the maximum cache size.
+ *
+ * If the total size of all cache entries exceeds this value,
+ * the least-recently used entries will be evicted.
+ *
+ * @param maxSize Maximum cache size, in bytes.
+ */
+void setMaxSize(off64_t maxSize)
+{
+	assert(maxSize > 0);
+	if (maxSize <= 0)
+		return;
+
+	MutexLocker mutexLocker(Private::cache_mutex);
+	Private::cache_max_size = maxSize;
+}
+
+/**
+ * Serialize a RomData object.
+ *
+ * This only serializes the RomData object itself.
+ * The cache entry header is not included.
+ *
+ * If metaDataOnly is true, fields and images are not loaded,
+ * and the deserialized RomData object will only have metadata.
+ *
+ * @param romData	[in] RomData object
+ * @param buf		[out] Output buffer
+ * @param metaDataOnly	[in] If true, only serialize metadata.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int serialize(const RomDataPtr &romData, vector<uint8_t> &buf, bool metaDataOnly)
+{
+	assert(romData != nullptr);
+	if (!romData || !romData->isValid())
+		return -EINVAL;
+
+	// Load the fields first. If this fails, don't cache anything.
+	// NOTE: Metadata-only entries have an empty field list.
+	const RomFields emptyFields;
+	const RomFields *const fields = (likely(!metaDataOnly) ? romData->fields() : &emptyFields);
+	if (!fields)
+		return -EIO;
+
+	Private::Writer w(buf);
+	w.str(romData->className());
+	w.str(romData->mimeType());
+	w.u8(static_cast<uint8_t>(romData->fileType()));
+	w.u8(romData->hasDangerousPermissions());
+
+	// System names: Types 0-2, generic then ROM-local.
+	for (unsigned int i = 0; i < Private::SYSNAME_COUNT; i++) {
+		const unsigned int type = (i % 3) | ((i >= 3) ? RomData::SYSNAME_REGION_ROM_LOCAL : 0);
+		w.str(romData->systemName(type));
+	}
+
+	// Select the internal images to cache.
+	// - Icon, since it may be used for small thumbnails.
+	// - First available internal image in image type priority order.
+	// NOTE: Metadata-only entries don't have any images.
+	const uint32_t imgbf = (likely(!metaDataOnly) ? romData->supportedImageTypes() : 0);
+	array<rp_image_const_ptr, RomData::IMG_INT_MAX + 1> images;
+	if (imgbf & RomData::IMGBF_INT_ICON) {
+		images[RomData::IMG_INT_ICON] = romData->image(RomData::IMG_INT_ICON);
+	}
+
+	const Config *const config = Config::instance();
+	Config::ImgTypePrio_t imgTypePrio;
+	switch (config->getImgTypePrio(romData->className(), &imgTypePrio)) {
+		case Config::ImgTypeResult::Success:
+		case Config::ImgTypeResult::SuccessDefaults:
+			for (unsigned int i = 0; i < imgTypePrio.length; i++) {
+				const uint8_t imgType = imgTypePrio.imgTypes[i];
+				if (imgType > RomData::IMG_INT_MAX || !(imgbf & (1U << imgType)))
+					continue;
+
+				if (!images[imgType]) {
+					images[imgType] = romData->image(static_cast<RomData::ImageType>(imgType));
+				}
+				if (images[imgType]) {
+					// Found an internal image.
+					break;
+				}
+			}
+			break;
+
+		default:
+			// Thumbnails are disabled for this class.
+			break;
+	}
+
+	// Supported image types: external image types, plus
+	// the internal images that were actually loaded.
+	uint32_t cached_imgbf = imgbf & ~((1U << (RomData::IMG_INT_MAX + 1)) - 1);
+	for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_INT_MAX; i++) {
+		if (images[i]) {
+			cached_imgbf |= (1U << i);
+		}
+	}
+	w.u32(cached_imgbf);
+	for (int i = 0; i <= RomData::IMG_EXT_MAX; i++) {
+		w.u32((imgbf & (1U << i)) ? romData->imgpf(static_cast<RomData::ImageType>(i)) : 0);
+	}
+	for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_INT_MAX; i++) {
+		if (cached_imgbf & (1U << i)) {
+			int ret = w.image(images[i]);
+			if (ret != 0)
+				return ret;
+		}
+	}
+
+	// External image URLs
+	// One URL list is cached for each image size. The URLs for a given
+	// size are retrieved by requesting the size's largest dimension.
+	vector<RomData::ExtURL> extURLs;
+	for (int i = RomData::IMG_EXT_MIN; i <= RomData::IMG_EXT_MAX; i++) {
+		if (!(cached_imgbf & (1U << i)))
+			continue;
+
+		const RomData::ImageType imageType = static_cast<RomData::ImageType>(i);
+		const vector<RomData::ImageSizeDef> sizeDefs = romData->supportedImageSizes(imageType);
+		w.u32(static_cast<uint32_t>(sizeDefs.size()));
+		for (const RomData::ImageSizeDef &sizeDef : sizeDefs) {
+			w.str(sizeDef.name);
+			w.u16(sizeDef.width);
+			w.u16(sizeDef.height);
+			w.u16(sizeDef.index);
+		}
+
+		if (sizeDefs.empty()) {
+			extURLs.clear();
+			romData->extURLs(imageType, &extURLs, RomData::IMAGE_SIZE_DEFAULT);
+			Private::writeExtURLs(w, extURLs);
+			continue;
+		}
+
+		for (size_t j = 0; j < sizeDefs.size(); j++) {
+			const int size = std::max(sizeDefs[j].width, sizeDefs[j].height);
+			extURLs.clear();
+			romData->extURLs(imageType, &extURLs,
+				(j == 0 || size == 0) ? static_cast<int>(RomData::IMAGE_SIZE_DEFAULT) : size);
+			Private::writeExtURLs(w, extURLs);
+		}
+	}
+
+	// Fields
+	int ret = Private::writeFields(w, fields);
+	if (ret != 0)
+		return ret;
+
+	// Metadata
+	Private::writeMetaData(w, romData->metaData());
+	return 0;
+}
+
+/**
+ * Deserialize a RomData object.
+ * @param filename	[in,opt] ROM filename (UTF-8) for RomData::filename()
+ * @param buf		[in] Serialized RomData object
+ * @param size		[in] Size of buf
+ * @return Cached RomData object, or nullptr on error.
+ */
+RomDataPtr deserialize(const char *filename, const uint8_t *buf, size_t size)
+{
+	assert(buf != nullptr);
+	if (!buf || size == 0)
+		return nullptr;
+
+	Private::Reader r(buf, size);
+	Private::CachedRomData *const romData = new Private::CachedRomData();
+	if (romData->load(filename, r) != 0) {
+		delete romData;
+		return nullptr;
+	}
+	return RomDataPtr(romData);
+}
+
+} }
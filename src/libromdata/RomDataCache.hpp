@@ -0,0 +1,137 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * RomDataCache.hpp: Persistent RomData cache.                             *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "common.h"
+#include "dll-macros.h"
+
+// Other rom-properties libraries
+#include "librpbase/RomData.hpp"
+
+// C includes
+#include <stdint.h>
+
+// C++ includes
+#include <vector>
+
+namespace LibRomData { namespace RomDataCache {
+
+/**
+ * The RomData cache stores the fields, metadata, thumbnail images,
+ * and external image URLs of parsed ROM images in the user's cache
+ * directory, so the ROM image doesn't need to be opened again if
+ * it hasn't changed.
+ *
+ * Cache entries are keyed by device and inode number, and are only
+ * valid if the file size and mtime haven't changed.
+ *
+ * NOTE: Cached RomData objects do not have an open file, so ROM
+ * operations, mipmaps, and animated icons are not available.
+ * Only use the cache for thumbnailing and metadata extraction.
+ * Metadata-only entries (RDA_METADATA_ONLY) don't have fields or images.
+ *
+ * NOTE 2: The cache is currently only supported on Unix-like systems.
+ */
+
+/**
+ * Cache statistics.
+ * These are tracked for the current process only.
+ */
+struct Stats {
+	uint32_t hits;		// Number of cache hits
+	uint32_t misses;	// Number of cache misses
+	uint32_t stores;	// Number of entries written
+	uint32_t evictions;	// Number of entries evicted
+	uint32_t errors;	// Number of read/write errors
+};
+
+/**
+ * Look up a ROM image in the RomData cache.
+ * The ROM image will not be opened.
+ * @param filename ROM filename (UTF-8)
+ * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @return Cached RomData object, or nullptr if not cached.
+ */
+RP_LIBROMDATA_PUBLIC
+LibRpBase::RomDataPtr lookup(const char *filename, unsigned int attrs = 0);
+
+/**
+ * Store a RomData object in the RomData cache.
+ *
+ * Field data, metadata, and thumbnail images will be loaded
+ * from the RomData object if they haven't been loaded yet.
+ * If attrs has RDA_METADATA_ONLY, only metadata will be stored.
+ *
+ * @param filename ROM filename (UTF-8)
+ * @param romData RomData object
+ * @param attrs RomDataAttr bitfield for the RomData subclass.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+RP_LIBROMDATA_PUBLIC
+int store(const char *filename, const LibRpBase::RomDataPtr &romData, unsigned int attrs);
+
+/**
+ * Get the cache statistics.
+ * @param pStats	[out] Cache statistics
+ */
+RP_LIBROMDATA_PUBLIC
+void getStats(Stats *pStats);
+
+/**
+ * Reset the cache statistics.
+ */
+RP_LIBROMDATA_PUBLIC
+void resetStats(void);
+
+/**
+ * Default maximum cache size, in bytes.
+ */
+static constexpr off64_t DEFAULT_MAX_SIZE = 64*1024*1024;
+
+/**
+ * Set the maximum cache size.
+ *
+ * If the total size of all cache entries exceeds this value,
+ * the least-recently used entries will be evicted.
+ *
+ * @param maxSize Maximum cache size, in bytes.
+ */
+RP_LIBROMDATA_PUBLIC
+void setMaxSize(off64_t maxSize);
+
+/** Serialization functions. (used by the test suite) **/
+
+/**
+ * Serialize a RomData object.
+ *
+ * This only serializes the RomData object itself.
+ * The cache entry header is not included.
+ *
+ * If metaDataOnly is true, fields and images are not loaded,
+ * and the deserialized RomData object will only have metadata.
+ *
+ * @param romData	[in] RomData object
+ * @param buf		[out] Output buffer
+ * @param metaDataOnly	[in] If true, only serialize metadata.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+RP_LIBROMDATA_PUBLIC
+int serialize(const LibRpBase::RomDataPtr &romData, std::vector<uint8_t> &buf, bool metaDataOnly = false);
+
+/**
+ * Deserialize a RomData object.
+ * @param filename	[in,opt] ROM filename (UTF-8) for RomData::filename()
+ * @param buf		[in] Serialized RomData object
+ * @param size		[in] Size of buf
+ * @return Cached RomData object, or nullptr on error.
+ */
+RP_LIBROMDATA_PUBLIC
+LibRpBase::RomDataPtr deserialize(const char *filename, const uint8_t *buf, size_t size);
+
+} }
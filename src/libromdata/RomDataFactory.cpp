@@ -11,6 +11,7 @@
 #include "libromdata/config.libromdata.h"
 
 #include "RomDataFactory.hpp"
+#include "RomDataCache.hpp"
 #include "RomData_p.hpp"	// for RomDataInfo
 
 // librpbase, librpfile
@@ -352,6 +353,118 @@ static const RomDataFns *const romDataFns_tbl[] = {
 	nullptr
 };
 
+/** Detection index **/
+
+// Magic number index for romDataFns_magic[].
+// - Key: Address in the high 32 bits; magic number in the low 32 bits.
+// - Value: Bitfield of romDataFns_magic[] indexes with this address and magic.
+// Iterating over the bits from LSB to MSB preserves the table order.
+typedef uint64_t magic_idx_bitfield_t;
+static_assert(ARRAY_SIZE(romDataFns_magic) - 1 <= sizeof(magic_idx_bitfield_t) * 8,
+	"romDataFns_magic[] has too many entries for magic_idx_bitfield_t");
+std::unordered_map<uint64_t, magic_idx_bitfield_t> map_magic;
+
+// All addresses used in romDataFns_magic[], sorted and deduplicated.
+vector<uint32_t> vec_magic_addrs;
+
+// File extension bucket flags for RomData subclasses without magic numbers.
+enum ExtBucket : uint8_t {
+	// File extension might have a header at a non-zero address.
+	EXT_BUCKET_HEADER_ADDR	= (1U << 0),
+	// File extension might have a footer.
+	EXT_BUCKET_FOOTER	= (1U << 1),
+};
+
+// File extensions for romDataFns_header[] entries with non-zero addresses.
+// TODO: Don't hard-code this.
+// Use a pointer to supportedFileExtensions_static() instead?
+static constexpr char exts_header_addr[][8] = {
+	".bin",		// generic .bin
+	".sms",		// Sega Master System
+	".gg",		// Game Gear
+	".tgc",		// game.com
+	".iso",		// ISO-9660
+	".img",		// CCD/IMG
+	".xiso",	// Xbox disc image
+	".min",		// Pokémon Mini
+};
+
+// File extensions for romDataFns_footer[] entries.
+// FIXME: Instead of hard-coded, check romDataInfo()->exts.
+static constexpr char exts_footer[][8] = {
+	".vb",		// VirtualBoy
+	".ws",		// WonderSwan
+	".wsc",		// WonderSwan Color
+	".pc2",		// Pocket Challenge v2 (WS-compatible)
+};
+
+// File extension buckets.
+// - Key: Lowercase file extension, including the leading dot.
+// - Value: ExtBucket bitfield.
+std::unordered_map<string, uint8_t> map_ext_buckets;
+
+pthread_once_t once_detection_index = PTHREAD_ONCE_INIT;
+
+/**
+ * Initialize the detection index.
+ *
+ * Internal function; must be called using pthread_once().
+ */
+static void init_detection_index(void)
+{
+	static constexpr size_t magic_count = ARRAY_SIZE(romDataFns_magic) - 1;
+#ifdef HAVE_UNORDERED_MAP_RESERVE
+	map_magic.reserve(magic_count);
+#endif /* HAVE_UNORDERED_MAP_RESERVE */
+
+	for (size_t i = 0; i < magic_count; i++) {
+		const RomDataFns *const fns = &romDataFns_magic[i];
+		const uint64_t key = (static_cast<uint64_t>(fns->address) << 32) | fns->size;
+		map_magic[key] |= (static_cast<magic_idx_bitfield_t>(1) << i);
+		vec_magic_addrs.push_back(fns->address);
+	}
+
+	std::sort(vec_magic_addrs.begin(), vec_magic_addrs.end());
+	vec_magic_addrs.erase(std::unique(vec_magic_addrs.begin(), vec_magic_addrs.end()), vec_magic_addrs.end());
+
+	// File extension buckets
+	for (const char *ext : exts_header_addr) {
+		map_ext_buckets[ext] |= EXT_BUCKET_HEADER_ADDR;
+	}
+	for (const char *ext : exts_footer) {
+		map_ext_buckets[ext] |= EXT_BUCKET_FOOTER;
+	}
+}
+
+/**
+ * Get the file extension buckets for the specified file extension.
+ * init_detection_index() must have been called first.
+ * @param ext File extension, including the leading dot. (May be nullptr.)
+ * @return ExtBucket bitfield.
+ */
+static uint8_t getExtBuckets(const char *ext)
+{
+	if (!ext || ext[0] == '\0') {
+		return 0;
+	}
+
+	// Lowercase the extension for the lookup.
+	// None of the indexed extensions are longer than 7 characters.
+	char ext_lc[8];
+	size_t i;
+	for (i = 0; i < sizeof(ext_lc) - 1 && ext[i] != '\0'; i++) {
+		ext_lc[i] = TOLOWER(ext[i]);
+	}
+	if (ext[i] != '\0') {
+		// Extension is too long.
+		return 0;
+	}
+	ext_lc[i] = '\0';
+
+	auto iter = map_ext_buckets.find(ext_lc);
+	return (iter != map_ext_buckets.end()) ? iter->second : 0;
+}
+
 /** IDiscReader / SparseDiscReader check arrays and functions **/
 
 typedef int (*pfnIsDiscSupported)(const uint8_t *pHeader, size_t szHeader);
@@ -671,6 +784,30 @@ RomData *checkISO(const IRpFilePtr &file)
 	return nullptr;
 }
 
+/**
+ * Get the RomDataAttr bitfield for a RomData subclass.
+ * @param className RomData subclass name
+ * @return RomDataAttr bitfield, or 0 if the class isn't in the detection tables.
+ */
+static unsigned int getClassAttrs(const char *className)
+{
+	if (!className)
+		return 0;
+
+	// RpTextureWrapper isn't in the detection tables.
+	if (!strcmp(className, RpTextureWrapper::romDataInfo()->className))
+		return ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA;
+
+	for (const RomDataFns *const *tblptr = &romDataFns_tbl[0]; *tblptr != nullptr; tblptr++) {
+		for (const RomDataFns *fns = *tblptr; fns->romDataInfo != nullptr; fns++) {
+			if (!strcmp(className, fns->romDataInfo()->className))
+				return fns->attrs;
+		}
+	}
+
+	return 0;
+}
+
 } // namespace Private
 
 /** RomDataFactory **/
@@ -692,6 +829,13 @@ RomData *checkISO(const IRpFilePtr &file)
  */
 RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 {
+	// The RomData cache is only supported for filenames.
+	attrs &= ~RDA_USE_CACHE;
+	if (attrs & RDA_METADATA_ONLY) {
+		// Metadata-only: Skip subclasses that don't have metadata.
+		attrs = (attrs & ~RDA_METADATA_ONLY) | ATTR_HAS_METADATA;
+	}
+
 	RomData::DetectInfo info;
 
 	// Get the file size.
@@ -764,37 +908,59 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 
 	// Check RomData subclasses that take a header at 0
 	// and definitely have a 32-bit magic number in the header.
-	const Private::RomDataFns *fns = &Private::romDataFns_magic[0];
-	for (; fns->romDataInfo != nullptr; fns++) {
+	// The detection index maps each (address, magic) pair to
+	// the matching romDataFns_magic[] entries, so only those
+	// entries need to be checked.
+	pthread_once(&Private::once_detection_index, Private::init_detection_index);
+	Private::magic_idx_bitfield_t magic_idx = 0;
+	for (const uint32_t address : Private::vec_magic_addrs) {
+		// TODO: Verify alignment restrictions.
+		assert(address % 4 == 0);
+		assert(address + sizeof(uint32_t) <= sizeof(header.u32));
+		if (address + sizeof(uint32_t) > info.header.size) {
+			// Header is too small. (Addresses are sorted.)
+			break;
+		}
+
+		const uint32_t magic = be32_to_cpu(header.u32[address/4]);
+		auto iter = Private::map_magic.find((static_cast<uint64_t>(address) << 32) | magic);
+		if (iter != Private::map_magic.end()) {
+			magic_idx |= iter->second;
+		}
+	}
+
+	const Private::RomDataFns *fns;
+	for (unsigned int i = 0; magic_idx != 0; i++, magic_idx >>= 1) {
+		if (!(magic_idx & 1))
+			continue;
+
+		// Found a matching magic number.
+		fns = &Private::romDataFns_magic[i];
 		if ((fns->attrs & attrs) != attrs) {
 			// This RomData subclass doesn't have the
 			// required attributes.
 			continue;
 		}
 
-		// Check the magic number.
-		// TODO: Verify alignment restrictions.
-		assert(fns->address % 4 == 0);
-		assert(fns->address + sizeof(uint32_t) <= sizeof(header.u32));
-		const uint32_t magic = be32_to_cpu(header.u32[fns->address/4]);
-		if (magic == fns->size) {
-			// Found a matching magic number.
-			if (fns->isRomSupported(&info) >= 0) {
-				RomData *const romData = fns->newRomData(reader);
-				if (romData->isValid()) {
-					// RomData subclass obtained.
-					return RomDataPtr(romData);
-				}
-
-				// Not actually supported.
-				delete romData;
+		if (fns->isRomSupported(&info) >= 0) {
+			RomData *const romData = fns->newRomData(reader);
+			if (romData->isValid()) {
+				// RomData subclass obtained.
+				return RomDataPtr(romData);
 			}
+
+			// Not actually supported.
+			delete romData;
 		}
 	}
 
 	// Check for supported textures.
+	// FileFormatFactory::isTextureSupported() only checks the
+	// header, so we don't have to construct an RpTextureWrapper
+	// for files that definitely aren't textures.
+	if (!reader->isDevice() &&
+	    FileFormatFactory::isTextureSupported(header.u8, info.header.size, reader->filename()))
 	{
-		// TODO: RpTextureWrapper::isRomSupported()?
 		RomData *const romData = new RpTextureWrapper(reader);
 		if (romData->isValid()) {
 			// RomData subclass obtained.
@@ -805,6 +971,10 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 		delete romData;
 	}
 
+	// File extension buckets for RomData subclasses that don't
+	// have magic numbers at address 0.
+	const uint8_t ext_buckets = Private::getExtBuckets(info.ext);
+
 	// Check other RomData subclasses that take a header,
 	// but don't have a simple 32-bit magic number check.
 	fns = &Private::romDataFns_header[0];
@@ -823,33 +993,7 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 			if (!checked_exts) {
 				// Check the file extension to reduce overhead
 				// for file types that don't use this.
-				// TODO: Don't hard-code this.
-				// Use a pointer to supportedFileExtensions_static() instead?
-				static constexpr char exts[][8] = {
-					".bin",		// generic .bin
-					".sms",		// Sega Master System
-					".gg",		// Game Gear
-					".tgc",		// game.com
-					".iso",		// ISO-9660
-					".img",		// CCD/IMG
-					".xiso",	// Xbox disc image
-					".min",		// Pokémon Mini
-				};
-
-				if (info.ext == nullptr) {
-					// No file extension...
-					break;
-				}
-
-				// Check for a matching extension.
-				bool found = false;
-				for (const char *ext : exts) {
-					if (!strcasecmp(info.ext, ext)) {
-						// Found a match!
-						found = true;
-					}
-				}
-				if (!found) {
+				if (!(ext_buckets & Private::EXT_BUCKET_HEADER_ADDR)) {
 					// No match.
 					break;
 				}
@@ -910,65 +1054,41 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 		return nullptr;
 	}
 
-	bool readFooter = false;
-	fns = &Private::romDataFns_footer[0];
-	for (; fns->romDataInfo != nullptr; fns++) {
-		if ((fns->attrs & attrs) != attrs) {
-			// This RomData subclass doesn't have the
-			// required attributes.
-			continue;
-		}
-
-		// Do we have a matching extension?
-		// FIXME: Instead of hard-coded, check romDataInfo()->exts.
-		static constexpr char exts[][8] = {
-			".vb",		// VirtualBoy
-			".ws",		// WonderSwan
-			".wsc",		// WonderSwan Color
-			".pc2",		// Pocket Challenge v2 (WS-compatible)
-		};
-
-		if (info.ext == nullptr) {
-			// No file extension...
-			break;
-		}
-
-		// Check for a matching extension.
-		bool found = false;
-		for (const char *ext : exts) {
-			if (!strcasecmp(info.ext, ext)) {
-				// Found a match!
-				found = true;
+	// Do we have a matching extension?
+	if (ext_buckets & Private::EXT_BUCKET_FOOTER) {
+		bool readFooter = false;
+		fns = &Private::romDataFns_footer[0];
+		for (; fns->romDataInfo != nullptr; fns++) {
+			if ((fns->attrs & attrs) != attrs) {
+				// This RomData subclass doesn't have the
+				// required attributes.
+				continue;
 			}
-		}
-		if (!found) {
-			// No match.
-			break;
-		}
 
-		// Make sure we've read the footer.
-		if (!readFooter) {
-			static constexpr int footer_size = 1024;
-			if (info.szFile > footer_size) {
-				info.header.addr = static_cast<uint32_t>(info.szFile - footer_size);
-				info.header.size = static_cast<uint32_t>(reader->seekAndRead(info.header.addr, header.u8, footer_size));
-				if (info.header.size == 0) {
-					// Seek and/or read error.
-					return nullptr;
+			// Make sure we've read the footer.
+			if (!readFooter) {
+				static constexpr int footer_size = 1024;
+				if (info.szFile > footer_size) {
+					info.header.addr = static_cast<uint32_t>(info.szFile - footer_size);
+					info.header.size = static_cast<uint32_t>(reader->seekAndRead(info.header.addr, header.u8, footer_size));
+					if (info.header.size == 0) {
+						// Seek and/or read error.
+						return nullptr;
+					}
 				}
+				readFooter = true;
 			}
-			readFooter = true;
-		}
 
-		if (fns->isRomSupported(&info) >= 0) {
-			RomData *const romData = fns->newRomData(reader);
-			if (romData->isValid()) {
-				// RomData subclass obtained.
-				return RomDataPtr(romData);
-			}
+			if (fns->isRomSupported(&info) >= 0) {
+				RomData *const romData = fns->newRomData(reader);
+				if (romData->isValid()) {
+					// RomData subclass obtained.
+					return RomDataPtr(romData);
+				}
 
-			// Not actually supported.
-			delete romData;
+				// Not actually supported.
+				delete romData;
+			}
 		}
 	}
 
@@ -1059,7 +1179,29 @@ static RomDataPtr T_create(const CharType *filename, unsigned int attrs)
  */
 RomDataPtr create(const char *filename, unsigned int attrs)
 {
-	return T_create(filename, attrs);
+	if (!(attrs & RDA_USE_CACHE)) {
+		return T_create(filename, attrs);
+	}
+	attrs &= ~RDA_USE_CACHE;
+	if (attrs & RDA_METADATA_ONLY) {
+		// Metadata-only cache entries are stored separately,
+		// but only for subclasses that have metadata.
+		attrs |= ATTR_HAS_METADATA;
+	}
+
+	// Check the RomData cache first.
+	RomDataPtr romData = RomDataCache::lookup(filename, attrs);
+	if (romData) {
+		return romData;
+	}
+
+	romData = T_create(filename, attrs);
+	if (romData) {
+		// Store the RomData object in the cache.
+		// NOTE: Errors are ignored here.
+		RomDataCache::store(filename, romData, attrs | Private::getClassAttrs(romData->className()));
+	}
+	return romData;
 }
 
 #ifdef _WIN32
@@ -1084,7 +1226,9 @@ RomDataPtr create(const char *filename, unsigned int attrs)
  */
 RomDataPtr create(const wchar_t *filename, unsigned int attrs)
 {
-	return T_create(filename, attrs);
+	// NOTE: The RomData cache is keyed by device and inode numbers,
+	// which aren't available from _wstat64(), so RDA_USE_CACHE is ignored.
+	return T_create(filename, attrs & ~RDA_USE_CACHE);
 }
 #endif /* _WIN32 */
 
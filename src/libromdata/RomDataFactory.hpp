@@ -53,6 +53,18 @@ enum RomDataAttr {
 	// Check for game-specific disc file systems.
 	// (For internal RomDataFactory use only.)
 	RDA_CHECK_ISO		= (1U << 8),
+
+	// Use the persistent RomData cache. (See RomDataCache.hpp.)
+	// Only supported by create(const char*).
+	// NOTE: Cached RomData objects do not have an open file,
+	// so only use this for thumbnailing and metadata extraction.
+	RDA_USE_CACHE		= (1U << 9),
+
+	// Open the file for metadata extraction only. (Implies RDA_HAS_METADATA.)
+	// Fields, images, and ROM operations might not be available
+	// in the returned RomData object. If used with RDA_USE_CACHE,
+	// the cache entry only contains metadata.
+	RDA_METADATA_ONLY	= (1U << 10),
 };
 
 /**
@@ -137,6 +137,37 @@ int Cdrom2352Reader::isDiscSupported(const uint8_t *pHeader, size_t szHeader) co
 	return isDiscSupported_static(pHeader, szHeader);
 }
 
+/**
+ * Announce that a range of the disc image will be read soon.
+ * The disc image position is not changed.
+ * @param pos	[in] Starting position
+ * @param size	[in] Size of the range, in bytes
+ * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+ */
+int Cdrom2352Reader::prefetch(off64_t pos, off64_t size)
+{
+	RP_D(const Cdrom2352Reader);
+	if (!m_file || d->disc_size <= 0 || d->block_size == 0) {
+		// Disc image wasn't initialized properly.
+		return -EBADF;
+	} else if (pos < 0 || size < 0) {
+		return -EINVAL;
+	} else if (size == 0 || pos >= d->disc_size) {
+		// Nothing to prefetch.
+		return 0;
+	}
+
+	if (size > d->disc_size - pos) {
+		size = d->disc_size - pos;
+	}
+
+	// Physical sectors are stored contiguously.
+	const off64_t blockStart = pos / d->block_size;
+	const off64_t blockEnd = (pos + size - 1) / d->block_size;
+	return m_file->prefetch(blockStart * d->physBlockSize,
+		(blockEnd - blockStart + 1) * d->physBlockSize);
+}
+
 /** SparseDiscReader functions **/
 
 /**
@@ -68,6 +68,16 @@ public:
 	 */
 	int isDiscSupported(const uint8_t *pHeader, size_t szHeader) const final;
 
+public:
+	/**
+	 * Announce that a range of the disc image will be read soon.
+	 * The disc image position is not changed.
+	 * @param pos	[in] Starting position
+	 * @param size	[in] Size of the range, in bytes
+	 * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+	 */
+	int prefetch(off64_t pos, off64_t size) final;
+
 protected:
 	/** SparseDiscReader functions **/
 
@@ -94,12 +94,8 @@ public:
 	// - v2: If set, block is compressed using LZ4; otherwise, deflate.
 	rp::uvector<uint32_t> indexEntries;
 
-	// Block cache
-	rp::uvector<uint8_t> blockCache;
-	uint32_t blockCacheIdx;
-
 	// Decompression buffer
-	// (Same size as blockCache.)
+	// (Same size as a block cache entry.)
 	rp::uvector<uint8_t> z_buffer;
 
 	// DAX: Size and NC area tables
@@ -122,7 +118,6 @@ public:
 CisoPspReaderPrivate::CisoPspReaderPrivate(CisoPspReader *q)
 	: super(q)
 	, cisoType(CisoType::Unknown)
-	, blockCacheIdx(~0U)
 	, index_shift(0)
 	, isDaxWithoutNCTable(false)
 {
@@ -479,9 +474,8 @@ CisoPspReader::CisoPspReader(const IRpFilePtr &file)
 		// more space than uncompressed.
 		cache_size *= 2;
 	}
-	d->blockCache.resize(cache_size);
+	d->initBlockCache(cache_size);
 	d->z_buffer.resize(cache_size);
-	d->blockCacheIdx = ~0U;
 
 	// Reset the disc position.
 	d->pos = 0;
@@ -748,9 +742,10 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 		return 0;
 	}
 
-	if (blockIdx == d->blockCacheIdx) {
+	const uint8_t *const pCachedBlock = d->getCachedBlock(blockIdx);
+	if (pCachedBlock) {
 		// Block is cached.
-		memcpy(ptr, &d->blockCache[pos], size);
+		memcpy(ptr, &pCachedBlock[pos], size);
 		return static_cast<int>(size);
 	}
 
@@ -891,6 +886,7 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 			break;
 	}
 
+	uint8_t *pBlock = nullptr;
 	switch (z_mode) {
 		default:
 			assert(!"Compression mode not supported...");
@@ -899,17 +895,17 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 
 		case CompressionMode::None: {
 			// Reading uncompressed data directly into the cache.
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->blockCache.data(), z_block_size);
+			pBlock = d->allocCachedBlock(blockIdx);
+			size_t sz_read = m_file->seekAndRead(physBlockAddr, pBlock, z_block_size);
 			if (sz_read != z_block_size) {
 				// Seek and/or read error.
-				d->blockCacheIdx = ~0U;
+				d->invalidateCachedBlock(blockIdx);
 				m_lastError = m_file->lastError();
 				if (m_lastError == 0) {
 					m_lastError = EIO;
 				}
 				return 0;
 			}
-			d->blockCacheIdx = blockIdx;
 			break;
 		}
 
@@ -933,21 +929,27 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 				return 0;
 			}
 
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
+			// If the file is memory-mapped, decompress directly from the mapping.
+			const uint8_t *z_data = m_file->view(physBlockAddr, z_block_size);
+			if (!z_data) {
+				size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
+				if (sz_read != z_block_size) {
+					// Seek and/or read error.
+					m_lastError = m_file->lastError();
+					if (m_lastError == 0) {
+						m_lastError = EIO;
+					}
+					return 0;
 				}
-				return 0;
+				z_data = d->z_buffer.data();
 			}
 
 			// Decompress the data.
+			pBlock = d->allocCachedBlock(blockIdx);
 			z_stream strm = { };
-			strm.next_in = d->z_buffer.data();
+			strm.next_in = const_cast<Bytef*>(z_data);
 			strm.avail_in = z_block_size;
-			strm.next_out = d->blockCache.data();
+			strm.next_out = pBlock;
 			strm.avail_out = d->block_size;
 			inflateInit2(&strm, windowBits);
 
@@ -958,7 +960,7 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 			if (status != Z_STREAM_END || uncomp_size != d->block_size) {
 				// Decompression error.
 				// TODO: Print warnings and/or more comprehensive error codes.
-				d->blockCacheIdx = ~0U;
+				d->invalidateCachedBlock(blockIdx);
 				m_lastError = EIO;
 				return 0;
 			}
@@ -982,25 +984,31 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 				return 0;
 			}
 
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
+			// If the file is memory-mapped, decompress directly from the mapping.
+			const uint8_t *z_data = m_file->view(physBlockAddr, z_block_size);
+			if (!z_data) {
+				size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
+				if (sz_read != z_block_size) {
+					// Seek and/or read error.
+					m_lastError = m_file->lastError();
+					if (m_lastError == 0) {
+						m_lastError = EIO;
+					}
+					return 0;
 				}
-				return 0;
+				z_data = d->z_buffer.data();
 			}
 
 			// Decompress the data.
+			pBlock = d->allocCachedBlock(blockIdx);
 			int sz_rd = LZ4_decompress_safe(
-				reinterpret_cast<const char*>(d->z_buffer.data()),
-				reinterpret_cast<char*>(d->blockCache.data()),
+				reinterpret_cast<const char*>(z_data),
+				reinterpret_cast<char*>(pBlock),
 				z_block_size, d->block_size);
 			if (sz_rd != (int)d->block_size) {
 				// Decompression error.
 				// TODO: Print warnings and/or more comprehensive error codes.
-				d->blockCacheIdx = ~0U;
+				d->invalidateCachedBlock(blockIdx);
 				m_lastError = EIO;
 				return 0;
 			}
@@ -1030,27 +1038,33 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 				return 0;
 			}
 
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
+			// If the file is memory-mapped, decompress directly from the mapping.
+			const uint8_t *z_data = m_file->view(physBlockAddr, z_block_size);
+			if (!z_data) {
+				size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
+				if (sz_read != z_block_size) {
+					// Seek and/or read error.
+					m_lastError = m_file->lastError();
+					if (m_lastError == 0) {
+						m_lastError = EIO;
+					}
+					return 0;
 				}
-				return 0;
+				z_data = d->z_buffer.data();
 			}
 
 			// Decompress the data.
 			// TODO: LZO in-place decompression?
 			lzo_uint dst_len = d->block_size;
+			pBlock = d->allocCachedBlock(blockIdx);
 			int ret = lzo1x_decompress_safe(
-				d->z_buffer.data(), z_block_size,
-				d->blockCache.data(), &dst_len,
+				z_data, z_block_size,
+				pBlock, &dst_len,
 				nullptr);
 			if (ret != LZO_E_OK || dst_len != d->block_size) {
 				// Decompression error.
 				// TODO: Print warnings and/or more comprehensive error codes.
-				d->blockCacheIdx = ~0U;
+				d->invalidateCachedBlock(blockIdx);
 				m_lastError = EIO;
 				return 0;
 			}
@@ -1064,8 +1078,8 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 	}
 
 	// Block has been loaded into the cache.
-	memcpy(ptr, &d->blockCache[pos], size);
-	d->blockCacheIdx = blockIdx;
+	assert(pBlock != nullptr);
+	memcpy(ptr, &pBlock[pos], size);
 	return static_cast<int>(size);
 }
 
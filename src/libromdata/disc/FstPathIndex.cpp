@@ -0,0 +1,200 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * FstPathIndex.cpp: Case-folded path index for FST parsers.               *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "librpbase/config.librpbase.h"
+
+#include "FstPathIndex.hpp"
+
+// C++ STL classes
+using std::string;
+using std::vector;
+
+namespace LibRomData {
+
+FstPathIndex::FstPathIndex()
+	: state(State::NotBuilt)
+	, lookupCount(0)
+{ }
+
+/**
+ * Normalize a path for the path index.
+ * Leading, trailing, and repeated slashes are removed.
+ * @param path Path
+ * @return Normalized path (empty for the root directory)
+ */
+string FstPathIndex::normalize_path(const char *path)
+{
+	string s_path;
+	for (const char *p = path; *p != '\0'; p++) {
+		if (*p == '/') {
+			if (s_path.empty() || s_path[s_path.size()-1] == '/') {
+				// Leading or repeated slash.
+				continue;
+			}
+		}
+		s_path += *p;
+	}
+
+	// Remove the trailing slash.
+	if (!s_path.empty() && s_path[s_path.size()-1] == '/') {
+		s_path.resize(s_path.size()-1);
+	}
+	return s_path;
+}
+
+/**
+ * Fold ASCII letters in a path to lowercase.
+ * Non-ASCII characters are left as-is.
+ * @param s_path Path
+ */
+inline void FstPathIndex::fold_path_case(string &s_path)
+{
+	for (char &c : s_path) {
+		if (c >= 'A' && c <= 'Z') {
+			c |= 0x20;
+		}
+	}
+}
+
+/**
+ * Build the path index.
+ * @param src FST entry accessor
+ * @return True on success; false if the FST is corrupted.
+ */
+bool FstPathIndex::build(const Source &src) const
+{
+	const uint32_t file_count = src.fst_entry_count();
+	parent_idx.assign(file_count, 0);
+#ifdef HAVE_UNORDERED_MAP_RESERVE
+	// NOTE: file_count includes the root directory entry.
+	path_index.reserve(file_count - 1);
+#endif
+
+	// Directory stack.
+	struct dir_t {
+		uint32_t end_idx;	// Index *after* the last entry in the directory
+		int idx;		// Directory index
+		size_t path_len;	// Length of the directory's path
+	};
+	vector<dir_t> dir_stack;
+	dir_stack.push_back({file_count, 0, 0});
+
+	string s_path;
+	for (uint32_t idx = 1; idx < file_count; idx++) {
+		// NOTE: The root directory is never popped, since
+		// its end_idx is file_count.
+		while (idx >= dir_stack.back().end_idx) {
+			dir_stack.pop_back();
+		}
+		const dir_t parent = dir_stack.back();
+
+		const char *const pName = src.fst_entry_name(idx);
+		if (!pName || pName[0] == '\0') {
+			// Empty or NULL name. This is invalid.
+			return false;
+		}
+
+		s_path.resize(parent.path_len);
+		if (!s_path.empty()) {
+			s_path += '/';
+		}
+		s_path += pName;
+		fold_path_case(s_path);
+		parent_idx[idx] = parent.idx;
+
+		auto ret = path_index.emplace(s_path, static_cast<int>(idx));
+		if (!ret.second) {
+			// Another entry has the same case-folded path.
+			ret.first->second = -1;
+		}
+
+		uint32_t next_idx;
+		if (src.fst_entry_is_dir(idx, &next_idx)) {
+			if (next_idx <= idx || next_idx > parent.end_idx) {
+				// Subdirectory is out of range.
+				return false;
+			}
+			dir_stack.push_back({next_idx, static_cast<int>(idx), s_path.size()});
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Find a path.
+ *
+ * NOTE: The root directory (empty normalized path) must be
+ * handled by the caller.
+ *
+ * @param src FST entry accessor
+ * @param s_path Normalized path (from normalize_path(); must not be empty)
+ * @return FST entry index, NOT_FOUND if not found, or USE_LINEAR if the FST has to be scanned.
+ */
+int FstPathIndex::find(const Source &src, const string &s_path) const
+{
+	assert(!s_path.empty());
+	if (s_path.empty()) {
+		return USE_LINEAR;
+	}
+
+	if (state == State::NotBuilt) {
+		if (lookupCount < MIN_LOOKUPS) {
+			// Not enough lookups to be worth building the index yet.
+			lookupCount++;
+			return USE_LINEAR;
+		}
+
+		// Build the path index.
+		if (build(src)) {
+			state = State::Built;
+		} else {
+			state = State::Failed;
+			path_index.clear();
+			parent_idx.clear();
+		}
+	}
+	if (state != State::Built) {
+		// Path index is not available.
+		return USE_LINEAR;
+	}
+
+	string s_key(s_path);
+	fold_path_case(s_key);
+	auto iter = path_index.find(s_key);
+	if (iter == path_index.end()) {
+		// Not found.
+		return NOT_FOUND;
+	}
+	if (iter->second < 0) {
+		// More than one entry has this case-folded path.
+		// Scan the FST to find the exact match.
+		return USE_LINEAR;
+	}
+
+	// The index is case-insensitive, but lookups are case-sensitive.
+	// Verify each path component from the entry up to the root.
+	size_t end_pos = s_path.size();
+	for (int idx = iter->second; idx > 0; idx = parent_idx[idx]) {
+		const size_t slash_pos = s_path.rfind('/', end_pos - 1);
+		const size_t name_pos = (slash_pos != string::npos) ? (slash_pos + 1) : 0;
+		const char *const pName = src.fst_entry_name(static_cast<uint32_t>(idx));
+		if (!pName || s_path.compare(name_pos, end_pos - name_pos, pName) != 0) {
+			// Case doesn't match.
+			return NOT_FOUND;
+		}
+		if (slash_pos == string::npos)
+			break;
+		end_pos = slash_pos;
+	}
+
+	return iter->second;
+}
+
+}
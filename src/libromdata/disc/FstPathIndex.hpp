@@ -0,0 +1,133 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * FstPathIndex.hpp: Case-folded path index for FST parsers.               *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "common.h"
+
+// C includes (C++ namespace)
+#include <cstdint>
+
+// C++ includes
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace LibRomData {
+
+/**
+ * Path index for FST parsers that store the directory tree
+ * as a flat array of entries, where each directory entry
+ * specifies the index *after* its last child entry.
+ * (GameCube/Wii and Wii U)
+ *
+ * The index is built once MIN_LOOKUPS lookups have been done,
+ * since most callers only look up one or two files.
+ */
+class FstPathIndex
+{
+public:
+	FstPathIndex();
+
+private:
+	RP_DISABLE_COPY(FstPathIndex)
+
+public:
+	/**
+	 * FST entry accessor.
+	 * Implemented by the FST parser's private class.
+	 */
+	class Source
+	{
+	protected:
+		Source() = default;
+		~Source() = default;
+
+	public:
+		/**
+		 * Get the total number of FST entries, including the root directory.
+		 * @return Number of FST entries
+		 */
+		virtual uint32_t fst_entry_count(void) const = 0;
+
+		/**
+		 * Get an FST entry's name for comparison purposes.
+		 * @param idx FST entry index (must be in range)
+		 * @return Name, or nullptr if an error occurred.
+		 */
+		virtual const char *fst_entry_name(uint32_t idx) const = 0;
+
+		/**
+		 * Check if an FST entry is a directory.
+		 * @param idx		[in] FST entry index (must be in range)
+		 * @param pEndIdx	[out] If a directory, index *after* the last entry in the directory.
+		 * @return True if this is a directory; false if it's a regular file.
+		 */
+		virtual bool fst_entry_is_dir(uint32_t idx, uint32_t *pEndIdx) const = 0;
+	};
+
+	// find() return values for paths that aren't indexed.
+	static constexpr int NOT_FOUND = -1;	// Path was not found
+	static constexpr int USE_LINEAR = -2;	// Index can't be used; scan the FST instead
+
+	/**
+	 * Normalize a path for the path index.
+	 * Leading, trailing, and repeated slashes are removed.
+	 * @param path Path
+	 * @return Normalized path (empty for the root directory)
+	 */
+	static std::string normalize_path(const char *path);
+
+	/**
+	 * Find a path.
+	 *
+	 * NOTE: The root directory (empty normalized path) must be
+	 * handled by the caller.
+	 *
+	 * @param src FST entry accessor
+	 * @param s_path Normalized path (from normalize_path(); must not be empty)
+	 * @return FST entry index, NOT_FOUND if not found, or USE_LINEAR if the FST has to be scanned.
+	 */
+	int find(const Source &src, const std::string &s_path) const;
+
+private:
+	/**
+	 * Fold ASCII letters in a path to lowercase.
+	 * Non-ASCII characters are left as-is.
+	 * @param s_path Path
+	 */
+	static inline void fold_path_case(std::string &s_path);
+
+	/**
+	 * Build the path index.
+	 * @param src FST entry accessor
+	 * @return True on success; false if the FST is corrupted.
+	 */
+	bool build(const Source &src) const;
+
+private:
+	// - Key: Full path without slashes at either end, with
+	//   ASCII letters folded to lowercase.
+	// - Value: FST entry index, or -1 if more than one entry
+	//   has the same case-folded path.
+	mutable std::unordered_map<std::string, int> path_index;
+	// Parent directory index for each FST entry.
+	// Used to verify the case of a path after an index lookup.
+	mutable std::vector<int> parent_idx;
+
+	enum class State : uint8_t {
+		NotBuilt,	// Not built yet
+		Built,		// Built successfully
+		Failed,		// FST is corrupted; scan the FST instead
+	};
+	mutable State state;
+	mutable unsigned int lookupCount;
+	static constexpr unsigned int MIN_LOOKUPS = 4;
+};
+
+}
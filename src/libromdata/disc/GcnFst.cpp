@@ -10,6 +10,7 @@
 #include "librpbase/config.librpbase.h"
 
 #include "GcnFst.hpp"
+#include "FstPathIndex.hpp"
 #include "../Console/gcn_structs.h"
 
 // Other rom-properties libraries
@@ -22,7 +23,7 @@ using std::unordered_map;
 
 namespace LibRomData {
 
-class GcnFstPrivate
+class GcnFstPrivate final : public FstPathIndex::Source
 {
 public:
 	GcnFstPrivate(const uint8_t *fstData, uint32_t len, uint8_t offsetShift);
@@ -49,6 +50,9 @@ public:
 	// - Value: string.
 	mutable unordered_map<uint32_t, string> u8_string_table;
 
+	// Path index for find_path().
+	FstPathIndex pathIndex;
+
 	/**
 	 * Check if an fst_entry is a directory.
 	 * @return True if this is a directory; false if it's a regular file.
@@ -62,6 +66,16 @@ public:
 	 */
 	inline const char *entry_name(const GCN_FST_Entry *fst_entry) const;
 
+	/**
+	 * Get an FST entry's name for comparison purposes.
+	 * ASCII names are returned directly from the string table,
+	 * since they're the same in cp1252, Shift-JIS, and UTF-8.
+	 * Other names are converted using entry_name().
+	 * @param fst_entry FST entry.
+	 * @return Name, or nullptr if an error occurred.
+	 */
+	inline const char *entry_name_fast(const GCN_FST_Entry *fst_entry) const;
+
 	/**
 	 * Get an FST entry.
 	 *
@@ -74,12 +88,56 @@ public:
 	 */
 	const GCN_FST_Entry *entry(int idx, const char **ppszName = nullptr) const;
 
+	/**
+	 * Find a path by scanning the FST.
+	 * This is used if the path index can't be used.
+	 * @param path Path. (Absolute paths only!)
+	 * @return fst_entry if found, or nullptr if not.
+	 */
+	const GCN_FST_Entry *find_path_linear(const char *path) const;
+
 	/**
 	 * Find a path.
 	 * @param path Path. (Absolute paths only!)
 	 * @return fst_entry if found, or nullptr if not.
 	 */
 	const GCN_FST_Entry *find_path(const char *path) const;
+
+	/** FstPathIndex::Source **/
+
+	/**
+	 * Get the total number of FST entries, including the root directory.
+	 * @return Number of FST entries
+	 */
+	uint32_t fst_entry_count(void) const final
+	{
+		return be32_to_cpu(fstData[0].root_dir.file_count);
+	}
+
+	/**
+	 * Get an FST entry's name for comparison purposes.
+	 * @param idx FST entry index (must be in range)
+	 * @return Name, or nullptr if an error occurred.
+	 */
+	const char *fst_entry_name(uint32_t idx) const final
+	{
+		return entry_name_fast(&fstData[idx]);
+	}
+
+	/**
+	 * Check if an FST entry is a directory.
+	 * @param idx		[in] FST entry index (must be in range)
+	 * @param pEndIdx	[out] If a directory, index *after* the last entry in the directory.
+	 * @return True if this is a directory; false if it's a regular file.
+	 */
+	bool fst_entry_is_dir(uint32_t idx, uint32_t *pEndIdx) const final
+	{
+		const GCN_FST_Entry *const fst_entry = &fstData[idx];
+		if (!is_dir(fst_entry))
+			return false;
+		*pEndIdx = be32_to_cpu(fst_entry->dir.next_offset);
+		return true;
+	}
 };
 
 /** GcnFstPrivate **/
@@ -191,6 +249,32 @@ inline const char *GcnFstPrivate::entry_name(const GCN_FST_Entry *fst_entry) con
 	return iter->second.c_str();
 }
 
+/**
+ * Get an FST entry's name for comparison purposes.
+ * ASCII names are returned directly from the string table,
+ * since they're the same in cp1252, Shift-JIS, and UTF-8.
+ * Other names are converted using entry_name().
+ * @param fst_entry FST entry.
+ * @return Name, or nullptr if an error occurred.
+ */
+inline const char *GcnFstPrivate::entry_name_fast(const GCN_FST_Entry *fst_entry) const
+{
+	const uint32_t offset = be32_to_cpu(fst_entry->file_type_name_offset) & 0xFFFFFF;
+	if (offset >= string_table_sz) {
+		// Out of range.
+		return nullptr;
+	}
+
+	const char *const str = &string_table_ptr[offset];
+	for (const char *p = str; *p != '\0'; p++) {
+		if (static_cast<uint8_t>(*p) >= 0x80) {
+			// Not ASCII.
+			return entry_name(fst_entry);
+		}
+	}
+	return str;
+}
+
 /**
  * Get an FST entry.
  *
@@ -228,11 +312,12 @@ const GCN_FST_Entry *GcnFstPrivate::entry(int idx, const char **ppszName) const
 }
 
 /**
- * Find a path.
+ * Find a path by scanning the FST.
+ * This is used if the path index can't be used.
  * @param path Path. (Absolute paths only!)
  * @return fst_entry if found, or nullptr if not.
  */
-const GCN_FST_Entry *GcnFstPrivate::find_path(const char *path) const
+const GCN_FST_Entry *GcnFstPrivate::find_path_linear(const char *path) const
 {
 	if (!path) {
 		// Invalid path.
@@ -315,12 +400,12 @@ const GCN_FST_Entry *GcnFstPrivate::find_path(const char *path) const
 			}
 			idx_already.insert(idx);
 
-			const char *pName;
-			fst_entry = this->entry(idx, &pName);
+			fst_entry = this->entry(idx);
 			if (!fst_entry) {
 				// Invalid path.
 				return nullptr;
 			}
+			const char *const pName = entry_name_fast(fst_entry);
 
 			// TODO: Is GCN/Wii case-sensitive?
 			if (pName && !strcmp(path_component.c_str(), pName)) {
@@ -363,6 +448,43 @@ const GCN_FST_Entry *GcnFstPrivate::find_path(const char *path) const
 	return fst_entry;
 }
 
+/**
+ * Find a path.
+ * @param path Path. (Absolute paths only!)
+ * @return fst_entry if found, or nullptr if not.
+ */
+const GCN_FST_Entry *GcnFstPrivate::find_path(const char *path) const
+{
+	if (!path) {
+		// Invalid path.
+		return nullptr;
+	}
+
+	// Get the root directory.
+	const GCN_FST_Entry *const root_entry = this->entry(0, nullptr);
+	if (!root_entry) {
+		// Can't find the root directory.
+		return nullptr;
+	}
+
+	const string s_path = FstPathIndex::normalize_path(path);
+	if (s_path.empty()) {
+		// Empty path or "/".
+		// Return the root directory.
+		return root_entry;
+	}
+
+	const int idx = pathIndex.find(*this, s_path);
+	if (idx == FstPathIndex::USE_LINEAR) {
+		// Path index is not available for this path.
+		return find_path_linear(path);
+	} else if (idx < 0) {
+		// Not found.
+		return nullptr;
+	}
+	return &fstData[idx];
+}
+
 /** GcnFst **/
 
 /**
@@ -127,6 +127,26 @@ off64_t GcnPartition::size(void)
 	return d->data_size;
 }
 
+/**
+ * Announce that a range of the partition will be read soon.
+ * The partition position is not changed.
+ * @param pos	[in] Starting position
+ * @param size	[in] Size of the range, in bytes
+ * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+ */
+int GcnPartition::prefetch(off64_t pos, off64_t size)
+{
+	RP_D(const GcnPartition);
+	if (!m_file || !m_file->isOpen()) {
+		return -EBADF;
+	} else if (pos < 0 || size < 0) {
+		return -EINVAL;
+	}
+
+	// GCN partitions are stored as-is.
+	return m_file->prefetch(d->data_offset + pos, size);
+}
+
 /** IPartition **/
 
 /**
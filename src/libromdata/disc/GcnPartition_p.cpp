@@ -58,6 +58,7 @@ int GcnPartitionPrivate::loadBootBlockAndInfo(void)
 	// Load the boot block and boot info.
 	// TODO: Consolidate into a single read?
 	RP_Q(GcnPartition);
+	q->prefetch(GCN_Boot_Block_ADDRESS, sizeof(bootBlock) + sizeof(bootInfo));
 	q->m_lastError = 0;
 	size_t size = q->seekAndRead(GCN_Boot_Block_ADDRESS, &bootBlock, sizeof(bootBlock));
 	if (size != sizeof(bootBlock)) {
@@ -140,8 +141,14 @@ int GcnPartitionPrivate::loadFst(void)
 		return -EIO;
 	}
 
+	// Announce the FST read, since Wii partitions read it
+	// one sector at a time.
+	const off64_t fst_offset = static_cast<off64_t>(bootBlock.fst_offset) << offsetShift;
+	const uint32_t fstData_len = bootBlock.fst_size << offsetShift;
+	q->prefetch(fst_offset, fstData_len);
+
 	// Seek to the beginning of the FST.
-	ret = q->seek(static_cast<off64_t>(bootBlock.fst_offset) << offsetShift);
+	ret = q->seek(fst_offset);
 	if (ret != 0) {
 		// Seek failed.
 		return -q->m_lastError;
@@ -149,7 +156,6 @@ int GcnPartitionPrivate::loadFst(void)
 
 	// Read the FST.
 	// TODO: Eliminate the extra copy?
-	const uint32_t fstData_len = bootBlock.fst_size << offsetShift;
 	uint8_t *const fstData = new uint8_t[fstData_len];
 	size_t size = q->read(fstData, fstData_len);
 	if (size != fstData_len) {
@@ -55,13 +55,9 @@ public:
 	rp::uvector<uint32_t> hashes;
 
 	// Decompression buffer
-	// (Same size as blockCache)
+	// (Same size as a block cache entry)
 	rp::uvector<uint8_t> z_buffer;
 
-	// Block cache
-	rp::uvector<uint8_t> blockCache;
-	uint32_t blockCacheIdx;
-
 	// Starting offset of the data area
 	// This offset must be added to the blockPointers value
 	uint32_t dataOffset;
@@ -78,7 +74,6 @@ public:
 
 GczReaderPrivate::GczReaderPrivate(GczReader *q)
 	: super(q)
-	, blockCacheIdx(~0U)
 	, dataOffset(0)
 {
 	// Clear the GCZ header struct.
@@ -262,9 +257,8 @@ GczReader::GczReader(const IRpFilePtr &file)
 
 	// Initialize the block cache and decompression buffer.
 	// NOTE: Extra 64 bytes is for zlib, in case it needs it.
-	d->blockCache.resize(d->block_size + 64);
+	d->initBlockCache(d->block_size + 64);
 	d->z_buffer.resize(d->block_size + 64);
-	d->blockCacheIdx = ~0U;
 
 	// Reset the disc position.
 	d->pos = 0;
@@ -404,9 +398,10 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 		return 0;
 	}
 
-	if (blockIdx == d->blockCacheIdx) {
+	const uint8_t *const pCachedBlock = d->getCachedBlock(blockIdx);
+	if (pCachedBlock) {
 		// Block is cached.
-		memcpy(ptr, &d->blockCache[pos], size);
+		memcpy(ptr, &pCachedBlock[pos], size);
 		return static_cast<int>(size);
 	}
 
@@ -434,23 +429,24 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 		}
 	}
 
+	uint8_t *pBlock;
 	if (!compressed) {
 		// Reading uncompressed data directly into the cache.
+		pBlock = d->allocCachedBlock(blockIdx);
 		if (isLastBlock) {
-			memset(d->blockCache.data(), 0, d->blockCache.size());
+			memset(pBlock, 0, d->blockCacheBufSize);
 		}
 
-		size_t sz_read = m_file->seekAndRead(physBlockAddr, d->blockCache.data(), z_block_size);
+		size_t sz_read = m_file->seekAndRead(physBlockAddr, pBlock, z_block_size);
 		if (sz_read != z_block_size && !isLastBlock) {
 			// Seek and/or read error.
-			d->blockCacheIdx = ~0U;
+			d->invalidateCachedBlock(blockIdx);
 			m_lastError = m_file->lastError();
 			if (m_lastError == 0) {
 				m_lastError = EIO;
 			}
 			return 0;
 		}
-		d->blockCacheIdx = blockIdx;
 	} else {
 		// Read compressed data into a temporary buffer,
 		// then decompress it.
@@ -460,19 +456,24 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 			return 0;
 		}
 
-		size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-		if (sz_read != z_block_size) {
-			// Seek and/or read error.
-			m_lastError = m_file->lastError();
-			if (m_lastError == 0) {
-				m_lastError = EIO;
+		// If the file is memory-mapped, decompress directly from the mapping.
+		const uint8_t *z_data = m_file->view(physBlockAddr, z_block_size);
+		if (!z_data) {
+			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
+			if (sz_read != z_block_size) {
+				// Seek and/or read error.
+				m_lastError = m_file->lastError();
+				if (m_lastError == 0) {
+					m_lastError = EIO;
+				}
+				return 0;
 			}
-			return 0;
+			z_data = d->z_buffer.data();
 		}
 
 		// Verify the hash of the *compressed* data.
 		uint32_t hash_calc = adler32(0L, Z_NULL, 0);
-		hash_calc = adler32(hash_calc, d->z_buffer.data(), z_block_size);
+		hash_calc = adler32(hash_calc, z_data, z_block_size);
 		if (hash_calc != le32_to_cpu(d->hashes[blockIdx])) {
 			// Hash error.
 			// TODO: Print warnings and/or more comprehensive error codes.
@@ -481,10 +482,11 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 		}
 
 		// Decompress the data.
+		pBlock = d->allocCachedBlock(blockIdx);
 		z_stream z = { };
-		z.next_in = d->z_buffer.data();
+		z.next_in = const_cast<Bytef*>(z_data);
 		z.avail_in = z_block_size;
-		z.next_out = d->blockCache.data();
+		z.next_out = pBlock;
 		z.avail_out = d->block_size;
 		inflateInit(&z);
 
@@ -495,15 +497,14 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 		if (status != Z_STREAM_END || uncomp_size != d->block_size) {
 			// Decompression error.
 			// TODO: Print warnings and/or more comprehensive error codes.
-			d->blockCacheIdx = ~0U;
+			d->invalidateCachedBlock(blockIdx);
 			m_lastError = EIO;
 			return 0;
 		}
 	}
 
 	// Block has been loaded into the cache.
-	memcpy(ptr, &d->blockCache[pos], size);
-	d->blockCacheIdx = blockIdx;
+	memcpy(ptr, &pBlock[pos], size);
 	return static_cast<int>(size);
 }
 
@@ -55,6 +55,24 @@ public:
 	ATTR_ACCESS_SIZE(read_only, 2, 3)
 	int isDiscSupported(const uint8_t *pHeader, size_t szHeader) const final;
 
+public:
+	/**
+	 * Announce that a range of the disc image will be read soon.
+	 *
+	 * NOTE: Not implemented in this subclass, since tracks
+	 * are stored in separate files.
+	 *
+	 * @param pos	[in] Starting position
+	 * @param size	[in] Size of the range, in bytes
+	 * @return -ENOTSUP
+	 */
+	int prefetch(off64_t pos, off64_t size) final
+	{
+		RP_UNUSED(pos);
+		RP_UNUSED(size);
+		return -ENOTSUP;
+	}
+
 protected:
 	/** SparseDiscReader functions **/
 
@@ -0,0 +1,233 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * HashTreeVerifier.cpp: Multi-threaded hash tree verification driver.     *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "HashTreeVerifier.hpp"
+
+// librpfile
+using LibRpFile::IRpFilePtr;
+
+// librpthreads
+#include "librpthreads/Semaphore.hpp"
+#include "librpthreads/ThreadPool.hpp"
+using LibRpThreads::Semaphore;
+using LibRpThreads::ThreadPool;
+
+// C++ STL classes
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData {
+
+class HashTreeVerifierPrivate
+{
+public:
+	HashTreeVerifierPrivate(uint32_t block_size, uint32_t batch_size)
+		: block_size(block_size)
+		, batch_size(batch_size)
+	{}
+
+private:
+	RP_DISABLE_COPY(HashTreeVerifierPrivate)
+
+public:
+	const uint32_t block_size;	// Size of each block in the file, in bytes
+	const uint32_t batch_size;	// Number of blocks per batch
+
+	ThreadPool pool;
+
+	/**
+	 * Hash tree verification job.
+	 * Jobs are reused; the calling thread reads the next batch of
+	 * blocks into a job once its previous batch has been collected.
+	 */
+	struct Job {
+		unique_ptr<HashTreeVerifier::Worker> worker;
+		const uint32_t block_size;	// Size of each block, in bytes
+
+		uint32_t first;			// First block in this batch
+		uint32_t count;			// Number of blocks in this batch
+		vector<uint8_t> buf;		// Blocks, as read from the file
+		vector<uint8_t> bad;		// Verification results (1 if bad)
+
+		Semaphore done;			// Released once the batch has been verified.
+
+		Job(HashTreeVerifier::Worker *worker, uint32_t block_size, uint32_t batch_size)
+			: worker(worker)
+			, block_size(block_size)
+			, first(0)
+			, count(0)
+			, buf(static_cast<size_t>(block_size) * batch_size)
+			, bad(batch_size)
+			, done(0)
+		{}
+
+		/**
+		 * Run a hash tree verification job. (ThreadPool::WorkFn)
+		 * @param param Job
+		 */
+		static void run(void *param);
+	};
+	vector<unique_ptr<Job>> jobs;
+};
+
+/** HashTreeVerifierPrivate **/
+
+/**
+ * Run a hash tree verification job. (ThreadPool::WorkFn)
+ * @param param Job
+ */
+void HashTreeVerifierPrivate::Job::run(void *param)
+{
+	Job *const job = static_cast<Job*>(param);
+	uint8_t *block = job->buf.data();
+	for (uint32_t i = 0; i < job->count; i++, block += job->block_size) {
+		job->bad[i] = !job->worker->verifyBlock(job->first + i, block);
+	}
+	job->done.release();
+}
+
+/** HashTreeVerifier **/
+
+/**
+ * Create a hash tree verifier.
+ * @param block_size	[in] Size of each block in the file, in bytes
+ * @param batch_size	[in] Number of blocks per batch
+ */
+HashTreeVerifier::HashTreeVerifier(uint32_t block_size, uint32_t batch_size)
+	: d_ptr(new HashTreeVerifierPrivate(block_size, batch_size))
+{
+	assert(block_size > 0);
+	assert(batch_size > 0);
+}
+
+HashTreeVerifier::~HashTreeVerifier()
+{
+	delete d_ptr;
+}
+
+/**
+ * Get the number of workers that should be added.
+ * Batches are double-buffered per worker thread so the
+ * calling thread can read the next batch while the
+ * workers are hashing.
+ * @return Number of workers
+ */
+unsigned int HashTreeVerifier::workerCount(void) const
+{
+	RP_D(const HashTreeVerifier);
+	return std::max(d->pool.threadCount(), 1U) * 2;
+}
+
+/**
+ * Add a worker.
+ * Each worker verifies one batch at a time.
+ * @param worker Worker (this object takes ownership)
+ */
+void HashTreeVerifier::addWorker(Worker *worker)
+{
+	RP_D(HashTreeVerifier);
+	assert(worker != nullptr);
+	if (!worker)
+		return;
+	d->jobs.emplace_back(new HashTreeVerifierPrivate::Job(worker, d->block_size, d->batch_size));
+}
+
+/**
+ * Verify the hash tree.
+ * At least one worker must have been added.
+ * @param file		[in] File
+ * @param data_addr	[in] Address of the first block in the file
+ * @param total		[in] Total number of blocks
+ * @param result	[out] Results
+ * @param progressFn	[in,opt] Progress callback
+ * @param userdata	[in,opt] User data for the progress callback
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int HashTreeVerifier::run(const IRpFilePtr &file, off64_t data_addr, uint32_t total,
+	Result &result, ProgressFn progressFn, void *userdata)
+{
+	result.blocks = 0;
+	result.badBlocks.clear();
+
+	RP_D(HashTreeVerifier);
+	assert(!d->jobs.empty());
+	if (d->jobs.empty()) {
+		return -EINVAL;
+	} else if (!file || !file->isOpen()) {
+		return -EBADF;
+	}
+
+	const unsigned int jobCount = static_cast<unsigned int>(d->jobs.size());
+
+	int ret = 0;
+	uint32_t next = 0;		// Next block to read
+	unsigned int inFlight = 0;	// Number of jobs that haven't been collected yet
+	unsigned int submitIdx = 0, collectIdx = 0;
+	while (true) {
+		// Fill all available job slots.
+		for (; ret == 0 && inFlight < jobCount && next < total; inFlight++) {
+			HashTreeVerifierPrivate::Job *const job = d->jobs[submitIdx].get();
+			job->first = next;
+			job->count = std::min(d->batch_size, total - next);
+
+			const size_t read_sz = static_cast<size_t>(job->count) * d->block_size;
+			const size_t size = file->seekAndRead(data_addr + (static_cast<off64_t>(next) * d->block_size),
+				job->buf.data(), read_sz);
+			if (size != read_sz) {
+				ret = -EIO;
+				break;
+			}
+
+			if (d->pool.threadCount() == 0 || d->pool.enqueue(HashTreeVerifierPrivate::Job::run, job) != 0) {
+				// No worker threads. Verify the batch on this thread.
+				HashTreeVerifierPrivate::Job::run(job);
+			}
+
+			next += job->count;
+			submitIdx = (submitIdx + 1) % jobCount;
+		}
+
+		if (inFlight == 0) {
+			// All jobs have been collected.
+			break;
+		}
+
+		// Collect the oldest job so the results stay in order.
+		HashTreeVerifierPrivate::Job *const job = d->jobs[collectIdx].get();
+		job->done.obtain();
+		collectIdx = (collectIdx + 1) % jobCount;
+		inFlight--;
+
+		for (uint32_t i = 0; i < job->count; i++) {
+			if (!job->bad[i])
+				continue;
+
+			const uint32_t block_num = job->first + i;
+			if (!result.badBlocks.empty() &&
+			    result.badBlocks.back().first + result.badBlocks.back().count == block_num)
+			{
+				// Extend the current range.
+				result.badBlocks.back().count++;
+			} else {
+				// New range.
+				result.badBlocks.push_back({block_num, 1});
+			}
+		}
+		result.blocks += job->count;
+
+		if (ret == 0 && progressFn && !progressFn(userdata, result.blocks, total)) {
+			// Cancelled. Remaining jobs will be collected, but not reported.
+			ret = -ECANCELED;
+		}
+	}
+
+	return ret;
+}
+
+}
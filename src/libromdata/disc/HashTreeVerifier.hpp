@@ -0,0 +1,133 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * HashTreeVerifier.hpp: Multi-threaded hash tree verification driver.     *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "common.h"
+#include "dll-macros.h"	// for RP_LIBROMDATA_PUBLIC
+
+// librpfile
+#include "librpfile/IRpFile.hpp"
+
+// C includes (C++ namespace)
+#include <cstdint>
+
+// C++ includes
+#include <vector>
+
+namespace LibRomData {
+
+class HashTreeVerifierPrivate;
+
+/**
+ * Hash tree verification driver for formats that store the
+ * hash tree inline with fixed-size blocks. (Wii, Wii U)
+ *
+ * Blocks are read in batches on the calling thread, and each
+ * batch is verified on a worker thread using the format-specific
+ * Worker. Results are collected in block order.
+ */
+class HashTreeVerifier
+{
+public:
+	/**
+	 * Create a hash tree verifier.
+	 * @param block_size	[in] Size of each block in the file, in bytes
+	 * @param batch_size	[in] Number of blocks per batch
+	 */
+	RP_LIBROMDATA_PUBLIC
+	HashTreeVerifier(uint32_t block_size, uint32_t batch_size);
+
+	RP_LIBROMDATA_PUBLIC
+	~HashTreeVerifier();
+
+private:
+	RP_DISABLE_COPY(HashTreeVerifier)
+	friend class HashTreeVerifierPrivate;
+	HashTreeVerifierPrivate *const d_ptr;
+
+public:
+	/**
+	 * Format-specific block verifier.
+	 * Each worker is only used by one thread at a time,
+	 * so it can hold its own cipher and hash state.
+	 */
+	class Worker
+	{
+	public:
+		virtual ~Worker() = default;
+
+		/**
+		 * Verify a single block.
+		 * @param block_num	[in] Block number
+		 * @param block		[in/out] Block data, as read from the file (may be decrypted in place)
+		 * @return True if the block is valid; false if not.
+		 */
+		virtual bool verifyBlock(uint32_t block_num, uint8_t *block) = 0;
+	};
+
+	/**
+	 * Range of consecutive blocks that failed verification.
+	 */
+	struct BadBlockRange {
+		uint32_t first;		// First bad block
+		uint32_t count;		// Number of bad blocks
+	};
+
+	/**
+	 * Hash tree verification results.
+	 */
+	struct Result {
+		uint32_t blocks;	// Number of blocks verified
+		std::vector<BadBlockRange> badBlocks;
+	};
+
+	/**
+	 * Hash tree verification progress callback.
+	 * @param userdata	[in] User data
+	 * @param done		[in] Number of blocks verified
+	 * @param total		[in] Total number of blocks
+	 * @return True to continue; false to cancel.
+	 */
+	typedef bool (*ProgressFn)(void *userdata, uint32_t done, uint32_t total);
+
+	/**
+	 * Get the number of workers that should be added.
+	 * Batches are double-buffered per worker thread so the
+	 * calling thread can read the next batch while the
+	 * workers are hashing.
+	 * @return Number of workers
+	 */
+	RP_LIBROMDATA_PUBLIC
+	unsigned int workerCount(void) const;
+
+	/**
+	 * Add a worker.
+	 * Each worker verifies one batch at a time.
+	 * @param worker Worker (this object takes ownership)
+	 */
+	RP_LIBROMDATA_PUBLIC
+	void addWorker(Worker *worker);
+
+	/**
+	 * Verify the hash tree.
+	 * At least one worker must have been added.
+	 * @param file		[in] File
+	 * @param data_addr	[in] Address of the first block in the file
+	 * @param total		[in] Total number of blocks
+	 * @param result	[out] Results
+	 * @param progressFn	[in,opt] Progress callback
+	 * @param userdata	[in,opt] User data for the progress callback
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	RP_LIBROMDATA_PUBLIC
+	int run(const LibRpFile::IRpFilePtr &file, off64_t data_addr, uint32_t total,
+		Result &result, ProgressFn progressFn = nullptr, void *userdata = nullptr);
+};
+
+}
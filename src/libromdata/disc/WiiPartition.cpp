@@ -17,6 +17,7 @@
 #ifdef ENABLE_DECRYPTION
 #  include "librpbase/crypto/IAesCipher.hpp"
 #  include "librpbase/crypto/AesCipherFactory.hpp"
+#  include "librpbase/crypto/Hash.hpp"
 #endif /* ENABLE_DECRYPTION */
 using namespace LibRpBase;
 
@@ -28,6 +29,7 @@ using namespace LibRpFile;
 // C++ STL classes
 using std::array;
 using std::unique_ptr;
+using std::vector;
 
 #include "GcnPartition_p.hpp"
 namespace LibRomData {
@@ -36,6 +38,12 @@ namespace LibRomData {
 #define SECTOR_SIZE_DECRYPTED 0x7C00
 #define SECTOR_SIZE_DECRYPTED_OFFSET 0x400
 
+// Hash tree layout
+#define H3_TABLE_SIZE 0x18000
+#define H3_TABLE_ENTRIES (H3_TABLE_SIZE / 20)
+#define CLUSTERS_PER_SUBGROUP 8
+#define CLUSTERS_PER_GROUP 64
+
 class WiiPartitionPrivate final : public GcnPartitionPrivate
 {
 public:
@@ -76,9 +84,10 @@ public:
 	off64_t pos_7C00;
 
 	// Decrypted sector cache.
-	// NOTE: Actual data starts at 0x400.
+	// Contiguous sectors are read with a single read() call
+	// and decrypted as a batch.
+	// NOTE: Actual data starts at 0x400 in each sector.
 	// Hashes and the sector IV are stored first.
-	uint32_t sector_num;				// Sector number.
 	union EncSector_t {
 		struct {
 			// NOTE: &hashes.H2[7][4], when encrypted, is the sector IV.
@@ -96,16 +105,23 @@ public:
 	};
 	ASSERT_STRUCT(EncSector_t, SECTOR_SIZE_ENCRYPTED);
 	static_assert(offsetof(EncSector_t, hashes.H2) + (7*20) + 4 == 0x3D0, "IV location is wrong");
-	EncSector_t sector_buf;	// Decrypted sector data.
+	static constexpr uint32_t SECTOR_CACHE_COUNT = 16;	// 512 KB
+	unique_ptr<EncSector_t[]> sector_cache;	// Allocated on first use.
+	uint32_t cache_first;			// First sector in the cache.
+	uint32_t cache_count;			// Number of valid sectors in the cache.
 
 	/**
-	 * Read and decrypt a sector.
-	 * The decrypted sector is stored in sector_buf.
+	 * Get a decrypted sector.
+	 * If the sector isn't cached, it's read along with up to
+	 * (count_hint - 1) following sectors. If the sector directly
+	 * follows the cached sectors, a full batch is read, since
+	 * this is most likely a sequential read.
 	 *
 	 * @param sector_num Sector number. (address / 0x7C00)
-	 * @return 0 on success; negative POSIX error code on error.
+	 * @param count_hint Number of sectors that will be needed, starting at sector_num.
+	 * @return Decrypted sector, or nullptr on error.
 	 */
-	int readSector(uint32_t sector_num);
+	const EncSector_t *getSector(uint32_t sector_num, uint32_t count_hint = 1);
 
 public:
 	/**
@@ -118,7 +134,38 @@ public:
 public:
 	// AES cipher for this partition's title key
 	unique_ptr<IAesCipher> aes_title;
-#endif
+
+	// Decrypted title key
+	// Needed to create additional ciphers for hash tree verification.
+	array<uint8_t, 16> title_key;
+
+public:
+	/**
+	 * Hash tree verification worker.
+	 * Decrypts each cluster if necessary, then checks its hashes.
+	 */
+	class HashTreeWorker final : public HashTreeVerifier::Worker {
+	public:
+		explicit HashTreeWorker(const uint8_t *h3)
+			: sha1(Hash::Algorithm::SHA1)
+			, h3(h3)
+		{}
+
+	public:
+		unique_ptr<IAesCipher> cipher;	// nullptr if the partition isn't encrypted
+		Hash sha1;
+		const uint8_t *const h3;	// H3 table (owned by verifyHashTree())
+
+	public:
+		/**
+		 * Verify a single cluster.
+		 * @param cluster_num	[in] Cluster number
+		 * @param sector	[in/out] Encrypted cluster data (decrypted in place)
+		 * @return True if the cluster is valid; false if not.
+		 */
+		bool verifyBlock(uint32_t cluster_num, uint8_t *sector) final;
+	};
+#endif /* ENABLE_DECRYPTION */
 };
 
 /** WiiPartitionPrivate **/
@@ -145,7 +192,8 @@ WiiPartitionPrivate::WiiPartitionPrivate(WiiPartition *q,
 	, encKeyReal(WiiTicket::EncryptionKeys::Unknown)
 	, cryptoMethod(cryptoMethod)
 	, pos_7C00(-1)
-	, sector_num(~0)
+	, cache_first(0)
+	, cache_count(0)
 {
 	// Clear data set by GcnPartition in case the
 	// partition headers can't be read.
@@ -155,6 +203,9 @@ WiiPartitionPrivate::WiiPartitionPrivate(WiiPartition *q,
 
 	// Clear the partition header struct.
 	memset(&partitionHeader, 0, sizeof(partitionHeader));
+#ifdef ENABLE_DECRYPTION
+	title_key.fill(0);
+#endif /* ENABLE_DECRYPTION */
 
 	// Partition header will be read in the WiiPartition constructor.
 }
@@ -217,8 +268,7 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 
 #ifdef ENABLE_DECRYPTION
 	// Get the title key.
-	uint8_t title_key[16];
-	int ret = wiiTicket->decryptTitleKey(title_key, sizeof(title_key));
+	int ret = wiiTicket->decryptTitleKey(title_key.data(), title_key.size());
 	if (ret != 0) {
 		// Title key decryption failed.
 		verifyResult = wiiTicket->verifyResult();
@@ -234,7 +284,7 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 	}
 
 	// Load the decrypted title key. (CBC mode)
-	ret = cipher->setKey(title_key, sizeof(title_key));
+	ret = cipher->setKey(title_key.data(), title_key.size());
 	ret |= cipher->setChainingMode(IAesCipher::ChainingMode::CBC);
 	if (ret != 0) {
 		// Error initializing the cipher.
@@ -242,12 +292,13 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 		return verifyResult;
 	}
 
-	// readSector() needs aes_title.
+	// getSector() needs aes_title.
 	aes_title = std::move(cipher);
 
 	// Read sector 0, which contains a disc header.
-	// NOTE: readSector() doesn't check verifyResult.
-	if (readSector(0) != 0) {
+	// NOTE: getSector() doesn't check verifyResult.
+	const EncSector_t *const sector0 = getSector(0);
+	if (!sector0) {
 		// Error reading sector 0.
 		aes_title.reset();
 		verifyResult = KeyManager::VerifyResult::IAesCipherDecryptErr;
@@ -257,12 +308,12 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 	// Verify that this is a Wii partition.
 	// If it isn't, the key is probably wrong.
 	const GCN_DiscHeader *const discHeader =
-		reinterpret_cast<const GCN_DiscHeader*>(sector_buf.data);
+		reinterpret_cast<const GCN_DiscHeader*>(sector0->data);
 	if (discHeader->magic_wii != cpu_to_be32(WII_MAGIC)) {
 		// Invalid disc header.
 
 		// NOTE: Debug discs may have incrementing values in update partitions.
-		if (!memcmp(sector_buf.data, incr_vals.data(), incr_vals.size())) {
+		if (!memcmp(sector0->data, incr_vals.data(), incr_vals.size())) {
 			// Found incrementing values.
 			verifyResult = KeyManager::VerifyResult::IncrementingValues;
 		} else {
@@ -286,17 +337,21 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 }
 
 /**
- * Read and decrypt a sector.
- * The decrypted sector is stored in sector_buf.
+ * Get a decrypted sector.
+ * If the sector isn't cached, it's read along with up to
+ * (count_hint - 1) following sectors. If the sector directly
+ * follows the cached sectors, a full batch is read, since
+ * this is most likely a sequential read.
  *
  * @param sector_num Sector number. (address / 0x7C00)
- * @return 0 on success; negative POSIX error code on error.
+ * @param count_hint Number of sectors that will be needed, starting at sector_num.
+ * @return Decrypted sector, or nullptr on error.
  */
-int WiiPartitionPrivate::readSector(uint32_t sector_num)
+const WiiPartitionPrivate::EncSector_t *WiiPartitionPrivate::getSector(uint32_t sector_num, uint32_t count_hint)
 {
-	if (this->sector_num == sector_num) {
+	if (sector_num >= cache_first && sector_num - cache_first < cache_count) {
 		// Sector is already in memory.
-		return 0;
+		return &sector_cache[sector_num - cache_first];
 	}
 
 	RP_Q(WiiPartition);
@@ -305,49 +360,141 @@ int WiiPartitionPrivate::readSector(uint32_t sector_num)
 	if (isCrypted) {
 		// Decryption is disabled.
 		q->m_lastError = EIO;
-		return -1;
+		return nullptr;
 	}
 #endif /* !ENABLE_DECRYPTION */
 
+	// Determine how many sectors to read.
+	uint32_t count = count_hint;
+	if (cache_count != 0 && sector_num == cache_first + cache_count) {
+		// Sequential read. Fill the entire cache.
+		count = SECTOR_CACHE_COUNT;
+	}
+	if (count == 0) {
+		count = 1;
+	} else if (count > SECTOR_CACHE_COUNT) {
+		count = SECTOR_CACHE_COUNT;
+	}
+	if (data_size > 0) {
+		// Don't read past the end of the partition.
+		const off64_t sectors_left = ((data_size + SECTOR_SIZE_ENCRYPTED - 1) / SECTOR_SIZE_ENCRYPTED) - sector_num;
+		if (sectors_left > 0 && static_cast<off64_t>(count) > sectors_left) {
+			count = static_cast<uint32_t>(sectors_left);
+		}
+	}
+
+	if (!sector_cache) {
+		sector_cache.reset(new EncSector_t[SECTOR_CACHE_COUNT]);
+	}
+
 	// NOTE: This function doesn't check verifyResult,
 	// since it's called by initDecryption() before
 	// verifyResult is set.
 	off64_t sector_addr = partition_offset + data_offset;
 	sector_addr += (static_cast<off64_t>(sector_num) * SECTOR_SIZE_ENCRYPTED);
 
-	int ret = q->m_file->seek(sector_addr);
-	if (ret != 0) {
-		q->m_lastError = q->m_file->lastError();
-		return ret;
-	}
-
-	size_t sz = q->m_file->read(&sector_buf, sizeof(sector_buf));
-	if (sz != sizeof(sector_buf)) {
-		// sector_buf may be invalid.
-		this->sector_num = ~0;
+	// The cache contents will be replaced, so invalidate it first.
+	cache_count = 0;
+	const size_t sz = q->m_file->seekAndRead(sector_addr, sector_cache.get(),
+		static_cast<size_t>(count) * SECTOR_SIZE_ENCRYPTED);
+	if (sz < SECTOR_SIZE_ENCRYPTED) {
+		// Not even the first sector could be read.
 		q->m_lastError = EIO;
-		return -1;
+		return nullptr;
 	}
+	// Short read: Only keep complete sectors.
+	count = static_cast<uint32_t>(sz / SECTOR_SIZE_ENCRYPTED);
 
 #ifdef ENABLE_DECRYPTION
 	if (isCrypted) {
-		// Decrypt the sector.
-		if (aes_title->decrypt(sector_buf.data, sizeof(sector_buf.data),
-		    &sector_buf.hashes.H2[7][4], 16) != SECTOR_SIZE_DECRYPTED)
-		{
-			// sector_buf may be invalid.
-			this->sector_num = ~0;
-			q->m_lastError = EIO;
-			return -1;
+		// Decrypt the sectors.
+		// Each sector's data has its own IV, which is stored
+		// in the encrypted hash area.
+		for (uint32_t i = 0; i < count; i++) {
+			EncSector_t &sector = sector_cache[i];
+			if (aes_title->decrypt(sector.data, sizeof(sector.data),
+			    &sector.hashes.H2[7][4], 16) != SECTOR_SIZE_DECRYPTED)
+			{
+				// Only the sectors before this one are valid.
+				if (i == 0) {
+					q->m_lastError = EIO;
+					return nullptr;
+				}
+				count = i;
+				break;
+			}
 		}
 	}
 #endif /* ENABLE_DECRYPTION */
 
-	// Sector read and decrypted.
-	this->sector_num = sector_num;
-	return 0;
+	// Sectors read and decrypted.
+	cache_first = sector_num;
+	cache_count = count;
+	return &sector_cache[0];
+}
+
+#ifdef ENABLE_DECRYPTION
+/**
+ * Verify a single cluster.
+ * @param cluster_num	[in] Cluster number
+ * @param sector	[in/out] Encrypted cluster data (decrypted in place)
+ * @return True if the cluster is valid; false if not.
+ */
+bool WiiPartitionPrivate::HashTreeWorker::verifyBlock(uint32_t cluster_num, uint8_t *sector)
+{
+	if (cipher) {
+		// The data IV is stored in the encrypted hash block,
+		// so it has to be copied before the hashes are decrypted.
+		// The hash block itself uses an all-zero IV.
+		static const uint8_t iv_zero[16] = {0};
+		uint8_t iv_data[16];
+		memcpy(iv_data, &sector[0x3D0], sizeof(iv_data));
+		if (cipher->decrypt(sector, SECTOR_SIZE_DECRYPTED_OFFSET, iv_zero, sizeof(iv_zero)) != SECTOR_SIZE_DECRYPTED_OFFSET ||
+		    cipher->decrypt(&sector[SECTOR_SIZE_DECRYPTED_OFFSET], SECTOR_SIZE_DECRYPTED, iv_data, sizeof(iv_data)) != SECTOR_SIZE_DECRYPTED)
+		{
+			// Decryption failed.
+			return false;
+		}
+	}
+
+	const EncSector_t *const pSector = reinterpret_cast<const EncSector_t*>(sector);
+	uint8_t digest[20];
+
+	// H0: One hash per 1 KB data block.
+	for (unsigned int i = 0; i < ARRAY_SIZE(pSector->hashes.H0); i++) {
+		sha1.reset();
+		sha1.process(&pSector->data[i * 0x400], 0x400);
+		sha1.getHash(digest, sizeof(digest));
+		if (memcmp(digest, pSector->hashes.H0[i], sizeof(digest)) != 0)
+			return false;
+	}
+
+	// H1: Hash of this cluster's H0 table.
+	sha1.reset();
+	sha1.process(pSector->hashes.H0, sizeof(pSector->hashes.H0));
+	sha1.getHash(digest, sizeof(digest));
+	if (memcmp(digest, pSector->hashes.H1[cluster_num % CLUSTERS_PER_SUBGROUP], sizeof(digest)) != 0)
+		return false;
+
+	// H2: Hash of this subgroup's H1 table.
+	sha1.reset();
+	sha1.process(pSector->hashes.H1, sizeof(pSector->hashes.H1));
+	sha1.getHash(digest, sizeof(digest));
+	if (memcmp(digest, pSector->hashes.H2[(cluster_num / CLUSTERS_PER_SUBGROUP) % 8], sizeof(digest)) != 0)
+		return false;
+
+	// H3: Hash of this group's H2 table.
+	const uint32_t group = cluster_num / CLUSTERS_PER_GROUP;
+	if (group >= H3_TABLE_ENTRIES)
+		return false;
+	sha1.reset();
+	sha1.process(pSector->hashes.H2, sizeof(pSector->hashes.H2));
+	sha1.getHash(digest, sizeof(digest));
+	return (memcmp(digest, &h3[group * 20], sizeof(digest)) == 0);
 }
 
+#endif /* ENABLE_DECRYPTION */
+
 /** WiiPartition **/
 
 /**
@@ -451,7 +598,6 @@ size_t WiiPartition::read(void *ptr, size_t size)
 		return 0;
 	}
 
-	// TODO: Consolidate this code and optimize it.
 	size_t ret = 0;
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 
@@ -465,64 +611,17 @@ size_t WiiPartition::read(void *ptr, size_t size)
 		size = static_cast<size_t>(d->data_size - d->pos_7C00);
 	}
 
+	// Logical sector size and the data offset within each sector.
+	uint32_t sector_size, sector_data_offset;
 	if ((d->cryptoMethod & CM_MASK_SECTOR) == CM_32K) {
 		// Full 32K sectors. (implies no encryption)
-
-		// Check if we're not starting on a block boundary.
-		const uint32_t blockStartOffset = d->pos_7C00 % SECTOR_SIZE_ENCRYPTED;
-		if (blockStartOffset != 0) {
-			// Not a block boundary.
-			// Read the end of the block.
-			uint32_t read_sz = SECTOR_SIZE_ENCRYPTED - blockStartOffset;
-			if (size < static_cast<size_t>(read_sz)) {
-				read_sz = static_cast<uint32_t>(size);
-			}
-
-			// Read and decrypt the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_ENCRYPTED);
-			d->readSector(blockStart);
-
-			// Copy data from the sector.
-			memcpy(ptr8, &d->sector_buf.fulldata[blockStartOffset], read_sz);
-
-			// Starting block read.
-			size -= read_sz;
-			ptr8 += read_sz;
-			ret += read_sz;
-			d->pos_7C00 += read_sz;
-		}
-
-		// Read entire blocks.
-		for (; size >= SECTOR_SIZE_ENCRYPTED;
-		     size -= SECTOR_SIZE_ENCRYPTED, ptr8 += SECTOR_SIZE_ENCRYPTED,
-		     ret += SECTOR_SIZE_ENCRYPTED, d->pos_7C00 += SECTOR_SIZE_ENCRYPTED)
-		{
-			assert(d->pos_7C00 % SECTOR_SIZE_ENCRYPTED == 0);
-
-			// Read the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_ENCRYPTED);
-			d->readSector(blockStart);
-
-			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf.fulldata, SECTOR_SIZE_ENCRYPTED);
-		}
-
-		// Check if we still have data left. (not a full block)
-		if (size > 0) {
-			// Not a full block.
-
-			// Read the sector.
-			assert(d->pos_7C00 % SECTOR_SIZE_ENCRYPTED == 0);
-			const uint32_t blockEnd = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_ENCRYPTED);
-			d->readSector(blockEnd);
-
-			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf.fulldata, size);
-
-			ret += size;
-			d->pos_7C00 += size;
-		}
+		sector_size = SECTOR_SIZE_ENCRYPTED;
+		sector_data_offset = 0;
 	} else {
+		// 1K hashes, 31K data.
+		sector_size = SECTOR_SIZE_DECRYPTED;
+		sector_data_offset = SECTOR_SIZE_DECRYPTED_OFFSET;
+
 		if ((d->cryptoMethod & CM_MASK_ENCRYPTED) == CM_ENCRYPTED) {
 #ifdef ENABLE_DECRYPTION
 			// Make sure decryption is initialized.
@@ -550,64 +649,37 @@ size_t WiiPartition::read(void *ptr, size_t size)
 #else /* !ENABLE_DECRYPTION */
 			// Decryption is not enabled.
 			m_lastError = EIO;
-			ret = 0;
+			return 0;
 #endif /* ENABLE_DECRYPTION */
 		}
+	}
 
-		// Check if we're not starting on a block boundary.
-		const uint32_t blockStartOffset = d->pos_7C00 % SECTOR_SIZE_DECRYPTED;
-		if (blockStartOffset != 0) {
-			// Not a block boundary.
-			// Read the end of the block.
-			uint32_t read_sz = SECTOR_SIZE_DECRYPTED - blockStartOffset;
-			if (size < static_cast<size_t>(read_sz)) {
-				read_sz = static_cast<uint32_t>(size);
-			}
-
-			// Read and decrypt the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_DECRYPTED);
-			d->readSector(blockStart);
-
-			// Copy data from the sector.
-			memcpy(ptr8, &d->sector_buf.data[blockStartOffset], read_sz);
-
-			// Starting block read.
-			size -= read_sz;
-			ptr8 += read_sz;
-			ret += read_sz;
-			d->pos_7C00 += read_sz;
+	while (size > 0) {
+		const uint32_t sector_num = static_cast<uint32_t>(d->pos_7C00 / sector_size);
+		const uint32_t sector_offset = static_cast<uint32_t>(d->pos_7C00 % sector_size);
+
+		// Number of sectors needed for the rest of this read.
+		// This allows the cache to load all of them at once.
+		const size_t sectors_needed = (sector_offset + size + sector_size - 1) / sector_size;
+		const WiiPartitionPrivate::EncSector_t *const sector = d->getSector(sector_num,
+			static_cast<uint32_t>(std::min<size_t>(sectors_needed, UINT32_MAX)));
+		if (!sector) {
+			// Error reading the sector.
+			// m_lastError was set by getSector().
+			break;
 		}
 
-		// Read entire blocks.
-		for (; size >= SECTOR_SIZE_DECRYPTED;
-		size -= SECTOR_SIZE_DECRYPTED, ptr8 += SECTOR_SIZE_DECRYPTED,
-		ret += SECTOR_SIZE_DECRYPTED, d->pos_7C00 += SECTOR_SIZE_DECRYPTED)
-		{
-			assert(d->pos_7C00 % SECTOR_SIZE_DECRYPTED == 0);
-
-			// Read and decrypt the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_DECRYPTED);
-			d->readSector(blockStart);
-
-			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf.data, SECTOR_SIZE_DECRYPTED);
+		// Copy data from the sector.
+		uint32_t read_sz = sector_size - sector_offset;
+		if (size < static_cast<size_t>(read_sz)) {
+			read_sz = static_cast<uint32_t>(size);
 		}
+		memcpy(ptr8, &sector->fulldata[sector_data_offset + sector_offset], read_sz);
 
-		// Check if we still have data left. (not a full block)
-		if (size > 0) {
-			// Not a full block.
-
-			// Read and decrypt the sector.
-			assert(d->pos_7C00 % SECTOR_SIZE_DECRYPTED == 0);
-			const uint32_t blockEnd = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_DECRYPTED);
-			d->readSector(blockEnd);
-
-			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf.data, size);
-
-			ret += size;
-			d->pos_7C00 += size;
-		}
+		size -= read_sz;
+		ptr8 += read_sz;
+		ret += read_sz;
+		d->pos_7C00 += read_sz;
 	}
 
 	// Finished reading the data.
@@ -659,6 +731,43 @@ off64_t WiiPartition::tell(void)
 	return d->pos_7C00;
 }
 
+/**
+ * Announce that a range of the partition will be read soon.
+ * The partition position is not changed.
+ *
+ * The range is converted to the encrypted sectors that
+ * contain the data, including the sector hashes.
+ *
+ * @param pos	[in] Starting position
+ * @param size	[in] Size of the range, in bytes
+ * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+ */
+int WiiPartition::prefetch(off64_t pos, off64_t size)
+{
+	RP_D(const WiiPartition);
+	if (!m_file || !m_file->isOpen()) {
+		return -EBADF;
+	} else if (pos < 0 || size < 0) {
+		return -EINVAL;
+	} else if (size == 0 || pos >= d->data_size) {
+		// Nothing to prefetch.
+		return 0;
+	}
+
+	if (size > d->data_size - pos) {
+		size = d->data_size - pos;
+	}
+
+	// Hashed sectors have 0x7C00 bytes of data per 0x8000-byte sector.
+	const off64_t logicalSectorSize = ((d->cryptoMethod & CM_MASK_SECTOR) == CM_1K_31K)
+		? SECTOR_SIZE_DECRYPTED
+		: SECTOR_SIZE_ENCRYPTED;
+	const off64_t sectorStart = pos / logicalSectorSize;
+	const off64_t sectorEnd = (pos + size - 1) / logicalSectorSize;
+	return m_file->prefetch(d->partition_offset + d->data_offset + (sectorStart * SECTOR_SIZE_ENCRYPTED),
+		(sectorEnd - sectorStart + 1) * SECTOR_SIZE_ENCRYPTED);
+}
+
 /**
  * Get the used partition size.
  * This size includes the partition header and hashes,
@@ -763,4 +872,109 @@ Nintendo_TitleID_BE_t WiiPartition::titleID(void) const
 	return d->partitionHeader.ticket.title_id;
 }
 
+/** Hash tree verification **/
+
+/**
+ * Verify the partition's hash tree.
+ *
+ * Every cluster is read and decrypted, and its H0, H1, and H2
+ * hashes are checked, along with the H3 table entry for its
+ * group. The H3 table itself is checked against the TMD.
+ * Clusters are decrypted and hashed on worker threads.
+ *
+ * @param result	[out] Results
+ * @param progressFn	[in,opt] Progress callback
+ * @param userdata	[in,opt] User data for the progress callback
+ * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if the partition isn't hashed)
+ */
+int WiiPartition::verifyHashTree(HashTreeResult &result, VerifyProgressFn progressFn, void *userdata)
+{
+	result.clusters = 0;
+	result.h3Valid = false;
+	result.badClusters.clear();
+
+	RP_D(WiiPartition);
+	if (!m_file || !m_file->isOpen()) {
+		return -EBADF;
+	} else if ((d->cryptoMethod & CM_MASK_SECTOR) != CM_1K_31K) {
+		// Partition doesn't have hashes.
+		return -ENOTSUP;
+	}
+
+#ifdef ENABLE_DECRYPTION
+	const bool isCrypted = ((d->cryptoMethod & CM_MASK_ENCRYPTED) == CM_ENCRYPTED);
+	if (isCrypted && d->initDecryption() != KeyManager::VerifyResult::OK) {
+		// Decryption could not be initialized.
+		return -EIO;
+	}
+
+	// Load the H3 table.
+	unique_ptr<uint8_t[]> h3(new uint8_t[H3_TABLE_SIZE]);
+	size_t size = m_file->seekAndRead(d->partition_offset + d->partitionHeader.h3_table_offset.geto_be(),
+		h3.get(), H3_TABLE_SIZE);
+	if (size != H3_TABLE_SIZE) {
+		return -EIO;
+	}
+
+	// Check the H3 table against the H4 hash in the TMD.
+	// The TMD is stored in the partition header, and its offset
+	// is relative to the start of the partition.
+	const off64_t tmd_offset = d->partitionHeader.tmd_offset.geto_be();
+	if (tmd_offset >= 0 && tmd_offset + static_cast<off64_t>(sizeof(RVL_TMD_Header) + sizeof(RVL_Content_Entry))
+	    <= static_cast<off64_t>(sizeof(d->partitionHeader)))
+	{
+		const uint8_t *const pTmd = reinterpret_cast<const uint8_t*>(&d->partitionHeader) + tmd_offset;
+		const RVL_TMD_Header *const tmdHeader = reinterpret_cast<const RVL_TMD_Header*>(pTmd);
+		const RVL_Content_Entry *const content0 =
+			reinterpret_cast<const RVL_Content_Entry*>(pTmd + sizeof(RVL_TMD_Header));
+		if (tmdHeader->nbr_cont != 0) {
+			Hash sha1(Hash::Algorithm::SHA1);
+			uint8_t digest[20];
+			sha1.process(h3.get(), H3_TABLE_SIZE);
+			sha1.getHash(digest, sizeof(digest));
+			result.h3Valid = (memcmp(digest, content0->sha1_hash, sizeof(digest)) == 0);
+		}
+	}
+
+	const uint32_t total = static_cast<uint32_t>(d->data_size / SECTOR_SIZE_ENCRYPTED);
+	const off64_t data_addr = d->partition_offset + d->data_offset;
+
+	HashTreeVerifier verifier(SECTOR_SIZE_ENCRYPTED, CLUSTERS_PER_GROUP);
+	const unsigned int workerCount = verifier.workerCount();
+	for (unsigned int i = 0; i < workerCount; i++) {
+		unique_ptr<WiiPartitionPrivate::HashTreeWorker> worker(
+			new WiiPartitionPrivate::HashTreeWorker(h3.get()));
+		if (!worker->sha1.isUsable()) {
+			return -ENOTSUP;
+		}
+		if (isCrypted) {
+			// Each worker needs its own cipher, since the
+			// CBC state can't be shared between threads.
+			worker->cipher.reset(AesCipherFactory::create());
+			if (!worker->cipher || !worker->cipher->isInit() ||
+			    worker->cipher->setKey(d->title_key.data(), d->title_key.size()) != 0 ||
+			    worker->cipher->setChainingMode(IAesCipher::ChainingMode::CBC) != 0)
+			{
+				return -EIO;
+			}
+		}
+		verifier.addWorker(worker.release());
+	}
+
+	HashTreeVerifier::Result vresult;
+	const int ret = verifier.run(m_file, data_addr, total, vresult, progressFn, userdata);
+	result.clusters = vresult.blocks;
+	result.badClusters = std::move(vresult.badBlocks);
+	if (ret == -EIO) {
+		m_lastError = EIO;
+	}
+	return ret;
+#else /* !ENABLE_DECRYPTION */
+	// SHA-1 is not available.
+	RP_UNUSED(progressFn);
+	RP_UNUSED(userdata);
+	return -ENOTSUP;
+#endif /* ENABLE_DECRYPTION */
+}
+
 }
@@ -18,6 +18,12 @@
 // WiiTicket for EncryptionKeys
 #include "../Console/WiiTicket.hpp"
 
+// Hash tree verification
+#include "HashTreeVerifier.hpp"
+
+// C++ includes
+#include <vector>
+
 namespace LibRomData {
 
 class WiiPartitionPrivate;
@@ -88,6 +94,19 @@ public:
 	 */
 	off64_t tell(void) final;
 
+	/**
+	 * Announce that a range of the partition will be read soon.
+	 * The partition position is not changed.
+	 *
+	 * The range is converted to the encrypted sectors that
+	 * contain the data, including the sector hashes.
+	 *
+	 * @param pos	[in] Starting position
+	 * @param size	[in] Size of the range, in bytes
+	 * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+	 */
+	int prefetch(off64_t pos, off64_t size) final;
+
 public:
 	/**
 	 * Get the used partition size.
@@ -136,6 +155,41 @@ public:
 	 * @return Title ID. (0-0 if unavailable)
 	 */
 	Nintendo_TitleID_BE_t titleID(void) const;
+
+public:
+	/** Hash tree verification **/
+
+	// Range of consecutive clusters that failed verification.
+	// Cluster numbers are relative to the start of the partition data.
+	typedef HashTreeVerifier::BadBlockRange BadClusterRange;
+
+	/**
+	 * Hash tree verification results.
+	 */
+	struct HashTreeResult {
+		uint32_t clusters;	// Number of clusters verified
+		bool h3Valid;		// True if the H3 table matches the TMD. (H4)
+		std::vector<BadClusterRange> badClusters;
+	};
+
+	// Hash tree verification progress callback.
+	// done and total are numbers of clusters.
+	typedef HashTreeVerifier::ProgressFn VerifyProgressFn;
+
+	/**
+	 * Verify the partition's hash tree.
+	 *
+	 * Every cluster is read and decrypted, and its H0, H1, and H2
+	 * hashes are checked, along with the H3 table entry for its
+	 * group. The H3 table itself is checked against the TMD.
+	 * Clusters are decrypted and hashed on worker threads.
+	 *
+	 * @param result	[out] Results
+	 * @param progressFn	[in,opt] Progress callback
+	 * @param userdata	[in,opt] User data for the progress callback
+	 * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if the partition isn't hashed)
+	 */
+	int verifyHashTree(HashTreeResult &result, VerifyProgressFn progressFn = nullptr, void *userdata = nullptr);
 };
 
 typedef std::shared_ptr<WiiPartition> WiiPartitionPtr;
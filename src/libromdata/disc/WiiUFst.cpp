@@ -10,6 +10,7 @@
 #include "librpbase/config.librpbase.h"
 
 #include "WiiUFst.hpp"
+#include "FstPathIndex.hpp"
 #include "../Console/wiiu_structs.h"
 
 // Other rom-properties libraries
@@ -23,7 +24,7 @@ using std::unordered_set;
 
 namespace LibRomData {
 
-class WiiUFstPrivate
+class WiiUFstPrivate final : public FstPathIndex::Source
 {
 public:
 	WiiUFstPrivate(const uint8_t *fstData, uint32_t len);
@@ -58,6 +59,9 @@ public:
 	// - Value: string.
 	mutable unordered_map<uint32_t, string> u8_string_table;
 
+	// Path index for find_path().
+	FstPathIndex pathIndex;
+
 	/**
 	 * Check if an fst_entry is a directory.
 	 * @return True if this is a directory; false if it's a regular file.
@@ -71,6 +75,16 @@ public:
 	 */
 	inline const char *entry_name(const WUP_FST_Entry *fst_entry) const;
 
+	/**
+	 * Get an FST entry's name for comparison purposes.
+	 * ASCII names are returned directly from the string table,
+	 * since they're the same in cp1252, Shift-JIS, and UTF-8.
+	 * Other names are converted using entry_name().
+	 * @param fst_entry FST entry.
+	 * @return Name, or nullptr if an error occurred.
+	 */
+	inline const char *entry_name_fast(const WUP_FST_Entry *fst_entry) const;
+
 	/**
 	 * Get an FST entry.
 	 *
@@ -83,12 +97,56 @@ public:
 	 */
 	const WUP_FST_Entry *entry(int idx, const char **ppszName = nullptr) const;
 
+	/**
+	 * Find a path by scanning the FST.
+	 * This is used if the path index can't be used.
+	 * @param path Path. (Absolute paths only!)
+	 * @return fst_entry if found, or nullptr if not.
+	 */
+	const WUP_FST_Entry *find_path_linear(const char *path) const;
+
 	/**
 	 * Find a path.
 	 * @param path Path. (Absolute paths only!)
 	 * @return fst_entry if found, or nullptr if not.
 	 */
 	const WUP_FST_Entry *find_path(const char *path) const;
+
+	/** FstPathIndex::Source **/
+
+	/**
+	 * Get the total number of FST entries, including the root directory.
+	 * @return Number of FST entries
+	 */
+	uint32_t fst_entry_count(void) const final
+	{
+		return be32_to_cpu(fstEntries[0].root_dir.file_count);
+	}
+
+	/**
+	 * Get an FST entry's name for comparison purposes.
+	 * @param idx FST entry index (must be in range)
+	 * @return Name, or nullptr if an error occurred.
+	 */
+	const char *fst_entry_name(uint32_t idx) const final
+	{
+		return entry_name_fast(&fstEntries[idx]);
+	}
+
+	/**
+	 * Check if an FST entry is a directory.
+	 * @param idx		[in] FST entry index (must be in range)
+	 * @param pEndIdx	[out] If a directory, index *after* the last entry in the directory.
+	 * @return True if this is a directory; false if it's a regular file.
+	 */
+	bool fst_entry_is_dir(uint32_t idx, uint32_t *pEndIdx) const final
+	{
+		const WUP_FST_Entry *const fst_entry = &fstEntries[idx];
+		if (!is_dir(fst_entry))
+			return false;
+		*pEndIdx = be32_to_cpu(fst_entry->dir.next_offset);
+		return true;
+	}
 };
 
 /** WiiUFstPrivate **/
@@ -237,6 +295,32 @@ inline const char *WiiUFstPrivate::entry_name(const WUP_FST_Entry *fst_entry) co
 	return iter->second.c_str();
 }
 
+/**
+ * Get an FST entry's name for comparison purposes.
+ * ASCII names are returned directly from the string table,
+ * since they're the same in cp1252, Shift-JIS, and UTF-8.
+ * Other names are converted using entry_name().
+ * @param fst_entry FST entry.
+ * @return Name, or nullptr if an error occurred.
+ */
+inline const char *WiiUFstPrivate::entry_name_fast(const WUP_FST_Entry *fst_entry) const
+{
+	const uint32_t offset = be32_to_cpu(fst_entry->file_type_name_offset) & 0xFFFFFF;
+	if (offset >= string_table_sz) {
+		// Out of range.
+		return nullptr;
+	}
+
+	const char *const str = &string_table_ptr[offset];
+	for (const char *p = str; *p != '\0'; p++) {
+		if (static_cast<uint8_t>(*p) >= 0x80) {
+			// Not ASCII.
+			return entry_name(fst_entry);
+		}
+	}
+	return str;
+}
+
 /**
  * Get an FST entry.
  *
@@ -274,11 +358,12 @@ const WUP_FST_Entry *WiiUFstPrivate::entry(int idx, const char **ppszName) const
 }
 
 /**
- * Find a path.
+ * Find a path by scanning the FST.
+ * This is used if the path index can't be used.
  * @param path Path. (Absolute paths only!)
  * @return fst_entry if found, or nullptr if not.
  */
-const WUP_FST_Entry *WiiUFstPrivate::find_path(const char *path) const
+const WUP_FST_Entry *WiiUFstPrivate::find_path_linear(const char *path) const
 {
 	if (!path) {
 		// Invalid path.
@@ -361,12 +446,12 @@ const WUP_FST_Entry *WiiUFstPrivate::find_path(const char *path) const
 			}
 			idx_already.insert(idx);
 
-			const char *pName;
-			fst_entry = this->entry(idx, &pName);
+			fst_entry = this->entry(idx);
 			if (!fst_entry) {
 				// Invalid path.
 				return nullptr;
 			}
+			const char *const pName = entry_name_fast(fst_entry);
 
 			// TODO: Is Wii U case-sensitive?
 			if (pName && !strcmp(path_component.c_str(), pName)) {
@@ -409,6 +494,43 @@ const WUP_FST_Entry *WiiUFstPrivate::find_path(const char *path) const
 	return fst_entry;
 }
 
+/**
+ * Find a path.
+ * @param path Path. (Absolute paths only!)
+ * @return fst_entry if found, or nullptr if not.
+ */
+const WUP_FST_Entry *WiiUFstPrivate::find_path(const char *path) const
+{
+	if (!path) {
+		// Invalid path.
+		return nullptr;
+	}
+
+	// Get the root directory.
+	const WUP_FST_Entry *const root_entry = this->entry(0, nullptr);
+	if (!root_entry) {
+		// Can't find the root directory.
+		return nullptr;
+	}
+
+	const string s_path = FstPathIndex::normalize_path(path);
+	if (s_path.empty()) {
+		// Empty path or "/".
+		// Return the root directory.
+		return root_entry;
+	}
+
+	const int idx = pathIndex.find(*this, s_path);
+	if (idx == FstPathIndex::USE_LINEAR) {
+		// Path index is not available for this path.
+		return find_path_linear(path);
+	} else if (idx < 0) {
+		// Not found.
+		return nullptr;
+	}
+	return &fstEntries[idx];
+}
+
 /** WiiUFst **/
 
 /**
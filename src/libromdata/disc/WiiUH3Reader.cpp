@@ -6,8 +6,6 @@
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
-// TODO: Hash validation?
-
 #include "stdafx.h"
 #include "config.librpbase.h"
 
@@ -15,6 +13,7 @@
 #include "Console/wiiu_structs.h"
 
 // librpbase
+#include "librpbase/crypto/Hash.hpp"
 #ifdef ENABLE_DECRYPTION
 #  include "librpbase/crypto/IAesCipher.hpp"
 #  include "librpbase/crypto/AesCipherFactory.hpp"
@@ -23,10 +22,18 @@ using namespace LibRpBase;
 using namespace LibRpFile;
 
 // C++ STL classes
+using std::array;
 using std::unique_ptr;
 
 namespace LibRomData {
 
+// Hash tree layout
+// Each H0 table covers 16 blocks (1 MB), each H1 table covers
+// 256 blocks (16 MB), and each H2 table covers 4096 blocks (256 MB).
+#define BLOCKS_PER_H0 16
+#define BLOCKS_PER_H1 (BLOCKS_PER_H0 * 16)
+#define BLOCKS_PER_H2 (BLOCKS_PER_H1 * 16)
+
 class WiiUH3ReaderPrivate final
 {
 public:
@@ -61,7 +68,39 @@ public:
 public:
 	// AES cipher for this content file's encryption key
 	IAesCipher *cipher;
-#endif
+
+	// Encryption key
+	// Needed to create ciphers for hash tree verification.
+	array<uint8_t, 16> key;
+
+	/**
+	 * Hash tree verification worker.
+	 * Decrypts each block, then checks its hashes.
+	 */
+	class HashTreeWorker final : public HashTreeVerifier::Worker {
+	public:
+		HashTreeWorker(const uint8_t *pH3, size_t h3Len)
+			: sha1(Hash::Algorithm::SHA1)
+			, h3(pH3)
+			, h3Len(h3Len)
+		{}
+
+	public:
+		unique_ptr<IAesCipher> cipher;
+		Hash sha1;
+		const uint8_t *const h3;	// H3 table (owned by the caller)
+		const size_t h3Len;		// Length of h3, in bytes
+
+	public:
+		/**
+		 * Verify a single block.
+		 * @param block_num	[in] Block number
+		 * @param block		[in/out] Encrypted block (decrypted in place)
+		 * @return True if the block is valid; false if not.
+		 */
+		bool verifyBlock(uint32_t block_num, uint8_t *block) final;
+	};
+#endif /* ENABLE_DECRYPTION */
 };
 
 /** WiiUH3ReaderPrivate **/
@@ -76,6 +115,10 @@ WiiUH3ReaderPrivate::WiiUH3ReaderPrivate(WiiUH3Reader *q, const uint8_t *pKey, s
 	, cipher(nullptr)
 #endif /* ENABLE_DECRYPTION */
 {
+#ifdef ENABLE_DECRYPTION
+	key.fill(0);
+#endif /* ENABLE_DECRYPTION */
+
 	// Key must be 128-bit.
 	assert(pKey != nullptr);
 	assert(keyLen == 16);
@@ -96,7 +139,8 @@ WiiUH3ReaderPrivate::WiiUH3ReaderPrivate(WiiUH3Reader *q, const uint8_t *pKey, s
 	}
 
 	// Set parameters.
-	// NOTE: We don't need to save the key separately.
+	// NOTE: The key is saved for hash tree verification.
+	memcpy(key.data(), pKey, key.size());
 	int ret = cipher->setKey(pKey, keyLen);
 	ret |= cipher->setChainingMode(IAesCipher::ChainingMode::CBC);
 	if (ret != 0) {
@@ -185,6 +229,38 @@ int WiiUH3ReaderPrivate::readSector(uint32_t sector_num)
 	return 0;
 }
 
+#ifdef ENABLE_DECRYPTION
+/**
+ * Verify a single block.
+ * @param block_num	[in] Block number
+ * @param block		[in/out] Encrypted block (decrypted in place)
+ * @return True if the block is valid; false if not.
+ */
+bool WiiUH3ReaderPrivate::HashTreeWorker::verifyBlock(uint32_t block_num, uint8_t *block)
+{
+	WUP_H3_Content_Block *const pBlock = reinterpret_cast<WUP_H3_Content_Block*>(block);
+
+	// Decrypt the hashes. (IV is zero)
+	static const uint8_t iv_zero[16] = {0};
+	if (cipher->decrypt(reinterpret_cast<uint8_t*>(&pBlock->hashes), sizeof(pBlock->hashes),
+	                    iv_zero, sizeof(iv_zero)) != sizeof(pBlock->hashes))
+	{
+		// Decryption failed.
+		return false;
+	}
+
+	// Decrypt the data. (IV is hashes.h0[block_num % 16].)
+	uint8_t iv_data[16];
+	memcpy(iv_data, pBlock->hashes.h0[block_num % BLOCKS_PER_H0], sizeof(iv_data));
+	if (cipher->decrypt(pBlock->data, sizeof(pBlock->data), iv_data, sizeof(iv_data)) != sizeof(pBlock->data)) {
+		// Decryption failed.
+		return false;
+	}
+
+	return WiiUH3Reader::verifyBlockHashes(sha1, block_num, block, h3, h3Len);
+}
+#endif /* ENABLE_DECRYPTION */
+
 /** WiiUH3Reader **/
 
 /**
@@ -395,4 +471,122 @@ off64_t WiiUH3Reader::partition_size_used(void) const
 	return d->partition_size;
 }
 
+/** Hash tree verification **/
+
+/**
+ * Verify the content's hash tree against an H3 table.
+ *
+ * Every block is read and decrypted, and its H0, H1, and H2
+ * hashes are checked, along with the H3 table entry for its
+ * 256 MB group. Blocks are decrypted and hashed on worker threads.
+ *
+ * NOTE: The H3 table itself should be checked against the TMD
+ * by the caller.
+ *
+ * @param pH3		[in] H3 table (usually loaded from the content's .h3 file)
+ * @param h3Len		[in] Length of pH3, in bytes
+ * @param result	[out] Results
+ * @param progressFn	[in,opt] Progress callback
+ * @param userdata	[in,opt] User data for the progress callback
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WiiUH3Reader::verifyHashTree(const uint8_t *pH3, size_t h3Len, HashTreeResult &result,
+	VerifyProgressFn progressFn, void *userdata)
+{
+	result.blocks = 0;
+	result.badBlocks.clear();
+
+	assert(pH3 != nullptr);
+	if (!pH3) {
+		return -EINVAL;
+	} else if (!m_file || !m_file->isOpen()) {
+		return -EBADF;
+	}
+
+#ifdef ENABLE_DECRYPTION
+	RP_D(const WiiUH3Reader);
+	const uint32_t total = static_cast<uint32_t>(d->partition_size / WUP_H3_SECTOR_SIZE_ENCRYPTED);
+
+	HashTreeVerifier verifier(WUP_H3_SECTOR_SIZE_ENCRYPTED, BLOCKS_PER_H0);
+	const unsigned int workerCount = verifier.workerCount();
+	for (unsigned int i = 0; i < workerCount; i++) {
+		unique_ptr<WiiUH3ReaderPrivate::HashTreeWorker> worker(
+			new WiiUH3ReaderPrivate::HashTreeWorker(pH3, h3Len));
+		if (!worker->sha1.isUsable()) {
+			return -ENOTSUP;
+		}
+
+		// Each worker needs its own cipher, since the
+		// CBC state can't be shared between threads.
+		worker->cipher.reset(AesCipherFactory::create());
+		if (!worker->cipher || !worker->cipher->isInit() ||
+		    worker->cipher->setKey(d->key.data(), d->key.size()) != 0 ||
+		    worker->cipher->setChainingMode(IAesCipher::ChainingMode::CBC) != 0)
+		{
+			return -EIO;
+		}
+		verifier.addWorker(worker.release());
+	}
+
+	const int ret = verifier.run(m_file, 0, total, result, progressFn, userdata);
+	if (ret == -EIO) {
+		m_lastError = EIO;
+	}
+	return ret;
+#else /* !ENABLE_DECRYPTION */
+	// Decryption and SHA-1 are not available.
+	RP_UNUSED(h3Len);
+	RP_UNUSED(progressFn);
+	RP_UNUSED(userdata);
+	return -ENOTSUP;
+#endif /* ENABLE_DECRYPTION */
+}
+
+/**
+ * Verify a decrypted block's H0, H1, H2, and H3 hashes.
+ * This is the per-block check used by verifyHashTree().
+ * @param sha1		[in] SHA-1 hash object
+ * @param block_num	[in] Block number
+ * @param block		[in] Decrypted block (WUP_H3_Content_Block)
+ * @param pH3		[in] H3 table
+ * @param h3Len		[in] Length of pH3, in bytes
+ * @return True if the block is valid; false if not.
+ */
+bool WiiUH3Reader::verifyBlockHashes(Hash &sha1, uint32_t block_num,
+	const uint8_t *block, const uint8_t *pH3, size_t h3Len)
+{
+	const WUP_H3_Content_Block *const pBlock = reinterpret_cast<const WUP_H3_Content_Block*>(block);
+	uint8_t digest[20];
+
+	// H0: Hash of this block's data.
+	sha1.reset();
+	sha1.process(pBlock->data, sizeof(pBlock->data));
+	sha1.getHash(digest, sizeof(digest));
+	if (memcmp(digest, pBlock->hashes.h0[block_num % BLOCKS_PER_H0], sizeof(digest)) != 0)
+		return false;
+
+	// H1: Hash of this block's H0 table.
+	sha1.reset();
+	sha1.process(pBlock->hashes.h0, sizeof(pBlock->hashes.h0));
+	sha1.getHash(digest, sizeof(digest));
+	if (memcmp(digest, pBlock->hashes.h1[(block_num / BLOCKS_PER_H0) % 16], sizeof(digest)) != 0)
+		return false;
+
+	// H2: Hash of this block's H1 table.
+	sha1.reset();
+	sha1.process(pBlock->hashes.h1, sizeof(pBlock->hashes.h1));
+	sha1.getHash(digest, sizeof(digest));
+	if (memcmp(digest, pBlock->hashes.h2[(block_num / BLOCKS_PER_H1) % 16], sizeof(digest)) != 0)
+		return false;
+
+	// H3: Hash of this block's H2 table.
+	const uint32_t h3_idx = block_num / BLOCKS_PER_H2;
+	if (h3_idx >= h3Len / 20)
+		return false;
+	sha1.reset();
+	sha1.process(pBlock->hashes.h2, sizeof(pBlock->hashes.h2));
+	sha1.getHash(digest, sizeof(digest));
+	return (memcmp(digest, &pH3[h3_idx * 20], sizeof(digest)) == 0);
+}
+
 }
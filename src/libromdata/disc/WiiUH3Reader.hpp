@@ -9,8 +9,13 @@
 #pragma once
 
 #include "librpbase/config.librpbase.h"
-#include "librpbase/disc/IDiscReader.hpp"
+#include "librpbase/disc/IPartition.hpp"
 #include "librpfile/IRpFile.hpp"
+#include "HashTreeVerifier.hpp"
+
+namespace LibRpBase {
+	class Hash;
+}
 
 namespace LibRomData {
 
@@ -84,6 +89,48 @@ public:
 	 * @return Used partition size, or -1 on error.
 	 */
 	off64_t partition_size_used(void) const override;
+
+public:
+	/** Hash tree verification **/
+
+	// Block numbers are 64 KB blocks, relative to the start of the content.
+	typedef HashTreeVerifier::BadBlockRange BadBlockRange;
+	typedef HashTreeVerifier::Result HashTreeResult;
+	typedef HashTreeVerifier::ProgressFn VerifyProgressFn;
+
+	/**
+	 * Verify the content's hash tree against an H3 table.
+	 *
+	 * Every block is read and decrypted, and its H0, H1, and H2
+	 * hashes are checked, along with the H3 table entry for its
+	 * 256 MB group. Blocks are decrypted and hashed on worker threads.
+	 *
+	 * NOTE: The H3 table itself should be checked against the TMD
+	 * by the caller.
+	 *
+	 * @param pH3		[in] H3 table (usually loaded from the content's .h3 file)
+	 * @param h3Len		[in] Length of pH3, in bytes
+	 * @param result	[out] Results
+	 * @param progressFn	[in,opt] Progress callback
+	 * @param userdata	[in,opt] User data for the progress callback
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int verifyHashTree(const uint8_t *pH3, size_t h3Len, HashTreeResult &result,
+		VerifyProgressFn progressFn = nullptr, void *userdata = nullptr);
+
+	/**
+	 * Verify a decrypted block's H0, H1, H2, and H3 hashes.
+	 * This is the per-block check used by verifyHashTree().
+	 * @param sha1		[in] SHA-1 hash object
+	 * @param block_num	[in] Block number
+	 * @param block		[in] Decrypted block (WUP_H3_Content_Block)
+	 * @param pH3		[in] H3 table
+	 * @param h3Len		[in] Length of pH3, in bytes
+	 * @return True if the block is valid; false if not.
+	 */
+	RP_LIBROMDATA_PUBLIC
+	static bool verifyBlockHashes(LibRpBase::Hash &sha1, uint32_t block_num,
+		const uint8_t *block, const uint8_t *pH3, size_t h3Len);
 };
 
 typedef std::shared_ptr<WiiUH3Reader> WiiUH3ReaderPtr;
@@ -300,6 +300,7 @@ const rp::uvector<uint8_t> *XDVDFSPartitionPrivate::getDirectory(const char *pat
 	}
 
 	// Read the directory.
+	q->m_file->prefetch(dir_addr, dir_size);
 	rp::uvector<uint8_t> dirTable(dir_size);
 	size_t size = q->m_file->seekAndRead(dir_addr, dirTable.data(), dirTable.size());
 	if (size != dirTable.size()) {
@@ -420,6 +421,26 @@ off64_t XDVDFSPartition::size(void)
 	return d->partition_size;
 }
 
+/**
+ * Announce that a range of the partition will be read soon.
+ * The partition position is not changed.
+ * @param pos	[in] Starting position
+ * @param size	[in] Size of the range, in bytes
+ * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+ */
+int XDVDFSPartition::prefetch(off64_t pos, off64_t size)
+{
+	RP_D(const XDVDFSPartition);
+	if (!m_file || !m_file->isOpen()) {
+		return -EBADF;
+	} else if (pos < 0 || size < 0) {
+		return -EINVAL;
+	}
+
+	// XDVDFS partitions are stored as-is.
+	return m_file->prefetch(d->partition_offset + pos, size);
+}
+
 /** IPartition **/
 
 /**
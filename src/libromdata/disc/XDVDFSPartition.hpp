@@ -74,6 +74,15 @@ public:
 	 */
 	off64_t size(void) final;
 
+	/**
+	 * Announce that a range of the partition will be read soon.
+	 * The partition position is not changed.
+	 * @param pos	[in] Starting position
+	 * @param size	[in] Size of the range, in bytes
+	 * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+	 */
+	int prefetch(off64_t pos, off64_t size) final;
+
 public:
 	/** IPartition **/
 
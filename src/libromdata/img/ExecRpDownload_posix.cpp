@@ -10,8 +10,19 @@
 #include "config.libromdata.h"
 #include "CacheManager.hpp"
 
+// Other rom-properties libraries
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/Semaphore.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+using LibRpThreads::Semaphore;
+
 // OS-specific includes.
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
 #include <signal.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -19,36 +30,55 @@
 # include <spawn.h>
 #endif /* HAVE_POSIX_SPAWN */
 
+// C includes. (C++ namespace)
+#include <ctime>
+
 // C++ includes.
 #include <string>
+#include <vector>
 using std::string;
+using std::vector;
+
+#ifndef MSG_NOSIGNAL
+// MSG_NOSIGNAL isn't available on Mac OS X.
+// TODO: Use SO_NOSIGPIPE instead.
+#  define MSG_NOSIGNAL 0
+#endif /* MSG_NOSIGNAL */
 
 namespace LibRomData {
 
+// TODO: Mac OS X path. (bundle?)
+static constexpr char rp_download_exe[] = DIR_INSTALL_LIBEXEC "/rp-download";
+
+// rp-download timeout, in milliseconds.
+// TODO: User-configurable timeout?
+static constexpr int RP_DOWNLOAD_TIMEOUT = 10*1000;
+
 /**
- * Execute rp-download. (POSIX version)
- * @param filteredCacheKey Filtered cache key.
- * @return 0 on success; negative POSIX error code on error.
+ * Get the current monotonic time.
+ * @return Monotonic time, in milliseconds.
  */
-int CacheManager::execRpDownload(const string &filteredCacheKey)
+static int64_t getMonotonicTimeMs(void)
 {
-	// TODO: Mac OS X path. (bundle?)
- 	static constexpr char rp_download_exe[] = DIR_INSTALL_LIBEXEC "/rp-download";
-
-	// Parameters.
-	const char *const argv[3] = {
-		rp_download_exe,
-		filteredCacheKey.c_str(),
-		nullptr
-	};
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (static_cast<int64_t>(ts.tv_sec) * 1000) + (ts.tv_nsec / 1000000);
+}
 
+/**
+ * Build a minimal environment for rp-download.
+ * This will include http_proxy and https_proxy if the proxy URL is set.
+ * @param s_env		[out] Environment variables (NULL-separated)
+ * @param envp		[out] Environment variable pointers (NULL-terminated)
+ * @param proxyUrl	[in] Proxy URL (empty for the system default)
+ */
+static void buildEnv(string &s_env, const char *envp[5], const string &proxyUrl)
+{
 	// Define a minimal environment for cURL.
-	// This will include http_proxy and https_proxy if the proxy URL is set.
 	// TODO: Separate proxies for http and https?
-	// TODO: Only build this once?
 	int pos[5] = {-1, -1, -1, -1, -1};
 	int count = 0;
-	std::string s_env;
+	s_env.clear();
 	s_env.reserve(1024);
 
 	// We want the HOME and USER variables.
@@ -68,7 +98,7 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 		s_env += envtmp;
 		s_env += '\0';
 	}
-	if (m_proxyUrl.empty()) {
+	if (proxyUrl.empty()) {
 		// Proxy URL is empty. Get the URLs from the environment.
 		envtmp = getenv("http_proxy");
 		if (envtmp && envtmp[0] != '\0') {
@@ -87,50 +117,100 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	} else {
 		// Proxy URL is set. Use it.
 		pos[count++] = static_cast<int>(s_env.size());
-		s_env += "http_proxy=" + m_proxyUrl;
+		s_env += "http_proxy=" + proxyUrl;
+		s_env += '\0';
 		pos[count++] = static_cast<int>(s_env.size());
-		s_env += "https_proxy=" + m_proxyUrl;
+		s_env += "https_proxy=" + proxyUrl;
+		s_env += '\0';
 	}
 
 	// Build envp.
-	const char *envp[5] = {nullptr, nullptr, nullptr, nullptr, nullptr};
 	unsigned int envp_idx = 0;
 	for (unsigned int i = 0; i < 5; i++) {
+		envp[i] = nullptr;
 		if (pos[i] >= 0) {
 			envp[envp_idx++] = &s_env[pos[i]];
 		}
 	}
+}
 
-	// TODO: Maybe we should close file handles...
-#ifdef HAVE_POSIX_SPAWN
-	// posix_spawn()
-	errno = 0;
-	pid_t pid;
-	int ret = posix_spawn(&pid, rp_download_exe,
-		nullptr,	// file_actions
-		nullptr,	// attrp
-		(char *const *)argv, (char *const *)envp);
+/**
+ * Create a socket pair for communicating with rp-download.
+ * Both sockets will have the close-on-exec flag set.
+ * @param sv	[out] Sockets
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int createSocketPair(int sv[2])
+{
+#ifdef SOCK_CLOEXEC
+	int ret = socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv);
+#else /* !SOCK_CLOEXEC */
+	int ret = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+	if (ret == 0) {
+		fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+		fcntl(sv[1], F_SETFD, FD_CLOEXEC);
+	}
+#endif /* SOCK_CLOEXEC */
 	if (ret != 0) {
-		// Error creating the child process.
 		int err = errno;
 		if (err == 0) {
 			err = EIO;
 		}
 		return -err;
 	}
+	return 0;
+}
+
+/**
+ * Spawn rp-download.
+ * @param argv		[in] Arguments
+ * @param envp		[in] Environment
+ * @param fd		[in] Socket to use for rp-download's stdout
+ * @param use_stdin	[in] If true, also use the socket for rp-download's stdin.
+ * @param pPid		[out] Process ID
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int spawnRpDownload(const char *const *argv, const char *const *envp,
+	int fd, bool use_stdin, pid_t *pPid)
+{
+	// TODO: Maybe we should close file handles...
+#ifdef HAVE_POSIX_SPAWN
+	// posix_spawn()
+	// NOTE: dup2() clears the close-on-exec flag.
+	posix_spawn_file_actions_t file_actions;
+	int ret = posix_spawn_file_actions_init(&file_actions);
+	if (ret != 0) {
+		return -ret;
+	}
+	ret = posix_spawn_file_actions_adddup2(&file_actions, fd, STDOUT_FILENO);
+	if (ret == 0 && use_stdin) {
+		ret = posix_spawn_file_actions_adddup2(&file_actions, fd, STDIN_FILENO);
+	}
+	if (ret == 0) {
+		ret = posix_spawn(pPid, rp_download_exe,
+			&file_actions,
+			nullptr,	// attrp
+			(char *const *)argv, (char *const *)envp);
+	}
+	posix_spawn_file_actions_destroy(&file_actions);
+	if (ret != 0) {
+		// Error creating the child process.
+		return -ret;
+	}
 #else /* !HAVE_POSIX_SPAWN */
 	// fork()/execve().
 	errno = 0;
 	pid_t pid = fork();
 	if (pid == 0) {
 		// Child process.
-		int ret = execve(rp_download_exe, (char *const *)argv, (char *const *)envp);
-		if (ret != 0) {
-			// execve() failed.
-			exit(EXIT_FAILURE);
+		if (dup2(fd, STDOUT_FILENO) < 0 ||
+		    (use_stdin && dup2(fd, STDIN_FILENO) < 0))
+		{
+			_exit(EXIT_FAILURE);
 		}
-		assert(!"Shouldn't get here...");
-		exit(EXIT_FAILURE);
+		execve(rp_download_exe, (char *const *)argv, (char *const *)envp);
+		// execve() failed.
+		_exit(EXIT_FAILURE);
 	} else if (pid == -1) {
 		// fork() failed.
 		int err = errno;
@@ -139,50 +219,477 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 		}
 		return -err;
 	}
+	*pPid = pid;
 #endif /* HAVE_POSIX_SPAWN */
 
+	return 0;
+}
+
+/**
+ * Persistent rp-download worker. ("rp-download -s")
+ *
+ * Cache keys are sent to rp-download over a socket, one per line.
+ * rp-download replies with "OK cache_key" or "ERR cache_key" once
+ * the cache key has been processed. rp-download keeps its connections
+ * alive between downloads, and can download several files at once.
+ *
+ * A reader thread waits for replies and wakes up the threads that
+ * requested the cache keys. The reader thread exits when rp-download
+ * exits, e.g. due to its idle timeout.
+ */
+class RpDownloadWorker
+{
+public:
+	RpDownloadWorker()
+		: m_proc(nullptr)
+		, m_disabled(false)
+	{}
+
+private:
+	RP_DISABLE_COPY(RpDownloadWorker)
+
+public:
+	/**
+	 * Download a file using the rp-download worker.
+	 * @param cache_key	[in] Cache key
+	 * @param s_env		[in] Environment variables (NULL-separated)
+	 * @param envp		[in] Environment variable pointers (NULL-terminated)
+	 * @return 0 on success; 1 if rp-download failed; negative POSIX error code if the worker couldn't be used.
+	 */
+	int download(const string &cache_key, const string &s_env, const char *const *envp);
+
+private:
+	// Thread waiting for a cache key.
+	struct Waiter {
+		const string &cache_key;
+		int64_t deadline;	// Monotonic time, in milliseconds
+		int status;		// Result code for download()
+		Semaphore sem;		// Released once the cache key has been processed
+
+		Waiter(const string &cache_key, int64_t deadline)
+			: cache_key(cache_key)
+			, deadline(deadline)
+			, status(-EIO)
+			, sem(0)
+		{}
+	};
+
+	// rp-download process.
+	struct Process {
+		RpDownloadWorker *worker;
+		pid_t pid;
+		int fd;			// Owned by the reader thread
+		string s_env;		// Environment used to start the process
+		vector<Waiter*> waiters;
+		unsigned int replies;	// Number of replies received
+	};
+
+	/**
+	 * Start a new rp-download worker process.
+	 * m_mutex must be locked by the caller.
+	 * @param s_env	[in] Environment variables (NULL-separated)
+	 * @param envp	[in] Environment variable pointers (NULL-terminated)
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int startProcess(const string &s_env, const char *const *envp);
+
+	/**
+	 * Reader thread.
+	 * @param param Process
+	 * @return nullptr
+	 */
+	static void *readerThread(void *param);
+
+	/**
+	 * Handle a reply line from rp-download.
+	 * m_mutex must be locked by the caller.
+	 * @param proc Process
+	 * @param line Reply line
+	 */
+	static void handleReply(Process *proc, const string &line);
+
+	/**
+	 * Wake up waiters with the specified status.
+	 * m_mutex must be locked by the caller.
+	 * @param proc Process
+	 * @param status Status
+	 * @param deadline If non-zero, only wake up waiters whose deadline is before this time.
+	 */
+	static void wakeWaiters(Process *proc, int status, int64_t deadline = 0);
+
+private:
+	Mutex m_mutex;
+	Process *m_proc;	// Current rp-download process
+	bool m_disabled;	// Set if the worker failed to start properly
+};
+
+/**
+ * Download a file using the rp-download worker.
+ * @param cache_key	[in] Cache key
+ * @param s_env		[in] Environment variables (NULL-separated)
+ * @param envp		[in] Environment variable pointers (NULL-terminated)
+ * @return 0 on success; 1 if rp-download failed; negative POSIX error code if the worker couldn't be used.
+ */
+int RpDownloadWorker::download(const string &cache_key, const string &s_env, const char *const *envp)
+{
+	Waiter waiter(cache_key, getMonotonicTimeMs() + RP_DOWNLOAD_TIMEOUT);
+
+	{
+		MutexLocker locker(m_mutex);
+		if (m_disabled) {
+			// Worker mode isn't supported by rp-download.
+			return -ENOTSUP;
+		}
+
+		if (m_proc && m_proc->s_env != s_env) {
+			// The environment has changed, e.g. due to a new proxy.
+			// Let the current worker finish its downloads and
+			// start a new worker.
+			shutdown(m_proc->fd, SHUT_WR);
+			m_proc = nullptr;
+		}
+		if (!m_proc) {
+			int ret = startProcess(s_env, envp);
+			if (ret != 0) {
+				return ret;
+			}
+		}
+
+		// Send the cache key.
+		string line;
+		line.reserve(cache_key.size() + 1);
+		line = cache_key;
+		line += '\n';
+		const char *p = line.data();
+		size_t size = line.size();
+		while (size > 0) {
+			ssize_t ret = send(m_proc->fd, p, size, MSG_NOSIGNAL);
+			if (ret < 0) {
+				if (errno == EINTR)
+					continue;
+				// rp-download probably exited due to its idle timeout.
+				// The reader thread will clean it up.
+				shutdown(m_proc->fd, SHUT_WR);
+				m_proc = nullptr;
+				return -EPIPE;
+			}
+			p += ret;
+			size -= ret;
+		}
+
+		m_proc->waiters.push_back(&waiter);
+	}
+
+	// Wait for the reader thread.
+	waiter.sem.obtain();
+	return waiter.status;
+}
+
+/**
+ * Start a new rp-download worker process.
+ * m_mutex must be locked by the caller.
+ * @param s_env	[in] Environment variables (NULL-separated)
+ * @param envp	[in] Environment variable pointers (NULL-terminated)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpDownloadWorker::startProcess(const string &s_env, const char *const *envp)
+{
+	int sv[2];
+	int ret = createSocketPair(sv);
+	if (ret != 0) {
+		return ret;
+	}
+
+	// Parameters.
+	const char *const argv[3] = {
+		rp_download_exe,
+		"-s",
+		nullptr
+	};
+
+	pid_t pid;
+	ret = spawnRpDownload(argv, envp, sv[1], true, &pid);
+	close(sv[1]);
+	if (ret != 0) {
+		close(sv[0]);
+		m_disabled = true;
+		return ret;
+	}
+
+	Process *const proc = new Process;
+	proc->worker = this;
+	proc->pid = pid;
+	proc->fd = sv[0];
+	proc->s_env = s_env;
+	proc->replies = 0;
+
+	// Create a detached reader thread.
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	pthread_t thread;
+	ret = pthread_create(&thread, &attr, readerThread, proc);
+	pthread_attr_destroy(&attr);
+	if (ret != 0) {
+		// Unable to create the reader thread.
+		close(proc->fd);
+		kill(pid, SIGTERM);
+		waitpid(pid, nullptr, 0);
+		delete proc;
+		return -ret;
+	}
+
+	m_proc = proc;
+	return 0;
+}
+
+/**
+ * Wake up waiters with the specified status.
+ * m_mutex must be locked by the caller.
+ * @param proc Process
+ * @param status Status
+ * @param deadline If non-zero, only wake up waiters whose deadline is before this time.
+ */
+void RpDownloadWorker::wakeWaiters(Process *proc, int status, int64_t deadline)
+{
+	for (auto iter = proc->waiters.begin(); iter != proc->waiters.end(); ) {
+		Waiter *const waiter = *iter;
+		if (deadline != 0 && waiter->deadline > deadline) {
+			++iter;
+			continue;
+		}
+
+		// NOTE: The waiter must be removed before releasing it,
+		// since it's owned by the waiting thread.
+		iter = proc->waiters.erase(iter);
+		waiter->status = status;
+		waiter->sem.release();
+	}
+}
+
+/**
+ * Handle a reply line from rp-download.
+ * m_mutex must be locked by the caller.
+ * @param proc Process
+ * @param line Reply line
+ */
+void RpDownloadWorker::handleReply(Process *proc, const string &line)
+{
+	// Reply format: "OK cache_key" or "ERR cache_key"
+	int status;
+	size_t key_pos;
+	if (!line.compare(0, 3, "OK ")) {
+		status = 0;
+		key_pos = 3;
+	} else if (!line.compare(0, 4, "ERR ")) {
+		status = 1;
+		key_pos = 4;
+	} else {
+		// Invalid reply.
+		return;
+	}
+	proc->replies++;
+
+	// Wake up all threads waiting for this cache key.
+	// NOTE: rp-download only replies once if the same cache key
+	// was requested multiple times before it was processed.
+	for (auto iter = proc->waiters.begin(); iter != proc->waiters.end(); ) {
+		Waiter *const waiter = *iter;
+		if (line.compare(key_pos, string::npos, waiter->cache_key) != 0) {
+			++iter;
+			continue;
+		}
+
+		iter = proc->waiters.erase(iter);
+		waiter->status = status;
+		waiter->sem.release();
+	}
+}
+
+/**
+ * Reader thread.
+ * @param param Process
+ * @return nullptr
+ */
+void *RpDownloadWorker::readerThread(void *param)
+{
+	Process *const proc = static_cast<Process*>(param);
+	RpDownloadWorker *const worker = proc->worker;
+
+	string linebuf;
+	char buf[1024];
+	bool eof = false;
+	while (!eof) {
+		// Time out any waiters that have passed their deadlines.
+		// NOTE: If there are no waiters, use the full timeout.
+		// New waiters always have a later deadline, so we'll
+		// wake up in time to check them.
+		int timeout = RP_DOWNLOAD_TIMEOUT;
+		{
+			MutexLocker locker(worker->m_mutex);
+			const int64_t now = getMonotonicTimeMs();
+			wakeWaiters(proc, -ETIMEDOUT, now);
+			for (const Waiter *waiter : proc->waiters) {
+				const int64_t remaining = waiter->deadline - now;
+				if (remaining < timeout) {
+					timeout = static_cast<int>(remaining);
+				}
+			}
+		}
+
+		// Wait for a reply from rp-download.
+		struct pollfd pfd;
+		pfd.fd = proc->fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		int ret = poll(&pfd, 1, timeout);
+		if (ret == 0 || (ret < 0 && errno == EINTR)) {
+			continue;
+		} else if (ret < 0) {
+			break;
+		}
+
+		const ssize_t size = read(proc->fd, buf, sizeof(buf));
+		if (size < 0 && errno == EINTR) {
+			continue;
+		} else if (size <= 0) {
+			// rp-download has exited, or an error occurred.
+			eof = (size == 0);
+			break;
+		}
+		linebuf.append(buf, static_cast<size_t>(size));
+
+		// Process all complete lines.
+		MutexLocker locker(worker->m_mutex);
+		size_t nl_pos;
+		while ((nl_pos = linebuf.find('\n')) != string::npos) {
+			handleReply(proc, linebuf.substr(0, nl_pos));
+			linebuf.erase(0, nl_pos + 1);
+		}
+	}
+
+	// Detach the process and wake up any remaining waiters.
+	unsigned int replies;
+	{
+		MutexLocker locker(worker->m_mutex);
+		if (worker->m_proc == proc) {
+			worker->m_proc = nullptr;
+		}
+		wakeWaiters(proc, -EIO);
+		replies = proc->replies;
+	}
+
+	close(proc->fd);
+	if (!eof) {
+		// An error occurred. Make sure rp-download exits.
+		kill(proc->pid, SIGTERM);
+	}
+	int wstatus = 0;
+	pid_t wpid;
+	do {
+		wpid = waitpid(proc->pid, &wstatus, 0);
+	} while (wpid < 0 && errno == EINTR);
+
+	if (replies == 0 && wpid == proc->pid &&
+	    (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0))
+	{
+		// rp-download failed without processing anything.
+		// Worker mode is probably not supported.
+		MutexLocker locker(worker->m_mutex);
+		worker->m_disabled = true;
+	}
+
+	delete proc;
+	return nullptr;
+}
+
+/**
+ * Get the rp-download worker.
+ * @return rp-download worker
+ */
+static RpDownloadWorker *getRpDownloadWorker(void)
+{
+	// NOTE: The worker is never deleted, since the reader thread
+	// may still be running when the process exits.
+	static RpDownloadWorker *const worker = new RpDownloadWorker();
+	return worker;
+}
+
+/**
+ * Execute rp-download once for a single cache key.
+ * @param filteredCacheKey	[in] Filtered cache key
+ * @param envp			[in] Environment variable pointers (NULL-terminated)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int execRpDownloadOnce(const string &filteredCacheKey, const char *const *envp)
+{
+	// Parameters.
+	const char *const argv[3] = {
+		rp_download_exe,
+		filteredCacheKey.c_str(),
+		nullptr
+	};
+
+	// rp-download's stdout is connected to a socket.
+	// rp-download doesn't write anything to stdout, so the
+	// socket will be closed when rp-download exits.
+	int sv[2];
+	int ret = createSocketPair(sv);
+	if (ret != 0) {
+		return ret;
+	}
+
+	pid_t pid;
+	ret = spawnRpDownload(argv, envp, sv[1], false, &pid);
+	close(sv[1]);
+	if (ret != 0) {
+		close(sv[0]);
+		return ret;
+	}
+
 	// Parent process.
 	// Wait up to 10 seconds for the process to exit.
-	// TODO: User-configurable timeout?
 	// TODO: Report errors somewhere.
-	bool ok = false;	// rp-download terminated successfully.
-	bool waited = false;	// waitpid() was successful.
-	int wstatus = 0;
-	for (unsigned int i = 10*4; i > 0; i--) {
-		pid_t wpid = waitpid(pid, &wstatus, WNOHANG);
-		if (wpid == pid) {
-			// Process has changed state.
-			if (WIFEXITED(wstatus)) {
-				// Child process has exited.
-				// If the return status is non-zero, it failed.
-				if (WEXITSTATUS(wstatus) != 0) {
-					// Failure.
-					break;
-				}
-				// Success!
-				ok = true;
-				waited = true;
-				break;
-			} else if (WIFSIGNALED(wstatus)) {
-				// Child process terminated abnormally.
-				waited = true;
-				break;
-			}
+	const int64_t deadline = getMonotonicTimeMs() + RP_DOWNLOAD_TIMEOUT;
+	bool exited = false;
+	while (!exited) {
+		const int64_t remaining = deadline - getMonotonicTimeMs();
+		if (remaining <= 0) {
+			break;
 		}
 
-		// Wait 250ms before checking again.
-		usleep(250*1000);
+		struct pollfd pfd;
+		pfd.fd = sv[0];
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		ret = poll(&pfd, 1, static_cast<int>(remaining));
+		if (ret < 0 && errno != EINTR) {
+			break;
+		} else if (ret > 0) {
+			char buf[64];
+			const ssize_t size = read(sv[0], buf, sizeof(buf));
+			if (size == 0 || (size < 0 && errno != EINTR)) {
+				// Socket was closed.
+				exited = true;
+			}
+		}
 	}
+	close(sv[0]);
 
-	if (!waited) {
+	if (!exited) {
 		// Process did not complete.
-		// TODO: Prevent race conditions by using waitid() instead of waitpid()?
 		// TODO: Better error code?
 		kill(pid, SIGTERM);
+		waitpid(pid, nullptr, 0);
 		return -ECHILD;
 	}
 
-	if (!ok) {
+	int wstatus = 0;
+	pid_t wpid;
+	do {
+		wpid = waitpid(pid, &wstatus, 0);
+	} while (wpid < 0 && errno == EINTR);
+	if (wpid != pid || !WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0) {
 		// rp-download failed for some reason.
 		// TODO: Better error code?
 		return -EIO;
@@ -192,4 +699,38 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	return 0;
 }
 
+/**
+ * Execute rp-download. (POSIX version)
+ * @param filteredCacheKey Filtered cache key.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheManager::execRpDownload(const string &filteredCacheKey)
+{
+	string s_env;
+	const char *envp[5];
+	buildEnv(s_env, envp, m_proxyUrl);
+
+	// Use the persistent rp-download worker if possible.
+	if (filteredCacheKey.find_first_of("\r\n") == string::npos) {
+		int ret = getRpDownloadWorker()->download(filteredCacheKey, s_env, envp);
+		switch (ret) {
+			case 0:
+				// rp-download has successfully downloaded the file.
+				return 0;
+			case 1:
+				// rp-download failed for some reason.
+				// TODO: Better error code?
+				return -EIO;
+			case -ETIMEDOUT:
+				// rp-download did not complete in time.
+				return -ECHILD;
+			default:
+				// Worker isn't available. Run rp-download directly.
+				break;
+		}
+	}
+
+	return execRpDownloadOnce(filteredCacheKey, envp);
+}
+
 }
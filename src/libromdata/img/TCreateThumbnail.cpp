@@ -21,6 +21,7 @@
 #include "librpbase/RomFields.hpp"
 #include "librpbase/config/Config.hpp"
 #include "librpbase/img/RpImageLoader.hpp"
+#include "librpfile/FileSystem.hpp"
 #include "librpfile/RpFile.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
@@ -43,39 +44,135 @@ using std::unique_ptr;
 namespace LibRomData {
 
 /**
- * Get an internal image.
+ * Load an internal image as an rp_image.
  * @param romData	[in] RomData object
  * @param imageType	[in] Image type
- * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size
  * @param sBIT		[out,opt] sBIT metadata
- * @return Internal image, or null ImgClass on error.
+ * @return Internal image, or nullptr on error.
  */
 template<typename ImgClass>
-ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
+rp_image_const_ptr TCreateThumbnail<ImgClass>::loadInternalImage(
 	const RomDataPtr &romData,
 	RomData::ImageType imageType,
-	ImgSize *pOutSize,
 	rp_image::sBIT_t *sBIT)
 {
+	if (sBIT) {
+		memset(sBIT, 0, sizeof(*sBIT));
+	}
+
 	assert(imageType >= RomData::IMG_INT_MIN && imageType <= RomData::IMG_INT_MAX);
 	if (imageType < RomData::IMG_INT_MIN || imageType > RomData::IMG_INT_MAX) {
 		// Out of range.
-		if (sBIT) {
+		return nullptr;
+	}
+
+	// TODO: Multiple internal image sizes. [add reqSize]
+	rp_image_const_ptr image = romData->image(imageType);
+	if (!image || !image->isValid()) {
+		// No image.
+		return nullptr;
+	}
+
+	if (sBIT) {
+		// Get the sBIT metadata.
+		if (image->get_sBIT(sBIT) != 0) {
+			// No sBIT metadata.
+			// Clear the struct.
 			memset(sBIT, 0, sizeof(*sBIT));
 		}
-		return getNullImgClass();
 	}
+	return image;
+}
 
-	const rp_image_const_ptr image = romData->image(imageType);
-	if (!image) {
-		// No image.
-		if (sBIT) {
+/**
+ * Load the smallest IMG_INT_IMAGE mipmap level that is
+ * at least as large as the requested size.
+ * Only the selected mipmap level is decoded.
+ * @param romData	[in] RomData object
+ * @param reqSize	[in] Requested image size (single dimension; assuming square image)
+ * @param pFullSize	[out] Full image size (mipmap level 0)
+ * @param sBIT		[out,opt] sBIT metadata
+ * @return Mipmap image, or nullptr if the full image should be used instead.
+ */
+template<typename ImgClass>
+rp_image_const_ptr TCreateThumbnail<ImgClass>::loadInternalMipmap(
+	const RomDataPtr &romData,
+	int reqSize, ImgSize *pFullSize,
+	rp_image::sBIT_t *sBIT)
+{
+	assert(reqSize > 0);
+	assert(pFullSize != nullptr);
+
+	const int mipmapCount = romData->mipmapCount();
+	if (mipmapCount <= 1) {
+		// No mipmaps.
+		return nullptr;
+	}
+
+	int fullDims[2];
+	if (romData->getMipmapDimensions(0, fullDims) != 0) {
+		// Unable to get the full image size.
+		return nullptr;
+	}
+
+	// Find the smallest mipmap level whose larger dimension is
+	// still at least the requested size, so the thumbnail will
+	// only be downscaled.
+	int mipmapLevel = 0;
+	for (int i = 1; i < mipmapCount; i++) {
+		int dims[2];
+		if (romData->getMipmapDimensions(i, dims) != 0)
+			break;
+		if (dims[0] < reqSize && dims[1] < reqSize)
+			break;
+		mipmapLevel = i;
+	}
+	if (mipmapLevel == 0) {
+		// The full image is the best match.
+		return nullptr;
+	}
+
+	rp_image_const_ptr image = romData->mipmap(mipmapLevel);
+	if (!image || !image->isValid()) {
+		// Unable to load the mipmap.
+		// The full image will be used instead.
+		return nullptr;
+	}
+
+	if (sBIT) {
+		// Get the sBIT metadata.
+		if (image->get_sBIT(sBIT) != 0) {
+			// No sBIT metadata.
+			// Clear the struct.
 			memset(sBIT, 0, sizeof(*sBIT));
 		}
-		return getNullImgClass();
 	}
 
-	// TODO: Multiple internal image sizes. [add reqSize]
+	pFullSize->width = fullDims[0];
+	pFullSize->height = fullDims[1];
+	return image;
+}
+
+/**
+ * Get an internal image.
+ * @param romData	[in] RomData object
+ * @param imageType	[in] Image type
+ * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size
+ * @param sBIT		[out,opt] sBIT metadata
+ * @return Internal image, or null ImgClass on error.
+ */
+template<typename ImgClass>
+ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
+	const RomDataPtr &romData,
+	RomData::ImageType imageType,
+	ImgSize *pOutSize,
+	rp_image::sBIT_t *sBIT)
+{
+	const rp_image_const_ptr image = loadInternalImage(romData, imageType, sBIT);
+	if (!image) {
+		// No image.
+		return getNullImgClass();
+	}
 
 	// Convert the rp_image to ImgClass.
 	ImgClass ret_img = rpImageToImgClass(image);
@@ -89,33 +186,32 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 			// TODO: Check for errors?
 			getImgClassSize(ret_img, pOutSize);
 		}
-		if (sBIT) {
-			// Get the sBIT metadata.
-			if (image->get_sBIT(sBIT) != 0) {
-				// No sBIT metadata.
-				// Clear the struct.
-				memset(sBIT, 0, sizeof(*sBIT));
-			}
-		}
+	} else if (sBIT) {
+		memset(sBIT, 0, sizeof(*sBIT));
 	}
 	return ret_img;
 }
 
 /**
- * Get an external image.
+ * Load an external image as an rp_image.
+ *
+ * If pFullSize is specified, the image may be decoded at a
+ * reduced size that's still at least reqSize, and the full
+ * image size will be stored in pFullSize.
+ *
  * @param romData	[in] RomData object
  * @param imageType	[in] Image type
  * @param reqSize	[in] Requested image size
- * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size
  * @param sBIT		[out,opt] sBIT metadata
- * @return External image, or null ImgClass on error.
+ * @param pFullSize	[out,opt] Full image size
+ * @return External image, or nullptr on error.
  */
 template<typename ImgClass>
-ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
+rp_image_const_ptr TCreateThumbnail<ImgClass>::loadExternalImage(
 	const RomDataPtr &romData,
 	RomData::ImageType imageType,
-	int reqSize, ImgSize *pOutSize,
-	rp_image::sBIT_t *sBIT)
+	int reqSize, rp_image::sBIT_t *sBIT,
+	ImgSize *pFullSize)
 {
 	assert(imageType >= RomData::IMG_EXT_MIN && imageType <= RomData::IMG_EXT_MAX);
 	if (imageType < RomData::IMG_EXT_MIN || imageType > RomData::IMG_EXT_MAX) {
@@ -123,7 +219,7 @@ ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 		if (sBIT) {
 			memset(sBIT, 0, sizeof(*sBIT));
 		}
-		return getNullImgClass();
+		return nullptr;
 	}
 
 	// Synchronously download from the source URLs.
@@ -135,7 +231,7 @@ ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 		if (sBIT) {
 			memset(sBIT, 0, sizeof(*sBIT));
 		}
-		return getNullImgClass();
+		return nullptr;
 	}
 
 	// NOTE: This will force a configuration timestamp check.
@@ -177,29 +273,31 @@ ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 		// Attempt to load the image.
 		shared_ptr<RpFile> file = std::make_shared<RpFile>(cache_filename, RpFile::FM_OPEN_READ);
 		if (file->isOpen()) {
-			const rp_image_const_ptr dl_img = RpImageLoader::load(file);
+			rp_image_const_ptr dl_img;
+			int fullDims[2] = {0, 0};
+			if (pFullSize && reqSize > 0) {
+				// Decode at a reduced size if possible.
+				dl_img = RpImageLoader::load(file, reqSize, fullDims);
+			} else {
+				dl_img = RpImageLoader::load(file);
+			}
 			if (dl_img && dl_img->isValid()) {
 				// Image loaded successfully.
 				file->close();
-				ImgClass ret_img = rpImageToImgClass(dl_img);
-				if (isImgClassValid(ret_img)) {
-					// Image converted successfully.
-					if (pOutSize) {
-						// Get the image size.
-						pOutSize->width = dl_img->width();
-						pOutSize->height = dl_img->height();
-					}
-					// Get the sBIT metadata.
-					if (sBIT) {
-						if (dl_img->get_sBIT(sBIT) != 0) {
-							// No sBIT metadata.
-							// Clear the struct.
-							memset(sBIT, 0, sizeof(*sBIT));
-						}
+				if (pFullSize) {
+					pFullSize->width = fullDims[0];
+					pFullSize->height = fullDims[1];
+				}
+				// Get the sBIT metadata.
+				if (sBIT) {
+					if (dl_img->get_sBIT(sBIT) != 0) {
+						// No sBIT metadata.
+						// Clear the struct.
+						memset(sBIT, 0, sizeof(*sBIT));
 					}
-					// TODO: Transparency processing?
-					return ret_img;
 				}
+				// TODO: Transparency processing?
+				return dl_img;
 			}
 		}
 	}
@@ -208,7 +306,43 @@ ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 	if (sBIT) {
 		memset(sBIT, 0, sizeof(*sBIT));
 	}
-	return getNullImgClass();
+	return nullptr;
+}
+
+/**
+ * Get an external image.
+ * @param romData	[in] RomData object
+ * @param imageType	[in] Image type
+ * @param reqSize	[in] Requested image size
+ * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size
+ * @param sBIT		[out,opt] sBIT metadata
+ * @return External image, or null ImgClass on error.
+ */
+template<typename ImgClass>
+ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
+	const RomDataPtr &romData,
+	RomData::ImageType imageType,
+	int reqSize, ImgSize *pOutSize,
+	rp_image::sBIT_t *sBIT)
+{
+	const rp_image_const_ptr dl_img = loadExternalImage(romData, imageType, reqSize, sBIT);
+	if (!dl_img) {
+		// No image.
+		return getNullImgClass();
+	}
+
+	ImgClass ret_img = rpImageToImgClass(dl_img);
+	if (isImgClassValid(ret_img)) {
+		// Image converted successfully.
+		if (pOutSize) {
+			// Get the image size.
+			pOutSize->width = dl_img->width();
+			pOutSize->height = dl_img->height();
+		}
+	} else if (sBIT) {
+		memset(sBIT, 0, sizeof(*sBIT));
+	}
+	return ret_img;
 }
 
 /**
@@ -289,15 +423,22 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomDataPtr &romData, int reqS
 			return RPCT_ERROR_CANNOT_OPEN_SOURCE_FILE;
 	}
 
+	// NOTE: All rescaling is done using rp_image::scaled().
+	// The image is converted to ImgClass after rescaling.
+	rp_image_const_ptr img;
+
+	// Full image size, if the image was loaded at a reduced size.
+	ImgSize fullSize = {0, 0};
+
 	if (config->getBoolConfigOption_default(Config::BoolConfig::Downloads_UseIntIconForSmallSizes) && reqSize <= 48) {
 		// Check for an icon first.
 		// TODO: Define "small sizes" somewhere. (DPI independence?)
 		if (imgbf & RomData::IMGBF_INT_ICON) {
-			pOutParams->retImg = getInternalImage(romData, RomData::IMG_INT_ICON, &pOutParams->fullSize, &pOutParams->sBIT);
+			img = loadInternalImage(romData, RomData::IMG_INT_ICON, &pOutParams->sBIT);
 			imgpf = romData->imgpf(RomData::IMG_INT_ICON);
 			imgbf &= ~RomData::IMGBF_INT_ICON;
 
-			if (isImgClassValid(pOutParams->retImg)) {
+			if (img) {
 				// Image retrieved.
 				// TODO: Better method than goto?
 				goto skip_image_check;
@@ -323,17 +464,30 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomDataPtr &romData, int reqS
 		}
 
 		// This image may be present.
+		// NOTE: Images that are rescaled from the full image size
+		// must not be loaded at a reduced size.
+		imgpf = romData->imgpf(imgType);
+		const bool canReduce = (reqSize > 0) &&
+			!(imgpf & (RomData::IMGPF_RESCALE_RFT_DIMENSIONS_2 | RomData::IMGPF_RESCALE_ASPECT_8to7));
 		if (imgType <= RomData::IMG_INT_MAX) {
 			// Internal image.
-			pOutParams->retImg = getInternalImage(romData, imgType, &pOutParams->fullSize, &pOutParams->sBIT);
-			imgpf = romData->imgpf(imgType);
+			if (imgType == RomData::IMG_INT_IMAGE && canReduce) {
+				// If the texture has mipmaps, decode the smallest
+				// mipmap level that's large enough instead of
+				// decoding the full image and downscaling it.
+				img = loadInternalMipmap(romData, reqSize, &fullSize, &pOutParams->sBIT);
+			}
+			if (!img) {
+				img = loadInternalImage(romData, imgType, &pOutParams->sBIT);
+			}
 		} else {
 			// External image.
-			pOutParams->retImg = getExternalImage(romData, imgType, reqSize, &pOutParams->fullSize, &pOutParams->sBIT);
-			imgpf = romData->imgpf(imgType);
+			// JPEG images may be decoded at a reduced size.
+			img = loadExternalImage(romData, imgType, reqSize, &pOutParams->sBIT,
+				canReduce ? &fullSize : nullptr);
 		}
 
-		if (isImgClassValid(pOutParams->retImg)) {
+		if (img) {
 			// Image retrieved.
 			break;
 		}
@@ -344,16 +498,21 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomDataPtr &romData, int reqS
 		imgbf &= ~bf;
 	}
 
-	if (!isImgClassValid(pOutParams->retImg)) {
+	if (!img) {
 		// No image.
 		return RPCT_ERROR_SOURCE_FILE_NO_IMAGE;
 	}
 
 skip_image_check:
+	if (fullSize.width > 0 && fullSize.height > 0) {
+		// The image was loaded at a reduced size.
+		pOutParams->fullSize = fullSize;
+	} else {
+		pOutParams->fullSize.width = img->width();
+		pOutParams->fullSize.height = img->height();
+	}
 	if (pOutParams->fullSize.width <= 0 || pOutParams->fullSize.height <= 0) {
 		// Image size is invalid.
-		freeImgClass(pOutParams->retImg);
-		pOutParams->retImg = getNullImgClass();
 		return RPCT_ERROR_CANNOT_OPEN_SOURCE_FILE;
 	}
 
@@ -380,15 +539,16 @@ skip_image_check:
 				field[1]->data.dimensions[0],
 				field[1]->data.dimensions[1],
 			};
-			ImgClass scaled_img = rescaleImgClass(pOutParams->retImg, rescaleSize);
-			if (isImgClassValid(scaled_img)) {
-				freeImgClass(pOutParams->retImg);
-				pOutParams->retImg = scaled_img;
-				pOutParams->fullSize = rescaleSize;
-
-				// Disable nearest-neighbor scaling, since we already lost
-				// pixel-perfect sharpness with the rescale.
-				imgpf &= ~RomData::IMGPF_RESCALE_NEAREST;
+			if (rescaleSize.width > 0 && rescaleSize.height > 0) {
+				rp_image_const_ptr scaled_img = img->scaled(rescaleSize.width, rescaleSize.height, rp_image::ScaleFilter::Box);
+				if (scaled_img) {
+					img = std::move(scaled_img);
+					pOutParams->fullSize = rescaleSize;
+
+					// Disable nearest-neighbor scaling, since we already lost
+					// pixel-perfect sharpness with the rescale.
+					imgpf &= ~RomData::IMGPF_RESCALE_NEAREST;
+				}
 			}
 		}
 	}
@@ -408,10 +568,9 @@ skip_image_check:
 		}
 		if (scaleW != 0) {
 			pOutParams->fullSize.width = scaleW;
-			ImgClass scaled_img = rescaleImgClass(pOutParams->retImg, pOutParams->fullSize, ScalingMethod::Bilinear);
-			if (isImgClassValid(scaled_img)) {
-				freeImgClass(pOutParams->retImg);
-				pOutParams->retImg = scaled_img;
+			rp_image_const_ptr scaled_img = img->scaled(scaleW, pOutParams->fullSize.height, rp_image::ScaleFilter::Bilinear);
+			if (scaled_img) {
+				img = std::move(scaled_img);
 
 				// Disable nearest-neighbor scaling, since we already lost
 				// pixel-perfect sharpness with the 8:7 rescale.
@@ -421,7 +580,7 @@ skip_image_check:
 	}
 
 	// Thumbnail size, in case it has to be adjusted.
-	ImgSize thumbSize = pOutParams->fullSize;
+	ImgSize thumbSize = {img->width(), img->height()};
 
 	if (reqSize > 0 && (imgpf & RomData::IMGPF_RESCALE_NEAREST)) {
 		// Nearest-neighbor upscale may be needed.
@@ -468,10 +627,10 @@ skip_image_check:
 			// may result in 0x0, which is no good. If this happens,
 			// skip the rescaling entirely.
 			if (rescale_sz.width > 0 && rescale_sz.height > 0) {
-				ImgClass scaled_img = rescaleImgClass(pOutParams->retImg, rescale_sz);
-				if (isImgClassValid(scaled_img)) {
-					freeImgClass(pOutParams->retImg);
-					pOutParams->retImg = scaled_img;
+				// NOTE: The box filter is nearest-neighbor when upscaling.
+				rp_image_const_ptr scaled_img = img->scaled(rescale_sz.width, rescale_sz.height, rp_image::ScaleFilter::Box);
+				if (scaled_img) {
+					img = std::move(scaled_img);
 					thumbSize = rescale_sz;
 				}
 			}
@@ -489,14 +648,27 @@ skip_image_check:
 		// may result in 0x0, which is no good. If this happens,
 		// skip the rescaling entirely.
 		if (rescale_sz.width > 0 && rescale_sz.height > 0) {
-			ImgClass scaled_img = rescaleImgClass(pOutParams->retImg, rescale_sz, ScalingMethod::Bilinear);
-			if (isImgClassValid(scaled_img)) {
-				freeImgClass(pOutParams->retImg);
-				pOutParams->retImg = scaled_img;
+			rp_image_const_ptr scaled_img = img->scaled(rescale_sz.width, rescale_sz.height, rp_image::ScaleFilter::Lanczos3);
+			if (scaled_img) {
+				img = std::move(scaled_img);
 				thumbSize = rescale_sz;
 			}
 		}
 	}
+
+	// Convert the rp_image to ImgClass.
+	pOutParams->retImg = rpImageToImgClass(img);
+	if (!isImgClassValid(pOutParams->retImg)) {
+		// Unable to convert the image.
+		pOutParams->retImg = getNullImgClass();
+		return RPCT_ERROR_CANNOT_OPEN_SOURCE_FILE;
+	}
+
+	// NOTE: The image may have been resized on Windows,
+	// since Windows has issues with non-square images.
+	// Hence, we have to get the size from retImg.
+	getImgClassSize(pOutParams->retImg, &thumbSize);
+
 	// Image retrieved successfully.
 	pOutParams->thumbSize = thumbSize;
 	return RPCT_SUCCESS;
@@ -550,19 +722,19 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const char *filename, int reqSize,
 		return RPCT_ERROR_INVALID_IMAGE_SIZE;
 	}
 
-	// Attempt to open the ROM file.
-	// TODO: OS-specific wrappers, e.g. RpQFile or RpGVfsFile.
-	// For now, using RpFile, which is an stdio wrapper.
-	shared_ptr<RpFile> file = std::make_shared<RpFile>(filename, RpFile::FM_OPEN_READ_GZ);
-	if (!file->isOpen()) {
-		// Could not open the file.
-		return RPCT_ERROR_CANNOT_OPEN_SOURCE_FILE;
-	}
-
 	// Get the appropriate RomData class for this ROM.
 	// RomData class *must* support at least one image type.
-	const RomDataPtr romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+	// NOTE: The RomData cache is checked first, so the ROM file
+	// might not need to be opened at all.
+	// TODO: OS-specific wrappers, e.g. RpQFile or RpGVfsFile.
+	// For now, RomDataFactory uses RpFile, which is an stdio wrapper.
+	const RomDataPtr romData = RomDataFactory::create(filename,
+		RomDataFactory::RDA_HAS_THUMBNAIL | RomDataFactory::RDA_USE_CACHE);
 	if (!romData) {
+		if (FileSystem::access(filename, R_OK) != 0) {
+			// Could not open the file.
+			return RPCT_ERROR_CANNOT_OPEN_SOURCE_FILE;
+		}
 		// ROM is not supported.
 		return RPCT_ERROR_SOURCE_FILE_NOT_SUPPORTED;
 	}
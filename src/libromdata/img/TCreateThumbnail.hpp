@@ -41,8 +41,10 @@ typedef enum {
  */
 typedef enum {
 	RPCT_FLAG_NO_XDG_THUMBNAIL_METADATA	= (1U << 0),	/*< Don't add XDG thumbnail metadata */
+	RPCT_FLAG_FAST_PNG			= (1U << 1),	/*< Favor PNG encoding speed over file size */
+	RPCT_FLAG_SMALL_PNG			= (1U << 2),	/*< Favor PNG file size over encoding speed */
 
-	RPCT_FLAG_VALID_MASK			= 0x00000001,
+	RPCT_FLAG_VALID_MASK			= 0x00000007,
 } RpCreateThumbnailFlags;
 
 /**
@@ -146,6 +148,52 @@ public:
 		int reqSize = 0, ImgSize *pOutSize = nullptr,
 		LibRpTexture::rp_image::sBIT_t *sBIT = nullptr);
 
+protected:
+	/**
+	 * Load an internal image as an rp_image.
+	 * @param romData	[in] RomData object
+	 * @param imageType	[in] Image type
+	 * @param sBIT		[out,opt] sBIT metadata
+	 * @return Internal image, or nullptr on error.
+	 */
+	LibRpTexture::rp_image_const_ptr loadInternalImage(const LibRpBase::RomDataPtr &romData,
+		LibRpBase::RomData::ImageType imageType,
+		LibRpTexture::rp_image::sBIT_t *sBIT = nullptr);
+
+	/**
+	 * Load the smallest IMG_INT_IMAGE mipmap level that is
+	 * at least as large as the requested size.
+	 * Only the selected mipmap level is decoded.
+	 * @param romData	[in] RomData object
+	 * @param reqSize	[in] Requested image size (single dimension; assuming square image)
+	 * @param pFullSize	[out] Full image size (mipmap level 0)
+	 * @param sBIT		[out,opt] sBIT metadata
+	 * @return Mipmap image, or nullptr if the full image should be used instead.
+	 */
+	LibRpTexture::rp_image_const_ptr loadInternalMipmap(const LibRpBase::RomDataPtr &romData,
+		int reqSize, ImgSize *pFullSize,
+		LibRpTexture::rp_image::sBIT_t *sBIT = nullptr);
+
+	/**
+	 * Load an external image as an rp_image.
+	 *
+	 * If pFullSize is specified, the image may be decoded at a
+	 * reduced size that's still at least reqSize, and the full
+	 * image size will be stored in pFullSize.
+	 *
+	 * @param romData	[in] RomData object
+	 * @param imageType	[in] Image type
+	 * @param reqSize	[in] Requested image size. [0 for largest]
+	 * @param sBIT		[out,opt] sBIT metadata
+	 * @param pFullSize	[out,opt] Full image size
+	 * @return External image, or nullptr on error.
+	 */
+	LibRpTexture::rp_image_const_ptr loadExternalImage(const LibRpBase::RomDataPtr &romData,
+		LibRpBase::RomData::ImageType imageType,
+		int reqSize = 0, LibRpTexture::rp_image::sBIT_t *sBIT = nullptr,
+		ImgSize *pFullSize = nullptr);
+
+public:
 	/**
 	 * getThumbnail() output parameters
 	 */
@@ -225,20 +273,6 @@ protected:
 	 */
 	virtual void freeImgClass(ImgClass &imgClass) const = 0;
 
-	enum class ScalingMethod {
-		Nearest = 0,
-		Bilinear = 1,
-	};
-
-	/**
-	 * Rescale an ImgClass using the specified scaling method.
-	 * @param imgClass ImgClass object.
-	 * @param sz New size.
-	 * @param method Scaling method.
-	 * @return Rescaled ImgClass.
-	 */
-	virtual ImgClass rescaleImgClass(const ImgClass &imgClass, ImgSize sz, ScalingMethod method = ScalingMethod::Nearest) const = 0;
-
 	/**
 	 * Get the size of the specified ImgClass.
 	 * @param imgClass	[in] ImgClass object.
@@ -18,8 +18,11 @@
 
 // Other rom-properties libraries
 #include "libromdata/data/AmiiboData.hpp"
+#include "libromdata/RomDataCache.hpp"
 #include "libromdata/RomDataFactory.hpp"
 #include "librpbase/RomData.hpp"
+#include "librpbase/RomFields.hpp"
+#include "librpbase/RomMetaData.hpp"
 #include "librpbase/TextOut.hpp"
 #include "librpfile/FileSystem.hpp"
 #include "librpfile/MemFile.hpp"
@@ -36,11 +39,13 @@ using namespace LibRpFile;
 #include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
 using std::array;
 using std::forward_list;
 using std::ostringstream;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 // Uninitialized vector class
 #include "uvector.h"
@@ -109,6 +114,13 @@ class RomHeaderTest : public ::testing::TestWithParam<RomHeaderTest_mode>
 		 */
 		int read_next_files(const RomHeaderTest_mode &mode);
 
+		/**
+		 * Compare two RomMetaData objects.
+		 * @param expected	[in] Expected metadata
+		 * @param actual	[in] Actual metadata
+		 */
+		static void compareMetaData(const RomMetaData *expected, const RomMetaData *actual);
+
 	public:
 		/** Test case parameters **/
 
@@ -366,6 +378,137 @@ TEST_P(RomHeaderTest, JSON)
 	}
 }
 
+TEST_P(RomHeaderTest, Cache)
+{
+	// Parameterized test
+	const RomHeaderTest_mode &mode = GetParam();
+
+	if (last_bin_filename != mode.bin_filename) {
+		// Need to read the next set of files.
+		int ret = read_next_files(mode);
+		ASSERT_EQ(ret, 0) << "Incorrect files loaded from the .tar file.";
+	}
+
+	// Make sure the binary file isn't empty.
+	ASSERT_GT(last_bin_data.size(), 0U) << "Binary file is empty.";
+
+	const shared_ptr<MemFile> memFile = std::make_shared<MemFile>(last_bin_data.data(), last_bin_data.size());
+	ASSERT_NE(memFile, nullptr) << "Unable to create MemFile object for binary data.";
+	memFile->setFilename(mode.bin_filename);	// needed for SNES
+	const RomDataPtr romData = RomDataFactory::create(memFile);
+	if (!romData) {
+		// Not a valid ROM image. Nothing to cache.
+		return;
+	}
+
+	// Serialize the RomData object, then deserialize it.
+	vector<uint8_t> buf;
+	ASSERT_EQ(0, RomDataCache::serialize(romData, buf)) << "Unable to serialize the RomData object.";
+	const RomDataPtr cachedRomData = RomDataCache::deserialize(mode.bin_filename.c_str(), buf.data(), buf.size());
+	ASSERT_NE(cachedRomData, nullptr) << "Unable to deserialize the RomData object.";
+
+	// The text output should be identical.
+	// NOTE: Only the selected thumbnail images are cached,
+	// so internal images are skipped here.
+	ostringstream oss_expected, oss_actual;
+	oss_expected << ROMOutput(romData.get(), 0, OF_SkipInternalImages);
+	oss_actual << ROMOutput(cachedRomData.get(), 0, OF_SkipInternalImages);
+	ASSERT_EQ(oss_expected.str(), oss_actual.str()) << "Cached RomData text output does not match the original.";
+}
+
+/**
+ * Compare two RomMetaData objects.
+ * @param expected	[in] Expected metadata
+ * @param actual	[in] Actual metadata
+ */
+void RomHeaderTest::compareMetaData(const RomMetaData *expected, const RomMetaData *actual)
+{
+	ASSERT_NE(expected, nullptr);
+	ASSERT_NE(actual, nullptr);
+	ASSERT_EQ(expected->count(), actual->count()) << "Metadata property count does not match.";
+
+	for (int i = 0; i < expected->count(); i++) {
+		const RomMetaData::MetaData *const pExpected = expected->at(i);
+		const RomMetaData::MetaData *const pActual = actual->at(i);
+		ASSERT_NE(pExpected, nullptr);
+		ASSERT_NE(pActual, nullptr);
+		ASSERT_EQ(pExpected->name, pActual->name) << "Metadata property #" << i << " name does not match.";
+		ASSERT_EQ(pExpected->type, pActual->type) << "Metadata property #" << i << " type does not match.";
+
+		switch (pExpected->type) {
+			case PropertyType::Integer:
+				EXPECT_EQ(pExpected->data.ivalue, pActual->data.ivalue) << "Metadata property #" << i;
+				break;
+			case PropertyType::UnsignedInteger:
+				EXPECT_EQ(pExpected->data.uvalue, pActual->data.uvalue) << "Metadata property #" << i;
+				break;
+			case PropertyType::String:
+				ASSERT_EQ(pExpected->data.str != nullptr, pActual->data.str != nullptr) << "Metadata property #" << i;
+				if (pExpected->data.str) {
+					EXPECT_EQ(*pExpected->data.str, *pActual->data.str) << "Metadata property #" << i;
+				}
+				break;
+			case PropertyType::Timestamp:
+				EXPECT_EQ(pExpected->data.timestamp, pActual->data.timestamp) << "Metadata property #" << i;
+				break;
+			case PropertyType::Double:
+				EXPECT_EQ(pExpected->data.dvalue, pActual->data.dvalue) << "Metadata property #" << i;
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+TEST_P(RomHeaderTest, MetaDataOnly)
+{
+	// Parameterized test
+	const RomHeaderTest_mode &mode = GetParam();
+
+	if (last_bin_filename != mode.bin_filename) {
+		// Need to read the next set of files.
+		int ret = read_next_files(mode);
+		ASSERT_EQ(ret, 0) << "Incorrect files loaded from the .tar file.";
+	}
+
+	// Make sure the binary file isn't empty.
+	ASSERT_GT(last_bin_data.size(), 0U) << "Binary file is empty.";
+
+	const shared_ptr<MemFile> memFile = std::make_shared<MemFile>(last_bin_data.data(), last_bin_data.size());
+	ASSERT_NE(memFile, nullptr) << "Unable to create MemFile object for binary data.";
+	memFile->setFilename(mode.bin_filename);	// needed for SNES
+	const RomDataPtr romData = RomDataFactory::create(memFile);
+	if (!romData) {
+		// Not a valid ROM image.
+		return;
+	}
+	const RomMetaData *const metaData = romData->metaData();
+	if (!metaData || metaData->empty()) {
+		// No metadata. The metadata-only mode might skip this class.
+		return;
+	}
+
+	// Metadata-only mode must detect the same class and return the same metadata.
+	const RomDataPtr romDataMD = RomDataFactory::create(memFile, RomDataFactory::RDA_METADATA_ONLY);
+	ASSERT_NE(romDataMD, nullptr) << "Metadata-only mode did not detect the ROM image.";
+	ASSERT_STREQ(romData->className(), romDataMD->className());
+	ASSERT_EQ(romData->fileType(), romDataMD->fileType());
+	ASSERT_NO_FATAL_FAILURE(compareMetaData(metaData, romDataMD->metaData()));
+
+	// Metadata-only cache entries must round-trip the metadata,
+	// but they don't have any fields or images.
+	vector<uint8_t> buf;
+	ASSERT_EQ(0, RomDataCache::serialize(romDataMD, buf, true)) << "Unable to serialize the RomData object.";
+	const RomDataPtr cachedRomData = RomDataCache::deserialize(mode.bin_filename.c_str(), buf.data(), buf.size());
+	ASSERT_NE(cachedRomData, nullptr) << "Unable to deserialize the RomData object.";
+	ASSERT_STREQ(romData->className(), cachedRomData->className());
+	ASSERT_EQ(romData->fileType(), cachedRomData->fileType());
+	ASSERT_NO_FATAL_FAILURE(compareMetaData(metaData, cachedRomData->metaData()));
+	EXPECT_EQ(0U, cachedRomData->supportedImageTypes());
+	const RomFields *const fields = cachedRomData->fields();
+	EXPECT_TRUE(!fields || fields->count() == 0);
+}
+
 /** Test case parameters. **/
 
 /**
@@ -634,6 +777,258 @@ INSTANTIATE_TEST_SUITE_P(DirectDrawSurface, RomHeaderTest,
 		"Other/DirectDrawSurface.json.tar.zst"))
 	, RomHeaderTest::test_case_suffix_generator);
 
+/** RomDataFactory benchmark **/
+
+class RomDataFactoryBenchmark : public ::testing::Test
+{
+	protected:
+		RomDataFactoryBenchmark()
+			: ::testing::Test()
+		{}
+
+	public:
+		void SetUp(void) final;
+
+	protected:
+		// Number of passes over the corpus for benchmarks
+		static constexpr unsigned int BENCHMARK_ITERATIONS = 20;
+
+		// Loaded ROM headers: filename and data
+		struct bin_file_t {
+			string filename;
+			rp::uvector<uint8_t> data;
+		};
+		static forward_list<bin_file_t> bin_files;
+		static unsigned int bin_file_count;
+
+		/**
+		 * Load all ROM headers from a .bin.tar.zst file.
+		 * @param bin_tar_filename .tar file containing the header files
+		 */
+		static void load_bin_tar(const char *bin_tar_filename);
+
+		/**
+		 * Run RomDataFactory::create() on all loaded files.
+		 * @param unsupported	[in] If true, scramble the data and use an unknown file extension.
+		 * @return Number of detected files.
+		 */
+		static unsigned int run_benchmark(bool unsupported);
+
+		/**
+		 * Run RomDataFactory::create() and RomData::metaData() on all loaded files.
+		 * @param attrs		[in] RomDataAttr bitfield for RomDataFactory::create()
+		 * @param doSerialize	[in] If true, also serialize the RomData object, as if storing it in the RomData cache.
+		 * @return Number of files with metadata.
+		 */
+		static unsigned int run_metaData_benchmark(unsigned int attrs, bool doSerialize);
+};
+
+forward_list<RomDataFactoryBenchmark::bin_file_t> RomDataFactoryBenchmark::bin_files;
+unsigned int RomDataFactoryBenchmark::bin_file_count = 0;
+
+/**
+ * Load all ROM headers from a .bin.tar.zst file.
+ * @param bin_tar_filename .tar file containing the header files
+ */
+void RomDataFactoryBenchmark::load_bin_tar(const char *bin_tar_filename)
+{
+	mtar_t bin_tar;
+	int ret = mtar_zstd_open_ro(&bin_tar, bin_tar_filename);
+	ASSERT_EQ(ret, 0) << "Could not open '" << bin_tar_filename << "', check the test directory!";
+
+	mtar_header_t h;
+	for (; ; mtar_next(&bin_tar)) {
+		int err = mtar_read_header(&bin_tar, &h);
+		if (err != MTAR_ESUCCESS) {
+			// Finished reading the .tar file.
+			break;
+		}
+		if (h.type != 0 /*MTAR_TREG*/ || h.size == 0 || h.size > MAX_BIN_FILESIZE) {
+			// Not a regular file, or the file is empty or too big.
+			continue;
+		}
+
+		bin_files.emplace_front();
+		bin_file_t &bin_file = bin_files.front();
+		bin_file.filename = h.name;
+		bin_file.data.resize(h.size);
+		err = mtar_read_data(&bin_tar, bin_file.data.data(), h.size);
+		if (err != MTAR_ESUCCESS) {
+			bin_files.pop_front();
+			continue;
+		}
+		bin_file_count++;
+	}
+
+	mtar_close(&bin_tar);
+}
+
+void RomDataFactoryBenchmark::SetUp(void)
+{
+	if (!bin_files.empty())
+		return;
+
+	static constexpr array<const char*, 21> bin_tar_filenames = {{
+		"Audio/ADX.SADX.bin.tar.zst",
+		"Console/DreamcastSave.bin.tar.zst",
+		"Console/GameCube.wia-rvz.bin.tar.zst",
+		"Console/MegaDrive.bin.tar.zst",
+		"Console/MegaDrive_32X.bin.tar.zst",
+		"Console/MegaDrive_Pico.bin.tar.zst",
+		"Console/NES.bin.tar.zst",
+		"Console/N64.bin.tar.zst",
+		"Console/Sega8Bit_SMS.bin.tar.zst",
+		"Console/Sega8Bit_SMS_SDSC.bin.tar.zst",
+		"Console/Sega8Bit_GG.bin.tar.zst",
+		"Console/Sega8Bit_GG_SDSC.bin.tar.zst",
+		"Console/SNES.bin.tar.zst",
+		"Console/SNES_BSX.bin.tar.zst",
+		"Console/SufamiTurbo.bin.tar.zst",
+		"Handheld/DMG.bin.tar.zst",
+		"Handheld/GameBoyAdvance.bin.tar.zst",
+		"Handheld/Nintendo3DS-3DSident.bin.tar.zst",
+		"Handheld/NintendoDS.bin.tar.zst",
+		"Other/Amiibo.bin.tar.zst",
+		"Other/DirectDrawSurface.bin.tar.zst",
+	}};
+
+	for (const char *bin_tar_filename : bin_tar_filenames) {
+		ASSERT_NO_FATAL_FAILURE(load_bin_tar(bin_tar_filename));
+	}
+	ASSERT_GT(bin_file_count, 0U) << "No files were read from the .bin.tar files.";
+}
+
+/**
+ * Run RomDataFactory::create() on all loaded files.
+ * @param unsupported	[in] If true, scramble the data and use an unknown file extension.
+ * @return Number of detected files.
+ */
+unsigned int RomDataFactoryBenchmark::run_benchmark(bool unsupported)
+{
+	// Create the MemFiles first.
+	forward_list<rp::uvector<uint8_t> > scrambled_data;
+	vector<shared_ptr<MemFile> > memFiles;
+	memFiles.reserve(bin_file_count);
+
+	for (const bin_file_t &bin_file : bin_files) {
+		const uint8_t *pData = bin_file.data.data();
+		string filename = bin_file.filename;
+		if (unsupported) {
+			// Simple LCG to scramble the data while keeping the size.
+			scrambled_data.emplace_front(bin_file.data.size());
+			rp::uvector<uint8_t> &scrambled = scrambled_data.front();
+			uint32_t seed = 0x12345678;
+			for (size_t i = 0; i < scrambled.size(); i++) {
+				seed = (seed * 1103515245U) + 12345U;
+				scrambled[i] = bin_file.data[i] ^ static_cast<uint8_t>(seed >> 16);
+			}
+			pData = scrambled.data();
+			filename += ".dat";
+		}
+
+		memFiles.emplace_back(std::make_shared<MemFile>(pData, bin_file.data.size()));
+		memFiles.back()->setFilename(filename);
+	}
+
+	unsigned int detected = 0;
+	for (const shared_ptr<MemFile> &memFile : memFiles) {
+		for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+			const RomDataPtr romData = RomDataFactory::create(memFile);
+			if (romData) {
+				detected++;
+			}
+		}
+	}
+	return detected;
+}
+
+/**
+ * Run RomDataFactory::create() and RomData::metaData() on all loaded files.
+ * @param attrs		[in] RomDataAttr bitfield for RomDataFactory::create()
+ * @param doSerialize	[in] If true, also serialize the RomData object, as if storing it in the RomData cache.
+ * @return Number of files with metadata.
+ */
+unsigned int RomDataFactoryBenchmark::run_metaData_benchmark(unsigned int attrs, bool doSerialize)
+{
+	vector<shared_ptr<MemFile> > memFiles;
+	memFiles.reserve(bin_file_count);
+	for (const bin_file_t &bin_file : bin_files) {
+		memFiles.emplace_back(std::make_shared<MemFile>(bin_file.data.data(), bin_file.data.size()));
+		memFiles.back()->setFilename(bin_file.filename);
+	}
+
+	const bool metaDataOnly = !!(attrs & RomDataFactory::RDA_METADATA_ONLY);
+	unsigned int hasMetaData = 0;
+	vector<uint8_t> buf;
+	for (const shared_ptr<MemFile> &memFile : memFiles) {
+		for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+			const RomDataPtr romData = RomDataFactory::create(memFile, attrs);
+			if (!romData)
+				continue;
+
+			const RomMetaData *const metaData = romData->metaData();
+			if (metaData && !metaData->empty()) {
+				hasMetaData++;
+			}
+			if (doSerialize) {
+				buf.clear();
+				RomDataCache::serialize(romData, buf, metaDataOnly);
+			}
+		}
+	}
+	return hasMetaData;
+}
+
+/**
+ * Benchmark RomDataFactory::create() over the RomHeaders corpus.
+ */
+TEST_F(RomDataFactoryBenchmark, create_benchmark)
+{
+	EXPECT_GT(run_benchmark(false), 0U);
+}
+
+/**
+ * Benchmark RomDataFactory::create() over scrambled (mostly unsupported) files.
+ */
+TEST_F(RomDataFactoryBenchmark, create_unsupported_benchmark)
+{
+	EXPECT_LT(run_benchmark(true), bin_file_count * BENCHMARK_ITERATIONS);
+}
+
+/**
+ * Benchmark RomDataFactory::create() + RomData::metaData() in the normal mode.
+ */
+TEST_F(RomDataFactoryBenchmark, create_metaData_benchmark)
+{
+	EXPECT_GT(run_metaData_benchmark(0, false), 0U);
+}
+
+/**
+ * Benchmark RomDataFactory::create() + RomData::metaData() in the metadata-only mode.
+ */
+TEST_F(RomDataFactoryBenchmark, create_metaData_metaDataOnly_benchmark)
+{
+	EXPECT_GT(run_metaData_benchmark(RomDataFactory::RDA_METADATA_ONLY, false), 0U);
+}
+
+/**
+ * Benchmark RomDataFactory::create() + RomData::metaData() + cache serialization
+ * in the normal mode. (RomData cache store, as done by indexers)
+ */
+TEST_F(RomDataFactoryBenchmark, create_metaData_serialize_benchmark)
+{
+	EXPECT_GT(run_metaData_benchmark(0, true), 0U);
+}
+
+/**
+ * Benchmark RomDataFactory::create() + RomData::metaData() + cache serialization
+ * in the metadata-only mode. (RomData cache store, as done by indexers)
+ */
+TEST_F(RomDataFactoryBenchmark, create_metaData_serialize_metaDataOnly_benchmark)
+{
+	EXPECT_GT(run_metaData_benchmark(RomDataFactory::RDA_METADATA_ONLY, true), 0U);
+}
+
 } }
 
 extern "C" int gtest_main(int argc, TCHAR *argv[])
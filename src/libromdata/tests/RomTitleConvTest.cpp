@@ -0,0 +1,291 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * RomTitleConvTest.cpp: ROM title conversion test and benchmark.          *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// MicroTAR
+#include "microtar_zstd.h"
+
+// librptext
+#include "librptext/conversion.hpp"
+using namespace LibRpText;
+
+// C includes
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes
+#include <array>
+#include <string>
+#include <vector>
+using std::array;
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class RomTitleConvTest : public ::testing::Test
+{
+	protected:
+		RomTitleConvTest()
+			: ::testing::Test()
+		{}
+
+	public:
+		void SetUp(void) final;
+
+	public:
+		// Number of passes over the corpus for benchmarks
+		static constexpr unsigned int BENCHMARK_ITERATIONS = 20;
+
+	protected:
+		// Title field extracted from a ROM header
+		struct rom_title_t {
+			string title;		// Raw title field (original encoding)
+			unsigned int cp;	// Code page
+			unsigned int flags;	// Conversion flags
+		};
+		static vector<rom_title_t> rom_titles;
+
+		/**
+		 * Title field location within a ROM header.
+		 */
+		struct title_field_t {
+			unsigned int address;	// Title address
+			unsigned int size;	// Title size
+		};
+
+		/**
+		 * ROM header corpus description.
+		 */
+		struct corpus_t {
+			const char *bin_tar_filename;	// .bin.tar.zst file
+			const char *ext;		// File extension
+			unsigned int cp;		// Code page
+			unsigned int flags;		// Conversion flags
+			array<title_field_t, 2> fields;	// Title fields (size == 0 for unused)
+		};
+
+		/**
+		 * Load title fields from all ROM headers in a .bin.tar.zst file.
+		 * @param corpus ROM header corpus description
+		 */
+		static void load_bin_tar(const corpus_t &corpus);
+
+		/**
+		 * Is a title pure ASCII?
+		 * @param title Title
+		 * @return True if the title only has 7-bit characters; false if not.
+		 */
+		static bool isAscii(const string &title);
+};
+
+vector<RomTitleConvTest::rom_title_t> RomTitleConvTest::rom_titles;
+
+/**
+ * Load title fields from all ROM headers in a .bin.tar.zst file.
+ * @param corpus ROM header corpus description
+ */
+void RomTitleConvTest::load_bin_tar(const corpus_t &corpus)
+{
+	mtar_t bin_tar;
+	int ret = mtar_zstd_open_ro(&bin_tar, corpus.bin_tar_filename);
+	ASSERT_EQ(ret, 0) << "Could not open '" << corpus.bin_tar_filename << "', check the test directory!";
+
+	const size_t ext_len = strlen(corpus.ext);
+	vector<char> data;
+	mtar_header_t h;
+	for (; ; mtar_next(&bin_tar)) {
+		int err = mtar_read_header(&bin_tar, &h);
+		if (err != MTAR_ESUCCESS) {
+			// Finished reading the .tar file.
+			break;
+		}
+		if (h.type != 0 /*MTAR_TREG*/ || h.size == 0) {
+			// Not a regular file, or the file is empty.
+			continue;
+		}
+
+		// Check the file extension.
+		const size_t name_len = strlen(h.name);
+		if (name_len <= ext_len || strcmp(&h.name[name_len - ext_len], corpus.ext) != 0) {
+			continue;
+		}
+
+		data.resize(h.size);
+		err = mtar_read_data(&bin_tar, data.data(), h.size);
+		if (err != MTAR_ESUCCESS) {
+			continue;
+		}
+
+		for (const title_field_t &field : corpus.fields) {
+			if (field.size == 0 || field.address + field.size > data.size()) {
+				continue;
+			}
+			rom_titles.push_back({string(&data[field.address], field.size), corpus.cp, corpus.flags});
+		}
+	}
+
+	mtar_close(&bin_tar);
+}
+
+/**
+ * Is a title pure ASCII?
+ * @param title Title
+ * @return True if the title only has 7-bit characters; false if not.
+ */
+bool RomTitleConvTest::isAscii(const string &title)
+{
+	for (const char chr : title) {
+		if (static_cast<uint8_t>(chr) & 0x80U)
+			return false;
+	}
+	return true;
+}
+
+void RomTitleConvTest::SetUp(void)
+{
+	if (!rom_titles.empty())
+		return;
+
+	// Title fields, using the same code pages as the RomData subclasses.
+	static const array<corpus_t, 4> corpora = {{
+		// MegaDrive: Domestic and export titles
+		{"Console/MegaDrive.bin.tar.zst", ".gen", 932, TEXTCONV_FLAG_CP1252_FALLBACK,
+			{{{0x120, 48}, {0x150, 48}}}},
+		// Nintendo 64: Title (big-endian .z64 only)
+		{"Console/N64.bin.tar.zst", ".z64", 932, TEXTCONV_FLAG_CP1252_FALLBACK,
+			{{{0x20, 20}, {0, 0}}}},
+		// Game Boy: 16-byte title
+		{"Handheld/DMG.bin.tar.zst", ".gb", 437, 0,
+			{{{0x134, 16}, {0, 0}}}},
+		// Game Boy Advance: Title
+		{"Handheld/GameBoyAdvance.bin.tar.zst", ".gba", 437, 0,
+			{{{0xA0, 12}, {0, 0}}}},
+	}};
+
+	for (const corpus_t &corpus : corpora) {
+		ASSERT_NO_FATAL_FAILURE(load_bin_tar(corpus));
+	}
+	ASSERT_FALSE(rom_titles.empty());
+}
+
+/**
+ * Pure-ASCII titles must be returned as-is, up to the first NULL byte.
+ * Other titles must convert to something.
+ */
+TEST_F(RomTitleConvTest, convertTitles)
+{
+	unsigned int ascii_count = 0;
+	for (const rom_title_t &rom_title : rom_titles) {
+		const string &title = rom_title.title;
+		const string utf8 = cpN_to_utf8(rom_title.cp, title.data(), static_cast<int>(title.size()), rom_title.flags);
+
+		const string expected = title.substr(0, title.find('\0'));
+		if (isAscii(expected)) {
+			EXPECT_EQ(expected, utf8);
+			ascii_count++;
+		} else {
+			EXPECT_FALSE(utf8.empty()) << "Non-ASCII title did not convert: " << expected;
+		}
+	}
+
+	// Nearly all titles in the corpus are ASCII.
+	EXPECT_GT(ascii_count, rom_titles.size() / 2);
+}
+
+/**
+ * Benchmark converting all titles to UTF-8.
+ */
+TEST_F(RomTitleConvTest, titles_to_utf8_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (const rom_title_t &rom_title : rom_titles) {
+			const string &title = rom_title.title;
+			const string utf8 = cpN_to_utf8(rom_title.cp, title.data(), static_cast<int>(title.size()), rom_title.flags);
+			EXPECT_LE(utf8.size(), title.size() * 3);
+		}
+	}
+}
+
+/**
+ * Benchmark converting all titles to UTF-16.
+ */
+TEST_F(RomTitleConvTest, titles_to_utf16_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (const rom_title_t &rom_title : rom_titles) {
+			const string &title = rom_title.title;
+			const std::u16string utf16 = cpN_to_utf16(rom_title.cp, title.data(), static_cast<int>(title.size()), rom_title.flags);
+			EXPECT_LE(utf16.size(), title.size());
+		}
+	}
+}
+
+} }
+
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: ROM title conversion tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n", LibRomData::Tests::RomTitleConvTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// Check for the RomHeaders directory and chdir() into it.
+#ifdef _WIN32
+	static constexpr array<const TCHAR*, 11> subdirs = {{
+		_T("RomHeaders"),
+		_T("bin\\RomHeaders"),
+		_T("src\\libromdata\\tests\\RomHeaders"),
+		_T("..\\src\\libromdata\\tests\\RomHeaders"),
+		_T("..\\..\\src\\libromdata\\tests\\RomHeaders"),
+		_T("..\\..\\..\\src\\libromdata\\tests\\RomHeaders"),
+		_T("..\\..\\..\\..\\src\\libromdata\\tests\\RomHeaders"),
+		_T("..\\..\\..\\..\\..\\src\\libromdata\\tests\\RomHeaders"),
+		_T("..\\..\\..\\bin\\RomHeaders"),
+		_T("..\\..\\..\\bin\\Debug\\RomHeaders"),
+		_T("..\\..\\..\\bin\\Release\\RomHeaders"),
+	}};
+#else /* !_WIN32 */
+	static constexpr array<const TCHAR*, 9> subdirs = {{
+		_T("RomHeaders"),
+		_T("bin/RomHeaders"),
+		_T("src/libromdata/tests/RomHeaders"),
+		_T("../src/libromdata/tests/RomHeaders"),
+		_T("../../src/libromdata/tests/RomHeaders"),
+		_T("../../../src/libromdata/tests/RomHeaders"),
+		_T("../../../../src/libromdata/tests/RomHeaders"),
+		_T("../../../../../src/libromdata/tests/RomHeaders"),
+		_T("../../../bin/RomHeaders"),
+	}};
+#endif /* _WIN32 */
+
+	bool is_found = false;
+	for (const TCHAR *const subdir : subdirs) {
+		if (!_taccess(subdir, R_OK)) {
+			if (_tchdir(subdir) == 0) {
+				is_found = true;
+				break;
+			}
+		}
+	}
+
+	if (!is_found) {
+		fputs("*** ERROR: Cannot find the RomHeaders test files directory.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
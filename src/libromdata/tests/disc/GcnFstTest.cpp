@@ -42,6 +42,7 @@ using LibRpBase::IFst;
 // C++ includes
 #include <algorithm>
 #include <array>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <unordered_set>
@@ -90,8 +91,53 @@ inline ::std::ostream& operator<<(::std::ostream& os, const GcnFstTest_mode& mod
 static constexpr uint64_t MAX_GCN_FST_BIN_FILESIZE = 1024UL*1024UL;	// 1.0 MB
 static constexpr uint64_t MAX_GCN_FST_TXT_FILESIZE = 1536UL*1024UL;	// 1.5 MB
 
+/**
+ * File entry collected from an FST using readdir().
+ */
+struct GcnFstTest_file {
+	string path;		// Full path, starting with '/'
+	off64_t offset;
+	off64_t size;
+	uint8_t type;
+};
+
+/**
+ * Recursively collect all entries in an FST using readdir().
+ * @param fst		[in] IFst
+ * @param subdir	[in] Subdirectory path
+ * @param files		[out] Collected entries
+ */
+static void collectFstFiles(IFst *fst, const string &subdir, vector<GcnFstTest_file> &files)
+{
+	IFst::Dir *dirp = fst->opendir(subdir.c_str());
+	ASSERT_TRUE(dirp != nullptr) <<
+		"Failed to open directory '" << subdir << "'.";
+
+	vector<string> subdirs;
+	for (IFst::DirEnt *dirent = fst->readdir(dirp); dirent != nullptr; dirent = fst->readdir(dirp)) {
+		string path = subdir;
+		if (path[path.size()-1] != '/') {
+			path += '/';
+		}
+		path += dirent->name;
+
+		if (dirent->type == DT_DIR) {
+			subdirs.push_back(path);
+		}
+		files.push_back({std::move(path), dirent->offset, dirent->size, dirent->type});
+	}
+	fst->closedir(dirp);
+
+	for (const string &path : subdirs) {
+		ASSERT_NO_FATAL_FAILURE(collectFstFiles(fst, path, files));
+	}
+}
+
+class GcnFstBenchmark;
 class GcnFstTest : public ::testing::TestWithParam<GcnFstTest_mode>
 {
+	friend class GcnFstBenchmark;
+
 	protected:
 		GcnFstTest()
 			: ::testing::TestWithParam<GcnFstTest_mode>()
@@ -397,6 +443,59 @@ TEST_P(GcnFstTest, NoDuplicateFilenames)
 	EXPECT_FALSE(m_fst->hasErrors());
 }
 
+/**
+ * Look up every entry using find_file() and compare it to readdir().
+ */
+TEST_P(GcnFstTest, FindFile)
+{
+	vector<GcnFstTest_file> files;
+	ASSERT_NO_FATAL_FAILURE(collectFstFiles(m_fst, "/", files));
+	ASSERT_FALSE(files.empty());
+
+	for (const GcnFstTest_file &file : files) {
+		IFst::DirEnt dirent;
+		ASSERT_EQ(0, m_fst->find_file(file.path.c_str(), &dirent)) <<
+			"find_file() failed for '" << file.path << "'.";
+		EXPECT_EQ(file.type, dirent.type) << file.path;
+		EXPECT_EQ(file.offset, dirent.offset) << file.path;
+		EXPECT_EQ(file.size, dirent.size) << file.path;
+
+		// Relative paths and extra slashes should also work.
+		string path2;
+		for (char c : file.path) {
+			path2 += c;
+			if (c == '/') {
+				path2 += '/';
+			}
+		}
+		path2 += '/';
+		EXPECT_EQ(0, m_fst->find_file(file.path.c_str() + 1, &dirent)) << file.path;
+		EXPECT_EQ(0, m_fst->find_file(path2.c_str(), &dirent)) << path2;
+
+		// Lookups are case-sensitive.
+		string upper = file.path;
+		std::transform(upper.begin(), upper.end(), upper.begin(),
+			[](char c) noexcept -> char { return (c >= 'a' && c <= 'z') ? (c & ~0x20) : c; });
+		if (upper != file.path) {
+			const bool has_upper = std::any_of(files.cbegin(), files.cend(),
+				[&upper](const GcnFstTest_file &f) noexcept -> bool { return f.path == upper; });
+			if (!has_upper) {
+				EXPECT_EQ(-ENOENT, m_fst->find_file(upper.c_str(), &dirent)) << upper;
+			}
+		}
+	}
+
+	// A file can't be used as a directory.
+	for (const GcnFstTest_file &file : files) {
+		if (file.type == DT_REG) {
+			IFst::DirEnt dirent;
+			const string path = file.path + "/test";
+			EXPECT_EQ(-ENOENT, m_fst->find_file(path.c_str(), &dirent)) << path;
+			break;
+		}
+	}
+}
+
 /**
  * Print the FST directory structure and compare it to a known-good version.
  */
@@ -582,6 +681,120 @@ INSTANTIATE_TEST_SUITE_P(Wii, GcnFstTest,
 	testing::ValuesIn(GcnFstTest::ReadTestCasesFromDisk(2))
 	, GcnFstTest::test_case_suffix_generator);
 
+/** GcnFst::find_file() benchmark **/
+
+class GcnFstBenchmark : public ::testing::Test
+{
+	protected:
+		GcnFstBenchmark()
+			: ::testing::Test()
+		{}
+
+	public:
+		void SetUp(void) final;
+
+	protected:
+		// Number of passes over the corpus for benchmarks
+		static constexpr unsigned int BENCHMARK_ITERATIONS = 20;
+
+		// Loaded FSTs
+		struct fst_file_t {
+			rp::uvector<uint8_t> data;
+			unsigned int start_offset;	// Nonzero for NKit FSTs
+			uint8_t offsetShift;
+			vector<string> paths;		// All file and directory paths
+		};
+		static vector<fst_file_t> fst_files;
+
+		/**
+		 * Open an FST, then look up files using find_file().
+		 * A new GcnFst is created for each FST on each pass,
+		 * so the time to build the path index is included.
+		 * @param max_lookups	[in] Maximum number of lookups per FST (0 for all files)
+		 */
+		static void run_benchmark(unsigned int max_lookups);
+};
+
+vector<GcnFstBenchmark::fst_file_t> GcnFstBenchmark::fst_files;
+
+void GcnFstBenchmark::SetUp(void)
+{
+	if (!fst_files.empty())
+		return;
+
+	static constexpr array<uint8_t, 10> root_dir_data = {{1,0,0,0,0,0,0,0,0,0}};
+	for (const uint8_t offsetShift : {0, 2}) {
+		const char *const zip_filename = (offsetShift == 0) ? "GameCube.fst.bin.zip" : "Wii.fst.bin.zip";
+		for (const GcnFstTest_mode &mode : GcnFstTest::ReadTestCasesFromDisk(offsetShift)) {
+			fst_files.emplace_back();
+			fst_file_t &fst_file = fst_files.back();
+			ASSERT_GT(GcnFstTest::getFileFromZip(zip_filename, mode.fst_filename.c_str(), fst_file.data), 0);
+			fst_file.offsetShift = offsetShift;
+
+			// Check for NKit FST recovery data.
+			fst_file.start_offset = 0;
+			if (fst_file.data.size() >= 0x60 &&
+			    !memcmp(&fst_file.data[0x50], root_dir_data.data(), root_dir_data.size()))
+			{
+				fst_file.start_offset = 0x50;
+			}
+
+			// NOTE: GcnFst's destructor isn't exported, so use IFst.
+			const std::unique_ptr<IFst> fst(new GcnFst(&fst_file.data[fst_file.start_offset],
+				static_cast<uint32_t>(fst_file.data.size() - fst_file.start_offset), offsetShift));
+			ASSERT_TRUE(fst->isOpen());
+			vector<GcnFstTest_file> files;
+			ASSERT_NO_FATAL_FAILURE(collectFstFiles(fst.get(), "/", files));
+			fst_file.paths.reserve(files.size());
+			for (GcnFstTest_file &file : files) {
+				fst_file.paths.push_back(std::move(file.path));
+			}
+		}
+	}
+	ASSERT_FALSE(fst_files.empty());
+}
+
+/**
+ * Open an FST, then look up files using find_file().
+ * A new GcnFst is created for each FST on each pass,
+ * so the time to build the path index is included.
+ * @param max_lookups	[in] Maximum number of lookups per FST (0 for all files)
+ */
+void GcnFstBenchmark::run_benchmark(unsigned int max_lookups)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (const fst_file_t &fst_file : fst_files) {
+			const std::unique_ptr<IFst> fst(new GcnFst(&fst_file.data[fst_file.start_offset],
+				static_cast<uint32_t>(fst_file.data.size() - fst_file.start_offset), fst_file.offsetShift));
+
+			// Spread the lookups evenly over the FST.
+			const size_t count = fst_file.paths.size();
+			const size_t n = (max_lookups == 0 || max_lookups > count) ? count : max_lookups;
+			for (size_t j = 0; j < n; j++) {
+				const string &path = fst_file.paths[(n == count) ? j : (j * (count - 1) / (n - 1))];
+				IFst::DirEnt dirent;
+				ASSERT_EQ(0, fst->find_file(path.c_str(), &dirent)) << path;
+			}
+		}
+	}
+}
+
+/**
+ * Benchmark a few lookups per FST, e.g. banner and opening.bnr.
+ */
+TEST_F(GcnFstBenchmark, find_file_few_benchmark)
+{
+	ASSERT_NO_FATAL_FAILURE(run_benchmark(4));
+}
+
+/**
+ * Benchmark looking up every file in each FST.
+ */
+TEST_F(GcnFstBenchmark, find_file_all_benchmark)
+{
+	ASSERT_NO_FATAL_FAILURE(run_benchmark(0));
+}
+
 } }
 
 extern "C" int gtest_main(int argc, TCHAR *argv[])
@@ -0,0 +1,270 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * HashTreeVerifierTest.cpp: HashTreeVerifier and Wii U H3 hash tests.     *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// HashTreeVerifier is tested with the Wii U hash levels using a
+// synthetic decrypted content file, so no encryption keys are needed.
+#include "disc/HashTreeVerifier.hpp"
+#include "disc/WiiUH3Reader.hpp"
+#include "Console/wiiu_structs.h"
+
+// librpbase, librpfile
+#include "librpbase/crypto/Hash.hpp"
+#include "librpfile/MemFile.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+
+// C includes (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes
+#include <memory>
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class HashTreeVerifierTest : public ::testing::Test
+{
+	public:
+		// Two full 1 MB superblocks, plus a partial superblock.
+		static constexpr uint32_t BLOCK_COUNT = 16 + 16 + 8;
+		static constexpr uint32_t H3_SIZE = 20;
+
+	public:
+		void SetUp(void) final;
+
+	public:
+		// Decrypted content file
+		vector<WUP_H3_Content_Block> m_content;
+		// H3 table
+		uint8_t m_h3[H3_SIZE];
+
+		/**
+		 * Calculate a SHA-1 hash.
+		 * @param pData	[in] Data
+		 * @param len	[in] Length of data
+		 * @param digest	[out] SHA-1 hash
+		 */
+		static void sha1(const void *pData, size_t len, uint8_t digest[20])
+		{
+			Hash hash(Hash::Algorithm::SHA1);
+			hash.process(pData, len);
+			hash.getHash(digest, 20);
+		}
+
+		/**
+		 * Worker that checks the Wii U hash levels of decrypted blocks.
+		 */
+		class Worker final : public HashTreeVerifier::Worker
+		{
+			public:
+				Worker(const uint8_t *pH3, size_t h3Len)
+					: sha1(Hash::Algorithm::SHA1)
+					, pH3(pH3)
+					, h3Len(h3Len)
+				{}
+
+				bool verifyBlock(uint32_t block_num, uint8_t *block) final
+				{
+					return WiiUH3Reader::verifyBlockHashes(sha1, block_num, block, pH3, h3Len);
+				}
+
+			private:
+				Hash sha1;
+				const uint8_t *const pH3;
+				const size_t h3Len;
+		};
+
+		/**
+		 * Verify the hash tree.
+		 * @param result	[out] Results
+		 * @param size		[in] Size of the content file to use (0 for the full file)
+		 * @param h3Len		[in] Length of the H3 table
+		 * @param progressFn	[in,opt] Progress callback
+		 * @param userdata	[in,opt] User data for the progress callback
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int verifyHashTree(HashTreeVerifier::Result &result, size_t size = 0, size_t h3Len = H3_SIZE,
+			HashTreeVerifier::ProgressFn progressFn = nullptr, void *userdata = nullptr)
+		{
+			if (size == 0) {
+				size = m_content.size() * sizeof(WUP_H3_Content_Block);
+			}
+			IRpFilePtr file = std::make_shared<MemFile>(m_content.data(), size);
+
+			HashTreeVerifier verifier(WUP_H3_SECTOR_SIZE_ENCRYPTED, 16);
+			const unsigned int workerCount = verifier.workerCount();
+			EXPECT_GE(workerCount, 1U);
+			for (unsigned int i = 0; i < workerCount; i++) {
+				verifier.addWorker(new Worker(m_h3, h3Len));
+			}
+			return verifier.run(file, 0, BLOCK_COUNT, result, progressFn, userdata);
+		}
+};
+
+/**
+ * Build the synthetic content file.
+ */
+void HashTreeVerifierTest::SetUp(void)
+{
+	m_content.resize(BLOCK_COUNT);
+	memset(m_content.data(), 0, m_content.size() * sizeof(WUP_H3_Content_Block));
+
+	// Data: Arbitrary per-block pattern.
+	for (uint32_t b = 0; b < BLOCK_COUNT; b++) {
+		uint8_t *const data = m_content[b].data;
+		for (unsigned int i = 0; i < sizeof(m_content[b].data); i++) {
+			data[i] = static_cast<uint8_t>((b * 7) + (i >> 4));
+		}
+	}
+
+	// H0: One table per superblock, shared by all of its blocks.
+	// H1: One table per 16 MB, with one entry per superblock.
+	uint8_t h1[16][20];
+	memset(h1, 0, sizeof(h1));
+	for (uint32_t s = 0; s < (BLOCK_COUNT + 15) / 16; s++) {
+		uint8_t h0[16][20];
+		memset(h0, 0, sizeof(h0));
+		for (uint32_t j = 0; j < 16 && (s * 16) + j < BLOCK_COUNT; j++) {
+			sha1(m_content[(s * 16) + j].data, sizeof(m_content[0].data), h0[j]);
+		}
+		for (uint32_t j = 0; j < 16 && (s * 16) + j < BLOCK_COUNT; j++) {
+			memcpy(m_content[(s * 16) + j].hashes.h0, h0, sizeof(h0));
+		}
+		sha1(h0, sizeof(h0), h1[s]);
+	}
+
+	// H2: One table per 256 MB.
+	uint8_t h2[16][20];
+	memset(h2, 0, sizeof(h2));
+	sha1(h1, sizeof(h1), h2[0]);
+	for (uint32_t b = 0; b < BLOCK_COUNT; b++) {
+		memcpy(m_content[b].hashes.h1, h1, sizeof(h1));
+		memcpy(m_content[b].hashes.h2, h2, sizeof(h2));
+	}
+
+	// H3: One entry per 256 MB.
+	sha1(h2, sizeof(h2), m_h3);
+}
+
+/**
+ * Verify content with a valid hash tree.
+ */
+TEST_F(HashTreeVerifierTest, valid)
+{
+	HashTreeVerifier::Result result;
+	ASSERT_EQ(0, verifyHashTree(result));
+	EXPECT_EQ(BLOCK_COUNT, result.blocks);
+	EXPECT_TRUE(result.badBlocks.empty());
+}
+
+/**
+ * Verify content with corrupted blocks.
+ * Consecutive bad blocks should be merged into a single range.
+ */
+TEST_F(HashTreeVerifierTest, corruptBlocks)
+{
+	// Corrupt data in blocks 5 and 6. (H0)
+	m_content[5].data[0x1234] ^= 0x01;
+	m_content[6].data[0xFBFF] ^= 0x80;
+	// Corrupt the H1 entry used by block 20.
+	m_content[20].hashes.h1[1][0] ^= 0xFF;
+	// Corrupt the H2 table in the last block.
+	m_content[BLOCK_COUNT - 1].hashes.h2[0][19] ^= 0xFF;
+
+	HashTreeVerifier::Result result;
+	ASSERT_EQ(0, verifyHashTree(result));
+	EXPECT_EQ(BLOCK_COUNT, result.blocks);
+	ASSERT_EQ(3U, result.badBlocks.size());
+	EXPECT_EQ(5U, result.badBlocks[0].first);
+	EXPECT_EQ(2U, result.badBlocks[0].count);
+	EXPECT_EQ(20U, result.badBlocks[1].first);
+	EXPECT_EQ(1U, result.badBlocks[1].count);
+	EXPECT_EQ(BLOCK_COUNT - 1, result.badBlocks[2].first);
+	EXPECT_EQ(1U, result.badBlocks[2].count);
+}
+
+/**
+ * Verify content against an H3 table that doesn't match.
+ * Every block should be reported in a single range.
+ */
+TEST_F(HashTreeVerifierTest, badH3)
+{
+	m_h3[0] ^= 0xFF;
+
+	HashTreeVerifier::Result result;
+	ASSERT_EQ(0, verifyHashTree(result));
+	EXPECT_EQ(BLOCK_COUNT, result.blocks);
+	ASSERT_EQ(1U, result.badBlocks.size());
+	EXPECT_EQ(0U, result.badBlocks[0].first);
+	EXPECT_EQ(BLOCK_COUNT, result.badBlocks[0].count);
+}
+
+/**
+ * Verify content against an H3 table that's too small.
+ */
+TEST_F(HashTreeVerifierTest, shortH3)
+{
+	HashTreeVerifier::Result result;
+	ASSERT_EQ(0, verifyHashTree(result, 0, H3_SIZE - 1));
+	ASSERT_EQ(1U, result.badBlocks.size());
+	EXPECT_EQ(0U, result.badBlocks[0].first);
+	EXPECT_EQ(BLOCK_COUNT, result.badBlocks[0].count);
+}
+
+/**
+ * Verify a truncated content file.
+ */
+TEST_F(HashTreeVerifierTest, readError)
+{
+	HashTreeVerifier::Result result;
+	EXPECT_EQ(-EIO, verifyHashTree(result, (BLOCK_COUNT - 1) * sizeof(WUP_H3_Content_Block)));
+	EXPECT_LT(result.blocks, BLOCK_COUNT);
+}
+
+/**
+ * Progress callback that cancels after the first batch.
+ */
+static bool cancelProgress(void *userdata, uint32_t done, uint32_t total)
+{
+	EXPECT_LE(done, total);
+	EXPECT_EQ(HashTreeVerifierTest::BLOCK_COUNT, total);
+	(*static_cast<unsigned int*>(userdata))++;
+	return false;
+}
+
+/**
+ * Cancel verification from the progress callback.
+ */
+TEST_F(HashTreeVerifierTest, cancel)
+{
+	unsigned int calls = 0;
+	HashTreeVerifier::Result result;
+	EXPECT_EQ(-ECANCELED, verifyHashTree(result, 0, H3_SIZE, cancelProgress, &calls));
+	EXPECT_EQ(1U, calls);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: HashTreeVerifier tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,286 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * WiiPartitionTest.cpp: WiiPartition hash tree verification test.        *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// WiiPartition hash tree verification is tested using
+// the GameCube class's ROM operation.
+#include "RomDataFactory.hpp"
+#include "Console/gcn_structs.h"
+#include "Console/wii_structs.h"
+
+// librpbase, librpfile
+#include "librpbase/crypto/Hash.hpp"
+#include "librpfile/MemFile.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+
+// C includes (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class WiiPartitionTest : public ::testing::Test
+{
+	public:
+		// Synthetic disc layout
+		// The partition is unencrypted, but hashed. (NASOS-style)
+		static constexpr uint32_t PTBL_OFFSET = RVL_VolumeGroupTable_ADDRESS + 0x20;
+		static constexpr uint32_t PART_OFFSET = 0x50000;
+
+		// Partition layout (relative to PART_OFFSET)
+		static constexpr uint32_t TMD_OFFSET = 0x2C0;
+		static constexpr uint32_t H3_OFFSET = 0x8000;
+		static constexpr uint32_t H3_SIZE = 0x18000;
+		static constexpr uint32_t DATA_OFFSET = H3_OFFSET + H3_SIZE;
+		static constexpr uint32_t CLUSTER_SIZE = 0x8000;
+
+		// Two full groups, plus a partial group.
+		static constexpr uint32_t CLUSTER_COUNT = 64 + 64 + 24;
+
+		// Number of iterations for benchmarks
+		static constexpr unsigned int BENCHMARK_ITERATIONS = 100;
+
+	public:
+		void SetUp(void) final;
+
+	public:
+		// Disc image
+		vector<uint8_t> m_disc;
+
+		/**
+		 * Get a pointer to a cluster in m_disc.
+		 * @param cluster_num Cluster number
+		 * @return Pointer to the cluster
+		 */
+		inline uint8_t *cluster(uint32_t cluster_num)
+		{
+			return &m_disc[PART_OFFSET + DATA_OFFSET + (cluster_num * CLUSTER_SIZE)];
+		}
+
+		/**
+		 * Calculate a SHA-1 hash.
+		 * @param pData	[in] Data
+		 * @param len	[in] Length of data
+		 * @param digest	[out] SHA-1 hash
+		 */
+		static void sha1(const void *pData, size_t len, uint8_t digest[20])
+		{
+			Hash hash(Hash::Algorithm::SHA1);
+			hash.process(pData, len);
+			hash.getHash(digest, 20);
+		}
+
+		/**
+		 * Verify the hash tree using the GameCube ROM operation.
+		 * @param params	[in/out] RomOpParams
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int verifyHashTree(RomData::RomOpParams &params)
+		{
+			IRpFilePtr file = std::make_shared<MemFile>(m_disc.data(), m_disc.size());
+			RomDataPtr romData = RomDataFactory::create(file);
+			EXPECT_TRUE(romData != nullptr);
+			if (!romData) {
+				return -EIO;
+			}
+
+			const vector<RomData::RomOp> ops = romData->romOps();
+			EXPECT_EQ(1U, ops.size());
+			if (ops.size() != 1) {
+				return -ENOTSUP;
+			}
+			EXPECT_EQ(static_cast<uint32_t>(RomData::RomOp::ROF_ENABLED | RomData::RomOp::ROF_VERIFY), ops[0].flags);
+			return romData->doRomOp(0, &params);
+		}
+};
+
+/**
+ * Build a partition image with a valid hash tree.
+ */
+void WiiPartitionTest::SetUp(void)
+{
+	m_disc.assign(PART_OFFSET + DATA_OFFSET + (CLUSTER_COUNT * CLUSTER_SIZE), 0);
+
+	// Disc header
+	GCN_DiscHeader *const discHeader = reinterpret_cast<GCN_DiscHeader*>(m_disc.data());
+	memcpy(discHeader->id6, "RTSTE8", 6);
+	discHeader->magic_wii = cpu_to_be32(WII_MAGIC);
+	strcpy(discHeader->game_title, "HASH TREE TEST");
+	discHeader->hash_verify = 0;
+	discHeader->disc_noCrypto = 1;
+
+	// Volume group and partition tables
+	RVL_VolumeGroupTable *const vgtbl = reinterpret_cast<RVL_VolumeGroupTable*>(&m_disc[RVL_VolumeGroupTable_ADDRESS]);
+	vgtbl->vg[0].count = cpu_to_be32(1);
+	vgtbl->vg[0].addr.val = cpu_to_be32(PTBL_OFFSET >> 2);
+	RVL_PartitionTableEntry *const pte = reinterpret_cast<RVL_PartitionTableEntry*>(&m_disc[PTBL_OFFSET]);
+	pte->addr.val = cpu_to_be32(PART_OFFSET >> 2);
+	pte->type = cpu_to_be32(RVL_PT_GAME);
+
+	// Partition header
+	RVL_PartitionHeader *const header = reinterpret_cast<RVL_PartitionHeader*>(&m_disc[PART_OFFSET]);
+	header->ticket.signature_type = cpu_to_be32(RVL_CERT_SIGTYPE_RSA2048_SHA1);
+	header->tmd_offset.val = cpu_to_be32(TMD_OFFSET >> 2);
+	header->h3_table_offset.val = cpu_to_be32(H3_OFFSET >> 2);
+	header->data_offset.val = cpu_to_be32(DATA_OFFSET >> 2);
+	header->data_size.val = cpu_to_be32((CLUSTER_COUNT * CLUSTER_SIZE) >> 2);
+
+	// Cluster data (pseudo-random) and H0 hashes
+	uint32_t seed = 0x12345678;
+	for (uint32_t c = 0; c < CLUSTER_COUNT; c++) {
+		uint8_t *const p = cluster(c);
+		for (unsigned int i = 0x400; i < CLUSTER_SIZE; i++) {
+			seed = (seed * 1103515245U) + 12345U;
+			p[i] = static_cast<uint8_t>(seed >> 16);
+		}
+		for (unsigned int i = 0; i < 31; i++) {
+			sha1(&p[0x400 + (i * 0x400)], 0x400, &p[i * 20]);
+		}
+	}
+
+	// H1: Each cluster in a subgroup has the H0 table hashes for the whole subgroup.
+	for (uint32_t c = 0; c < CLUSTER_COUNT; c++) {
+		uint8_t h1[20];
+		sha1(cluster(c), 31 * 20, h1);
+		const uint32_t sg_start = c & ~7U;
+		for (uint32_t i = sg_start; i < sg_start + 8 && i < CLUSTER_COUNT; i++) {
+			memcpy(cluster(i) + 0x280 + ((c % 8) * 20), h1, sizeof(h1));
+		}
+	}
+
+	// H2: Each cluster in a group has the H1 table hashes for the whole group.
+	for (uint32_t c = 0; c < CLUSTER_COUNT; c += 8) {
+		uint8_t h2[20];
+		sha1(cluster(c) + 0x280, 8 * 20, h2);
+		const uint32_t g_start = c & ~63U;
+		for (uint32_t i = g_start; i < g_start + 64 && i < CLUSTER_COUNT; i++) {
+			memcpy(cluster(i) + 0x340 + (((c / 8) % 8) * 20), h2, sizeof(h2));
+		}
+	}
+
+	// H3: One hash per group.
+	uint8_t *const h3 = &m_disc[PART_OFFSET + H3_OFFSET];
+	for (uint32_t c = 0; c < CLUSTER_COUNT; c += 64) {
+		sha1(cluster(c) + 0x340, 8 * 20, &h3[(c / 64) * 20]);
+	}
+
+	// H4: Stored in the first TMD content entry.
+	uint8_t *const pTmd = &m_disc[PART_OFFSET + TMD_OFFSET];
+	RVL_TMD_Header *const tmd = reinterpret_cast<RVL_TMD_Header*>(pTmd);
+	tmd->nbr_cont = cpu_to_be16(1);
+	RVL_Content_Entry *const content = reinterpret_cast<RVL_Content_Entry*>(pTmd + sizeof(RVL_TMD_Header));
+	sha1(h3, H3_SIZE, content->sha1_hash);
+}
+
+/**
+ * Verify a partition with a valid hash tree.
+ */
+TEST_F(WiiPartitionTest, verifyHashTree_valid)
+{
+	RomData::RomOpParams params;
+	ASSERT_EQ(0, verifyHashTree(params));
+	EXPECT_EQ(0, params.status);
+	EXPECT_EQ(string("Hash tree is valid.\n0p0: OK (152 clusters)"), params.msg);
+	EXPECT_EQ(1U, params.fieldIdx.size());
+}
+
+/**
+ * Verify a partition with corrupted clusters.
+ * Consecutive bad clusters should be merged into a single range.
+ */
+TEST_F(WiiPartitionTest, verifyHashTree_corruptClusters)
+{
+	// Corrupt data in clusters 5 and 6.
+	cluster(5)[0x1234] ^= 0x01;
+	cluster(6)[0x7FFF] ^= 0x80;
+	// Corrupt the H1 table in cluster 70.
+	cluster(70)[0x280 + (3 * 20)] ^= 0xFF;
+	// Corrupt the H2 table in the last cluster.
+	cluster(CLUSTER_COUNT - 1)[0x340] ^= 0xFF;
+
+	RomData::RomOpParams params;
+	ASSERT_EQ(0, verifyHashTree(params));
+	EXPECT_EQ(0, params.status);
+	EXPECT_EQ(string("Hash tree has ERRORS.\n0p0: 4 of 152 clusters are corrupted: 0x5-0x6 0x46 0x97"), params.msg);
+}
+
+/**
+ * Verify a partition whose H3 table doesn't match the TMD.
+ */
+TEST_F(WiiPartitionTest, verifyHashTree_badH4)
+{
+	// Corrupt an unused H3 table entry.
+	m_disc[PART_OFFSET + H3_OFFSET + (100 * 20)] ^= 0xFF;
+
+	RomData::RomOpParams params;
+	ASSERT_EQ(0, verifyHashTree(params));
+	EXPECT_EQ(string("Hash tree has ERRORS.\n0p0: H3 table does not match the TMD."), params.msg);
+}
+
+/**
+ * Progress callback that cancels after the first batch.
+ */
+static bool cancelProgress(void *userdata, uint64_t done, uint64_t total)
+{
+	EXPECT_LE(done, total);
+	EXPECT_EQ(static_cast<uint64_t>(WiiPartitionTest::CLUSTER_COUNT), total);
+	(*static_cast<unsigned int*>(userdata))++;
+	return false;
+}
+
+/**
+ * Cancel verification from the progress callback.
+ */
+TEST_F(WiiPartitionTest, verifyHashTree_cancel)
+{
+	unsigned int calls = 0;
+	RomData::RomOpParams params;
+	params.progressFn = cancelProgress;
+	params.progressUserData = &calls;
+	EXPECT_EQ(-ECANCELED, verifyHashTree(params));
+	EXPECT_EQ(-ECANCELED, params.status);
+	EXPECT_EQ(1U, calls);
+}
+
+/**
+ * Benchmark hash tree verification.
+ */
+TEST_F(WiiPartitionTest, verifyHashTree_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		RomData::RomOpParams params;
+		ASSERT_EQ(0, verifyHashTree(params));
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: WiiPartition tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n", LibRomData::Tests::WiiPartitionTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
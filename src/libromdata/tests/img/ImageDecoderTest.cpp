@@ -448,6 +448,15 @@ void ImageDecoderTest::decodeTest_internal(void)
 		EXPECT_EQ(img_dds.get(), img_base.get()) << "Mipmap level 0 is *not* the same object as the base image.";
 	}
 
+	// The mipmap dimensions must be available without loading the mipmap.
+	if (mode.mipmapLevel >= 0) {
+		EXPECT_GT(m_romData->mipmapCount(), mode.mipmapLevel);
+		int dims[2] = {0, 0};
+		EXPECT_EQ(0, m_romData->getMipmapDimensions(mode.mipmapLevel, dims));
+		EXPECT_EQ(img_dds->width(), dims[0]) << "Mipmap width does not match getMipmapDimensions().";
+		EXPECT_EQ(img_dds->height(), dims[1]) << "Mipmap height does not match getMipmapDimensions().";
+	}
+
 	// Verify the pixel format.
 	if (!mode.expected_pixel_format.empty()) {
 		// This must be RpTextureWrapper.
@@ -961,6 +970,31 @@ INSTANTIATE_TEST_SUITE_P(KTX2, ImageDecoderTest,
 		KTX2_MIPMAP_TEST("rgb-mipmap-reference-u", 6, "R8G8B8_SRGB"))
 	, ImageDecoderTest::test_case_suffix_generator);
 
+#ifdef HAVE_ZSTD
+// KTX2 tests (Zstandard supercompression)
+// NOTE: Same texture data as the uncompressed tests above.
+#define KTX2_ZSTD_IMAGE_TEST(file, format) ImageDecoderTest_mode( \
+			"KTX2/" file ".zstd.ktx2.gz", \
+			"KTX2/" file ".png", (format))
+#define KTX2_ZSTD_MIPMAP_TEST(file, mipmapLevel, format) ImageDecoderTest_mode( \
+			"KTX2/" file ".zstd.ktx2.gz", \
+			"KTX2/" file "." #mipmapLevel ".png", (format), \
+			RomData::IMG_INT_IMAGE, (mipmapLevel))
+INSTANTIATE_TEST_SUITE_P(KTX2_Zstd, ImageDecoderTest,
+	::testing::Values(
+		KTX2_ZSTD_IMAGE_TEST("texturearray_bc3_unorm", "BC3_UNORM_BLOCK"),
+
+		// Mipmaps
+		KTX2_ZSTD_MIPMAP_TEST("rgb-mipmap-reference-u", 0, "R8G8B8_SRGB"),
+		KTX2_ZSTD_MIPMAP_TEST("rgb-mipmap-reference-u", 1, "R8G8B8_SRGB"),
+		KTX2_ZSTD_MIPMAP_TEST("rgb-mipmap-reference-u", 2, "R8G8B8_SRGB"),
+		KTX2_ZSTD_MIPMAP_TEST("rgb-mipmap-reference-u", 3, "R8G8B8_SRGB"),
+		KTX2_ZSTD_MIPMAP_TEST("rgb-mipmap-reference-u", 4, "R8G8B8_SRGB"),
+		KTX2_ZSTD_MIPMAP_TEST("rgb-mipmap-reference-u", 5, "R8G8B8_SRGB"),
+		KTX2_ZSTD_MIPMAP_TEST("rgb-mipmap-reference-u", 6, "R8G8B8_SRGB"))
+	, ImageDecoderTest::test_case_suffix_generator);
+#endif /* HAVE_ZSTD */
+
 // Valve VTF tests (all formats)
 #define VTF_IMAGE_TEST(file, format) ImageDecoderTest_mode( \
 			"VTF/" file ".vtf.gz", \
@@ -0,0 +1,400 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * RomChecksumTest.cpp: RomChecksum test.                                  *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// RomChecksum
+#include "libromdata/utils/RomChecksum.hpp"
+#include "libromdata/utils/SuperMagicDrive.hpp"
+#include "librpfile/MemFile.hpp"
+#include "aligned_malloc.h"
+using namespace LibRpFile;
+
+// C includes (C++ namespace)
+#include <cstdio>
+
+// C++ includes
+#include <memory>
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class RomChecksumTest : public ::testing::Test
+{
+	public:
+		// Test ROM size: 1.5 MB (not a power of 2)
+		static constexpr size_t ROM_SIZE = 1536U * 1024U;
+
+		// Number of iterations for benchmarks
+		static constexpr unsigned int BENCHMARK_ITERATIONS = 1000;
+
+	public:
+		void SetUp(void) final;
+
+	public:
+		// Test ROM data (pseudo-random)
+		vector<uint8_t> m_rom;
+
+		/**
+		 * Create a MemFile for the specified data.
+		 * @param data Data
+		 * @return MemFile
+		 */
+		static inline IRpFilePtr memFile(const vector<uint8_t> &data)
+		{
+			return std::make_shared<MemFile>(data.data(), data.size());
+		}
+
+		/**
+		 * Simple byte sum.
+		 * @param pData Data
+		 * @param len Length
+		 * @return Byte sum
+		 */
+		static uint32_t byteSum(const uint8_t *pData, size_t len)
+		{
+			uint32_t sum = 0;
+			for (size_t i = 0; i < len; i++) {
+				sum += pData[i];
+			}
+			return sum;
+		}
+};
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void RomChecksumTest::SetUp(void)
+{
+	// Fill the ROM with pseudo-random data. (LCG)
+	m_rom.resize(ROM_SIZE);
+	uint32_t seed = 0x12345678;
+	for (uint8_t &p : m_rom) {
+		seed = (seed * 1103515245U) + 12345U;
+		p = static_cast<uint8_t>(seed >> 16);
+	}
+}
+
+/**
+ * Test the standard byte sum function.
+ */
+TEST_F(RomChecksumTest, sumBytes_cpp_test)
+{
+	uint32_t even = 0, odd = 0;
+	for (size_t i = 0; i < m_rom.size(); i += 2) {
+		even += m_rom[i];
+		odd += m_rom[i+1];
+	}
+
+	uint32_t sums[2] = {0, 0};
+	RomChecksum::sumBytes_cpp(m_rom.data(), m_rom.size(), sums);
+	EXPECT_EQ(even, sums[0]);
+	EXPECT_EQ(odd, sums[1]);
+
+	// Odd length: The trailing byte is an even byte.
+	sums[0] = 0; sums[1] = 0;
+	RomChecksum::sumBytes_cpp(m_rom.data(), 3, sums);
+	EXPECT_EQ(static_cast<uint32_t>(m_rom[0] + m_rom[2]), sums[0]);
+	EXPECT_EQ(static_cast<uint32_t>(m_rom[1]), sums[1]);
+}
+
+#ifdef RCS_HAS_SSE2
+/**
+ * Test the SSE2-optimized byte sum function.
+ */
+TEST_F(RomChecksumTest, sumBytes_sse2_test)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.");
+		return;
+	}
+
+	auto buf = aligned_uptr<uint8_t>(16, m_rom.size());
+	memcpy(buf.get(), m_rom.data(), m_rom.size());
+
+	// Test multiple lengths to check the unrolled loop and the remainder.
+	for (size_t len : {(size_t)16, (size_t)48, (size_t)64, (size_t)80, m_rom.size()}) {
+		uint32_t expected[2] = {0, 0};
+		RomChecksum::sumBytes_cpp(buf.get(), len, expected);
+
+		uint32_t sums[2] = {0, 0};
+		RomChecksum::sumBytes_sse2(buf.get(), len, sums);
+		EXPECT_EQ(expected[0], sums[0]) << "len == " << len;
+		EXPECT_EQ(expected[1], sums[1]) << "len == " << len;
+	}
+}
+
+/**
+ * Benchmark the SSE2-optimized byte sum function.
+ */
+TEST_F(RomChecksumTest, sumBytes_sse2_benchmark)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.");
+		return;
+	}
+
+	auto buf = aligned_uptr<uint8_t>(16, m_rom.size());
+	memcpy(buf.get(), m_rom.data(), m_rom.size());
+
+	uint32_t sums[2] = {0, 0};
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		RomChecksum::sumBytes_sse2(buf.get(), m_rom.size(), sums);
+	}
+	EXPECT_NE(0U, sums[0] | sums[1]);
+}
+#endif /* RCS_HAS_SSE2 */
+
+/**
+ * Benchmark the standard byte sum function.
+ */
+TEST_F(RomChecksumTest, sumBytes_cpp_benchmark)
+{
+	uint32_t sums[2] = {0, 0};
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		RomChecksum::sumBytes_cpp(m_rom.data(), m_rom.size(), sums);
+	}
+	EXPECT_NE(0U, sums[0] | sums[1]);
+}
+
+/**
+ * Test the sumBytes() dispatch function with unaligned pointers.
+ */
+TEST_F(RomChecksumTest, sumBytes_dispatch_test)
+{
+	for (size_t offset = 0; offset < 4; offset++) {
+		const size_t len = m_rom.size() - 64 - offset;
+		uint32_t expected[2] = {0, 0};
+		RomChecksum::sumBytes_cpp(&m_rom[offset], len, expected);
+
+		uint32_t sums[2] = {0, 0};
+		RomChecksum::sumBytes(&m_rom[offset], len, sums);
+		EXPECT_EQ(expected[0], sums[0]) << "offset == " << offset;
+		EXPECT_EQ(expected[1], sums[1]) << "offset == " << offset;
+	}
+}
+
+/**
+ * Test Mega Drive checksums, including a copier header and SMD interleaving.
+ */
+TEST_F(RomChecksumTest, MegaDrive_test)
+{
+	uint16_t expected = 0;
+	for (size_t i = 0x200; i < m_rom.size(); i += 2) {
+		expected += static_cast<uint16_t>((m_rom[i] << 8) | m_rom[i+1]);
+	}
+
+	RomChecksum::Params params;
+	params.algorithm = RomChecksum::Algorithm::MegaDrive;
+	params.expected[0] = expected;
+
+	RomChecksum::Result result;
+	ASSERT_EQ(0, RomChecksum::verify(memFile(m_rom), params, result));
+	EXPECT_EQ(expected, result.checksum[0]);
+	EXPECT_TRUE(result.valid);
+	EXPECT_EQ((off64_t)m_rom.size(), result.size);
+	const uint32_t crc32_bin = result.crc32;
+
+	// SMD: 512-byte header, then 16 KB blocks with odd bytes first.
+	vector<uint8_t> smd(512 + m_rom.size());
+	static constexpr size_t half = SuperMagicDrive::SMD_BLOCK_SIZE / 2;
+	for (size_t blk = 0; blk < m_rom.size(); blk += SuperMagicDrive::SMD_BLOCK_SIZE) {
+		uint8_t *const pDest = &smd[512 + blk];
+		const uint8_t *const pSrc = &m_rom[blk];
+		for (size_t i = 0; i < half; i++) {
+			pDest[i] = pSrc[(i * 2) + 1];
+			pDest[half + i] = pSrc[i * 2];
+		}
+	}
+
+	params.flags = RomChecksum::RCF_SMD_INTERLEAVED;
+	params.offset = 512;
+	ASSERT_EQ(0, RomChecksum::verify(memFile(smd), params, result));
+	EXPECT_EQ(expected, result.checksum[0]);
+	EXPECT_TRUE(result.valid);
+	EXPECT_EQ(crc32_bin, result.crc32);
+
+	// Invalid checksum.
+	params.expected[0] = expected ^ 0x1234;
+	ASSERT_EQ(0, RomChecksum::verify(memFile(smd), params, result));
+	EXPECT_FALSE(result.valid);
+}
+
+/**
+ * Test SNES checksums with mirroring. (1.5 MB == 1 MB + 512 KB mirrored twice)
+ */
+TEST_F(RomChecksumTest, SNES_test)
+{
+	const size_t base = 1024U * 1024U;
+	const uint32_t expected = (byteSum(m_rom.data(), base) +
+		(byteSum(&m_rom[base], m_rom.size() - base) * 2)) & 0xFFFF;
+
+	RomChecksum::Params params;
+	params.algorithm = RomChecksum::Algorithm::SNES;
+	params.expected[0] = expected;
+
+	RomChecksum::Result result;
+	ASSERT_EQ(0, RomChecksum::verify(memFile(m_rom), params, result));
+	EXPECT_EQ(expected, result.checksum[0]);
+	EXPECT_TRUE(result.valid);
+
+	// Power-of-2 size: No mirroring.
+	params.size = base;
+	params.expected[0] = byteSum(m_rom.data(), base) & 0xFFFF;
+	ASSERT_EQ(0, RomChecksum::verify(memFile(m_rom), params, result));
+	EXPECT_TRUE(result.valid);
+}
+
+/**
+ * Test SNES checksums with three segments. (1.75 MB == 1 MB + 512 KB + 256 KB)
+ * The 256 KB segment is mirrored to fill 512 KB; the resulting 1 MB tail
+ * is not mirrored any further.
+ */
+TEST_F(RomChecksumTest, SNES_threeSegments_test)
+{
+	static constexpr size_t seg1M = 1024U * 1024U;
+	static constexpr size_t seg512K = 512U * 1024U;
+	static constexpr size_t seg256K = 256U * 1024U;
+
+	// Append 256 KB to the 1.5 MB test ROM.
+	vector<uint8_t> rom(m_rom);
+	rom.insert(rom.end(), m_rom.begin(), m_rom.begin() + seg256K);
+	ASSERT_EQ(seg1M + seg512K + seg256K, rom.size());
+
+	const uint32_t expected = (byteSum(rom.data(), seg1M) +
+		byteSum(&rom[seg1M], seg512K) +
+		(byteSum(&rom[seg1M + seg512K], seg256K) * 2)) & 0xFFFF;
+
+	RomChecksum::Params params;
+	params.algorithm = RomChecksum::Algorithm::SNES;
+	params.expected[0] = expected;
+
+	RomChecksum::Result result;
+	ASSERT_EQ(0, RomChecksum::verify(memFile(rom), params, result));
+	EXPECT_EQ(expected, result.checksum[0]);
+	EXPECT_TRUE(result.valid);
+}
+
+/**
+ * Test Game Boy global checksums.
+ */
+TEST_F(RomChecksumTest, GameBoy_test)
+{
+	const uint32_t expected = (byteSum(m_rom.data(), m_rom.size()) - m_rom[0x14E] - m_rom[0x14F]) & 0xFFFF;
+
+	RomChecksum::Params params;
+	params.algorithm = RomChecksum::Algorithm::GameBoy;
+	params.expected[0] = expected;
+
+	RomChecksum::Result result;
+	ASSERT_EQ(0, RomChecksum::verify(memFile(m_rom), params, result));
+	EXPECT_EQ(expected, result.checksum[0]);
+	EXPECT_TRUE(result.valid);
+}
+
+/**
+ * Test WonderSwan checksums.
+ */
+TEST_F(RomChecksumTest, WonderSwan_test)
+{
+	const uint32_t expected = byteSum(m_rom.data(), m_rom.size() - 2) & 0xFFFF;
+
+	RomChecksum::Params params;
+	params.algorithm = RomChecksum::Algorithm::WonderSwan;
+	params.expected[0] = expected;
+
+	RomChecksum::Result result;
+	ASSERT_EQ(0, RomChecksum::verify(memFile(m_rom), params, result));
+	EXPECT_EQ(expected, result.checksum[0]);
+	EXPECT_TRUE(result.valid);
+}
+
+/**
+ * Test N64 byteswapped formats.
+ * The test ROM doesn't have a known boot code, so the CRCs can't be verified,
+ * but the normalized data (and therefore the hashes) must be identical.
+ */
+TEST_F(RomChecksumTest, N64_formats_test)
+{
+	RomChecksum::Params params;
+	params.algorithm = RomChecksum::Algorithm::N64;
+
+	RomChecksum::Result result;
+	ASSERT_EQ(0, RomChecksum::verify(memFile(m_rom), params, result));
+	EXPECT_EQ(0U, result.n64_cic);
+	EXPECT_FALSE(result.valid);
+	const uint32_t crc32_z64 = result.crc32;
+
+	// V64: 16-bit byteswapped
+	vector<uint8_t> v64(m_rom);
+	for (size_t i = 0; i < v64.size(); i += 2) {
+		std::swap(v64[i], v64[i+1]);
+	}
+	params.flags = RomChecksum::RCF_N64_V64;
+	ASSERT_EQ(0, RomChecksum::verify(memFile(v64), params, result));
+	EXPECT_EQ(crc32_z64, result.crc32);
+
+	// swap2: wordswapped
+	vector<uint8_t> swap2(m_rom);
+	for (size_t i = 0; i < swap2.size(); i += 4) {
+		std::swap(swap2[i+0], swap2[i+2]);
+		std::swap(swap2[i+1], swap2[i+3]);
+	}
+	params.flags = RomChecksum::RCF_N64_SWAP2;
+	ASSERT_EQ(0, RomChecksum::verify(memFile(swap2), params, result));
+	EXPECT_EQ(crc32_z64, result.crc32);
+
+	// LE32: 32-bit byteswapped
+	vector<uint8_t> le32(m_rom);
+	for (size_t i = 0; i < le32.size(); i += 4) {
+		std::swap(le32[i+0], le32[i+3]);
+		std::swap(le32[i+1], le32[i+2]);
+	}
+	params.flags = RomChecksum::RCF_N64_LE32;
+	ASSERT_EQ(0, RomChecksum::verify(memFile(le32), params, result));
+	EXPECT_EQ(crc32_z64, result.crc32);
+
+	// Unknown CICs are rejected.
+	uint32_t crc[2];
+	EXPECT_EQ(-ENOTSUP, RomChecksum::n64CalcCRC(m_rom.data(), 1234, crc));
+}
+
+/**
+ * Benchmark a full verification pass, including hashes.
+ */
+TEST_F(RomChecksumTest, verify_MegaDrive_benchmark)
+{
+	RomChecksum::Params params;
+	params.algorithm = RomChecksum::Algorithm::MegaDrive;
+	const IRpFilePtr file = memFile(m_rom);
+
+	RomChecksum::Result result;
+	for (unsigned int i = BENCHMARK_ITERATIONS / 10; i > 0; i--) {
+		ASSERT_EQ(0, RomChecksum::verify(file, params, result));
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: RomChecksum tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n", LibRomData::Tests::RomChecksumTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,603 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * RomChecksum.cpp: Full-ROM checksum verification for cartridge systems. *
+ * Standard version. (C++ code only)                                       *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RomChecksum.hpp"
+#include "SuperMagicDrive.hpp"
+
+// Other rom-properties libraries
+#include "librpbase/crypto/Hash.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+using namespace LibRpText;
+
+// C++ STL classes
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace RomChecksum {
+
+// Read buffer size.
+// Must be a multiple of SuperMagicDrive::SMD_BLOCK_SIZE.
+static constexpr size_t READ_BUFFER_SIZE = 1024U * 1024U;
+static_assert(READ_BUFFER_SIZE % SuperMagicDrive::SMD_BLOCK_SIZE == 0,
+	"READ_BUFFER_SIZE must be a multiple of SMD_BLOCK_SIZE");
+
+// Mega Drive: Checksum starts after the ROM header.
+static constexpr off64_t MD_CHECKSUM_START = 0x200;
+
+// Game Boy: Global checksum location. (big-endian)
+static constexpr off64_t GB_CHECKSUM_ADDRESS = 0x14E;
+
+// N64: Boot code and CRC areas.
+static constexpr unsigned int N64_HEADER_SIZE = 0x40;
+static constexpr unsigned int N64_BOOTCODE_END = 0x1000;
+static constexpr unsigned int N64_CRC_START = 0x1000;
+static constexpr unsigned int N64_CRC_LENGTH = 0x100000;
+static constexpr unsigned int N64_CRC_END = N64_CRC_START + N64_CRC_LENGTH;
+
+/**
+ * Sum bytes at even and odd offsets.
+ * Standard version using regular C++ code.
+ * @param pData	[in] Data
+ * @param len	[in] Length of data, in bytes
+ * @param sums	[in/out] sums[0] += even bytes; sums[1] += odd bytes
+ */
+void sumBytes_cpp(const uint8_t *pData, size_t len, uint32_t sums[2])
+{
+	uint32_t even = 0, odd = 0;
+	const uint8_t *const pEnd = pData + (len & ~static_cast<size_t>(1));
+	for (; pData < pEnd; pData += 2) {
+		even += pData[0];
+		odd  += pData[1];
+	}
+	if (len & 1) {
+		// Trailing even byte.
+		even += *pData;
+	}
+
+	sums[0] += even;
+	sums[1] += odd;
+}
+
+/**
+ * Sum bytes at even and odd offsets.
+ * Uses the best available implementation.
+ * NOTE: pData should be 2-byte aligned relative to the start of the ROM.
+ * @param pData	[in] Data
+ * @param len	[in] Length of data, in bytes
+ * @param sums	[in/out] sums[0] += even bytes; sums[1] += odd bytes
+ */
+void sumBytes(const uint8_t *pData, size_t len, uint32_t sums[2])
+{
+#ifdef RCS_HAS_SSE2
+#  ifndef RCS_ALWAYS_HAS_SSE2
+	if (RP_CPU_HasSSE2())
+#  endif /* !RCS_ALWAYS_HAS_SSE2 */
+	{
+		// Process the unaligned head using the C++ version.
+		// If the head has an odd length, the even/odd lanes
+		// won't line up, so the whole buffer is handled in C++.
+		size_t head = (16U - (reinterpret_cast<uintptr_t>(pData) & 15U)) & 15U;
+		if (!(head & 1)) {
+			if (head > len) {
+				head = len;
+			}
+			if (head > 0) {
+				sumBytes_cpp(pData, head, sums);
+				pData += head;
+				len -= head;
+			}
+
+			const size_t body = len & ~static_cast<size_t>(15);
+			if (body > 0) {
+				sumBytes_sse2(pData, body, sums);
+				pData += body;
+				len -= body;
+			}
+		}
+	}
+#endif /* RCS_HAS_SSE2 */
+
+	if (len > 0) {
+		sumBytes_cpp(pData, len, sums);
+	}
+}
+
+/**
+ * Detect the N64 CIC using the boot code.
+ * @param pData	[in] ROM data, in Z64 format. (Must be at least 0x1000 bytes.)
+ * @return CIC (e.g. 6102), or 0 if unknown.
+ */
+unsigned int n64DetectCIC(const uint8_t *pData)
+{
+	Hash crc32(Hash::Algorithm::CRC32);
+	crc32.process(&pData[N64_HEADER_SIZE], N64_BOOTCODE_END - N64_HEADER_SIZE);
+
+	switch (crc32.getHash32()) {
+		case 0x6170A4A1:	return 6101;
+		case 0x009E9EA3:	return 7102;
+		case 0x90BB6CB5:	return 6102;
+		case 0x0B050EE0:	return 6103;
+		case 0x98BC2C86:	return 6105;
+		case 0xACC8580A:	return 6106;
+		default:		break;
+	}
+	return 0;
+}
+
+/**
+ * Calculate the N64 CRCs over the first 1 MB of program code.
+ * Reference: n64crc.c by Parasyte
+ * @param pData	[in] ROM data, in Z64 format. (Must be at least 0x101000 bytes.)
+ * @param cic	[in] CIC (6101, 6102, 6103, 6105, 6106, or 7102)
+ * @param crc	[out] CRCs
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int n64CalcCRC(const uint8_t *pData, unsigned int cic, uint32_t crc[2])
+{
+	uint32_t seed;
+	switch (cic) {
+		case 6101:
+		case 6102:
+		case 7102:
+			seed = 0xF8CA4DDC;
+			break;
+		case 6103:
+			seed = 0xA3886759;
+			break;
+		case 6105:
+			seed = 0xDF26F436;
+			break;
+		case 6106:
+			seed = 0x1FEA617A;
+			break;
+		default:
+			// Unsupported CIC.
+			return -ENOTSUP;
+	}
+
+	uint32_t t1, t2, t3, t4, t5, t6;
+	t1 = t2 = t3 = t4 = t5 = t6 = seed;
+
+	const uint32_t *const p32 = reinterpret_cast<const uint32_t*>(pData);
+	for (unsigned int i = N64_CRC_START; i < N64_CRC_END; i += 4) {
+		const uint32_t d = be32_to_cpu(p32[i / 4]);
+		if ((t6 + d) < t6) {
+			t4++;
+		}
+		t6 += d;
+		t3 ^= d;
+		const unsigned int shift = (d & 0x1F);
+		const uint32_t r = (shift != 0) ? ((d << shift) | (d >> (32 - shift))) : d;
+		t5 += r;
+		if (t2 > d) {
+			t2 ^= r;
+		} else {
+			t2 ^= t6 ^ d;
+		}
+
+		if (cic == 6105) {
+			t1 += be32_to_cpu(p32[(N64_HEADER_SIZE + 0x0710 + (i & 0xFF)) / 4]) ^ d;
+		} else {
+			t1 += t5 ^ d;
+		}
+	}
+
+	switch (cic) {
+		case 6103:
+			crc[0] = (t6 ^ t4) + t3;
+			crc[1] = (t5 ^ t2) + t1;
+			break;
+		case 6106:
+			crc[0] = (t6 * t4) + t3;
+			crc[1] = (t5 * t2) + t1;
+			break;
+		default:
+			crc[0] = t6 ^ t4 ^ t3;
+			crc[1] = t5 ^ t2 ^ t1;
+			break;
+	}
+	return 0;
+}
+
+/**
+ * Subtract bytes within an excluded range from a byte sum.
+ * @param pData		[in] Chunk data
+ * @param pos		[in] ROM position of the chunk
+ * @param len		[in] Length of the chunk
+ * @param excl_start	[in] Start of the excluded range
+ * @param excl_len	[in] Length of the excluded range
+ * @param sum		[in/out] Byte sum
+ */
+static void subtractExcludedBytes(const uint8_t *pData, off64_t pos, size_t len,
+	off64_t excl_start, off64_t excl_len, uint32_t &sum)
+{
+	const off64_t start = std::max(pos, excl_start);
+	const off64_t end = std::min(pos + static_cast<off64_t>(len), excl_start + excl_len);
+	for (off64_t i = start; i < end; i++) {
+		sum -= pData[i - pos];
+	}
+}
+
+/**
+ * Verify a ROM image by reading it in a single streaming pass.
+ * The system checksum, CRC32, and (if available) MD5 and SHA-1
+ * are all calculated from the same buffers.
+ * @param file		[in] ROM file
+ * @param params	[in] Parameters
+ * @param result	[out] Results
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int verify(const IRpFilePtr &file, const Params &params, Result &result)
+{
+	assert((bool)file);
+	assert(params.algorithm < Algorithm::Max);
+	if (!file || !file->isOpen()) {
+		return -EBADF;
+	} else if (params.algorithm >= Algorithm::Max) {
+		return -EINVAL;
+	}
+
+	off64_t size = params.size;
+	if (size <= 0) {
+		size = file->size() - params.offset;
+	}
+	const bool isSMD = !!(params.flags & RCF_SMD_INTERLEAVED);
+	if (isSMD) {
+		// Ignore trailing partial blocks.
+		size &= ~static_cast<off64_t>(SuperMagicDrive::SMD_BLOCK_SIZE - 1);
+	}
+	if (size <= 0 || params.offset < 0) {
+		return -EIO;
+	}
+
+	memset(&result, 0, sizeof(result));
+
+	Hash crc32(Hash::Algorithm::CRC32);
+#ifdef ENABLE_DECRYPTION
+	Hash md5(Hash::Algorithm::MD5);
+	Hash sha1(Hash::Algorithm::SHA1);
+#endif /* ENABLE_DECRYPTION */
+
+	// SNES: ROMs with non-power-of-2 sizes are mirrored up to the
+	// next power of 2. Each set bit in the ROM size is a segment,
+	// starting with the highest bit.
+	vector<off64_t> snes_seg_size;
+	vector<uint32_t> snes_seg_sum;
+	if (params.algorithm == Algorithm::SNES) {
+		for (int bit = 62; bit >= 0; bit--) {
+			const off64_t seg = static_cast<off64_t>(1) << bit;
+			if (size & seg) {
+				snes_seg_size.emplace_back(seg);
+			}
+		}
+		snes_seg_sum.resize(snes_seg_size.size());
+	}
+
+	// N64: The first 1 MB of program code is buffered for the CRC calculation.
+	// Short ROMs are zero-padded.
+	unique_ptr<uint8_t[]> n64_data;
+	if (params.algorithm == Algorithm::N64) {
+		n64_data.reset(new uint8_t[N64_CRC_END]);
+		if (size < N64_CRC_END) {
+			memset(&n64_data[size], 0, N64_CRC_END - static_cast<size_t>(size));
+		}
+	}
+
+	// Read buffer. (SMD ROMs use a second buffer for deinterleaving.)
+	auto buf = aligned_uptr<uint8_t>(16, isSMD ? (READ_BUFFER_SIZE * 2) : READ_BUFFER_SIZE);
+	uint8_t *const pRead = buf.get();
+	uint8_t *const pDecoded = isSMD ? (pRead + READ_BUFFER_SIZE) : pRead;
+
+	int ret = file->seek(params.offset);
+	if (ret != 0) {
+		ret = -file->lastError();
+		return (ret != 0) ? ret : -EIO;
+	}
+
+	uint32_t sums[2] = {0, 0};
+	unsigned int snes_seg_idx = 0;
+	off64_t snes_seg_end = (!snes_seg_size.empty() ? snes_seg_size[0] : 0);
+	for (off64_t pos = 0; pos < size; ) {
+		const size_t len = static_cast<size_t>(std::min(static_cast<off64_t>(READ_BUFFER_SIZE), size - pos));
+		const size_t sz_read = file->read(pRead, len);
+		if (sz_read != len) {
+			// Short read.
+			ret = -file->lastError();
+			return (ret != 0) ? ret : -EIO;
+		}
+
+		// Normalize the data.
+		if (isSMD) {
+			for (size_t i = 0; i < len; i += SuperMagicDrive::SMD_BLOCK_SIZE) {
+				SuperMagicDrive::decodeBlock(&pDecoded[i], &pRead[i]);
+			}
+		} else if (params.flags & RCF_N64_V64) {
+			rp_byte_swap_16_array(reinterpret_cast<uint16_t*>(pRead), len & ~static_cast<size_t>(1));
+		} else if (params.flags & RCF_N64_SWAP2) {
+			uint32_t *p32 = reinterpret_cast<uint32_t*>(pRead);
+			const uint32_t *const p32_end = p32 + (len / 4);
+			for (; p32 < p32_end; p32++) {
+				*p32 = (*p32 >> 16) | (*p32 << 16);
+			}
+		} else if (params.flags & RCF_N64_LE32) {
+			rp_byte_swap_32_array(reinterpret_cast<uint32_t*>(pRead), len & ~static_cast<size_t>(3));
+		}
+		const uint8_t *const pData = pDecoded;
+
+		crc32.process(pData, len);
+#ifdef ENABLE_DECRYPTION
+		md5.process(pData, len);
+		sha1.process(pData, len);
+#endif /* ENABLE_DECRYPTION */
+
+		switch (params.algorithm) {
+			default:
+			case Algorithm::None:
+				break;
+
+			case Algorithm::MegaDrive:
+				if (pos + static_cast<off64_t>(len) > MD_CHECKSUM_START) {
+					const size_t skip = (pos < MD_CHECKSUM_START)
+						? static_cast<size_t>(MD_CHECKSUM_START - pos) : 0;
+					sumBytes(&pData[skip], len - skip, sums);
+				}
+				break;
+
+			case Algorithm::SNES: {
+				// Split the chunk at segment boundaries.
+				off64_t seg_pos = pos;
+				const off64_t chunk_end = pos + static_cast<off64_t>(len);
+				while (seg_pos < chunk_end) {
+					const off64_t seg_len = std::min(chunk_end, snes_seg_end) - seg_pos;
+					uint32_t seg_sums[2] = {0, 0};
+					sumBytes(&pData[seg_pos - pos], static_cast<size_t>(seg_len), seg_sums);
+					snes_seg_sum[snes_seg_idx] += seg_sums[0] + seg_sums[1];
+					seg_pos += seg_len;
+					if (seg_pos == snes_seg_end && snes_seg_idx + 1 < snes_seg_size.size()) {
+						snes_seg_idx++;
+						snes_seg_end += snes_seg_size[snes_seg_idx];
+					}
+				}
+				break;
+			}
+
+			case Algorithm::GameBoy:
+				sumBytes(pData, len, sums);
+				subtractExcludedBytes(pData, pos, len, GB_CHECKSUM_ADDRESS, 2, sums[0]);
+				break;
+
+			case Algorithm::WonderSwan:
+				sumBytes(pData, len, sums);
+				subtractExcludedBytes(pData, pos, len, size - 2, 2, sums[0]);
+				break;
+
+			case Algorithm::N64:
+				if (pos < N64_CRC_END) {
+					const size_t n64_len = static_cast<size_t>(
+						std::min(static_cast<off64_t>(len), N64_CRC_END - pos));
+					memcpy(&n64_data[pos], pData, n64_len);
+				}
+				break;
+		}
+
+		pos += len;
+	}
+
+	result.size = size;
+	result.crc32 = crc32.getHash32();
+#ifdef ENABLE_DECRYPTION
+	md5.getHash(result.md5, sizeof(result.md5));
+	sha1.getHash(result.sha1, sizeof(result.sha1));
+#endif /* ENABLE_DECRYPTION */
+
+	// Finalize the system checksum.
+	switch (params.algorithm) {
+		default:
+		case Algorithm::None:
+			// Nothing to verify.
+			result.valid = true;
+			return 0;
+
+		case Algorithm::MegaDrive:
+			// 16-bit big-endian word sum: even bytes are the high bytes.
+			result.checksum[0] = ((sums[0] << 8) + sums[1]) & 0xFFFF;
+			break;
+
+		case Algorithm::SNES: {
+			// Each segment's tail (all of the smaller segments) is
+			// mirrored to fill the segment's size. (snes9x: checksum_mirror_sum())
+			// tail_len is the number of bytes the accumulated tail covers.
+			uint32_t sum = 0;
+			off64_t tail_len = 0;
+			for (size_t i = snes_seg_size.size(); i > 0; i--) {
+				const off64_t seg = snes_seg_size[i - 1];
+				if (tail_len != 0) {
+					if (tail_len < seg) {
+						sum *= static_cast<uint32_t>(seg / tail_len);
+					}
+					tail_len = seg * 2;
+				} else {
+					// Smallest segment: Nothing to mirror.
+					tail_len = seg;
+				}
+				sum += snes_seg_sum[i - 1];
+			}
+			result.checksum[0] = sum & 0xFFFF;
+			break;
+		}
+
+		case Algorithm::GameBoy:
+		case Algorithm::WonderSwan:
+			result.checksum[0] = (sums[0] + sums[1]) & 0xFFFF;
+			break;
+
+		case Algorithm::N64:
+			result.n64_cic = n64DetectCIC(n64_data.get());
+			if (result.n64_cic == 0) {
+				// Unknown CIC. CRCs can't be verified.
+				result.valid = false;
+				return 0;
+			}
+			n64CalcCRC(n64_data.get(), result.n64_cic, result.checksum);
+			result.valid = (result.checksum[0] == params.expected[0] &&
+			                result.checksum[1] == params.expected[1]);
+			return 0;
+	}
+
+	result.valid = (result.checksum[0] == params.expected[0]);
+	return 0;
+}
+
+/**
+ * Set a verification result field.
+ * If the field was added by a previous verification, it's updated in place.
+ * @param fields	[in/out] RomFields
+ * @param name		[in] Field name
+ * @param str		[in] Field value
+ * @param fieldIdx	[in/out] Updated field indexes
+ */
+void setResultField(RomFields &fields, const char *name, const string &str, vector<int> &fieldIdx)
+{
+	// TODO: Better way to update fields.
+	for (int i = fields.count() - 1; i >= 0; i--) {
+		const RomFields::Field *const cfield = fields.at(i);
+		if (!cfield || cfield->type != RomFields::RFT_STRING ||
+		    !cfield->name || strcmp(cfield->name, name) != 0)
+		{
+			continue;
+		}
+
+		RomFields::Field *const field = const_cast<RomFields::Field*>(cfield);
+		char *const old_str = const_cast<char*>(field->data.str);
+		field->data.str = strdup(str.c_str());
+		free(old_str);
+		fieldIdx.emplace_back(i);
+		return;
+	}
+
+	const int idx = fields.addField_string(name, str, RomFields::STRF_MONOSPACE);
+	if (idx >= 0) {
+		fieldIdx.emplace_back(idx);
+	}
+}
+
+/**
+ * Convert a hash to a lowercase hexadecimal string.
+ * @param pHash	[in] Hash
+ * @param len	[in] Length of the hash, in bytes
+ * @return Hexadecimal string
+ */
+static string hashToString(const uint8_t *pHash, size_t len)
+{
+	static constexpr char hex_lookup[] = "0123456789abcdef";
+	string s;
+	s.resize(len * 2);
+	for (size_t i = 0; i < len; i++) {
+		s[(i * 2) + 0] = hex_lookup[pHash[i] >> 4];
+		s[(i * 2) + 1] = hex_lookup[pHash[i] & 0x0F];
+	}
+	return s;
+}
+
+/**
+ * Verify a ROM image as a RomData ROM operation.
+ * Result fields are added to the end of the field list. If they were
+ * added by a previous verification, they're updated in place instead.
+ * @param file		[in] ROM file
+ * @param params	[in] Parameters
+ * @param fields	[in/out] RomFields (should already be loaded)
+ * @param pParams	[out] RomOpParams
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int doVerifyRomOp(const IRpFilePtr &file, const Params &params,
+	RomFields &fields, RomData::RomOpParams *pParams)
+{
+	Result result;
+	int ret = verify(file, params, result);
+	if (ret != 0) {
+		pParams->status = ret;
+		pParams->msg = C_("RomChecksum", "An error occurred while reading the ROM image.");
+		return ret;
+	}
+
+	// Result fields are added to the last tab.
+	// NOTE: Fields must be ordered by tab index.
+	fields.setTabIndex(fields.tabCount() - 1);
+
+	string s_checksum;
+	switch (params.algorithm) {
+		case Algorithm::None:
+			break;
+
+		case Algorithm::N64:
+			if (result.n64_cic == 0) {
+				s_checksum = C_("RomChecksum", "Unknown CIC; CRCs cannot be verified.");
+			} else if (result.valid) {
+				s_checksum = rp_sprintf_p(C_("RomChecksum", "0x%1$08X 0x%2$08X (valid; CIC-%3$u)"),
+					result.checksum[0], result.checksum[1], result.n64_cic);
+			} else {
+				s_checksum = rp_sprintf_p(C_("RomChecksum", "0x%1$08X 0x%2$08X (INVALID; should be 0x%3$08X 0x%4$08X)"),
+					params.expected[0], params.expected[1],
+					result.checksum[0], result.checksum[1]);
+			}
+			break;
+
+		default:
+			if (result.valid) {
+				s_checksum = rp_sprintf(C_("RomChecksum", "0x%04X (valid)"), result.checksum[0]);
+			} else {
+				s_checksum = rp_sprintf_p(C_("RomChecksum", "0x%1$04X (INVALID; should be 0x%2$04X)"),
+					params.expected[0], result.checksum[0]);
+			}
+			break;
+	}
+
+	pParams->fieldIdx.clear();
+	pParams->fieldIdx.reserve(4);
+	if (!s_checksum.empty()) {
+		setResultField(fields, C_("RomChecksum", "ROM Checksum"), s_checksum, pParams->fieldIdx);
+	}
+
+	char crc32_buf[16];
+	snprintf(crc32_buf, sizeof(crc32_buf), "%08X", result.crc32);
+	setResultField(fields, "CRC32", crc32_buf, pParams->fieldIdx);
+#ifdef ENABLE_DECRYPTION
+	const string s_md5 = hashToString(result.md5, sizeof(result.md5));
+	const string s_sha1 = hashToString(result.sha1, sizeof(result.sha1));
+	setResultField(fields, "MD5", s_md5, pParams->fieldIdx);
+	setResultField(fields, "SHA-1", s_sha1, pParams->fieldIdx);
+#endif /* ENABLE_DECRYPTION */
+
+	// Status message. Hashes are included, since the UI frontends
+	// can only update fields that were already displayed.
+	pParams->status = 0;
+	if (params.algorithm == Algorithm::None) {
+		pParams->msg = C_("RomChecksum", "ROM image hashes calculated.");
+	} else if (result.valid) {
+		pParams->msg = C_("RomChecksum", "ROM checksum is valid.");
+	} else if (params.algorithm == Algorithm::N64 && result.n64_cic == 0) {
+		pParams->msg = C_("RomChecksum", "ROM checksum could not be verified.");
+	} else {
+		pParams->msg = C_("RomChecksum", "ROM checksum is INVALID.");
+	}
+	pParams->msg += "\nCRC32: ";
+	pParams->msg += crc32_buf;
+#ifdef ENABLE_DECRYPTION
+	pParams->msg += "\nMD5: ";
+	pParams->msg += s_md5;
+	pParams->msg += "\nSHA-1: ";
+	pParams->msg += s_sha1;
+#endif /* ENABLE_DECRYPTION */
+	return 0;
+}
+
+} }
@@ -0,0 +1,191 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * RomChecksum.hpp: Full-ROM checksum verification for cartridge systems. *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "common.h"
+#include "dll-macros.h"	// for RP_LIBROMDATA_PUBLIC
+#include "config.librpbase.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// C++ includes
+#include <string>
+#include <vector>
+
+#include "librpbase/RomData.hpp"
+#include "librpfile/IRpFile.hpp"
+
+#include "librpcpuid/cpu_dispatch.h"
+#if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
+#  include "librpcpuid/cpuflags_x86.h"
+#  define RCS_HAS_SSE2 1
+#endif
+#ifdef RP_CPU_AMD64
+#  define RCS_ALWAYS_HAS_SSE2 1
+#endif
+
+namespace LibRpBase {
+	class RomFields;
+}
+
+namespace LibRomData { namespace RomChecksum {
+
+/**
+ * System checksum algorithm.
+ */
+enum class Algorithm : uint8_t {
+	None		= 0,	// No system checksum; hashes only.
+	MegaDrive	= 1,	// Sega Mega Drive: 16-bit BE word sum from 0x200 to EOF.
+	SNES		= 2,	// SNES: 16-bit byte sum, with mirroring for non-power-of-2 sizes.
+	GameBoy		= 3,	// Game Boy: 16-bit byte sum, excluding the checksum word at 0x14E.
+	N64		= 4,	// Nintendo 64: CRC1/CRC2, depending on the CIC.
+	WonderSwan	= 5,	// WonderSwan: 16-bit byte sum, excluding the last word.
+
+	Max
+};
+
+/**
+ * Data format flags.
+ */
+enum Flags : uint32_t {
+	RCF_SMD_INTERLEAVED	= (1U << 0),	// Super Magic Drive interleaved (16 KB blocks)
+	RCF_N64_V64		= (1U << 1),	// N64: 16-bit byteswapped (V64)
+	RCF_N64_SWAP2		= (1U << 2),	// N64: wordswapped (swap2)
+	RCF_N64_LE32		= (1U << 3),	// N64: 32-bit byteswapped (LE32)
+};
+
+/**
+ * Verification parameters.
+ */
+struct Params {
+	Algorithm algorithm;	// System checksum algorithm
+	uint32_t flags;		// Data format flags (see Flags)
+	off64_t offset;		// Start of the ROM data, e.g. after a copier header
+	off64_t size;		// Size of the ROM data (0 == until EOF)
+	uint32_t expected[2];	// Checksum(s) stored in the ROM header
+
+	Params()
+		: algorithm(Algorithm::None)
+		, flags(0)
+		, offset(0)
+		, size(0)
+	{
+		expected[0] = 0;
+		expected[1] = 0;
+	}
+};
+
+/**
+ * Verification results.
+ * Hashes are calculated over the normalized ROM data, i.e. without
+ * copier headers, deinterleaved, and in big-endian order for N64.
+ */
+struct Result {
+	off64_t size;		// Number of bytes processed
+	uint32_t checksum[2];	// Calculated checksum(s)
+	unsigned int n64_cic;	// N64 only: Detected CIC (e.g. 6102), or 0 if unknown.
+	bool valid;		// True if the checksum(s) match the expected values.
+
+	uint32_t crc32;
+#ifdef ENABLE_DECRYPTION
+	uint8_t md5[16];
+	uint8_t sha1[20];
+#endif /* ENABLE_DECRYPTION */
+};
+
+/** Internal algorithms **/
+// NOTE: These are public to allow for unit tests and benchmarking.
+
+/**
+ * Sum bytes at even and odd offsets.
+ * Standard version using regular C++ code.
+ * @param pData	[in] Data
+ * @param len	[in] Length of data, in bytes
+ * @param sums	[in/out] sums[0] += even bytes; sums[1] += odd bytes
+ */
+void RP_LIBROMDATA_PUBLIC sumBytes_cpp(const uint8_t *pData, size_t len, uint32_t sums[2]);
+
+#if RCS_HAS_SSE2
+/**
+ * Sum bytes at even and odd offsets.
+ * SSE2-optimized version.
+ * NOTE: pData must be 16-byte aligned, and len must be a multiple of 16.
+ * @param pData	[in] Data
+ * @param len	[in] Length of data, in bytes
+ * @param sums	[in/out] sums[0] += even bytes; sums[1] += odd bytes
+ */
+void RP_LIBROMDATA_PUBLIC sumBytes_sse2(const uint8_t *pData, size_t len, uint32_t sums[2]);
+#endif /* RCS_HAS_SSE2 */
+
+/**
+ * Sum bytes at even and odd offsets.
+ * Uses the best available implementation.
+ * NOTE: pData should be 2-byte aligned relative to the start of the ROM.
+ * @param pData	[in] Data
+ * @param len	[in] Length of data, in bytes
+ * @param sums	[in/out] sums[0] += even bytes; sums[1] += odd bytes
+ */
+void RP_LIBROMDATA_PUBLIC sumBytes(const uint8_t *pData, size_t len, uint32_t sums[2]);
+
+/**
+ * Calculate the N64 CRCs over the first 1 MB of program code.
+ * @param pData	[in] ROM data, in Z64 format. (Must be at least 0x101000 bytes.)
+ * @param cic	[in] CIC (6101, 6102, 6103, 6105, 6106, or 7102)
+ * @param crc	[out] CRCs
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RP_LIBROMDATA_PUBLIC n64CalcCRC(const uint8_t *pData, unsigned int cic, uint32_t crc[2]);
+
+/**
+ * Detect the N64 CIC using the boot code.
+ * @param pData	[in] ROM data, in Z64 format. (Must be at least 0x1000 bytes.)
+ * @return CIC (e.g. 6102), or 0 if unknown.
+ */
+unsigned int RP_LIBROMDATA_PUBLIC n64DetectCIC(const uint8_t *pData);
+
+/** Main functions **/
+
+/**
+ * Verify a ROM image by reading it in a single streaming pass.
+ * The system checksum, CRC32, and (if available) MD5 and SHA-1
+ * are all calculated from the same buffers.
+ * @param file		[in] ROM file
+ * @param params	[in] Parameters
+ * @param result	[out] Results
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RP_LIBROMDATA_PUBLIC verify(const LibRpFile::IRpFilePtr &file, const Params &params, Result &result);
+
+/**
+ * Set a verification result field.
+ * If the field was added by a previous verification, it's updated in place.
+ * NOTE: New fields are added to the current tab.
+ * @param fields	[in/out] RomFields
+ * @param name		[in] Field name
+ * @param str		[in] Field value
+ * @param fieldIdx	[in/out] Updated field indexes
+ */
+void setResultField(LibRpBase::RomFields &fields, const char *name,
+	const std::string &str, std::vector<int> &fieldIdx);
+
+/**
+ * Verify a ROM image as a RomData ROM operation.
+ * Result fields are added to the end of the last tab. If they were
+ * added by a previous verification, they're updated in place instead.
+ * @param file		[in] ROM file
+ * @param params	[in] Parameters
+ * @param fields	[in/out] RomFields (should already be loaded)
+ * @param pParams	[out] RomOpParams
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int doVerifyRomOp(const LibRpFile::IRpFilePtr &file, const Params &params,
+	LibRpBase::RomFields &fields, LibRpBase::RomData::RomOpParams *pParams);
+
+} }
@@ -0,0 +1,81 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * RomChecksum_sse2.cpp: Full-ROM checksum verification for cartridge     *
+ * systems. SSE2-optimized version.                                        *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RomChecksum.hpp"
+
+// SSE2 intrinsics
+#include <emmintrin.h>
+
+namespace LibRomData { namespace RomChecksum {
+
+/**
+ * Sum bytes at even and odd offsets.
+ * SSE2-optimized version.
+ * NOTE: pData must be 16-byte aligned, and len must be a multiple of 16.
+ * @param pData	[in] Data
+ * @param len	[in] Length of data, in bytes
+ * @param sums	[in/out] sums[0] += even bytes; sums[1] += odd bytes
+ */
+void sumBytes_sse2(const uint8_t *pData, size_t len, uint32_t sums[2])
+{
+	ASSERT_ALIGNMENT(16, pData);
+	assert(len % 16 == 0);
+
+	// PSADBW against zero sums each group of 8 bytes into a 64-bit lane.
+	// Even bytes are the low bytes of each 16-bit word.
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask_even = _mm_set1_epi16(0x00FF);
+	__m128i acc_even = _mm_setzero_si128();
+	__m128i acc_odd = _mm_setzero_si128();
+
+	const __m128i *p = reinterpret_cast<const __m128i*>(pData);
+	const __m128i *const p_end4 = p + ((len / 16) & ~static_cast<size_t>(3));
+	const __m128i *const p_end = p + (len / 16);
+
+	// Process 64 bytes (512 bits) at a time.
+	for (; p < p_end4; p += 4) {
+		const __m128i x0 = _mm_load_si128(&p[0]);
+		const __m128i x1 = _mm_load_si128(&p[1]);
+		const __m128i x2 = _mm_load_si128(&p[2]);
+		const __m128i x3 = _mm_load_si128(&p[3]);
+
+		// NOTE: Each 16-bit lane is at most 0xFF*4, so adding
+		// the vectors before PSADBW can't overflow.
+		const __m128i even = _mm_add_epi16(
+			_mm_add_epi16(_mm_and_si128(x0, mask_even), _mm_and_si128(x1, mask_even)),
+			_mm_add_epi16(_mm_and_si128(x2, mask_even), _mm_and_si128(x3, mask_even)));
+		const __m128i odd = _mm_add_epi16(
+			_mm_add_epi16(_mm_srli_epi16(x0, 8), _mm_srli_epi16(x1, 8)),
+			_mm_add_epi16(_mm_srli_epi16(x2, 8), _mm_srli_epi16(x3, 8)));
+
+		// PSADBW works on bytes, so split the 16-bit lanes
+		// into low and high bytes.
+		acc_even = _mm_add_epi64(acc_even, _mm_sad_epu8(_mm_and_si128(even, mask_even), zero));
+		acc_even = _mm_add_epi64(acc_even, _mm_slli_epi64(_mm_sad_epu8(_mm_srli_epi16(even, 8), zero), 8));
+		acc_odd  = _mm_add_epi64(acc_odd,  _mm_sad_epu8(_mm_and_si128(odd, mask_even), zero));
+		acc_odd  = _mm_add_epi64(acc_odd,  _mm_slli_epi64(_mm_sad_epu8(_mm_srli_epi16(odd, 8), zero), 8));
+	}
+
+	// Remaining 16-byte blocks.
+	for (; p < p_end; p++) {
+		const __m128i x = _mm_load_si128(p);
+		acc_even = _mm_add_epi64(acc_even, _mm_sad_epu8(_mm_and_si128(x, mask_even), zero));
+		acc_odd  = _mm_add_epi64(acc_odd,  _mm_sad_epu8(_mm_srli_epi16(x, 8), zero));
+	}
+
+	// Combine the two 64-bit lanes.
+	// Only the low 32 bits are needed.
+	acc_even = _mm_add_epi64(acc_even, _mm_srli_si128(acc_even, 8));
+	acc_odd  = _mm_add_epi64(acc_odd,  _mm_srli_si128(acc_odd, 8));
+	sums[0] += static_cast<uint32_t>(_mm_cvtsi128_si32(acc_even));
+	sums[1] += static_cast<uint32_t>(_mm_cvtsi128_si32(acc_odd));
+}
+
+} }
@@ -782,6 +782,37 @@ int RomData::loadInternalMipmap(int mipmapLevel, LibRpTexture::rp_image_const_pt
 	return -ENOENT;
 }
 
+/**
+ * Get the number of mipmap levels for IMG_INT_IMAGE.
+ * This includes mipmap level 0, i.e. the full image.
+ * @return Number of mipmap levels, or 0 if mipmaps aren't supported.
+ */
+int RomData::mipmapCount(void) const
+{
+	// No mipmaps are supported by the base class.
+	return 0;
+}
+
+/**
+ * Get the dimensions of an IMG_INT_IMAGE mipmap level
+ * without loading the mipmap.
+ * @param mipmapLevel	[in] Mipmap level.
+ * @param pBuf		[out] Two-element array for [x, y].
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomData::getMipmapDimensions(int mipmapLevel, int pBuf[2]) const
+{
+	RP_UNUSED(pBuf);
+	assert(mipmapLevel >= 0);
+	if (mipmapLevel < 0) {
+		// mipmapLevel is out of range.
+		return -EINVAL;
+	}
+
+	// No mipmaps are supported by the base class.
+	return -ENOENT;
+}
+
 /**
  * Load metadata properties.
  * Called by RomData::metaData() if the metadata hasn't been loaded yet.
@@ -1033,20 +1064,33 @@ int RomData::doRomOp(int id, RomOpParams *pParams)
 		return -EINVAL;
 	}
 
+	// NOTE: Directory-based RomData subclasses don't have
+	// a file or filename, so there's nothing to reopen.
+#ifdef _WIN32
+	const bool hasFilename = (d->filename || d->filenameW);
+#else /* !_WIN32 */
+	const bool hasFilename = (d->filename != nullptr);
+#endif /* _WIN32 */
+
 	bool closeFileAfter;
-	if (d->file) {
+	if (d->file || !hasFilename) {
 		closeFileAfter = false;
 	} else {
 		// Reopen the file.
+		// Verification operations don't modify the file,
+		// so the file can be opened read-only. This also
+		// allows verification of compressed files.
 		closeFileAfter = true;
+		const bool isVerify = !!(v_ops[id].flags & RomOp::ROF_VERIFY);
+		const RpFile::FileMode mode = (isVerify ? RpFile::FM_OPEN_READ_GZ : RpFile::FM_OPEN_WRITE);
 		IRpFilePtr file;
 #ifdef _WIN32
 		if (d->filenameW) {
-			file = std::make_shared<RpFile>(d->filenameW, RpFile::FM_OPEN_WRITE);
+			file = std::make_shared<RpFile>(d->filenameW, mode);
 		} else
 #endif /* _WIN32 */
 		{
-			file = std::make_shared<RpFile>(d->filename, RpFile::FM_OPEN_WRITE);
+			file = std::make_shared<RpFile>(d->filename, mode);
 		}
 
 		if (!file->isOpen()) {
@@ -1056,7 +1100,9 @@ int RomData::doRomOp(int id, RomOpParams *pParams)
 				ret = -EIO;
 			}
 			pParams->status = ret;
-			pParams->msg = C_("RomData", "Unable to reopen the file for writing.");
+			pParams->msg = (isVerify)
+				? C_("RomData", "Unable to reopen the file.")
+				: C_("RomData", "Unable to reopen the file for writing.");
 			return ret;
 		}
 		d->file = std::move(file);
@@ -1066,6 +1112,12 @@ int RomData::doRomOp(int id, RomOpParams *pParams)
 	// make sure it's writable.
 	if (v_ops[id].flags & RomOp::ROF_REQ_WRITABLE) {
 		// Writable file is required.
+		if (!d->file) {
+			// No file to write to.
+			pParams->status = -EBADF;
+			pParams->msg = C_("RomData", "Unable to reopen the file for writing.");
+			return -EBADF;
+		}
 		if (d->file->isCompressed()) {
 			// Cannot write to a compressed file.
 			pParams->status = -EIO;
@@ -437,6 +437,22 @@ public:
 	 */
 	virtual int loadInternalMipmap(int mipmapLevel, LibRpTexture::rp_image_const_ptr &pImage);
 
+	/**
+	 * Get the number of mipmap levels for IMG_INT_IMAGE.
+	 * This includes mipmap level 0, i.e. the full image.
+	 * @return Number of mipmap levels, or 0 if mipmaps aren't supported.
+	 */
+	virtual int mipmapCount(void) const;
+
+	/**
+	 * Get the dimensions of an IMG_INT_IMAGE mipmap level
+	 * without loading the mipmap.
+	 * @param mipmapLevel	[in] Mipmap level.
+	 * @param pBuf		[out] Two-element array for [x, y].
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	virtual int getMipmapDimensions(int mipmapLevel, int pBuf[2]) const;
+
 public:
 	/**
 	 * Get the ROM Fields object.
@@ -569,6 +585,7 @@ public:
 			ROF_ENABLED		= (1U << 0),	// Set to enable the ROM op
 			ROF_REQ_WRITABLE	= (1U << 1),	// Requires a writable RomData
 			ROF_SAVE_FILE		= (1U << 2),	// Prompt to save a new file
+			ROF_VERIFY		= (1U << 3),	// Verification only; file is not modified
 		};
 
 		// Data depends on RomOpsFlags.
@@ -607,9 +624,22 @@ public:
 		/** IN: Parameters **/
 		const char *save_filename;	// Filename for saving data.
 
+		/**
+		 * Progress callback for long-running operations. (optional)
+		 * @param userdata	[in] User data
+		 * @param done		[in] Amount of work done
+		 * @param total		[in] Total amount of work
+		 * @return True to continue; false to cancel.
+		 */
+		typedef bool (*ProgressFn)(void *userdata, uint64_t done, uint64_t total);
+		ProgressFn progressFn;		// Progress callback. (optional)
+		void *progressUserData;		// User data for progressFn.
+
 		RomOpParams()
 			: status(0)
 			, save_filename(nullptr)
+			, progressFn(nullptr)
+			, progressUserData(nullptr)
 		{}
 	};
 
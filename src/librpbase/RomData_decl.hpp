@@ -177,7 +177,23 @@ public: \
 	 * @param pImage	[out] Reference to rp_image_const_ptr to store the image in. \
 	 * @return 0 on success; negative POSIX error code on error. \
 	 */ \
-	int loadInternalMipmap(int mipmapLevel, LibRpTexture::rp_image_const_ptr &pImage) final;
+	int loadInternalMipmap(int mipmapLevel, LibRpTexture::rp_image_const_ptr &pImage) final; \
+	\
+	/** \
+	 * Get the number of mipmap levels for IMG_INT_IMAGE. \
+	 * This includes mipmap level 0, i.e. the full image. \
+	 * @return Number of mipmap levels, or 0 if mipmaps aren't supported. \
+	 */ \
+	int mipmapCount(void) const final; \
+	\
+	/** \
+	 * Get the dimensions of an IMG_INT_IMAGE mipmap level \
+	 * without loading the mipmap. \
+	 * @param mipmapLevel	[in] Mipmap level. \
+	 * @param pBuf		[out] Two-element array for [x, y]. \
+	 * @return 0 on success; negative POSIX error code on error. \
+	 */ \
+	int getMipmapDimensions(int mipmapLevel, int pBuf[2]) const final;
 
 /**
  * RomData subclass function declaration for obtaining URLs for external images.
@@ -178,4 +178,29 @@ off64_t DiscReader::size(void)
 	return m_length;
 }
 
+/**
+ * Announce that a range of the disc image will be read soon.
+ * The disc image position is not changed.
+ * @param pos	[in] Starting position
+ * @param size	[in] Size of the range, in bytes
+ * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+ */
+int DiscReader::prefetch(off64_t pos, off64_t size)
+{
+	assert(m_file != nullptr);
+	if (!m_file) {
+		return -EBADF;
+	} else if (pos < 0 || size < 0) {
+		return -EINVAL;
+	} else if (pos >= m_length) {
+		// Nothing to prefetch.
+		return 0;
+	}
+
+	if (size > m_length - pos) {
+		size = m_length - pos;
+	}
+	return m_file->prefetch(m_offset + pos, size);
+}
+
 }
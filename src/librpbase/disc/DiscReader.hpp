@@ -89,6 +89,15 @@ class DiscReader final : public IDiscReader
 		 */
 		off64_t size(void) override;
 
+		/**
+		 * Announce that a range of the disc image will be read soon.
+		 * The disc image position is not changed.
+		 * @param pos	[in] Starting position
+		 * @param size	[in] Size of the range, in bytes
+		 * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+		 */
+		int prefetch(off64_t pos, off64_t size) final;
+
 	protected:
 		// Offset/length. Useful for e.g. GameCube TGC.
 		off64_t m_offset;
@@ -168,4 +168,30 @@ off64_t PartitionFile::size(void)
 	return m_size;
 }
 
+/** Extra functions **/
+
+/**
+ * Announce that a range of the file will be read soon.
+ * The file position is not changed.
+ * @param pos	[in] Starting position
+ * @param size	[in] Size of the range, in bytes
+ * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+ */
+int PartitionFile::prefetch(off64_t pos, off64_t size)
+{
+	if (!m_partition) {
+		return -EBADF;
+	} else if (pos < 0 || size < 0) {
+		return -EINVAL;
+	} else if (pos >= m_size) {
+		// Nothing to prefetch.
+		return 0;
+	}
+
+	if (size > m_size - pos) {
+		size = m_size - pos;
+	}
+	return m_partition->prefetch(m_offset + pos, size);
+}
+
 }
@@ -90,6 +90,18 @@ class PartitionFile final : public LibRpFile::IRpFile
 		 */
 		off64_t size(void) final;
 
+	public:
+		/** Extra functions **/
+
+		/**
+		 * Announce that a range of the file will be read soon.
+		 * The file position is not changed.
+		 * @param pos	[in] Starting position
+		 * @param size	[in] Size of the range, in bytes
+		 * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+		 */
+		int prefetch(off64_t pos, off64_t size) final;
+
 	protected:
 		IDiscReader *m_partition;
 		off64_t m_offset;	// File starting offset.
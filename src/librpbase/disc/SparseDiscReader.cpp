@@ -23,6 +23,11 @@ SparseDiscReaderPrivate::SparseDiscReaderPrivate(SparseDiscReader *q)
 	, disc_size(0)
 	, pos(-1)
 	, block_size(0)
+	, blockCacheBufSize(0)
+	, blockCacheCount(BLOCK_CACHE_DEFAULT_COUNT)
+	, blockCacheTick(0)
+	, blockCacheHits(0)
+	, blockCacheMisses(0)
 {
 	// NOTE: Can't check q->m_file here.
 
@@ -30,6 +35,122 @@ SparseDiscReaderPrivate::SparseDiscReaderPrivate(SparseDiscReader *q)
 	// set by the subclass.
 }
 
+/**
+ * Initialize the block cache.
+ *
+ * This should be called by subclasses that need to decompress
+ * blocks once block_size is known. The cache is shared by all
+ * compressed disc image formats, and uses LRU eviction.
+ *
+ * @param buf_size Size of each cache entry's buffer. (Must be >= block_size.)
+ */
+void SparseDiscReaderPrivate::initBlockCache(size_t buf_size)
+{
+	assert(buf_size >= block_size);
+	blockCacheBufSize = buf_size;
+	blockCacheEntries.assign(blockCacheCount, {~0U, 0});
+	blockCacheData.resize(blockCacheCount * buf_size);
+	blockCacheTick = 0;
+}
+
+/**
+ * Set the number of entries in the block cache.
+ * All cached blocks will be discarded.
+ * @param count Number of entries (minimum 1)
+ */
+void SparseDiscReaderPrivate::setBlockCacheCount(unsigned int count)
+{
+	assert(count > 0);
+	if (count == 0) {
+		count = 1;
+	}
+	blockCacheCount = count;
+
+	if (blockCacheBufSize != 0) {
+		// Block cache is in use. Reinitialize it.
+		initBlockCache(blockCacheBufSize);
+	}
+}
+
+/**
+ * Get a block from the block cache.
+ * This marks the block as the most recently used block.
+ * @param blockIdx Block index
+ * @return Pointer to the cached block data, or nullptr if the block isn't cached.
+ */
+const uint8_t *SparseDiscReaderPrivate::getCachedBlock(uint32_t blockIdx)
+{
+	assert(blockCacheBufSize != 0);
+
+	// NOTE: The cache is small, so a linear search is sufficient.
+	const size_t count = blockCacheEntries.size();
+	for (size_t i = 0; i < count; i++) {
+		BlockCacheEntry &entry = blockCacheEntries[i];
+		if (entry.blockIdx == blockIdx) {
+			// Found the block.
+			entry.lastUsed = ++blockCacheTick;
+			blockCacheHits++;
+			return &blockCacheData[i * blockCacheBufSize];
+		}
+	}
+
+	// Block is not cached.
+	blockCacheMisses++;
+	return nullptr;
+}
+
+/**
+ * Allocate a block cache entry, evicting the least recently used block if necessary.
+ *
+ * The caller must fill the returned buffer with the block data.
+ * If the block cannot be loaded, invalidateCachedBlock() must be called.
+ *
+ * @param blockIdx Block index
+ * @return Pointer to the block cache entry's buffer. (blockCacheBufSize bytes)
+ */
+uint8_t *SparseDiscReaderPrivate::allocCachedBlock(uint32_t blockIdx)
+{
+	assert(blockCacheBufSize != 0);
+	assert(!blockCacheEntries.empty());
+
+	// Find an unused entry, or the least recently used entry.
+	// NOTE: Unused entries have lastUsed == 0.
+	const size_t count = blockCacheEntries.size();
+	size_t lru = 0;
+	for (size_t i = 0; i < count; i++) {
+		const BlockCacheEntry &entry = blockCacheEntries[i];
+		if (entry.blockIdx == ~0U) {
+			// Unused entry.
+			lru = i;
+			break;
+		}
+		// NOTE: Comparing the difference from the current tick
+		// handles wraparound correctly.
+		if ((blockCacheTick - entry.lastUsed) > (blockCacheTick - blockCacheEntries[lru].lastUsed)) {
+			lru = i;
+		}
+	}
+
+	BlockCacheEntry &entry = blockCacheEntries[lru];
+	entry.blockIdx = blockIdx;
+	entry.lastUsed = ++blockCacheTick;
+	return &blockCacheData[lru * blockCacheBufSize];
+}
+
+/**
+ * Invalidate a block in the block cache.
+ * @param blockIdx Block index
+ */
+void SparseDiscReaderPrivate::invalidateCachedBlock(uint32_t blockIdx)
+{
+	for (BlockCacheEntry &entry : blockCacheEntries) {
+		if (entry.blockIdx == blockIdx) {
+			entry.blockIdx = ~0U;
+			entry.lastUsed = 0;
+		}
+	}
+}
+
 /** SparseDiscReader **/
 
 SparseDiscReader::SparseDiscReader(SparseDiscReaderPrivate *d, const IRpFilePtr &file)
@@ -209,6 +330,113 @@ off64_t SparseDiscReader::size(void)
 	return d->disc_size;
 }
 
+/**
+ * Announce that a range of the disc image will be read soon.
+ * The disc image position is not changed.
+ *
+ * The logical range is converted to physical block ranges
+ * using getPhysBlockAddr(). Subclasses that override readBlock()
+ * instead of getPhysBlockAddr() should override this function.
+ *
+ * @param pos	[in] Starting position
+ * @param size	[in] Size of the range, in bytes
+ * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+ */
+int SparseDiscReader::prefetch(off64_t pos, off64_t size)
+{
+	RP_D(const SparseDiscReader);
+	if (!m_file || d->disc_size <= 0 || d->block_size == 0) {
+		// Disc image wasn't initialized properly.
+		return -EBADF;
+	} else if (pos < 0 || size < 0) {
+		return -EINVAL;
+	} else if (size == 0 || pos >= d->disc_size) {
+		// Nothing to prefetch.
+		return 0;
+	}
+
+	if (size > d->disc_size - pos) {
+		size = d->disc_size - pos;
+	}
+
+	// Merge physical blocks into contiguous ranges.
+	// NOTE: Compressed blocks may be smaller than block_size,
+	// so a block that starts within the current range is
+	// considered to be contiguous.
+	const uint32_t blockStart = static_cast<uint32_t>(pos / d->block_size);
+	const uint32_t blockEnd = static_cast<uint32_t>((pos + size - 1) / d->block_size);
+	off64_t range_start = -1, range_end = -1;
+	int ret = 0;
+	for (uint32_t blockIdx = blockStart; blockIdx <= blockEnd; blockIdx++) {
+		const off64_t physBlockAddr = getPhysBlockAddr(blockIdx);
+		if (physBlockAddr <= 0) {
+			// Empty or invalid block.
+			continue;
+		}
+
+		if (range_start >= 0 && physBlockAddr >= range_start && physBlockAddr <= range_end) {
+			// Block is contiguous with the current range.
+			range_end = std::max(range_end, physBlockAddr + static_cast<off64_t>(d->block_size));
+			continue;
+		}
+
+		// Prefetch the current range and start a new one.
+		if (range_start >= 0) {
+			ret = m_file->prefetch(range_start, range_end - range_start);
+		}
+		range_start = physBlockAddr;
+		range_end = physBlockAddr + d->block_size;
+	}
+	if (range_start >= 0) {
+		ret = m_file->prefetch(range_start, range_end - range_start);
+	}
+
+	return ret;
+}
+
+/** Block cache **/
+
+/**
+ * Get the number of entries in the block cache.
+ * @return Number of entries in the block cache
+ */
+unsigned int SparseDiscReader::blockCacheCount(void) const
+{
+	RP_D(const SparseDiscReader);
+	return d->blockCacheCount;
+}
+
+/**
+ * Set the number of entries in the block cache.
+ * All cached blocks will be discarded.
+ * @param count Number of entries (minimum 1)
+ */
+void SparseDiscReader::setBlockCacheCount(unsigned int count)
+{
+	RP_D(SparseDiscReader);
+	d->setBlockCacheCount(count);
+}
+
+/**
+ * Get the number of block cache hits.
+ * @return Number of block cache hits
+ */
+unsigned int SparseDiscReader::blockCacheHits(void) const
+{
+	RP_D(const SparseDiscReader);
+	return d->blockCacheHits;
+}
+
+/**
+ * Get the number of block cache misses.
+ * @return Number of block cache misses
+ */
+unsigned int SparseDiscReader::blockCacheMisses(void) const
+{
+	RP_D(const SparseDiscReader);
+	return d->blockCacheMisses;
+}
+
 /** SparseDiscReader **/
 
 /**
@@ -59,6 +59,53 @@ class NOVTABLE SparseDiscReader : public IDiscReader
 		 */
 		off64_t size(void) final;
 
+		/**
+		 * Announce that a range of the disc image will be read soon.
+		 * The disc image position is not changed.
+		 *
+		 * The logical range is converted to physical block ranges
+		 * using getPhysBlockAddr(). Subclasses that override readBlock()
+		 * instead of getPhysBlockAddr() should override this function.
+		 *
+		 * @param pos	[in] Starting position
+		 * @param size	[in] Size of the range, in bytes
+		 * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+		 */
+		int prefetch(off64_t pos, off64_t size) override;
+
+	public:
+		/** Block cache **/
+
+		// Subclasses that decompress blocks keep the most recently
+		// used blocks in an LRU cache, so switching between e.g.
+		// the FST and the banner doesn't decompress the same
+		// blocks over and over again.
+
+		/**
+		 * Get the number of entries in the block cache.
+		 * @return Number of entries in the block cache
+		 */
+		unsigned int blockCacheCount(void) const;
+
+		/**
+		 * Set the number of entries in the block cache.
+		 * All cached blocks will be discarded.
+		 * @param count Number of entries (minimum 1)
+		 */
+		void setBlockCacheCount(unsigned int count);
+
+		/**
+		 * Get the number of block cache hits.
+		 * @return Number of block cache hits
+		 */
+		unsigned int blockCacheHits(void) const;
+
+		/**
+		 * Get the number of block cache misses.
+		 * @return Number of block cache misses
+		 */
+		unsigned int blockCacheMisses(void) const;
+
 	protected:
 		/** Virtual functions for SparseDiscReader subclasses. **/
 
@@ -13,6 +13,10 @@
 #include <stdint.h>
 #include "common.h"
 
+// C++ includes
+#include <vector>
+#include "uvector.h"
+
 namespace LibRpBase {
 
 class SparseDiscReader;
@@ -33,6 +37,69 @@ class SparseDiscReaderPrivate
 		off64_t disc_size;		// Virtual disc image size.
 		off64_t pos;			// Read position.
 		unsigned int block_size;	// Block size.
+
+	public:
+		/** Block cache **/
+
+		// Default number of entries in the block cache.
+		static constexpr unsigned int BLOCK_CACHE_DEFAULT_COUNT = 16;
+
+		/**
+		 * Initialize the block cache.
+		 *
+		 * This should be called by subclasses that need to decompress
+		 * blocks once block_size is known. The cache is shared by all
+		 * compressed disc image formats, and uses LRU eviction.
+		 *
+		 * @param buf_size Size of each cache entry's buffer. (Must be >= block_size.)
+		 */
+		void initBlockCache(size_t buf_size);
+
+		/**
+		 * Set the number of entries in the block cache.
+		 * All cached blocks will be discarded.
+		 * @param count Number of entries (minimum 1)
+		 */
+		void setBlockCacheCount(unsigned int count);
+
+		/**
+		 * Get a block from the block cache.
+		 * This marks the block as the most recently used block.
+		 * @param blockIdx Block index
+		 * @return Pointer to the cached block data, or nullptr if the block isn't cached.
+		 */
+		const uint8_t *getCachedBlock(uint32_t blockIdx);
+
+		/**
+		 * Allocate a block cache entry, evicting the least recently used block if necessary.
+		 *
+		 * The caller must fill the returned buffer with the block data.
+		 * If the block cannot be loaded, invalidateCachedBlock() must be called.
+		 *
+		 * @param blockIdx Block index
+		 * @return Pointer to the block cache entry's buffer. (blockCacheBufSize bytes)
+		 */
+		uint8_t *allocCachedBlock(uint32_t blockIdx);
+
+		/**
+		 * Invalidate a block in the block cache.
+		 * @param blockIdx Block index
+		 */
+		void invalidateCachedBlock(uint32_t blockIdx);
+
+		struct BlockCacheEntry {
+			uint32_t blockIdx;	// Block index (~0U if unused)
+			uint32_t lastUsed;	// Last-used tick (for LRU)
+		};
+		std::vector<BlockCacheEntry> blockCacheEntries;
+		rp::uvector<uint8_t> blockCacheData;	// blockCacheEntries.size() * blockCacheBufSize
+		size_t blockCacheBufSize;		// Buffer size per entry (0 if the cache isn't used)
+		unsigned int blockCacheCount;		// Number of cache entries
+		uint32_t blockCacheTick;		// Current LRU tick
+
+		// Block cache statistics
+		unsigned int blockCacheHits;
+		unsigned int blockCacheMisses;
 };
 
 }
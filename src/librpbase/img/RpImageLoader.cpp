@@ -49,6 +49,23 @@ static constexpr array<uint8_t, 4> exif_magic = {{'E','x','i','f'}};
  * @return rp_image*, or nullptr on error.
  */
 rp_image_ptr load(const IRpFilePtr &file)
+{
+	return load(file, 0, nullptr);
+}
+
+/**
+ * Load an image from an IRpFile, decoding it at a reduced size if possible.
+ *
+ * JPEG images will be decoded at 1/2, 1/4, or 1/8 size using
+ * DCT scaling, as long as the larger dimension is still at
+ * least reqSize. Other formats are always decoded at full size.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param reqSize	[in] Requested image size (single dimension; assuming square image) [0 for full size]
+ * @param pFullSize	[out,opt] Two-element array for the full image size [x, y]
+ * @return rp_image*, or nullptr on error.
+ */
+rp_image_ptr load(const IRpFilePtr &file, int reqSize, int pFullSize[2])
 {
 	file->rewind();
 
@@ -59,7 +76,12 @@ rp_image_ptr load(const IRpFilePtr &file)
 		// Check for PNG.
 		if (!memcmp(buf, png_magic.data(), png_magic.size())) {
 			// Found a PNG image.
-			return RpPng::load(file);
+			rp_image_ptr img = RpPng::load(file);
+			if (img && pFullSize) {
+				pFullSize[0] = img->width();
+				pFullSize[1] = img->height();
+			}
+			return img;
 		}
 #ifdef HAVE_JPEG
 		else if (buf[0] == 0xFF && buf[1] != 0xFF && buf[2] == 0xFF) {
@@ -69,7 +91,7 @@ rp_image_ptr load(const IRpFilePtr &file)
 			    !memcmp(&buf[6], exif_magic.data(), exif_magic.size()))
 			{
 				// Found a JPEG image.
-				return RpJpeg::load(file);
+				return RpJpeg::load(file, reqSize, pFullSize);
 			}
 		}
 #endif /* HAVE_JPEG */
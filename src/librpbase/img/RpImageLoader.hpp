@@ -24,4 +24,19 @@ namespace LibRpBase { namespace RpImageLoader {
 RP_LIBROMDATA_PUBLIC
 LibRpTexture::rp_image_ptr load(const LibRpFile::IRpFilePtr &file);
 
+/**
+ * Load an image from an IRpFile, decoding it at a reduced size if possible.
+ *
+ * JPEG images will be decoded at 1/2, 1/4, or 1/8 size using
+ * DCT scaling, as long as the larger dimension is still at
+ * least reqSize. Other formats are always decoded at full size.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param reqSize	[in] Requested image size (single dimension; assuming square image) [0 for full size]
+ * @param pFullSize	[out,opt] Two-element array for the full image size [x, y]
+ * @return rp_image*, or nullptr on error.
+ */
+RP_LIBROMDATA_PUBLIC
+LibRpTexture::rp_image_ptr load(const LibRpFile::IRpFilePtr &file, int reqSize, int pFullSize[2] = nullptr);
+
 } }
@@ -204,10 +204,17 @@ void RpJpegPrivate::jpeg_IRpFile_src(j_decompress_ptr cinfo, IRpFile *infile)
 
 /**
  * Load a JPEG image from an IRpFile.
- * @param file IRpFile to load from.
+ *
+ * If reqSize is specified, the image will be decoded at 1/2, 1/4,
+ * or 1/8 size using DCT scaling, as long as its larger dimension
+ * is still at least reqSize.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param reqSize	[in,opt] Requested image size (single dimension; assuming square image) [0 for full size]
+ * @param pFullSize	[out,opt] Two-element array for the full image size [x, y]
  * @return rp_image*, or nullptr on error.
  */
-rp_image_ptr RpJpeg::load(const IRpFilePtr &file)
+rp_image_ptr RpJpeg::load(const IRpFilePtr &file, int reqSize, int pFullSize[2])
 {
 	if (!file)
 		return nullptr;
@@ -287,7 +294,26 @@ rp_image_ptr RpJpeg::load(const IRpFilePtr &file)
 		return nullptr;
 	}
 
+	if (pFullSize) {
+		pFullSize[0] = static_cast<int>(cinfo.image_width);
+		pFullSize[1] = static_cast<int>(cinfo.image_height);
+	}
+
 	/** Step 4: Set parameters for decompression. **/
+	if (reqSize > 0) {
+		// Use the smallest DCT scale that keeps the larger
+		// dimension at least as large as the requested size.
+		// All versions of libjpeg support 1/2, 1/4, and 1/8.
+		const unsigned int max_dim = std::max(cinfo.image_width, cinfo.image_height);
+		for (unsigned int denom = 8; denom > 1; denom >>= 1) {
+			if ((max_dim + denom - 1) / denom >= static_cast<unsigned int>(reqSize)) {
+				cinfo.scale_num = 1;
+				cinfo.scale_denom = denom;
+				break;
+			}
+		}
+	}
+
 	// Make sure we use libjpeg's built-in colorspace conversion
 	// where possible.
 	switch (cinfo.jpeg_color_space) {
@@ -386,7 +412,7 @@ rp_image_ptr RpJpeg::load(const IRpFilePtr &file)
 				return nullptr;
 			}
 
-			img = new rp_image(cinfo.image_width, cinfo.image_height, rp_image::Format::ARGB32);
+			img = new rp_image(cinfo.output_width, cinfo.output_height, rp_image::Format::ARGB32);
 			if (!img->isValid()) {
 				// Could not allocate the image.
 				delete img;
@@ -407,7 +433,7 @@ rp_image_ptr RpJpeg::load(const IRpFilePtr &file)
 				return nullptr;
 			}
 
-			img = new rp_image(cinfo.image_width, cinfo.image_height, rp_image::Format::ARGB32);
+			img = new rp_image(cinfo.output_width, cinfo.output_height, rp_image::Format::ARGB32);
 			if (!img->isValid()) {
 				// Could not allocate the image.
 				delete img;
@@ -426,7 +452,7 @@ rp_image_ptr RpJpeg::load(const IRpFilePtr &file)
 				return nullptr;
 			}
 
-			img = new rp_image(cinfo.image_width, cinfo.image_height, rp_image::Format::ARGB32);
+			img = new rp_image(cinfo.output_width, cinfo.output_height, rp_image::Format::ARGB32);
 			if (!img->isValid()) {
 				// Could not allocate the image.
 				delete img;
@@ -28,10 +28,18 @@ class RpJpeg
 	public:
 		/**
 		 * Load a JPEG image from an IRpFile.
-		 * @param file IRpFile to load from.
+		 *
+		 * If reqSize is specified, the image will be decoded at 1/2, 1/4,
+		 * or 1/8 size using DCT scaling, as long as its larger dimension
+		 * is still at least reqSize.
+		 *
+		 * @param file		[in] IRpFile to load from.
+		 * @param reqSize	[in,opt] Requested image size (single dimension; assuming square image) [0 for full size]
+		 * @param pFullSize	[out,opt] Two-element array for the full image size [x, y]
 		 * @return rp_image*, or nullptr on error.
 		 */
-		static LibRpTexture::rp_image_ptr load(const LibRpFile::IRpFilePtr &file);
+		static LibRpTexture::rp_image_ptr load(const LibRpFile::IRpFilePtr &file,
+			int reqSize = 0, int pFullSize[2] = nullptr);
 };
 
 }
@@ -34,10 +34,17 @@ namespace LibRpBase {
 
 /**
  * Load a JPEG image from an IRpFile.
- * @param file IRpFile to load from.
+ *
+ * If reqSize is specified, the image will be decoded at 1/2, 1/4,
+ * or 1/8 size using DCT scaling, as long as its larger dimension
+ * is still at least reqSize.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param reqSize	[in,opt] Requested image size (single dimension; assuming square image) [0 for full size]
+ * @param pFullSize	[out,opt] Two-element array for the full image size [x, y]
  * @return rp_image*, or nullptr on error.
  */
-rp_image_ptr RpJpeg::load(const IRpFilePtr &file)
+rp_image_ptr RpJpeg::load(const IRpFilePtr &file, int reqSize, int pFullSize[2])
 {
 	if (!file)
 		return nullptr;
@@ -55,8 +62,15 @@ rp_image_ptr RpJpeg::load(const IRpFilePtr &file)
 	}
 
 	// Create an rp_image using the GDI+ bitmap.
+	// NOTE: GDI+ doesn't support DCT scaling, so reqSize is ignored.
+	RP_UNUSED(reqSize);
 	RpGdiplusBackend *const backend = new RpGdiplusBackend(pGdipBmp);
-	return std::make_shared<rp_image>(backend);
+	rp_image_ptr img = std::make_shared<rp_image>(backend);
+	if (pFullSize) {
+		pFullSize[0] = img->width();
+		pFullSize[1] = img->height();
+	}
+	return img;
 }
 
 }
@@ -531,9 +531,10 @@ rp_image_ptr load(const IRpFilePtr &file)
  *
  * @param file IRpFile to write to
  * @param img rp_image to save
+ * @param profile PNG encode profile
  * @return 0 on success; negative POSIX error code on error
  */
-int save(const IRpFilePtr &file, const rp_image_const_ptr &img)
+int save(const IRpFilePtr &file, const rp_image_const_ptr &img, RpPngWriter::Profile profile)
 {
 	assert((bool)file);
 	assert(img != nullptr);
@@ -544,6 +545,7 @@ int save(const IRpFilePtr &file, const rp_image_const_ptr &img)
 	unique_ptr<RpPngWriter> pngWriter(new RpPngWriter(file, img));
 	if (!pngWriter->isOpen())
 		return -pngWriter->lastError();
+	pngWriter->setProfile(profile);
 
 	// Write the PNG IHDR.
 	int ret = pngWriter->write_IHDR();
@@ -559,9 +561,10 @@ int save(const IRpFilePtr &file, const rp_image_const_ptr &img)
  *
  * @param filename Destination filename (UTF-8)
  * @param img rp_image to save
+ * @param profile PNG encode profile
  * @return 0 on success; negative POSIX error code on error
  */
-int save(const char *filename, const rp_image_const_ptr &img)
+int save(const char *filename, const rp_image_const_ptr &img, RpPngWriter::Profile profile)
 {
 	assert(filename != nullptr);
 	assert(filename[0] != '\0');
@@ -573,6 +576,7 @@ int save(const char *filename, const rp_image_const_ptr &img)
 	unique_ptr<RpPngWriter> pngWriter(new RpPngWriter(filename, img));
 	if (!pngWriter->isOpen())
 		return -pngWriter->lastError();
+	pngWriter->setProfile(profile);
 
 	// Write the PNG IHDR.
 	int ret = pngWriter->write_IHDR();
@@ -589,9 +593,10 @@ int save(const char *filename, const rp_image_const_ptr &img)
  *
  * @param filename Destination filename (UTF-8)
  * @param img rp_image to save
+ * @param profile PNG encode profile
  * @return 0 on success; negative POSIX error code on error
  */
-int save(const wchar_t *filename, const rp_image_const_ptr &img)
+int save(const wchar_t *filename, const rp_image_const_ptr &img, RpPngWriter::Profile profile)
 {
 	assert(filename != nullptr);
 	assert(filename[0] != L'\0');
@@ -603,6 +608,7 @@ int save(const wchar_t *filename, const rp_image_const_ptr &img)
 	unique_ptr<RpPngWriter> pngWriter(new RpPngWriter(filename, img));
 	if (!pngWriter->isOpen())
 		return -pngWriter->lastError();
+	pngWriter->setProfile(profile);
 
 	// Write the PNG IHDR.
 	int ret = pngWriter->write_IHDR();
@@ -631,9 +637,10 @@ int save(const wchar_t *filename, const rp_image_const_ptr &img)
  *
  * @param file IRpFile to write to
  * @param iconAnimData Animated image data to save
+ * @param profile PNG encode profile
  * @return 0 on success; negative POSIX error code on error
  */
-int save(const IRpFilePtr &file, const IconAnimDataConstPtr &iconAnimData)
+int save(const IRpFilePtr &file, const IconAnimDataConstPtr &iconAnimData, RpPngWriter::Profile profile)
 {
 	assert((bool)file);
 	assert((bool)iconAnimData);
@@ -644,6 +651,7 @@ int save(const IRpFilePtr &file, const IconAnimDataConstPtr &iconAnimData)
 	unique_ptr<RpPngWriter> pngWriter(new RpPngWriter(file, iconAnimData));
 	if (!pngWriter->isOpen())
 		return -pngWriter->lastError();
+	pngWriter->setProfile(profile);
 
 	// Write the PNG IHDR.
 	int ret = pngWriter->write_IHDR();
@@ -668,9 +676,10 @@ int save(const IRpFilePtr &file, const IconAnimDataConstPtr &iconAnimData)
  *
  * @param filename Destination filename (UTF-8)
  * @param iconAnimData Animated image data to save
+ * @param profile PNG encode profile
  * @return 0 on success; negative POSIX error code on error
  */
-int save(const char *filename, const IconAnimDataConstPtr &iconAnimData)
+int save(const char *filename, const IconAnimDataConstPtr &iconAnimData, RpPngWriter::Profile profile)
 {
 	assert(filename != nullptr);
 	assert(filename[0] != '\0');
@@ -682,6 +691,7 @@ int save(const char *filename, const IconAnimDataConstPtr &iconAnimData)
 	unique_ptr<RpPngWriter> pngWriter(new RpPngWriter(filename, iconAnimData));
 	if (!pngWriter->isOpen())
 		return -pngWriter->lastError();
+	pngWriter->setProfile(profile);
 
 	// Write the PNG IHDR.
 	int ret = pngWriter->write_IHDR();
@@ -707,9 +717,10 @@ int save(const char *filename, const IconAnimDataConstPtr &iconAnimData)
  *
  * @param filename Destination filename (UTF-16)
  * @param iconAnimData Animated image data to save
+ * @param profile PNG encode profile
  * @return 0 on success; negative POSIX error code on error
  */
-int save(const wchar_t *filename, const IconAnimDataConstPtr &iconAnimData)
+int save(const wchar_t *filename, const IconAnimDataConstPtr &iconAnimData, RpPngWriter::Profile profile)
 {
 	assert(filename != nullptr);
 	assert(filename[0] != L'\0');
@@ -721,6 +732,7 @@ int save(const wchar_t *filename, const IconAnimDataConstPtr &iconAnimData)
 	unique_ptr<RpPngWriter> pngWriter(new RpPngWriter(filename, iconAnimData));
 	if (!pngWriter->isOpen())
 		return -pngWriter->lastError();
+	pngWriter->setProfile(profile);
 
 	// Write the PNG IHDR.
 	int ret = pngWriter->write_IHDR();
@@ -18,6 +18,7 @@
 #include "../img/IconAnimData.hpp"
 #include "librpfile/IRpFile.hpp"
 #include "librptexture/img/rp_image.hpp"
+#include "RpPngWriter.hpp"
 
 namespace LibRpBase {
 
@@ -40,19 +41,21 @@ LibRpTexture::rp_image_ptr load(const LibRpFile::IRpFilePtr &file);
  *
  * @param file IRpFile to write to
  * @param img rp_image to save
+ * @param profile PNG encode profile
  * @return 0 on success; negative POSIX error code on error
  */
-int save(const LibRpFile::IRpFilePtr &file, const LibRpTexture::rp_image_const_ptr &img);
+int save(const LibRpFile::IRpFilePtr &file, const LibRpTexture::rp_image_const_ptr &img, RpPngWriter::Profile profile = RpPngWriter::Profile::Balanced);
 
 /**
  * Save an image in PNG format to a file.
  *
  * @param filename Destination filename (UTF-8)
  * @param img rp_image to save
+ * @param profile PNG encode profile
  * @return 0 on success; negative POSIX error code on error
  */
 RP_LIBROMDATA_PUBLIC
-int save(const char *filename, const LibRpTexture::rp_image_const_ptr &img);
+int save(const char *filename, const LibRpTexture::rp_image_const_ptr &img, RpPngWriter::Profile profile = RpPngWriter::Profile::Balanced);
 
 #ifdef _WIN32
 /**
@@ -60,10 +63,11 @@ int save(const char *filename, const LibRpTexture::rp_image_const_ptr &img);
  *
  * @param filename Destination filename
  * @param img rp_image to save (UTF-16)
+ * @param profile PNG encode profile
  * @return 0 on success; negative POSIX error code on error
  */
 RP_LIBROMDATA_PUBLIC
-int save(const wchar_t *filename, const LibRpTexture::rp_image_const_ptr &img);
+int save(const wchar_t *filename, const LibRpTexture::rp_image_const_ptr &img, RpPngWriter::Profile profile = RpPngWriter::Profile::Balanced);
 #endif /* _WIN32 */
 
 /**
@@ -83,9 +87,10 @@ int save(const wchar_t *filename, const LibRpTexture::rp_image_const_ptr &img);
  *
  * @param file IRpFile to write to
  * @param iconAnimData Animated image data to save
+ * @param profile PNG encode profile
  * @return 0 on success; negative POSIX error code on error
  */
-int save(const LibRpFile::IRpFilePtr &file, const IconAnimDataConstPtr &iconAnimData);
+int save(const LibRpFile::IRpFilePtr &file, const IconAnimDataConstPtr &iconAnimData, RpPngWriter::Profile profile = RpPngWriter::Profile::Balanced);
 
 /**
  * Save an animated image in APNG format to a file.
@@ -100,10 +105,11 @@ int save(const LibRpFile::IRpFilePtr &file, const IconAnimDataConstPtr &iconAnim
  *
  * @param filename Destination filename (UTF-8)
  * @param iconAnimData Animated image data to save
+ * @param profile PNG encode profile
  * @return 0 on success; negative POSIX error code on error
  */
 RP_LIBROMDATA_PUBLIC
-int save(const char *filename, const IconAnimDataConstPtr &iconAnimData);
+int save(const char *filename, const IconAnimDataConstPtr &iconAnimData, RpPngWriter::Profile profile = RpPngWriter::Profile::Balanced);
 
 #ifdef _WIN32
 /**
@@ -119,10 +125,11 @@ int save(const char *filename, const IconAnimDataConstPtr &iconAnimData);
  *
  * @param filename Destination filename (UTF-16)
  * @param iconAnimData Animated image data to save
+ * @param profile PNG encode profile
  * @return 0 on success; negative POSIX error code on error
  */
 RP_LIBROMDATA_PUBLIC
-int save(const wchar_t *filename, const IconAnimDataConstPtr &iconAnimData);
+int save(const wchar_t *filename, const IconAnimDataConstPtr &iconAnimData, RpPngWriter::Profile profile = RpPngWriter::Profile::Balanced);
 #endif /* _WIN32 */
 
 /** Version info wrapper functions **/
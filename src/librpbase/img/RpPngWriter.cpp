@@ -110,18 +110,21 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const IRpFilePtr &file, int width, int height, rp_image::Format format)
 			: lastError(0), file(file), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Balanced)
 		{
 			init(width, height, format);
 		}
 		RpPngWriterPrivate(const IRpFilePtr &file, const rp_image_const_ptr &img)
 			: lastError(0), file(file), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Balanced)
 		{
 			init(img);
 		}
 		RpPngWriterPrivate(const IRpFilePtr &file, const IconAnimDataConstPtr &iconAnimData)
 			: lastError(0), file(file), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Balanced)
 		{
 			init(iconAnimData);
 		}
@@ -129,6 +132,7 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const char *filename, int width, int height, rp_image::Format format)
 			: lastError(0), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Balanced)
 		{
 			file.reset(filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(width, height, format);
@@ -136,6 +140,7 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const char *filename, const rp_image_const_ptr &img)
 			: lastError(0), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Balanced)
 		{
 			file.reset(filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(img);
@@ -143,6 +148,7 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const char *filename, const IconAnimDataConstPtr &iconAnimData)
 			: lastError(0), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Balanced)
 		{
 			file.reset(filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(iconAnimData);
@@ -152,6 +158,7 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const wchar_t *filename, int width, int height, rp_image::Format format)
 			: lastError(0), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Balanced)
 		{
 			file.reset(filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(width, height, format);
@@ -159,6 +166,7 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const wchar_t *filename, const rp_image_const_ptr &img)
 			: lastError(0), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Balanced)
 		{
 			file.reset(filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(img);
@@ -166,6 +174,7 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const wchar_t *filename, const IconAnimDataConstPtr &iconAnimData)
 			: lastError(0), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Balanced)
 		{
 			file.reset(filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(iconAnimData);
@@ -287,6 +296,9 @@ class RpPngWriterPrivate
 		// Current state.
 		bool IHDR_written;
 
+		// Encode profile
+		RpPngWriter::Profile profile;
+
 	public:
 		/**
 		 * Initialize the PNG write structs.
@@ -324,6 +336,27 @@ class RpPngWriterPrivate
 		 */
 		int write_CI8_palette(void);
 
+		/**
+		 * Select a PNG row filter for the Fastest and Balanced profiles.
+		 *
+		 * A subset of rows is filtered using each of the five PNG
+		 * filter types, and the filter with the lowest sum of
+		 * absolute residuals is selected. This is the heuristic
+		 * recommended by the PNG specification, but applied to
+		 * the whole image instead of each row.
+		 *
+		 * @param row_pointers PNG row pointers. Array must have cache.height elements.
+		 * @return PNG_FILTER_* value
+		 */
+		int selectFilter(const png_byte *const *row_pointers) const;
+
+		/**
+		 * Apply the row filter for the current encode profile.
+		 * This must be called before the first row is written.
+		 * @param row_pointers PNG row pointers. Array must have cache.height elements.
+		 */
+		void applyFilter(const png_byte *const *row_pointers);
+
 		/**
 		 * Write raw image data to the PNG image.
 		 *
@@ -722,6 +755,119 @@ int RpPngWriterPrivate::write_CI8_palette(void)
 	return 0;
 }
 
+/**
+ * Get the absolute value of a PNG filter residual.
+ * Residuals are treated as signed bytes, per the PNG specification.
+ * @param r Residual (only the low 8 bits are used)
+ * @return Absolute value
+ */
+static inline unsigned int abs_residual(int r)
+{
+	const int8_t v = static_cast<int8_t>(static_cast<uint8_t>(r));
+	return static_cast<unsigned int>(v < 0 ? -v : v);
+}
+
+/**
+ * Select a PNG row filter for the Fastest and Balanced profiles.
+ *
+ * A subset of rows is filtered using each of the five PNG
+ * filter types, and the filter with the lowest sum of
+ * absolute residuals is selected. This is the heuristic
+ * recommended by the PNG specification, but applied to
+ * the whole image instead of each row.
+ *
+ * @param row_pointers PNG row pointers. Array must have cache.height elements.
+ * @return PNG_FILTER_* value
+ */
+int RpPngWriterPrivate::selectFilter(const png_byte *const *row_pointers) const
+{
+	if (cache.format != rp_image::Format::ARGB32 || cache.width <= 0 || cache.height <= 0) {
+		// Paletted images almost always compress best without filtering.
+		return PNG_FILTER_NONE;
+	}
+
+	// NOTE: If skip_alpha is set, libpng filters 24-bit rows,
+	// but the source rows are still 32-bit. The constant alpha
+	// channel adds the same amount to every filter's sum, so
+	// this is close enough for selecting a filter.
+	static constexpr unsigned int bpp = 4;
+	const unsigned int row_bytes = static_cast<unsigned int>(cache.width) * bpp;
+
+	// Sample up to 32 evenly-spaced rows.
+	static constexpr int SAMPLE_ROWS = 32;
+	const int step = (cache.height > SAMPLE_ROWS) ? (cache.height / SAMPLE_ROWS) : 1;
+
+	// Sums of absolute residuals: None, Sub, Up, Average, Paeth
+	array<uint64_t, 5> sums;
+	sums.fill(0);
+
+	for (int y = 0; y < cache.height; y += step) {
+		const uint8_t *const cur = row_pointers[y];
+		const uint8_t *const prev = (y > 0) ? row_pointers[y-1] : nullptr;
+
+		for (unsigned int x = 0; x < row_bytes; x++) {
+			const int c = cur[x];
+			const int a = (x >= bpp) ? cur[x-bpp] : 0;		// left
+			const int b = prev ? prev[x] : 0;			// up
+			const int d = (prev && x >= bpp) ? prev[x-bpp] : 0;	// upper-left
+
+			// Paeth predictor
+			const int p = a + b - d;
+			const int pa = abs(p - a);
+			const int pb = abs(p - b);
+			const int pc = abs(p - d);
+			const int paeth = (pa <= pb && pa <= pc) ? a : ((pb <= pc) ? b : d);
+
+			sums[0] += abs_residual(c);
+			sums[1] += abs_residual(c - a);
+			sums[2] += abs_residual(c - b);
+			sums[3] += abs_residual(c - ((a + b) >> 1));
+			sums[4] += abs_residual(c - paeth);
+		}
+	}
+
+	// Select the filter with the lowest sum.
+	// If multiple filters are tied, the cheaper one is used.
+	static constexpr array<int, 5> filters = {{
+		PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP,
+		PNG_FILTER_AVG, PNG_FILTER_PAETH
+	}};
+	size_t best = 0;
+	for (size_t i = 1; i < sums.size(); i++) {
+		if (sums[i] < sums[best]) {
+			best = i;
+		}
+	}
+	return filters[best];
+}
+
+/**
+ * Apply the row filter for the current encode profile.
+ * This must be called before the first row is written.
+ * @param row_pointers PNG row pointers. Array must have cache.height elements.
+ */
+void RpPngWriterPrivate::applyFilter(const png_byte *const *row_pointers)
+{
+	int filter;
+	switch (profile) {
+		default:
+		case RpPngWriter::Profile::Fastest:
+		case RpPngWriter::Profile::Balanced:
+			// NOTE: Filtering usually makes the image data more
+			// compressible, so zlib has less work to do. This
+			// is faster than PNG_FILTER_NONE even at level 1.
+			filter = selectFilter(row_pointers);
+			break;
+		case RpPngWriter::Profile::Smallest:
+			// libpng's adaptive filtering doesn't work well with
+			// paletted images, so only use it for ARGB32.
+			filter = (cache.format == rp_image::Format::ARGB32)
+				? PNG_ALL_FILTERS : PNG_FILTER_NONE;
+			break;
+	}
+	png_set_filter(png_ptr, 0, filter);
+}
+
 /**
  * Write raw image data to the PNG image.
  *
@@ -787,6 +933,7 @@ int RpPngWriterPrivate::write_IDAT(const png_byte *const *row_pointers, bool is_
 	}
 
 	// Write the image data.
+	applyFilter(row_pointers);
 	png_write_image(png_ptr, const_cast<png_bytepp>(row_pointers));
 	return 0;
 }
@@ -923,6 +1070,11 @@ int RpPngWriterPrivate::write_IDAT_APNG(void)
 			row_pointers[y] = static_cast<const png_byte*>(img->scanLine(y));
 		}
 
+		if (i == 0) {
+			// Select the row filter using the first frame.
+			applyFilter(row_pointers);
+		}
+
 		// Frame header.
 		png_write_frame_head(png_ptr, info_ptr, (png_bytepp)row_pointers,
 				cache.width, cache.height, 0, 0,	// width, height, x offset, y offset
@@ -1188,6 +1340,32 @@ void RpPngWriter::close(void)
 	d->close();
 }
 
+/**
+ * Set the PNG encode profile.
+ * This must be called before write_IHDR().
+ * @param profile Encode profile
+ */
+void RpPngWriter::setProfile(Profile profile)
+{
+	RP_D(RpPngWriter);
+	assert(!d->IHDR_written);
+	assert(profile >= Profile::Fastest && profile < Profile::Max);
+	if (profile < Profile::Fastest || profile >= Profile::Max) {
+		profile = Profile::Balanced;
+	}
+	d->profile = profile;
+}
+
+/**
+ * Get the PNG encode profile.
+ * @return Encode profile
+ */
+RpPngWriter::Profile RpPngWriter::profile(void) const
+{
+	RP_D(const RpPngWriter);
+	return d->profile;
+}
+
 /**
  * Write the PNG IHDR.
  * This must be called before writing any other image data.
@@ -1230,9 +1408,19 @@ int RpPngWriter::write_IHDR(void)
 #endif /* PNG_SETJMP_SUPPORTED */
 
 	// Initialize compression parameters.
-	// TODO: Customizable?
+	// NOTE: The row filter is set in write_IDAT(), since the
+	// image data is needed in order to select a filter.
+	// NOTE: There's no separate libdeflate-style encoder for the
+	// Fastest profile. zlib-ng (the internal zlib) already uses its
+	// deflate_quick strategy for level 1; system zlib uses deflate_fast.
+	static constexpr uint8_t zlib_levels[] = {1, 6, 9};
+	static_assert(ARRAY_SIZE(zlib_levels) == static_cast<size_t>(RpPngWriter::Profile::Max),
+		"zlib_levels[] is out of sync with RpPngWriter::Profile");
 	png_set_filter(d->png_ptr, 0, PNG_FILTER_NONE);
-	png_set_compression_level(d->png_ptr, PNG_Z_DEFAULT_COMPRESSION);
+	png_set_compression_level(d->png_ptr, zlib_levels[static_cast<size_t>(d->profile)]);
+	if (d->profile == RpPngWriter::Profile::Smallest) {
+		png_set_compression_mem_level(d->png_ptr, 9);
+	}
 
 	// Write the PNG header.
 	switch (d->cache.format) {
@@ -238,6 +238,31 @@ public:
 	 */
 	void close(void);
 
+	/**
+	 * PNG encode profile.
+	 * Selects the zlib compression level and the PNG row filter.
+	 */
+	enum class Profile : uint8_t {
+		Fastest,	// zlib level 1, one filter selected by sampling the image
+		Balanced,	// zlib level 6, one filter selected by sampling the image (default)
+		Smallest,	// zlib level 9, libpng's adaptive per-row filtering
+
+		Max
+	};
+
+	/**
+	 * Set the PNG encode profile.
+	 * This must be called before write_IHDR().
+	 * @param profile Encode profile
+	 */
+	void setProfile(Profile profile);
+
+	/**
+	 * Get the PNG encode profile.
+	 * @return Encode profile
+	 */
+	Profile profile(void) const;
+
 	/**
 	 * Write the PNG IHDR.
 	 * This must be called before writing any other image data.
@@ -0,0 +1,321 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * SparseDiscReaderTest.cpp: SparseDiscReader block cache test.            *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+#include "common.h"
+#include "tcharx.h"
+
+// Other rom-properties libraries
+#include "librpfile/MemFile.hpp"
+using namespace LibRpFile;
+
+// SparseDiscReader
+#include "disc/SparseDiscReader.hpp"
+#include "disc/SparseDiscReader_p.hpp"
+
+// C includes
+#include <stdint.h>
+
+// C includes (C++ namespace)
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes
+#include <memory>
+#include <vector>
+using std::shared_ptr;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+/** FakeSparseDiscReader **/
+
+/**
+ * Fake SparseDiscReader for testing the block cache.
+ * Blocks are "decompressed" by copying them from the underlying file,
+ * and the number of decompressions is counted for each block.
+ */
+class FakeSparseDiscReaderPrivate;
+class FakeSparseDiscReader final : public SparseDiscReader
+{
+	public:
+		explicit FakeSparseDiscReader(const IRpFilePtr &file, unsigned int block_size);
+
+	private:
+		typedef SparseDiscReader super;
+		RP_DISABLE_COPY(FakeSparseDiscReader)
+
+	public:
+		int isDiscSupported(const uint8_t *pHeader, size_t szHeader) const final
+		{
+			RP_UNUSED(pHeader);
+			RP_UNUSED(szHeader);
+			return 0;
+		}
+
+		/**
+		 * Get the number of times a block was decompressed.
+		 * @param blockIdx Block index
+		 * @return Number of decompressions
+		 */
+		unsigned int decompressCount(uint32_t blockIdx) const;
+
+		/**
+		 * Make the specified block fail to decompress.
+		 * @param blockIdx Block index, or ~0U to disable.
+		 */
+		void setBadBlock(uint32_t blockIdx);
+
+	protected:
+		off64_t getPhysBlockAddr(uint32_t blockIdx) const final;
+		int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size) final;
+};
+
+class FakeSparseDiscReaderPrivate final : public SparseDiscReaderPrivate
+{
+	public:
+		explicit FakeSparseDiscReaderPrivate(FakeSparseDiscReader *q)
+			: super(q)
+			, badBlock(~0U)
+		{}
+
+	private:
+		typedef SparseDiscReaderPrivate super;
+		RP_DISABLE_COPY(FakeSparseDiscReaderPrivate)
+
+	public:
+		vector<unsigned int> decompressCount;	// Decompressions per block
+		uint32_t badBlock;			// Block that fails to decompress
+};
+
+FakeSparseDiscReader::FakeSparseDiscReader(const IRpFilePtr &file, unsigned int block_size)
+	: super(new FakeSparseDiscReaderPrivate(this), file)
+{
+	RP_D(FakeSparseDiscReader);
+	d->block_size = block_size;
+	d->disc_size = file->size();
+	d->pos = 0;
+	d->decompressCount.resize(static_cast<size_t>((d->disc_size + block_size - 1) / block_size));
+	d->initBlockCache(block_size);
+}
+
+unsigned int FakeSparseDiscReader::decompressCount(uint32_t blockIdx) const
+{
+	RP_D(const FakeSparseDiscReader);
+	assert(blockIdx < d->decompressCount.size());
+	return d->decompressCount[blockIdx];
+}
+
+void FakeSparseDiscReader::setBadBlock(uint32_t blockIdx)
+{
+	RP_D(FakeSparseDiscReader);
+	d->badBlock = blockIdx;
+}
+
+off64_t FakeSparseDiscReader::getPhysBlockAddr(uint32_t blockIdx) const
+{
+	RP_D(const FakeSparseDiscReader);
+	return static_cast<off64_t>(blockIdx) * d->block_size;
+}
+
+int FakeSparseDiscReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
+{
+	RP_D(FakeSparseDiscReader);
+	assert(blockIdx < d->decompressCount.size());
+
+	const uint8_t *const pCachedBlock = d->getCachedBlock(blockIdx);
+	if (pCachedBlock) {
+		// Block is cached.
+		memcpy(ptr, &pCachedBlock[pos], size);
+		return static_cast<int>(size);
+	}
+
+	// "Decompress" the block into the cache.
+	d->decompressCount[blockIdx]++;
+	uint8_t *const pBlock = d->allocCachedBlock(blockIdx);
+	const size_t sz_read = m_file->seekAndRead(getPhysBlockAddr(blockIdx), pBlock, d->block_size);
+	if (sz_read != d->block_size || blockIdx == d->badBlock) {
+		// Decompression error.
+		d->invalidateCachedBlock(blockIdx);
+		m_lastError = EIO;
+		return 0;
+	}
+
+	memcpy(ptr, &pBlock[pos], size);
+	return static_cast<int>(size);
+}
+
+/** SparseDiscReaderTest **/
+
+class SparseDiscReaderTest : public ::testing::Test
+{
+	protected:
+		SparseDiscReaderTest()
+			: ::testing::Test()
+		{}
+
+	public:
+		void SetUp(void) final;
+
+	protected:
+		// Block size and count for the fake disc image
+		static constexpr unsigned int BLOCK_SIZE = 256;
+		static constexpr unsigned int BLOCK_COUNT = 8;
+
+		// Number of entries in the block cache
+		static constexpr unsigned int CACHE_COUNT = 4;
+
+		// Fake disc image: Each byte is (blockIdx << 4) ^ (offset & 0xFF)
+		vector<uint8_t> disc_data;
+		shared_ptr<FakeSparseDiscReader> discReader;
+
+		/**
+		 * Read a full block and verify its contents.
+		 * @param blockIdx Block index
+		 */
+		void readAndCheckBlock(uint32_t blockIdx);
+};
+
+void SparseDiscReaderTest::SetUp(void)
+{
+	disc_data.resize(BLOCK_SIZE * BLOCK_COUNT);
+	for (size_t i = 0; i < disc_data.size(); i++) {
+		disc_data[i] = static_cast<uint8_t>(((i / BLOCK_SIZE) << 4) ^ (i & 0xFF));
+	}
+
+	const IRpFilePtr memFile = std::make_shared<MemFile>(disc_data.data(), disc_data.size());
+	discReader = std::make_shared<FakeSparseDiscReader>(memFile, BLOCK_SIZE);
+	ASSERT_TRUE(discReader->isOpen());
+	discReader->setBlockCacheCount(CACHE_COUNT);
+	ASSERT_EQ(CACHE_COUNT, discReader->blockCacheCount());
+}
+
+/**
+ * Read a full block and verify its contents.
+ * @param blockIdx Block index
+ */
+void SparseDiscReaderTest::readAndCheckBlock(uint32_t blockIdx)
+{
+	uint8_t buf[BLOCK_SIZE];
+	const size_t size = discReader->seekAndRead(static_cast<off64_t>(blockIdx) * BLOCK_SIZE, buf, sizeof(buf));
+	ASSERT_EQ(sizeof(buf), size) << "block " << blockIdx;
+	ASSERT_EQ(0, memcmp(buf, &disc_data[blockIdx * BLOCK_SIZE], sizeof(buf))) << "block " << blockIdx;
+}
+
+/**
+ * Reading the same block twice should only decompress it once.
+ */
+TEST_F(SparseDiscReaderTest, hitAndMiss)
+{
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(0));
+	EXPECT_EQ(0U, discReader->blockCacheHits());
+	EXPECT_EQ(1U, discReader->blockCacheMisses());
+
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(0));
+	EXPECT_EQ(1U, discReader->blockCacheHits());
+	EXPECT_EQ(1U, discReader->blockCacheMisses());
+	EXPECT_EQ(1U, discReader->decompressCount(0));
+
+	// Partial reads within a cached block are also hits.
+	uint8_t buf[16];
+	ASSERT_EQ(sizeof(buf), discReader->seekAndRead(100, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &disc_data[100], sizeof(buf)));
+	EXPECT_EQ(2U, discReader->blockCacheHits());
+	EXPECT_EQ(1U, discReader->decompressCount(0));
+}
+
+/**
+ * The least recently used block should be evicted first.
+ */
+TEST_F(SparseDiscReaderTest, evictionOrder)
+{
+	// Fill the cache: [0, 1, 2, 3]
+	for (uint32_t i = 0; i < CACHE_COUNT; i++) {
+		ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(i));
+	}
+	EXPECT_EQ(0U, discReader->blockCacheHits());
+	EXPECT_EQ(CACHE_COUNT, discReader->blockCacheMisses());
+
+	// Touch block 0, so block 1 is now the least recently used block.
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(0));
+	EXPECT_EQ(1U, discReader->blockCacheHits());
+
+	// Block 4 evicts block 1: [0, 2, 3, 4]
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(4));
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(0));
+	EXPECT_EQ(1U, discReader->decompressCount(0));
+	EXPECT_EQ(1U, discReader->decompressCount(4));
+
+	// Block 1 was evicted. Reloading it evicts block 2: [0, 1, 3, 4]
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(1));
+	EXPECT_EQ(2U, discReader->decompressCount(1));
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(3));
+	EXPECT_EQ(1U, discReader->decompressCount(3));
+
+	// LRU order is now 4, 0, 1, 3, so block 2 evicts block 4: [0, 1, 2, 3]
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(2));
+	EXPECT_EQ(2U, discReader->decompressCount(2));
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(0));
+	EXPECT_EQ(1U, discReader->decompressCount(0));
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(4));
+	EXPECT_EQ(2U, discReader->decompressCount(4));
+}
+
+/**
+ * A block that fails to decompress must not be cached.
+ */
+TEST_F(SparseDiscReaderTest, badBlockNotCached)
+{
+	discReader->setBadBlock(5);
+	uint8_t buf[BLOCK_SIZE];
+	EXPECT_EQ(0U, discReader->seekAndRead(5 * BLOCK_SIZE, buf, sizeof(buf)));
+	EXPECT_EQ(0U, discReader->seekAndRead(5 * BLOCK_SIZE, buf, sizeof(buf)));
+	EXPECT_EQ(2U, discReader->decompressCount(5));
+	EXPECT_EQ(0U, discReader->blockCacheHits());
+
+	// Once the block can be decompressed, it's cached.
+	discReader->setBadBlock(~0U);
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(5));
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(5));
+	EXPECT_EQ(3U, discReader->decompressCount(5));
+	EXPECT_EQ(1U, discReader->blockCacheHits());
+}
+
+/**
+ * Changing the cache size discards all cached blocks.
+ */
+TEST_F(SparseDiscReaderTest, setBlockCacheCount)
+{
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(0));
+	discReader->setBlockCacheCount(1);
+	EXPECT_EQ(1U, discReader->blockCacheCount());
+
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(0));
+	EXPECT_EQ(2U, discReader->decompressCount(0));
+
+	// Only one entry: Alternating between two blocks always misses.
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(1));
+	ASSERT_NO_FATAL_FAILURE(readAndCheckBlock(0));
+	EXPECT_EQ(3U, discReader->decompressCount(0));
+	EXPECT_EQ(1U, discReader->decompressCount(1));
+}
+
+} }
+
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fputs("LibRpBase test suite: SparseDiscReader block cache test.\n\n", stderr);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
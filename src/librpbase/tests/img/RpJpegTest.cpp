@@ -0,0 +1,300 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RpJpegTest.cpp: RpJpeg DCT-scaled decoding test.                        *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+#include "common.h"
+#include "tcharx.h"
+
+// Other rom-properties libraries
+#include "librpfile/MemFile.hpp"
+using namespace LibRpFile;
+
+// librpbase, librptexture
+#include "img/RpImageLoader.hpp"
+#include "librptexture/img/rp_image.hpp"
+using namespace LibRpTexture;
+
+// C includes
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// libjpeg
+// NOTE: jpeglib.h requires stdio.h to be included first.
+#include <jpeglib.h>
+
+// C++ includes
+#include <memory>
+#include <vector>
+using std::shared_ptr;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+class RpJpegTest : public ::testing::Test
+{
+	protected:
+		RpJpegTest()
+			: ::testing::Test()
+		{}
+
+	public:
+		void SetUp(void) final;
+
+	protected:
+		// Number of decodes per benchmark
+		static constexpr unsigned int BENCHMARK_ITERATIONS = 20;
+
+		// Test image dimensions
+		static constexpr int IMG_WIDTH = 2048;
+		static constexpr int IMG_HEIGHT = 1536;
+
+		// Encoded test image
+		static vector<uint8_t> jpeg_data;
+
+		/**
+		 * Encode a test image as a JPEG.
+		 * @param out	[out] JPEG data
+		 * @return 0 on success; non-zero on error.
+		 */
+		static int encodeTestImage(vector<uint8_t> &out);
+
+		/**
+		 * Decode the test image.
+		 * @param reqSize	[in] Requested image size [0 for full size]
+		 * @param pFullSize	[out,opt] Full image size [x, y]
+		 * @return Decoded image, or nullptr on error.
+		 */
+		static rp_image_ptr decode(int reqSize, int pFullSize[2] = nullptr);
+
+		/**
+		 * Decode the test image BENCHMARK_ITERATIONS times.
+		 * @param reqSize	[in] Requested image size [0 for full size]
+		 */
+		static void run_benchmark(int reqSize);
+};
+
+vector<uint8_t> RpJpegTest::jpeg_data;
+
+void RpJpegTest::SetUp(void)
+{
+	if (!jpeg_data.empty())
+		return;
+
+	ASSERT_EQ(0, encodeTestImage(jpeg_data)) << "Could not encode the test image.";
+	ASSERT_FALSE(jpeg_data.empty());
+}
+
+/**
+ * Encode a test image as a JPEG.
+ * @param out	[out] JPEG data
+ * @return 0 on success; non-zero on error.
+ */
+int RpJpegTest::encodeTestImage(vector<uint8_t> &out)
+{
+	// NOTE: jpeg_mem_dest() isn't available in libjpeg 6b,
+	// so use a temporary file.
+	FILE *f = tmpfile();
+	if (!f)
+		return -1;
+
+	jpeg_compress_struct cinfo;
+	jpeg_error_mgr jerr;
+	cinfo.err = jpeg_std_error(&jerr);
+	jpeg_create_compress(&cinfo);
+	jpeg_stdio_dest(&cinfo, f);
+
+	cinfo.image_width = IMG_WIDTH;
+	cinfo.image_height = IMG_HEIGHT;
+	cinfo.input_components = 3;
+	cinfo.in_color_space = JCS_RGB;
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, 90, TRUE);
+	jpeg_start_compress(&cinfo, TRUE);
+
+	// Gradients with a checkerboard, so there's some high-frequency detail.
+	vector<uint8_t> row(IMG_WIDTH * 3);
+	while (cinfo.next_scanline < cinfo.image_height) {
+		const unsigned int y = cinfo.next_scanline;
+		uint8_t *p = row.data();
+		for (unsigned int x = 0; x < IMG_WIDTH; x++, p += 3) {
+			const uint8_t check = (((x >> 4) ^ (y >> 4)) & 1) ? 0x40 : 0x00;
+			p[0] = static_cast<uint8_t>((x * 255) / IMG_WIDTH) ^ check;
+			p[1] = static_cast<uint8_t>((y * 255) / IMG_HEIGHT) ^ check;
+			p[2] = static_cast<uint8_t>(((x + y) * 255) / (IMG_WIDTH + IMG_HEIGHT));
+		}
+		JSAMPROW row_pointer = row.data();
+		jpeg_write_scanlines(&cinfo, &row_pointer, 1);
+	}
+
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+
+	// Read the JPEG data back.
+	const long size = ftell(f);
+	if (size <= 0) {
+		fclose(f);
+		return -1;
+	}
+	out.resize(size);
+	rewind(f);
+	const size_t sz_read = fread(out.data(), 1, out.size(), f);
+	fclose(f);
+	return (sz_read == out.size()) ? 0 : -1;
+}
+
+/**
+ * Decode the test image.
+ * @param reqSize	[in] Requested image size [0 for full size]
+ * @param pFullSize	[out,opt] Full image size [x, y]
+ * @return Decoded image, or nullptr on error.
+ */
+rp_image_ptr RpJpegTest::decode(int reqSize, int pFullSize[2])
+{
+	const IRpFilePtr memFile = std::make_shared<MemFile>(jpeg_data.data(), jpeg_data.size());
+	return RpImageLoader::load(memFile, reqSize, pFullSize);
+}
+
+/**
+ * Decode the test image BENCHMARK_ITERATIONS times.
+ * @param reqSize	[in] Requested image size [0 for full size]
+ */
+void RpJpegTest::run_benchmark(int reqSize)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		const rp_image_ptr img = decode(reqSize);
+		ASSERT_TRUE(img != nullptr);
+	}
+}
+
+/**
+ * Full-size decoding.
+ */
+TEST_F(RpJpegTest, fullSize)
+{
+	int fullSize[2] = {0, 0};
+	const rp_image_ptr img = decode(0, fullSize);
+	ASSERT_TRUE(img != nullptr);
+	EXPECT_EQ(IMG_WIDTH, img->width());
+	EXPECT_EQ(IMG_HEIGHT, img->height());
+	EXPECT_EQ(IMG_WIDTH, fullSize[0]);
+	EXPECT_EQ(IMG_HEIGHT, fullSize[1]);
+}
+
+/**
+ * DCT-scaled decoding must pick the smallest scale whose
+ * larger dimension is still at least the requested size.
+ */
+TEST_F(RpJpegTest, scaledSize)
+{
+	static const struct {
+		int reqSize;
+		int width;
+		int height;
+	} scale_tests[] = {
+		{ 128, IMG_WIDTH / 8, IMG_HEIGHT / 8},
+		{ 256, IMG_WIDTH / 8, IMG_HEIGHT / 8},
+		{ 257, IMG_WIDTH / 4, IMG_HEIGHT / 4},
+		{ 512, IMG_WIDTH / 4, IMG_HEIGHT / 4},
+		{ 768, IMG_WIDTH / 2, IMG_HEIGHT / 2},
+		{1024, IMG_WIDTH / 2, IMG_HEIGHT / 2},
+		{1025, IMG_WIDTH,     IMG_HEIGHT},
+		{4096, IMG_WIDTH,     IMG_HEIGHT},
+	};
+
+	for (const auto &p : scale_tests) {
+		int fullSize[2] = {0, 0};
+		const rp_image_ptr img = decode(p.reqSize, fullSize);
+		ASSERT_TRUE(img != nullptr) << "reqSize " << p.reqSize;
+		EXPECT_EQ(p.width, img->width()) << "reqSize " << p.reqSize;
+		EXPECT_EQ(p.height, img->height()) << "reqSize " << p.reqSize;
+		EXPECT_EQ(IMG_WIDTH, fullSize[0]) << "reqSize " << p.reqSize;
+		EXPECT_EQ(IMG_HEIGHT, fullSize[1]) << "reqSize " << p.reqSize;
+	}
+}
+
+/**
+ * A DCT-scaled image should look like a downscaled full-size image.
+ */
+TEST_F(RpJpegTest, scaledContents)
+{
+	const rp_image_const_ptr full = decode(0);
+	const rp_image_const_ptr scaled = decode(256);
+	ASSERT_TRUE(full != nullptr);
+	ASSERT_TRUE(scaled != nullptr);
+	ASSERT_EQ(full->format(), rp_image::Format::ARGB32);
+	ASSERT_EQ(scaled->format(), rp_image::Format::ARGB32);
+	ASSERT_EQ(IMG_WIDTH / 8, scaled->width());
+
+	// Compare each scaled pixel to the average of the
+	// corresponding 8x8 block in the full-size image.
+	uint64_t total_diff = 0;
+	for (int y = 0; y < scaled->height(); y++) {
+		const argb32_t *const src = static_cast<const argb32_t*>(scaled->scanLine(y));
+		for (int x = 0; x < scaled->width(); x++) {
+			unsigned int sum[3] = {0, 0, 0};
+			for (int by = 0; by < 8; by++) {
+				const argb32_t *const blk = static_cast<const argb32_t*>(full->scanLine(y*8 + by)) + x*8;
+				for (int bx = 0; bx < 8; bx++) {
+					sum[0] += blk[bx].r;
+					sum[1] += blk[bx].g;
+					sum[2] += blk[bx].b;
+				}
+			}
+			total_diff += abs(static_cast<int>(sum[0] / 64) - src[x].r);
+			total_diff += abs(static_cast<int>(sum[1] / 64) - src[x].g);
+			total_diff += abs(static_cast<int>(sum[2] / 64) - src[x].b);
+		}
+	}
+
+	// Average difference per channel must be small.
+	const double avg_diff = static_cast<double>(total_diff) /
+		(static_cast<double>(scaled->width()) * scaled->height() * 3);
+	EXPECT_LT(avg_diff, 4.0);
+}
+
+/**
+ * Benchmark full-size decoding.
+ */
+TEST_F(RpJpegTest, full_benchmark)
+{
+	run_benchmark(0);
+}
+
+/**
+ * Benchmark decoding for a 256px thumbnail. (1/8 scale)
+ */
+TEST_F(RpJpegTest, thumb256_benchmark)
+{
+	run_benchmark(256);
+}
+
+/**
+ * Benchmark decoding for a 512px thumbnail. (1/4 scale)
+ */
+TEST_F(RpJpegTest, thumb512_benchmark)
+{
+	run_benchmark(512);
+}
+
+} }
+
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fputs("LibRpBase test suite: RpJpeg DCT-scaled decoding test.\n\n", stderr);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
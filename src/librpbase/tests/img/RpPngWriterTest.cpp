@@ -0,0 +1,320 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RpPngWriterTest.cpp: RpPngWriter encode profile test.                   *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// zlib
+#include <zlib.h>
+
+#include "common.h"
+#include "tcharx.h"
+
+// Other rom-properties libraries
+#include "librpfile/MemFile.hpp"
+#include "librpfile/RpFile.hpp"
+#include "librpfile/VectorFile.hpp"
+using namespace LibRpFile;
+
+// librpbase, librptexture
+#include "img/RpPng.hpp"
+#include "img/RpPngWriter.hpp"
+#include "librptexture/img/rp_image.hpp"
+using namespace LibRpTexture;
+
+// C includes
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+using std::array;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+class RpPngWriterTest : public ::testing::Test
+{
+	protected:
+		RpPngWriterTest()
+			: ::testing::Test()
+		{}
+
+	public:
+		void SetUp(void) final;
+
+	protected:
+		// Number of passes over the corpus for benchmarks
+		static constexpr unsigned int BENCHMARK_ITERATIONS = 20;
+
+		// Loaded images from the png_data corpus
+		struct png_image_t {
+			const char *filename;
+			rp_image_const_ptr img;
+		};
+		static vector<png_image_t> png_images;
+
+		/**
+		 * Encode an image using the specified profile.
+		 * @param img		[in] Image
+		 * @param profile	[in] Encode profile
+		 * @param file		[in] VectorFile to write to
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int encode(const rp_image_const_ptr &img, RpPngWriter::Profile profile, const shared_ptr<VectorFile> &file);
+
+		/**
+		 * Encode every image in the corpus, decode it, and compare
+		 * the decoded image to the original.
+		 * @param profile	[in] Encode profile
+		 * @param pTotalSize	[out,opt] Total size of all encoded images
+		 */
+		static void check_roundtrip(RpPngWriter::Profile profile, size_t *pTotalSize = nullptr);
+
+		/**
+		 * Encode every image in the corpus BENCHMARK_ITERATIONS times.
+		 * @param profile	[in] Encode profile
+		 */
+		static void run_benchmark(RpPngWriter::Profile profile);
+};
+
+vector<RpPngWriterTest::png_image_t> RpPngWriterTest::png_images;
+
+void RpPngWriterTest::SetUp(void)
+{
+	if (!png_images.empty())
+		return;
+
+	static constexpr array<const char*, 15> png_filenames = {{
+		"gl_quad.ARGB32.png",
+		"gl_quad.RGB24.png",
+		"gl_quad.RGB24.tRNS.png",
+		"gl_quad.gray.alpha.png",
+		"gl_quad.gray.png",
+		"gl_triangle.ARGB32.png",
+		"gl_triangle.RGB24.png",
+		"gl_triangle.RGB24.tRNS.png",
+		"gl_triangle.gray.alpha.png",
+		"gl_triangle.gray.png",
+		"happy-mac.mono.odd-size.png",
+		"happy-mac.mono.png",
+		"odd-width.16color.CI4.png",
+		"xterm-256color.CI8.png",
+		"xterm-256color.CI8.tRNS.png",
+	}};
+
+	for (const char *filename : png_filenames) {
+		const IRpFilePtr file = std::make_shared<RpFile>(filename, RpFile::FM_OPEN_READ);
+		ASSERT_TRUE(file->isOpen()) << "Could not open '" << filename << "', check the test directory!";
+		rp_image_const_ptr img = RpPng::load(file);
+		ASSERT_TRUE(img != nullptr) << "Could not load '" << filename << "'.";
+		png_images.push_back({filename, std::move(img)});
+	}
+}
+
+/**
+ * Encode an image using the specified profile.
+ * @param img		[in] Image
+ * @param profile	[in] Encode profile
+ * @param file		[in] VectorFile to write to
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpPngWriterTest::encode(const rp_image_const_ptr &img, RpPngWriter::Profile profile, const shared_ptr<VectorFile> &file)
+{
+	RpPngWriter pngWriter(file, img);
+	if (!pngWriter.isOpen())
+		return -pngWriter.lastError();
+	pngWriter.setProfile(profile);
+
+	int ret = pngWriter.write_IHDR();
+	if (ret != 0)
+		return ret;
+	return pngWriter.write_IDAT();
+}
+
+/**
+ * Encode every image in the corpus, decode it, and compare
+ * the decoded image to the original.
+ * @param profile	[in] Encode profile
+ * @param pTotalSize	[out,opt] Total size of all encoded images
+ */
+void RpPngWriterTest::check_roundtrip(RpPngWriter::Profile profile, size_t *pTotalSize)
+{
+	size_t total_size = 0;
+	for (const png_image_t &png_image : png_images) {
+		const shared_ptr<VectorFile> vectorFile = std::make_shared<VectorFile>();
+		ASSERT_EQ(0, encode(png_image.img, profile, vectorFile)) << png_image.filename;
+		const vector<uint8_t> &data = vectorFile->vector();
+		total_size += data.size();
+
+		const IRpFilePtr memFile = std::make_shared<MemFile>(data.data(), data.size());
+		const rp_image_const_ptr img = RpPng::load(memFile);
+		ASSERT_TRUE(img != nullptr) << png_image.filename;
+		ASSERT_EQ(png_image.img->width(), img->width()) << png_image.filename;
+		ASSERT_EQ(png_image.img->height(), img->height()) << png_image.filename;
+
+		// Compare the images in ARGB32 format.
+		const rp_image_const_ptr expected = png_image.img->dup_ARGB32();
+		const rp_image_const_ptr actual = img->dup_ARGB32();
+		ASSERT_TRUE(expected != nullptr);
+		ASSERT_TRUE(actual != nullptr);
+		const size_t row_bytes = static_cast<size_t>(expected->width()) * sizeof(uint32_t);
+		for (int y = 0; y < expected->height(); y++) {
+			ASSERT_EQ(0, memcmp(expected->scanLine(y), actual->scanLine(y), row_bytes))
+				<< png_image.filename << ": row " << y << " does not match";
+		}
+	}
+
+	if (pTotalSize) {
+		*pTotalSize = total_size;
+	}
+}
+
+/**
+ * Encode every image in the corpus BENCHMARK_ITERATIONS times.
+ * @param profile	[in] Encode profile
+ */
+void RpPngWriterTest::run_benchmark(RpPngWriter::Profile profile)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (const png_image_t &png_image : png_images) {
+			const shared_ptr<VectorFile> vectorFile = std::make_shared<VectorFile>();
+			ASSERT_EQ(0, encode(png_image.img, profile, vectorFile)) << png_image.filename;
+		}
+	}
+}
+
+/**
+ * Round-trip the corpus using the Fastest profile.
+ */
+TEST_F(RpPngWriterTest, roundtrip_Fastest)
+{
+	ASSERT_NO_FATAL_FAILURE(check_roundtrip(RpPngWriter::Profile::Fastest));
+}
+
+/**
+ * Round-trip the corpus using the Balanced profile.
+ */
+TEST_F(RpPngWriterTest, roundtrip_Balanced)
+{
+	ASSERT_NO_FATAL_FAILURE(check_roundtrip(RpPngWriter::Profile::Balanced));
+}
+
+/**
+ * Round-trip the corpus using the Smallest profile.
+ */
+TEST_F(RpPngWriterTest, roundtrip_Smallest)
+{
+	ASSERT_NO_FATAL_FAILURE(check_roundtrip(RpPngWriter::Profile::Smallest));
+}
+
+/**
+ * Make sure the profiles are ordered by output size over the whole corpus.
+ */
+TEST_F(RpPngWriterTest, profileSizeOrder)
+{
+	size_t fastest_size = 0, balanced_size = 0, smallest_size = 0;
+	ASSERT_NO_FATAL_FAILURE(check_roundtrip(RpPngWriter::Profile::Fastest, &fastest_size));
+	ASSERT_NO_FATAL_FAILURE(check_roundtrip(RpPngWriter::Profile::Balanced, &balanced_size));
+	ASSERT_NO_FATAL_FAILURE(check_roundtrip(RpPngWriter::Profile::Smallest, &smallest_size));
+
+	EXPECT_LE(balanced_size, fastest_size);
+	EXPECT_LE(smallest_size, balanced_size);
+}
+
+/**
+ * Benchmark the Fastest profile.
+ */
+TEST_F(RpPngWriterTest, Fastest_benchmark)
+{
+	run_benchmark(RpPngWriter::Profile::Fastest);
+}
+
+/**
+ * Benchmark the Balanced profile.
+ */
+TEST_F(RpPngWriterTest, Balanced_benchmark)
+{
+	run_benchmark(RpPngWriter::Profile::Balanced);
+}
+
+/**
+ * Benchmark the Smallest profile.
+ */
+TEST_F(RpPngWriterTest, Smallest_benchmark)
+{
+	run_benchmark(RpPngWriter::Profile::Smallest);
+}
+
+} }
+
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fputs("LibRpBase test suite: RpPngWriter encode profile test.\n\n", stderr);
+	fflush(nullptr);
+
+	// Make sure the CRC32 table is initialized.
+	get_crc_table();
+
+	// Check for the png_data directory and chdir() into it.
+#ifdef _WIN32
+	static constexpr array<const TCHAR*, 11> subdirs = {{
+		_T("png_data"),
+		_T("bin\\png_data"),
+		_T("src\\librpbase\\tests\\img\\png_data"),
+		_T("..\\src\\librpbase\\tests\\img\\png_data"),
+		_T("..\\..\\src\\librpbase\\tests\\img\\png_data"),
+		_T("..\\..\\..\\src\\librpbase\\tests\\img\\png_data"),
+		_T("..\\..\\..\\..\\src\\librpbase\\tests\\img\\png_data"),
+		_T("..\\..\\..\\..\\..\\src\\librpbase\\tests\\img\\png_data"),
+		_T("..\\..\\..\\bin\\png_data"),
+		_T("..\\..\\..\\bin\\Debug\\png_data"),
+		_T("..\\..\\..\\bin\\Release\\png_data"),
+	}};
+#else /* !_WIN32 */
+	static constexpr array<const TCHAR*, 9> subdirs = {{
+		_T("png_data"),
+		_T("bin/png_data"),
+		_T("src/librpbase/tests/img/png_data"),
+		_T("../src/librpbase/tests/img/png_data"),
+		_T("../../src/librpbase/tests/img/png_data"),
+		_T("../../../src/librpbase/tests/img/png_data"),
+		_T("../../../../src/librpbase/tests/img/png_data"),
+		_T("../../../../../src/librpbase/tests/img/png_data"),
+		_T("../../../bin/png_data"),
+	}};
+#endif /* _WIN32 */
+
+	bool is_found = false;
+	for (const TCHAR *const subdir : subdirs) {
+		if (!_taccess(subdir, R_OK)) {
+			if (_tchdir(subdir) == 0) {
+				is_found = true;
+				break;
+			}
+		}
+	}
+
+	if (!is_found) {
+		fputs("*** ERROR: Cannot find the png_data test images directory.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -145,6 +145,12 @@ static void RP_CPU_InitCPUFlags_int(void)
 	// Required for AVX and AVX2.
 	can_XSAVE = (regs[REG_ECX] & (CPUFLAG_IA32_ECX_XSAVE | CPUFLAG_IA32_ECX_OSXSAVE)) ==
 	                             (CPUFLAG_IA32_ECX_XSAVE | CPUFLAG_IA32_ECX_OSXSAVE);
+	if (can_XSAVE) {
+		// Make sure the OS has enabled the SSE and AVX register state.
+		// If it hasn't, AVX instructions will fault.
+		can_XSAVE = (xgetbv(0) & (IA32_XCR0_SSE | IA32_XCR0_AVX)) ==
+		                         (IA32_XCR0_SSE | IA32_XCR0_AVX);
+	}
 	if (can_XSAVE) {
 		// XSAVE and OSXSAVE are set.
 		if (regs[REG_ECX] & CPUFLAG_IA32_ECX_AVX)
@@ -189,6 +189,34 @@ static FORCEINLINE void cpuid_count(unsigned int level, unsigned int count, unsi
 #endif
 }
 
+/**
+ * Run the `xgetbv` instruction.
+ * NOTE: Only call this if CPUID reports OSXSAVE.
+ * @param index Extended control register index (%ecx)
+ * @return Extended control register value. (low 32 bits only)
+ */
+static FORCEINLINE unsigned int xgetbv(unsigned int index)
+{
+#if defined(__GNUC__)
+	// NOTE: Using the opcode directly for compatibility
+	// with older assemblers that don't know `xgetbv`.
+	unsigned int eax, edx;
+	__asm__ (
+		".byte 0x0F, 0x01, 0xD0\n"
+		: "=a" (eax), "=d" (edx)
+		: "c" (index)
+		);
+	return eax;
+#elif defined(_MSC_VER) && (_MSC_VER > 1600 || (_MSC_VER == 1600 && _MSC_FULL_VER >= 160040219))
+	// MSVC 2010 SP1 and later have the _xgetbv() intrinsic.
+	return (unsigned int)_xgetbv(index);
+#else
+	// Unable to check XCR0. Assume AVX state isn't enabled.
+	((void)index);
+	return 0;
+#endif
+}
+
 // Register indexes
 #define REG_EAX 0
 #define REG_EBX 1
@@ -206,6 +234,11 @@ static FORCEINLINE void cpuid_count(unsigned int level, unsigned int count, unsi
 // CR0.EM: FPU emulation.
 #define IA32_CR0_EM		(1U << 2)
 
+// XCR0: XSAVE feature enable mask.
+// Both SSE and AVX state must be enabled by the OS to use AVX/AVX2.
+#define IA32_XCR0_SSE		(1U << 1)
+#define IA32_XCR0_AVX		(1U << 2)
+
 // CPUID function 1: Processor Info and Feature Bits
 
 // Flags stored in the %edx register.
@@ -199,6 +199,47 @@ class RP_LIBROMDATA_PUBLIC NOVTABLE IRpFile
 			return -ENOTSUP;
 		}
 
+		/**
+		 * Get a read-only pointer to a range of the file's data.
+		 *
+		 * This allows zero-copy access if the file is backed by memory,
+		 * e.g. MemFile or a memory-mapped RpFile. The file position
+		 * is not changed.
+		 *
+		 * NOTE: The pointer is only valid until the file is
+		 * closed, modified, or made writable.
+		 *
+		 * @param pos	[in] Starting position
+		 * @param size	[in] Size of the range, in bytes
+		 * @return Pointer to the data, or nullptr if direct access isn't available for this range.
+		 */
+		virtual const uint8_t *view(off64_t pos, size_t size)
+		{
+			// Not supported.
+			RP_UNUSED(pos);
+			RP_UNUSED(size);
+			return nullptr;
+		}
+
+		/**
+		 * Announce that a range of the file will be read soon.
+		 *
+		 * This is an advisory function. Subclasses that can't do
+		 * anything useful with the hint should leave it as-is.
+		 * The file position is not changed.
+		 *
+		 * @param pos	[in] Starting position
+		 * @param size	[in] Size of the range, in bytes
+		 * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+		 */
+		virtual int prefetch(off64_t pos, off64_t size)
+		{
+			// Not supported.
+			RP_UNUSED(pos);
+			RP_UNUSED(size);
+			return -ENOTSUP;
+		}
+
 	public:
 		/** Convenience functions implemented for all IRpFile subclasses **/
 
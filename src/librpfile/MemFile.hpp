@@ -114,6 +114,26 @@ class RP_LIBROMDATA_PUBLIC MemFile : public IRpFile
 			return m_filename;
 		}
 
+	public:
+		/** Extra functions **/
+
+		/**
+		 * Get a read-only pointer to a range of the file's data.
+		 * The file position is not changed.
+		 * @param pos	[in] Starting position
+		 * @param size	[in] Size of the range, in bytes
+		 * @return Pointer to the data, or nullptr if the range is out of bounds.
+		 */
+		const uint8_t *view(off64_t pos, size_t size) final
+		{
+			if (!m_buf || pos < 0 || static_cast<uint64_t>(pos) > m_size ||
+			    size > m_size - static_cast<size_t>(pos))
+			{
+				return nullptr;
+			}
+			return static_cast<const uint8_t*>(m_buf) + static_cast<size_t>(pos);
+		}
+
 	public:
 		/** MemFile functions **/
 
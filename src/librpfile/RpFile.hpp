@@ -177,6 +177,40 @@ class RpFile final : public IRpFile
 		 */
 		int makeWritable(void) final;
 
+		/**
+		 * Get a read-only pointer to a range of the file's data.
+		 *
+		 * This is only available for read-only regular files on local
+		 * file systems. The file is memory-mapped on the first call.
+		 * The file position is not changed.
+		 *
+		 * The current file size is checked on every call, so a range
+		 * that was truncated by another process is never returned.
+		 *
+		 * NOTE: Files are never memory-mapped on Windows,
+		 * so this always returns nullptr there.
+		 *
+		 * @param pos	[in] Starting position
+		 * @param size	[in] Size of the range, in bytes
+		 * @return Pointer to the data, or nullptr if direct access isn't available for this range.
+		 */
+		RP_LIBROMDATA_PUBLIC
+		const uint8_t *view(off64_t pos, size_t size) final;
+
+		/**
+		 * Announce that a range of the file will be read soon.
+		 *
+		 * On Unix-like systems, this uses posix_fadvise(), or
+		 * posix_madvise() if the file is memory-mapped.
+		 * This is mostly useful for files on network file systems.
+		 * The file position is not changed.
+		 *
+		 * @param pos	[in] Starting position
+		 * @param size	[in] Size of the range, in bytes
+		 * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+		 */
+		int prefetch(off64_t pos, off64_t size) final;
+
 	public:
 		/** Device file functions **/
 
@@ -90,6 +90,19 @@ class RpFilePrivate
 		gzFile gzfd;		// Used for transparent gzip decompression.
 		off64_t gzsz;		// Uncompressed file size.
 
+#ifdef HAVE_MMAP
+		// Memory-mapped file data.
+		// Only used for read-only regular files on local file systems.
+		// read(), seek(), tell(), and size() always use stdio.
+		// The file is only mapped once view() is called, and view()
+		// checks the current file size before returning a pointer.
+		// NOTE: If another process truncates the file after view()
+		// returns, accessing the truncated range raises SIGBUS.
+		uint8_t *map;		// Mapped file data
+		off64_t map_size;	// Mapped file size
+		bool map_tried;		// Set once mapFile() has been called
+#endif /* HAVE_MMAP */
+
 		// Device information struct.
 		// Only used if the underlying file
 		// is a device node.
@@ -194,6 +207,29 @@ class RpFilePrivate
 		 */
 		int reOpenFile(void);
 
+#ifdef HAVE_MMAP
+		/**
+		 * Map the file into memory, if possible.
+		 *
+		 * INTERNAL FUNCTION. The file must already be open.
+		 * If the file can't be mapped, stdio will be used.
+		 *
+		 * Only files opened read-only are mapped. Writable files
+		 * always use stdio, since we might truncate them ourselves.
+		 *
+		 * This is only called by view(), so regular reads never
+		 * touch the mapping.
+		 *
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int mapFile(void);
+
+		/**
+		 * Unmap the file, if it's mapped.
+		 */
+		void unmapFile(void);
+#endif /* HAVE_MMAP */
+
 	public:
 		/**
 		 * Read one sector into the sector cache.
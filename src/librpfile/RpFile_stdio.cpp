@@ -15,6 +15,7 @@
 
 #include "RpFile.hpp"
 #include "RpFile_p.hpp"
+#include "FileSystem.hpp"
 
 // librpbyteswap
 #include "librpbyteswap/byteswap_rp.h"
@@ -23,14 +24,32 @@
 #include <fcntl.h>	// AT_EMPTY_PATH
 #include <sys/stat.h>	// stat(), statx()
 #include <unistd.h>	// ftruncate()
+#ifdef HAVE_MMAP
+#  include <sys/mman.h>	// mmap(), munmap()
+#endif /* HAVE_MMAP */
 
 namespace LibRpFile {
 
+#ifdef HAVE_MMAP
+// Maximum file size for memory-mapping.
+// 32-bit systems don't have enough address space to
+// map large disc images, so those will use stdio.
+#  if SIZE_MAX > 0xFFFFFFFFU
+static constexpr off64_t MMAP_MAX_SIZE = (1LL << 40);	// 1 TiB
+#  else /* SIZE_MAX <= 0xFFFFFFFFU */
+static constexpr off64_t MMAP_MAX_SIZE = (256LL << 20);	// 256 MiB
+#  endif /* SIZE_MAX > 0xFFFFFFFFU */
+#endif /* HAVE_MMAP */
+
 /** RpFilePrivate **/
 
 RpFilePrivate::RpFilePrivate(RpFile *q, const char *filename, RpFile::FileMode mode)
 	: q_ptr(q), file(INVALID_HANDLE_VALUE)
-	, mode(mode), gzfd(nullptr), gzsz(-1), devInfo(nullptr)
+	, mode(mode), gzfd(nullptr), gzsz(-1)
+#ifdef HAVE_MMAP
+	, map(nullptr), map_size(0), map_tried(false)
+#endif /* HAVE_MMAP */
+	, devInfo(nullptr)
 {
 	assert(filename != nullptr);
 	this->filename = strdup(filename);
@@ -38,6 +57,11 @@ RpFilePrivate::RpFilePrivate(RpFile *q, const char *filename, RpFile::FileMode m
 
 RpFilePrivate::~RpFilePrivate()
 {
+#ifdef HAVE_MMAP
+	if (map) {
+		munmap(map, static_cast<size_t>(map_size));
+	}
+#endif /* HAVE_MMAP */
 	if (gzfd != nullptr) {
 		gzclose_r(gzfd);
 	}
@@ -222,6 +246,93 @@ int RpFilePrivate::reOpenFile(void)
 	return 0;
 }
 
+#ifdef HAVE_MMAP
+/**
+ * Map the file into memory, if possible.
+ *
+ * INTERNAL FUNCTION. The file must already be open.
+ * If the file can't be mapped, stdio will be used.
+ *
+ * Only files opened read-only are mapped. Writable files
+ * always use stdio, since we might truncate them ourselves.
+ *
+ * This is only called by view(), so regular reads never
+ * touch the mapping.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpFilePrivate::mapFile(void)
+{
+	RP_Q(const RpFile);
+	assert(file != nullptr);
+	assert(map == nullptr);
+	if (!file || map) {
+		return -EBADF;
+	}
+
+	// Only read-only regular files can be mapped.
+	// gzipped files and devices must use stdio.
+	if ((mode & RpFile::FM_MODE_MASK) != RpFile::FM_OPEN_READ ||
+	    gzfd != nullptr || devInfo != nullptr ||
+	    q->m_fileType != DT_REG)
+	{
+		return -ENOTSUP;
+	}
+
+	// Don't map files on network file systems.
+	// If the connection is lost, accessing the mapping
+	// would raise SIGBUS instead of returning an error.
+	if (FileSystem::isOnBadFS(filename, false)) {
+		return -ENOTSUP;
+	}
+
+	const int fd = fileno(file);
+	struct stat sb;
+	if (fstat(fd, &sb) != 0) {
+		int err = -errno;
+		if (err == 0) {
+			err = -EIO;
+		}
+		return err;
+	}
+	if (!S_ISREG(sb.st_mode) || sb.st_size <= 0) {
+		// Not a regular file, or the file is empty.
+		return -ENOTSUP;
+	} else if (sb.st_size > MMAP_MAX_SIZE) {
+		// File is too big to map.
+		return -EFBIG;
+	}
+
+	void *const ptr = mmap(nullptr, static_cast<size_t>(sb.st_size),
+		PROT_READ, MAP_PRIVATE, fd, 0);
+	if (ptr == MAP_FAILED) {
+		int err = -errno;
+		if (err == 0) {
+			err = -ENOMEM;
+		}
+		return err;
+	}
+
+	map = static_cast<uint8_t*>(ptr);
+	map_size = sb.st_size;
+	return 0;
+}
+
+/**
+ * Unmap the file, if it's mapped.
+ */
+void RpFilePrivate::unmapFile(void)
+{
+	if (!map) {
+		return;
+	}
+
+	munmap(map, static_cast<size_t>(map_size));
+	map = nullptr;
+	map_size = 0;
+}
+#endif /* HAVE_MMAP */
+
 /** RpFile **/
 
 /**
@@ -362,6 +473,9 @@ void RpFile::close(void)
 		d->devInfo->close();
 	}
 
+#ifdef HAVE_MMAP
+	d->unmapFile();
+#endif /* HAVE_MMAP */
 	if (d->gzfd != nullptr) {
 		gzclose_r(d->gzfd);
 		d->gzfd = nullptr;
@@ -637,6 +751,10 @@ int RpFile::makeWritable(void)
 	}
 
 	RP_D(RpFile);
+#ifdef HAVE_MMAP
+	// The mapping is read-only, so switch back to stdio.
+	d->unmapFile();
+#endif /* HAVE_MMAP */
 	off64_t prev_pos = ftello(d->file);
 	fclose(d->file);
 	d->file = fopen(d->filename, "rb+");
@@ -659,4 +777,114 @@ int RpFile::makeWritable(void)
 	return 0;
 }
 
+/**
+ * Get a read-only pointer to a range of the file's data.
+ *
+ * This is only available for read-only regular files on local
+ * file systems. The file is memory-mapped on the first call.
+ * The file position is not changed.
+ *
+ * The current file size is checked on every call, so a range
+ * that was truncated by another process is never returned.
+ *
+ * @param pos	[in] Starting position
+ * @param size	[in] Size of the range, in bytes
+ * @return Pointer to the data, or nullptr if direct access isn't available for this range.
+ */
+const uint8_t *RpFile::view(off64_t pos, size_t size)
+{
+#ifdef HAVE_MMAP
+	RP_D(RpFile);
+	if (!d->map) {
+		if (d->map_tried || !d->file) {
+			return nullptr;
+		}
+		// Map the file into memory.
+		d->map_tried = true;
+		if (d->mapFile() != 0) {
+			return nullptr;
+		}
+	}
+
+	if (pos < 0 || pos > d->map_size ||
+	    static_cast<uint64_t>(size) > static_cast<uint64_t>(d->map_size - pos))
+	{
+		return nullptr;
+	}
+
+	// Make sure the range wasn't truncated since the file was mapped.
+	// Accessing pages past EOF raises SIGBUS.
+	struct stat sb;
+	if (fstat(fileno(d->file), &sb) != 0 ||
+	    static_cast<uint64_t>(sb.st_size) < static_cast<uint64_t>(pos) + size)
+	{
+		return nullptr;
+	}
+	return &d->map[pos];
+#else /* !HAVE_MMAP */
+	RP_UNUSED(pos);
+	RP_UNUSED(size);
+	return nullptr;
+#endif /* HAVE_MMAP */
+}
+
+/**
+ * Announce that a range of the file will be read soon.
+ *
+ * On Unix-like systems, this uses posix_fadvise(), or
+ * posix_madvise() if the file is memory-mapped.
+ * This is mostly useful for files on network file systems.
+ * The file position is not changed.
+ *
+ * @param pos	[in] Starting position
+ * @param size	[in] Size of the range, in bytes
+ * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+ */
+int RpFile::prefetch(off64_t pos, off64_t size)
+{
+	RP_D(const RpFile);
+	if (pos < 0 || size < 0) {
+		return -EINVAL;
+	} else if (size == 0) {
+		// Nothing to prefetch.
+		return 0;
+	} else if (d->gzfd) {
+		// gzip-compressed file. File offsets don't match
+		// the uncompressed data, so we can't prefetch.
+		return -ENOTSUP;
+	}
+
+#ifdef HAVE_MMAP
+	if (d->map) {
+#  ifdef HAVE_POSIX_MADVISE
+		if (pos >= d->map_size) {
+			// Nothing to prefetch.
+			return 0;
+		}
+		if (size > d->map_size - pos) {
+			size = d->map_size - pos;
+		}
+
+		// posix_madvise() requires a page-aligned address.
+		static const off64_t page_mask = static_cast<off64_t>(sysconf(_SC_PAGESIZE)) - 1;
+		const off64_t start = pos & ~page_mask;
+		return -posix_madvise(&d->map[start], static_cast<size_t>(size + (pos - start)), POSIX_MADV_WILLNEED);
+#  else /* !HAVE_POSIX_MADVISE */
+		return -ENOTSUP;
+#  endif /* HAVE_POSIX_MADVISE */
+	}
+#endif /* HAVE_MMAP */
+
+	if (!d->file) {
+		return -EBADF;
+	}
+
+#ifdef HAVE_POSIX_FADVISE
+	// NOTE: posix_fadvise() returns an error number instead of setting errno.
+	return -posix_fadvise(fileno(d->file), pos, size, POSIX_FADV_WILLNEED);
+#else /* !HAVE_POSIX_FADVISE */
+	return -ENOTSUP;
+#endif /* HAVE_POSIX_FADVISE */
+}
+
 }
@@ -151,6 +151,47 @@ class SubFile final : public IRpFile
 			return m_length;
 		}
 
+	public:
+		/** Extra functions **/
+
+		/**
+		 * Get a read-only pointer to a range of the file's data.
+		 * The file position is not changed.
+		 * @param pos	[in] Starting position
+		 * @param size	[in] Size of the range, in bytes
+		 * @return Pointer to the data, or nullptr if direct access isn't available for this range.
+		 */
+		const uint8_t *view(off64_t pos, size_t size) final
+		{
+			if (!m_file || pos < 0 || pos > m_length ||
+			    static_cast<uint64_t>(size) > static_cast<uint64_t>(m_length - pos))
+			{
+				return nullptr;
+			}
+			return m_file->view(pos + m_offset, size);
+		}
+
+		/**
+		 * Announce that a range of the file will be read soon.
+		 * The file position is not changed.
+		 * @param pos	[in] Starting position
+		 * @param size	[in] Size of the range, in bytes
+		 * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+		 */
+		int prefetch(off64_t pos, off64_t size) final
+		{
+			if (!m_file || pos < 0 || size < 0) {
+				return -EINVAL;
+			} else if (pos >= m_length) {
+				// Nothing to prefetch.
+				return 0;
+			}
+			if (size > m_length - pos) {
+				size = m_length - pos;
+			}
+			return m_file->prefetch(pos + m_offset, size);
+		}
+
 	protected:
 		LibRpFile::IRpFilePtr m_file;
 		off64_t m_offset;
@@ -853,4 +853,48 @@ int RpFile::makeWritable(void)
 	return 0;
 }
 
+/**
+ * Get a read-only pointer to a range of the file's data.
+ *
+ * This is only available if the file is memory-mapped,
+ * which is done for read-only regular files on local
+ * file systems. The file position is not changed.
+ *
+ * NOTE: Files are never memory-mapped on Windows,
+ * so this always returns nullptr there.
+ *
+ * @param pos	[in] Starting position
+ * @param size	[in] Size of the range, in bytes
+ * @return Pointer to the data, or nullptr if direct access isn't available for this range.
+ */
+const uint8_t *RpFile::view(off64_t pos, size_t size)
+{
+	// Files are never memory-mapped on Windows.
+	// Callers will fall back to read().
+	RP_UNUSED(pos);
+	RP_UNUSED(size);
+	return nullptr;
+}
+
+/**
+ * Announce that a range of the file will be read soon.
+ *
+ * On Unix-like systems, this uses posix_fadvise(), or
+ * posix_madvise() if the file is memory-mapped.
+ * This is mostly useful for files on network file systems.
+ * The file position is not changed.
+ *
+ * @param pos	[in] Starting position
+ * @param size	[in] Size of the range, in bytes
+ * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+ */
+int RpFile::prefetch(off64_t pos, off64_t size)
+{
+	// TODO: Windows doesn't have an equivalent to posix_fadvise()
+	// for file handles. PrefetchVirtualMemory() requires a mapping.
+	RP_UNUSED(pos);
+	RP_UNUSED(size);
+	return -ENOTSUP;
+}
+
 }
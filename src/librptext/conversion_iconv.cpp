@@ -37,15 +37,146 @@
 #  include <iconv.h>
 #endif
 
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+// CPU flags
+#include "librpcpuid/cpu_dispatch.h"
+#ifdef RP_CPU_AMD64
+#  include <emmintrin.h>
+#endif /* RP_CPU_AMD64 */
+
 // C includes (C++ namespace)
 #include <cassert>
+#include <cstring>
 
 // C++ STL classes
+#include <array>
+using std::array;
 using std::string;
 using std::u16string;
 
 namespace LibRpText {
 
+/** iconv descriptor cache **/
+
+/**
+ * Cache of iconv descriptors, keyed by character set pair.
+ *
+ * iconv_open() is expensive, and most conversions use the same few
+ * character set pairs, so descriptors are reused instead of being
+ * closed after each conversion.
+ *
+ * An iconv descriptor has conversion state, so it can only be used
+ * by one thread at a time. A descriptor is removed from the cache
+ * while it's in use, and returned to the cache afterwards.
+ */
+class IconvCache
+{
+	public:
+		IconvCache()
+		{
+			for (entry_t &entry : entries) {
+				entry.src_charset[0] = '\0';
+				entry.dest_charset[0] = '\0';
+				entry.cd = (iconv_t)(-1);
+			}
+		}
+
+		~IconvCache()
+		{
+			for (entry_t &entry : entries) {
+				if (entry.cd != (iconv_t)(-1)) {
+					iconv_close(entry.cd);
+				}
+			}
+		}
+
+		// Disable copy/assignment constructors.
+		IconvCache(const IconvCache &) = delete;
+		IconvCache &operator=(const IconvCache &) = delete;
+
+	public:
+		/**
+		 * Get an iconv descriptor for the specified character sets.
+		 * The descriptor must be returned using release() when done.
+		 * @param src_charset	[in] Source character set
+		 * @param dest_charset	[in] Destination character set
+		 * @return iconv descriptor, or (iconv_t)(-1) on error.
+		 */
+		iconv_t get(const char *src_charset, const char *dest_charset)
+		{
+			{
+				MutexLocker mutexLocker(mutex);
+				for (entry_t &entry : entries) {
+					if (entry.cd != (iconv_t)(-1) &&
+					    !strcmp(entry.src_charset, src_charset) &&
+					    !strcmp(entry.dest_charset, dest_charset))
+					{
+						// Found a cached descriptor.
+						iconv_t cd = entry.cd;
+						entry.cd = (iconv_t)(-1);
+						return cd;
+					}
+				}
+			}
+
+			// No cached descriptor. Open a new one.
+			return iconv_open(dest_charset, src_charset);
+		}
+
+		/**
+		 * Return an iconv descriptor to the cache.
+		 * If the cache is full, the descriptor will be closed.
+		 * @param src_charset	[in] Source character set
+		 * @param dest_charset	[in] Destination character set
+		 * @param cd		[in] iconv descriptor
+		 */
+		void release(const char *src_charset, const char *dest_charset, iconv_t cd)
+		{
+			// Reset the conversion state before caching the descriptor,
+			// since the conversion might have failed partway through.
+			iconv(cd, nullptr, nullptr, nullptr, nullptr);
+
+			if (strlen(src_charset) < sizeof(entries[0].src_charset) &&
+			    strlen(dest_charset) < sizeof(entries[0].dest_charset))
+			{
+				MutexLocker mutexLocker(mutex);
+				for (entry_t &entry : entries) {
+					if (entry.cd != (iconv_t)(-1))
+						continue;
+
+					// Empty slot, or a slot for this character set pair
+					// whose descriptor is currently in use.
+					if (entry.src_charset[0] == '\0' ||
+					    (!strcmp(entry.src_charset, src_charset) &&
+					     !strcmp(entry.dest_charset, dest_charset)))
+					{
+						strcpy(entry.src_charset, src_charset);
+						strcpy(entry.dest_charset, dest_charset);
+						entry.cd = cd;
+						return;
+					}
+				}
+			}
+
+			// Cache is full.
+			iconv_close(cd);
+		}
+
+	private:
+		struct entry_t {
+			char src_charset[32];	// may include "//IGNORE"
+			char dest_charset[16];
+			iconv_t cd;		// (iconv_t)(-1) if not cached
+		};
+		array<entry_t, 16> entries;
+		Mutex mutex;
+};
+static IconvCache iconvCache;
+
 /** OS-specific text conversion functions. **/
 
 /**
@@ -77,23 +208,18 @@ static char *rp_iconv(const char *src, int len,
 	// * http://www.delorie.com/gnu/docs/glibc/libc_101.html
 	// * http://www.codase.com/search/call?name=iconv
 
-	// Open an iconv descriptor.
-	iconv_t cd;
+	// Get an iconv descriptor.
 #if defined(__linux__) || defined(HAVE_ICONV_LIBICONV)
 	// glibc/libiconv: Append "//IGNORE" to the source character set
 	// if ignoreErr == true.
 	// TODO: Destination, not source?
+	char tmpsrc[32];
 	if (ignoreErr) {
-		char tmpsrc[32];
 		snprintf(tmpsrc, sizeof(tmpsrc), "%s//IGNORE", src_charset);
-		cd = iconv_open(dest_charset, tmpsrc);
-	} else {
-		// Not ignoring errors.
-		cd = iconv_open(dest_charset, src_charset);
+		src_charset = tmpsrc;
 	}
-#else
-	cd = iconv_open(dest_charset, src_charset);
 #endif
+	iconv_t cd = iconvCache.get(src_charset, dest_charset);
 
 	if (cd == (iconv_t)(-1)) {
 		// Error opening iconv.
@@ -139,8 +265,8 @@ static char *rp_iconv(const char *src, int len,
 		}
 	}
 
-	// Close the iconv descriptor.
-	iconv_close(cd);
+	// Return the iconv descriptor to the cache.
+	iconvCache.release(src_charset, dest_charset, cd);
 
 	if (success) {
 		// The string was converted successfully.
@@ -189,6 +315,121 @@ static inline void codePageToEncName(char *enc_name, size_t len, unsigned int cp
 	}
 }
 
+/** ASCII fast paths **/
+
+/**
+ * Is the specified code page ASCII-compatible?
+ * If it is, pure-ASCII text can be converted without iconv.
+ * @param cp	[in] Code page number.
+ * @return True if 0x00-0x7F map to ASCII; false if not or unknown.
+ */
+static inline bool isAsciiCompatible(unsigned int cp)
+{
+	switch (cp) {
+		case CP_ACP:
+		case CP_LATIN1:
+		case CP_UTF8:
+		case CP_SJIS:
+		case CP_GB2312:
+		case 437:
+		case 850:
+			return true;
+		default:
+			// Windows code pages: cp1250 through cp1258
+			return (cp >= 1250 && cp <= 1258);
+	}
+}
+
+/**
+ * Is an 8-bit string pure ASCII?
+ * @param str	[in] 8-bit text.
+ * @param len	[in] Length of str, in bytes.
+ * @return True if all characters are 7-bit ASCII; false if not.
+ */
+static inline bool isAscii(const char *str, size_t len)
+{
+#ifdef RP_CPU_AMD64
+	// amd64 always has SSE2.
+	// Check 16 bytes at a time using the high bit of each byte.
+	for (; len >= 16; str += 16, len -= 16) {
+		const __m128i xmm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str));
+		if (_mm_movemask_epi8(xmm) != 0)
+			return false;
+	}
+#else /* !RP_CPU_AMD64 */
+	// Check one machine word at a time.
+	static constexpr uintptr_t hi_bits = static_cast<uintptr_t>(0x8080808080808080ULL);
+	for (; len >= sizeof(uintptr_t); str += sizeof(uintptr_t), len -= sizeof(uintptr_t)) {
+		uintptr_t word;
+		memcpy(&word, str, sizeof(word));
+		if (word & hi_bits)
+			return false;
+	}
+#endif /* RP_CPU_AMD64 */
+
+	for (; len > 0; str++, len--) {
+		if (static_cast<uint8_t>(*str) & 0x80U)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Is a UTF-16 string pure ASCII?
+ * @param wcs		[in] UTF-16 text.
+ * @param len		[in] Length of wcs, in characters.
+ * @param byteswap	[in] If true, wcs is in the opposite of host-endian.
+ * @return True if all characters are 7-bit ASCII; false if not.
+ */
+static inline bool isAscii(const char16_t *wcs, size_t len, bool byteswap)
+{
+	// Any bit set in the mask means the character isn't ASCII.
+	const uint16_t mask = (byteswap ? 0x80FFU : 0xFF80U);
+
+#ifdef RP_CPU_AMD64
+	// amd64 always has SSE2.
+	// Check 8 characters at a time.
+	const __m128i xmm_mask = _mm_set1_epi16(static_cast<short>(mask));
+	const __m128i xmm_zero = _mm_setzero_si128();
+	for (; len >= 8; wcs += 8, len -= 8) {
+		const __m128i xmm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(wcs));
+		const __m128i xmm_cmp = _mm_cmpeq_epi16(_mm_and_si128(xmm, xmm_mask), xmm_zero);
+		if (_mm_movemask_epi8(xmm_cmp) != 0xFFFF)
+			return false;
+	}
+#endif /* RP_CPU_AMD64 */
+
+	for (; len > 0; wcs++, len--) {
+		if (*wcs & mask)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Convert a pure-ASCII UTF-16 string to 8-bit text.
+ * @param wcs		[in] UTF-16 text. (must be pure ASCII)
+ * @param len		[in] Length of wcs, in characters.
+ * @param byteswap	[in] If true, wcs is in the opposite of host-endian.
+ * @return 8-bit text.
+ */
+static string ascii16_to_ascii8(const char16_t *wcs, size_t len, bool byteswap)
+{
+	string ret;
+	ret.resize(len);
+	char *p = &ret[0];
+	if (byteswap) {
+		for (; len > 0; wcs++, p++, len--) {
+			*p = static_cast<char>(*wcs >> 8);
+		}
+	} else {
+		for (; len > 0; wcs++, p++, len--) {
+			*p = static_cast<char>(*wcs);
+		}
+	}
+	return ret;
+}
+
 /**
  * Convert 8-bit text to UTF-8.
  * Trailing NULL bytes will be removed.
@@ -209,6 +450,10 @@ string cpN_to_utf8(unsigned int cp, const char *str, int len, unsigned int flags
 	}
 
 	len = check_NULL_terminator(str, len);
+	if (isAsciiCompatible(cp) && isAscii(str, len)) {
+		// Pure ASCII. No conversion is needed.
+		return string(str, len);
+	}
 
 	// Get the encoding name for the primary code page.
 	char cp_name[20];
@@ -276,6 +521,16 @@ string cpN_to_utf8(unsigned int cp, const char *str, int len, unsigned int flags
 u16string cpN_to_utf16(unsigned int cp, const char *str, int len, unsigned int flags)
 {
 	len = check_NULL_terminator(str, len);
+	if (isAsciiCompatible(cp) && isAscii(str, len)) {
+		// Pure ASCII. Zero-extend to UTF-16.
+		u16string ret;
+		ret.resize(len);
+		const uint8_t *const src = reinterpret_cast<const uint8_t*>(str);
+		for (int i = 0; i < len; i++) {
+			ret[i] = src[i];
+		}
+		return ret;
+	}
 
 	// Get the encoding name for the primary code page.
 	char cp_name[20];
@@ -335,6 +590,10 @@ u16string cpN_to_utf16(unsigned int cp, const char *str, int len, unsigned int f
 string utf8_to_cpN(unsigned int cp, const char *str, int len)
 {
 	len = check_NULL_terminator(str, len);
+	if (isAsciiCompatible(cp) && isAscii(str, len)) {
+		// Pure ASCII. No conversion is needed.
+		return string(str, len);
+	}
 
 	// Get the encoding name for the primary code page.
 	char cp_name[20];
@@ -365,6 +624,10 @@ string utf8_to_cpN(unsigned int cp, const char *str, int len)
 string utf16_to_cpN(unsigned int cp, const char16_t *wcs, int len)
 {
 	len = check_NULL_terminator(wcs, len);
+	if (isAsciiCompatible(cp) && isAscii(wcs, len, false)) {
+		// Pure ASCII. Truncate to 8-bit.
+		return ascii16_to_ascii8(wcs, len, false);
+	}
 
 	// Get the encoding name for the primary code page.
 	char cp_name[20];
@@ -395,6 +658,11 @@ string utf16_to_cpN(unsigned int cp, const char16_t *wcs, int len)
 string utf16le_to_utf8(const char16_t *wcs, int len)
 {
 	len = check_NULL_terminator(wcs, len);
+	static constexpr bool byteswap = (SYS_BYTEORDER != SYS_LIL_ENDIAN);
+	if (isAscii(wcs, len, byteswap)) {
+		// Pure ASCII. Truncate to 8-bit.
+		return ascii16_to_ascii8(wcs, len, byteswap);
+	}
 
 	// Attempt to convert the text from UTF-16LE to UTF-8.
 	string ret;
@@ -416,6 +684,11 @@ string utf16le_to_utf8(const char16_t *wcs, int len)
 string utf16be_to_utf8(const char16_t *wcs, int len)
 {
 	len = check_NULL_terminator(wcs, len);
+	static constexpr bool byteswap = (SYS_BYTEORDER != SYS_BIG_ENDIAN);
+	if (isAscii(wcs, len, byteswap)) {
+		// Pure ASCII. Truncate to 8-bit.
+		return ascii16_to_ascii8(wcs, len, byteswap);
+	}
 
 	// Attempt to convert the text from UTF-16BE to UTF-8.
 	string ret;
@@ -771,6 +771,51 @@ TEST_F(TextFuncsTest, utf16_to_latin1)
 	EXPECT_EQ(C8(cp1252_data), str);
 }
 
+/**
+ * Test the pure-ASCII fast paths with a single non-ASCII character
+ * at every position, for string lengths that cross the block size
+ * used by the ASCII checks.
+ */
+TEST_F(TextFuncsTest, ascii_fast_path)
+{
+	for (int len = 1; len <= 40; len++) {
+		// Pure ASCII.
+		string ascii8;
+		for (int i = 0; i < len; i++) {
+			ascii8 += static_cast<char>('A' + (i % 26));
+		}
+		const u16string ascii16(ascii8.begin(), ascii8.end());
+		EXPECT_EQ(ascii8, cp1252_to_utf8(ascii8.data(), len)) << "len == " << len;
+		EXPECT_EQ(ascii16, cp1252_to_utf16(ascii8.data(), len)) << "len == " << len;
+		EXPECT_EQ(ascii8, utf8_to_latin1(ascii8.data(), len)) << "len == " << len;
+		EXPECT_EQ(ascii8, utf16_to_latin1(ascii16.data(), len)) << "len == " << len;
+
+		// One non-ASCII character at each position.
+		// U+0100 checks the high byte of UTF-16 characters.
+		for (int pos = 0; pos < len; pos++) {
+			string cp1252 = ascii8;
+			cp1252[pos] = static_cast<char>(0xE9);
+			string expected8 = ascii8;
+			expected8.replace(pos, 1, "\xC3\xA9");
+			EXPECT_EQ(expected8, cp1252_to_utf8(cp1252.data(), len)) << "len == " << len << ", pos == " << pos;
+
+			u16string utf16 = ascii16;
+			utf16[pos] = 0x0100;
+			expected8 = ascii8;
+			expected8.replace(pos, 1, "\xC4\x80");
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
+			const u16string utf16le = utf16;
+			const u16string utf16be = utf16_bswap(utf16.data(), len);
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+			const u16string utf16le = utf16_bswap(utf16.data(), len);
+			const u16string utf16be = utf16;
+#endif
+			EXPECT_EQ(expected8, utf16le_to_utf8(utf16le.data(), len)) << "len == " << len << ", pos == " << pos;
+			EXPECT_EQ(expected8, utf16be_to_utf8(utf16be.data(), len)) << "len == " << len << ", pos == " << pos;
+		}
+	}
+}
+
 /** Miscellaneous functions. **/
 
 /**
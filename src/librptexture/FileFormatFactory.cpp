@@ -111,10 +111,93 @@ class FileFormatFactoryPrivate
 		 * indicating if the file type handler supports thumbnails.
 		 */
 		static void init_supportedFileExtensions(void);
+
+		/**
+		 * Check if a file might be a TGA file using heuristics.
+		 * Based on heuristics from `file`.
+		 * @param pHeader	[in] First 32 bytes of the file
+		 * @param filename	[in,opt] Filename (for file extension checks)
+		 * @return True if this might be a TGA file; false if not.
+		 */
+		static bool checkTGAHeuristics(const uint8_t *pHeader, const char *filename);
 };
 
 /** FileFormatFactoryPrivate **/
 
+/**
+ * Check if a file might be a TGA file using heuristics.
+ * Based on heuristics from `file`.
+ * @param pHeader	[in] First 32 bytes of the file
+ * @param filename	[in,opt] Filename (for file extension checks)
+ * @return True if this might be a TGA file; false if not.
+ */
+bool FileFormatFactoryPrivate::checkTGAHeuristics(const uint8_t *pHeader, const char *filename)
+{
+	// NOTE: We're also checking the file extension due to
+	// conflicts with "WWF Raw" on SNES.
+	const char *const ext = FileSystem::file_ext(filename);
+	bool ext_ok = false;
+	if (!ext || ext[0] == '\0') {
+		// No extension. Check for TGA anyway.
+		ext_ok = true;
+	} else if (!strcasecmp(ext, ".tga")) {
+		// TGA extension.
+		ext_ok = true;
+	} else if (!strcasecmp(ext, ".gz")) {
+		// Check if it's ".tga.gz".
+		const size_t filename_len = strlen(filename);
+		if (filename_len >= 7) {
+			if (!strncasecmp(&filename[filename_len-7], ".tga", 4)) {
+				// It's ".tga.gz".
+				ext_ok = true;
+			}
+		}
+	}
+	if (!ext_ok) {
+		return false;
+	}
+
+	// test of Color Map Type 0~no 1~color map
+	// and Image Type 1 2 3 9 10 11 32 33
+	// and Color Map Entry Size 0 15 16 24 32
+	// NOTE: The header might not be 32-bit aligned.
+	uint32_t header32[2];
+	memcpy(header32, pHeader, sizeof(header32));
+	if (((header32[0] & be32_to_cpu(0x00FEC400)) != 0) ||
+	    ((header32[1] & be32_to_cpu(0x000000C0)) != 0))
+	{
+		return false;
+	}
+
+	const TGA_Header *const tgaHeader = reinterpret_cast<const TGA_Header*>(pHeader);
+
+	// skip some MPEG sequence *.vob and some CRI ADX audio with improbable interleave bits
+	if ((tgaHeader->img.attr_dir & 0xC0) == 0xC0 ||
+	// skip more garbage like *.iso by looking for positive image type
+	     tgaHeader->image_type == 0 ||
+	// skip some compiled terminfo like xterm+tmux by looking for image type less equal 33
+	     tgaHeader->image_type >= 34 ||
+	// skip some MPEG sequence *.vob HV001T01.EVO winnicki.mpg with unacceptable alpha channel depth 11
+	    (tgaHeader->img.attr_dir & 0x0F) == 11)
+	{
+		return false;
+	}
+
+	// skip arches.3200 , Finder.Root , Slp.1 by looking for low pixel depth 1 8 15 16 24 32
+	switch (tgaHeader->img.bpp) {
+		case 1:  case 8:
+		case 15: case 16:
+		case 24: case 32:
+			// Valid color depth.
+			return true;
+
+		default:
+			break;
+	}
+
+	return false;
+}
+
 #ifdef FILEFORMATFACTORY_USE_FILE_EXTENSIONS
 vector<const char*> FileFormatFactoryPrivate::vec_exts;
 pthread_once_t FileFormatFactoryPrivate::once_exts = PTHREAD_ONCE_INIT;
@@ -217,70 +300,17 @@ FileFormatPtr FileFormatFactory::create(const IRpFilePtr &file)
 	}
 
 	// Use some heuristics to check for TGA files.
-	// Based on heuristics from `file`.
 	// TGA 2.0 has an identifying footer as well.
-	// NOTE: We're also checking the file extension due to
-	// conflicts with "WWF Raw" on SNES.
-	const char *const filename = file->filename();
-	const char *const ext = FileSystem::file_ext(filename);
-	bool ext_ok = false;
-	if (!ext || ext[0] == '\0') {
-		// No extension. Check for TGA anyway.
-		ext_ok = true;
-	} else if (!strcasecmp(ext, ".tga")) {
-		// TGA extension.
-		ext_ok = true;
-	} else if (!strcasecmp(ext, ".gz")) {
-		// Check if it's ".tga.gz".
-		const size_t filename_len = strlen(filename);
-		if (filename_len >= 7) {
-			if (!strncasecmp(&filename[filename_len-7], ".tga", 4)) {
-				// It's ".tga.gz".
-				ext_ok = true;
-			}
+	if (FileFormatFactoryPrivate::checkTGAHeuristics(magic.u8, file->filename())) {
+		// This might be TGA.
+		FileFormat *const fileFormat = new TGA(file);
+		if (fileFormat->isValid()) {
+			// FileFormat subclass obtained.
+			return FileFormatPtr(fileFormat);
 		}
-	}
-
-	// test of Color Map Type 0~no 1~color map
-	// and Image Type 1 2 3 9 10 11 32 33
-	// and Color Map Entry Size 0 15 16 24 32
-	if (ext_ok &&
-	    ((magic.u32[0] & be32_to_cpu(0x00FEC400)) == 0) &&
-	    ((magic.u32[1] & be32_to_cpu(0x000000C0)) == 0))
-	{
-		const TGA_Header *const tgaHeader = reinterpret_cast<const TGA_Header*>(&magic);
-
-		// skip some MPEG sequence *.vob and some CRI ADX audio with improbable interleave bits
-		if ((tgaHeader->img.attr_dir & 0xC0) != 0xC0 &&
-		// skip more garbage like *.iso by looking for positive image type
-		     tgaHeader->image_type > 0 &&
-		// skip some compiled terminfo like xterm+tmux by looking for image type less equal 33
-		     tgaHeader->image_type < 34 &&
-		// skip some MPEG sequence *.vob HV001T01.EVO winnicki.mpg with unacceptable alpha channel depth 11
-		    (tgaHeader->img.attr_dir & 0x0F) != 11)
-		{
-			// skip arches.3200 , Finder.Root , Slp.1 by looking for low pixel depth 1 8 15 16 24 32
-			switch (tgaHeader->img.bpp) {
-				case 1:  case 8:
-				case 15: case 16:
-				case 24: case 32: {
-					// Valid color depth.
-					// This might be TGA.
-					FileFormat *const fileFormat = new TGA(file);
-					if (fileFormat->isValid()) {
-						// FileFormat subclass obtained.
-						return FileFormatPtr(fileFormat);
-					}
-
-					// Not actually supported.
-					delete fileFormat;
-					break;
-				}
 
-				default:
-					break;
-			}
-		}
+		// Not actually supported.
+		delete fileFormat;
 	}
 
 #if SYS_BYTEORDER == SYS_LIL_ENDIAN
@@ -314,6 +344,59 @@ FileFormatPtr FileFormatFactory::create(const IRpFilePtr &file)
 	return nullptr;
 }
 
+/**
+ * Quickly check if a file might be a supported texture file.
+ *
+ * This only checks magic numbers and header heuristics, so it's
+ * much cheaper than create() for files that aren't textures.
+ * If this function returns true, create() must still be called
+ * to determine if the file is actually supported.
+ *
+ * @param pHeader	[in] File header (at least 32 bytes)
+ * @param szHeader	[in] Size of pHeader
+ * @param filename	[in,opt] Filename (for file extension checks)
+ * @return True if the file might be supported; false if it definitely isn't.
+ */
+bool FileFormatFactory::isTextureSupported(const uint8_t *pHeader, size_t szHeader, const char *filename)
+{
+	assert(pHeader != nullptr);
+	if (!pHeader || szHeader < 32) {
+		// create() requires at least 32 bytes.
+		return false;
+	}
+
+	// NOTE: The header might not be 32-bit aligned.
+	uint32_t magic[2];
+	memcpy(magic, pHeader, sizeof(magic));
+
+	// Khronos KTX (1.1 and 2.0)
+	if (magic[0] == cpu_to_be32('\xABKTX')) {
+		if (magic[1] == cpu_to_be32(' 11\xBB') ||
+		    magic[1] == cpu_to_be32(' 20\xBB'))
+		{
+			return true;
+		}
+	}
+
+	// TGA heuristics
+	if (FileFormatFactoryPrivate::checkTGAHeuristics(pHeader, filename)) {
+		return true;
+	}
+
+	// FileFormat subclasses that have a 32-bit magic number at address 0.
+	magic[0] = be32_to_cpu(magic[0]);
+	const FileFormatFactoryPrivate::FileFormatFns *fns =
+		&FileFormatFactoryPrivate::FileFormatFns_magic[0];
+	for (; fns->textureInfo != nullptr; fns++) {
+		if (magic[0] == fns->magic) {
+			return true;
+		}
+	}
+
+	// Not supported.
+	return false;
+}
+
 #ifdef FILEFORMATFACTORY_USE_FILE_EXTENSIONS
 /**
  * Initialize the vector of supported file extensions.
@@ -56,6 +56,21 @@ public:
 	 */
 	static FileFormatPtr create(const LibRpFile::IRpFilePtr &file);
 
+	/**
+	 * Quickly check if a file might be a supported texture file.
+	 *
+	 * This only checks magic numbers and header heuristics, so it's
+	 * much cheaper than create() for files that aren't textures.
+	 * If this function returns true, create() must still be called
+	 * to determine if the file is actually supported.
+	 *
+	 * @param pHeader	[in] File header (at least 32 bytes)
+	 * @param szHeader	[in] Size of pHeader
+	 * @param filename	[in,opt] Filename (for file extension checks)
+	 * @return True if the file might be supported; false if it definitely isn't.
+	 */
+	static bool isTextureSupported(const uint8_t *pHeader, size_t szHeader, const char *filename);
+
 #ifdef FILEFORMATFACTORY_USE_FILE_EXTENSIONS
 	/**
 	 * Get all supported file extensions.
@@ -9,6 +9,7 @@
 #include "stdafx.h"
 
 #include "ImageDecoder_ASTC.hpp"
+#include "ImageDecoder_p.hpp"
 #include "basisu_astc_decomp.h"
 
 // librptexture
@@ -102,7 +103,7 @@ rp_image_ptr fromASTC(int width, int height,
 #  else
 #    define SHARED_OMP5(x)
 #  endif
-#pragma omp parallel for default(none) shared(img_buf, bErr) SHARED_OMP5(pDestBits) firstprivate(block_x, block_y, tilesX, tilesY, bytesPerTileRow, stride_px)
+#pragma omp parallel for default(none) shared(img_buf, bErr) SHARED_OMP5(pDestBits) firstprivate(block_x, block_y, tilesX, tilesY, bytesPerTileRow, stride_px) if(physWidth * physHeight >= ImageDecoderPrivate::OMP_MIN_PIXELS)
 #endif /* _OPENMP */
 	for (int y = 0; y < tilesY; y++) {
 		const uint8_t *pSrc = &img_buf[y * bytesPerTileRow];
@@ -637,23 +637,24 @@ rp_image_ptr fromETC1(int width, int height,
 		return nullptr;
 	}
 
-	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf);
-
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+	const int tilesX = physWidth / 4;
+	const int tilesY = physHeight / 4;
 
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
+#pragma omp parallel for default(none) shared(img_buf, img) firstprivate(tilesX, tilesY) if(tilesX * tilesY >= ImageDecoderPrivate::OMP_MIN_TILES)
+	for (int y = 0; y < tilesY; y++) {
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
 
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
-		// Decode the ETC1 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC1>(tileBuf, etc1_src);
+		const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf) + (y * tilesX);
+		for (int x = 0; x < tilesX; x++, etc1_src++) {
+			// Decode the ETC1 RGB block.
+			decodeBlock_ETC_RGB<ETC_DM_ETC1>(tileBuf, etc1_src);
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
-	} }
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
+		}
+	}
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -703,23 +704,24 @@ rp_image_ptr fromETC2_RGB(int width, int height,
 		return nullptr;
 	}
 
-	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf);
-
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+	const int tilesX = physWidth / 4;
+	const int tilesY = physHeight / 4;
 
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
+#pragma omp parallel for default(none) shared(img_buf, img) firstprivate(tilesX, tilesY) if(tilesX * tilesY >= ImageDecoderPrivate::OMP_MIN_TILES)
+	for (int y = 0; y < tilesY; y++) {
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
 
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
-		// Decode the ETC2 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, etc1_src);
+		const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf) + (y * tilesX);
+		for (int x = 0; x < tilesX; x++, etc1_src++) {
+			// Decode the ETC2 RGB block.
+			decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, etc1_src);
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
-	} }
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
+		}
+	}
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -813,27 +815,28 @@ rp_image_ptr fromETC2_RGBA(int width, int height,
 		return nullptr;
 	}
 
-	const etc2_rgba_block *etc2_src = reinterpret_cast<const etc2_rgba_block*>(img_buf);
-
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+	const int tilesX = physWidth / 4;
+	const int tilesY = physHeight / 4;
 
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
+#pragma omp parallel for default(none) shared(img_buf, img) firstprivate(tilesX, tilesY) if(tilesX * tilesY >= ImageDecoderPrivate::OMP_MIN_TILES)
+	for (int y = 0; y < tilesY; y++) {
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
 
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, etc2_src++) {
-		// Decode the ETC2 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, &etc2_src->etc1);
+		const etc2_rgba_block *etc2_src = reinterpret_cast<const etc2_rgba_block*>(img_buf) + (y * tilesX);
+		for (int x = 0; x < tilesX; x++, etc2_src++) {
+			// Decode the ETC2 RGB block.
+			decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, &etc2_src->etc1);
 
-		// Decode the ETC2 alpha block.
-		// TODO: Don't fill in the alpha channel in decodeBlock_ETC2_RGB()?
-		T_decodeBlock_EAC<ARGB32_BYTE_OFFSET_A>(tileBuf, &etc2_src->alpha);
+			// Decode the ETC2 alpha block.
+			// TODO: Don't fill in the alpha channel in decodeBlock_ETC2_RGB()?
+			T_decodeBlock_EAC<ARGB32_BYTE_OFFSET_A>(tileBuf, &etc2_src->alpha);
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
-	} }
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
+		}
+	}
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -883,23 +886,24 @@ rp_image_ptr fromETC2_RGB_A1(int width, int height,
 		return nullptr;
 	}
 
-	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf);
-
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+	const int tilesX = physWidth / 4;
+	const int tilesY = physHeight / 4;
 
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
+#pragma omp parallel for default(none) shared(img_buf, img) firstprivate(tilesX, tilesY) if(tilesX * tilesY >= ImageDecoderPrivate::OMP_MIN_TILES)
+	for (int y = 0; y < tilesY; y++) {
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
 
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
-		// Decode the ETC2 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC2 | ETC2_DM_A1>(tileBuf, etc1_src);
+		const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf) + (y * tilesX);
+		for (int x = 0; x < tilesX; x++, etc1_src++) {
+			// Decode the ETC2 RGB block.
+			decodeBlock_ETC_RGB<ETC_DM_ETC2 | ETC2_DM_A1>(tileBuf, etc1_src);
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
-	} }
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
+		}
+	}
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -949,26 +953,27 @@ rp_image_ptr fromEAC_R11(int width, int height,
 		return nullptr;
 	}
 
-	const etc2_alpha *eac_block = reinterpret_cast<const etc2_alpha*>(img_buf);
-
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
-
-	// Temporary tile buffer.
-	// NOTE: Must be initialized to 0xFF000000U, since
-	// T_decodeBlock_EAC<>() only modifies a single channel.
-	array<uint32_t, 4*4> tileBuf;
-	tileBuf.fill(0xFF000000U);
-
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, eac_block++) {
-		// Decode the EAC R11 block.
-		T_decodeBlock_EAC<ARGB32_BYTE_OFFSET_R>(tileBuf, eac_block);
-
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
-	} }
+	const int tilesX = physWidth / 4;
+	const int tilesY = physHeight / 4;
+
+#pragma omp parallel for default(none) shared(img_buf, img) firstprivate(tilesX, tilesY) if(tilesX * tilesY >= ImageDecoderPrivate::OMP_MIN_TILES)
+	for (int y = 0; y < tilesY; y++) {
+		// Temporary tile buffer.
+		// NOTE: Must be initialized to 0xFF000000U, since
+		// T_decodeBlock_EAC<>() only modifies a single channel.
+		array<uint32_t, 4*4> tileBuf;
+		tileBuf.fill(0xFF000000U);
+
+		const etc2_alpha *eac_block = reinterpret_cast<const etc2_alpha*>(img_buf) + (y * tilesX);
+		for (int x = 0; x < tilesX; x++, eac_block++) {
+			// Decode the EAC R11 block.
+			T_decodeBlock_EAC<ARGB32_BYTE_OFFSET_R>(tileBuf, eac_block);
+
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
+		}
+	}
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -1019,28 +1024,29 @@ rp_image_ptr fromEAC_RG11(int width, int height,
 		return nullptr;
 	}
 
-	const etc2_alpha *eac_block = reinterpret_cast<const etc2_alpha*>(img_buf);
-
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
-
-	// Temporary tile buffer.
-	// NOTE: Must be initialized to 0xFF000000U, since
-	// T_decodeBlock_EAC<>() only modifies a single channel.
-	array<uint32_t, 4*4> tileBuf;
-	tileBuf.fill(0xFF000000U);
-
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, eac_block += 2) {
-		// Decode the EAC R11 block.
-		T_decodeBlock_EAC<ARGB32_BYTE_OFFSET_R>(tileBuf, &eac_block[0]);
-		// Decode the EAC G11 block.
-		T_decodeBlock_EAC<ARGB32_BYTE_OFFSET_G>(tileBuf, &eac_block[1]);
-
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
-	} }
+	const int tilesX = physWidth / 4;
+	const int tilesY = physHeight / 4;
+
+#pragma omp parallel for default(none) shared(img_buf, img) firstprivate(tilesX, tilesY) if(tilesX * tilesY >= ImageDecoderPrivate::OMP_MIN_TILES)
+	for (int y = 0; y < tilesY; y++) {
+		// Temporary tile buffer.
+		// NOTE: Must be initialized to 0xFF000000U, since
+		// T_decodeBlock_EAC<>() only modifies a single channel.
+		array<uint32_t, 4*4> tileBuf;
+		tileBuf.fill(0xFF000000U);
+
+		const etc2_alpha *eac_block = reinterpret_cast<const etc2_alpha*>(img_buf) + (y * tilesX * 2);
+		for (int x = 0; x < tilesX; x++, eac_block += 2) {
+			// Decode the EAC R11 block.
+			T_decodeBlock_EAC<ARGB32_BYTE_OFFSET_R>(tileBuf, &eac_block[0]);
+			// Decode the EAC G11 block.
+			T_decodeBlock_EAC<ARGB32_BYTE_OFFSET_G>(tileBuf, &eac_block[1]);
+
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
+		}
+	}
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -107,32 +107,29 @@ rp_image_ptr fromLinear16_sse2(PixelFormat px_format,
 	const uint16_t *RESTRICT img_buf, size_t img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSE2 */
 
-#if defined(HAVE_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
-
-#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
-// System does support IFUNC, but it's always guaranteed to have SSE2.
-// Eliminate the IFUNC dispatch on this system.
-
+#ifdef IMAGEDECODER_HAS_AVX2
 /**
  * Convert a linear 16-bit RGB image to rp_image.
+ * AVX2-optimized version.
  * @param px_format	[in] 16-bit pixel format.
  * @param width		[in] Image width.
  * @param height	[in] Image height.
- * @param img_buf	[in] Image buffer.
- * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
  * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 4, 5)
-static inline rp_image_ptr fromLinear16(PixelFormat px_format,
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromLinear16_avx2(PixelFormat px_format,
 	int width, int height,
-	const uint16_t *img_buf, size_t img_siz, int stride = 0)
-{
-	// amd64 always has SSE2.
-	return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
-}
-#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
-// System supports IFUNC and is not guaranteed to always have SSE2.
+	const uint16_t *RESTRICT img_buf, size_t img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(HAVE_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+// System supports IFUNC.
+// NOTE: IFUNC is used even if the CPU is guaranteed to have SSE2,
+// since AVX2 is checked at runtime.
 
 /**
  * Convert a linear 16-bit RGB image to rp_image.
@@ -146,10 +143,9 @@ static inline rp_image_ptr fromLinear16(PixelFormat px_format,
  */
 ATTR_ACCESS_SIZE(read_only, 4, 5)
 RP_LIBROMDATA_PUBLIC
-IFUNC_SSE2_STATIC_INLINE rp_image_ptr fromLinear16(PixelFormat px_format,
+IFUNC_STATIC_INLINE rp_image_ptr fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, size_t img_siz, int stride = 0);
-#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
 
 #else /* !HAVE_IFUNC or not i386/amd64 */
 // System does not support IFUNC, or we aren't guaranteed to have
@@ -170,6 +166,11 @@ static inline rp_image_ptr fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, size_t img_siz, int stride = 0)
 {
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear16_avx2(px_format, width, height, img_buf, img_siz, stride);
+	}
+#  endif /* IMAGEDECODER_HAS_AVX2 */
 #  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
 	// amd64 always has SSE2.
 	return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
@@ -225,6 +226,25 @@ rp_image_ptr fromLinear24_ssse3(PixelFormat px_format,
 	const uint8_t *RESTRICT img_buf, size_t img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a linear 24-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 24-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] Image buffer. (must be byte-addressable)
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 4, 5)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromLinear24_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
 #if defined(HAVE_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a linear 24-bit RGB image to rp_image.
@@ -260,6 +280,11 @@ static inline rp_image_ptr fromLinear24(PixelFormat px_format,
 	int width, int height,
 	const uint8_t *RESTRICT img_buf, size_t img_siz, int stride = 0)
 {
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear24_avx2(px_format, width, height, img_buf, img_siz, stride);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
 #  ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return fromLinear24_ssse3(px_format, width, height, img_buf, img_siz, stride);
@@ -309,6 +334,25 @@ rp_image_ptr fromLinear32_ssse3(PixelFormat px_format,
 	const uint32_t *RESTRICT img_buf, size_t img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a linear 32-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 32-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*4]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 4, 5)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromLinear32_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint32_t *RESTRICT img_buf, size_t img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
 #if defined(HAVE_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a linear 32-bit RGB image to rp_image.
@@ -342,6 +386,11 @@ static inline rp_image_ptr fromLinear32(PixelFormat px_format,
 	int width, int height,
 	const uint32_t *RESTRICT img_buf, size_t img_siz, int stride = 0)
 {
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear32_avx2(px_format, width, height, img_buf, img_siz, stride);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
 #  ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return fromLinear32_ssse3(px_format, width, height, img_buf, img_siz, stride);
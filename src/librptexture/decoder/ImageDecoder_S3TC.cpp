@@ -310,31 +310,32 @@ static rp_image_ptr T_fromDXT1(int width, int height,
 		return nullptr;
 	}
 
-	const dxt1_block *dxt1_src = reinterpret_cast<const dxt1_block*>(img_buf);
-
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
-
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
-
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, dxt1_src++) {
-		// Decode the DXT1 tile palette.
-		argb32_t pal[4];
-		decode_DXTn_tile_color_palette_S3TC<palflags>(pal, dxt1_src);
-
-		// Process the 16 color indexes.
-		uint32_t indexes = le32_to_cpu(dxt1_src->indexes);
-		for (uint32_t &p : tileBuf) {
-			p = pal[indexes & 3].u32;
-			indexes >>= 2;
-		}
+	const int tilesX = physWidth / 4;
+	const int tilesY = physHeight / 4;
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
-	} }
+#pragma omp parallel for default(none) shared(img_buf, img) firstprivate(tilesX, tilesY) if(tilesX * tilesY >= ImageDecoderPrivate::OMP_MIN_TILES)
+	for (int y = 0; y < tilesY; y++) {
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
+
+		const dxt1_block *dxt1_src = reinterpret_cast<const dxt1_block*>(img_buf) + (y * tilesX);
+		for (int x = 0; x < tilesX; x++, dxt1_src++) {
+			// Decode the DXT1 tile palette.
+			argb32_t pal[4];
+			decode_DXTn_tile_color_palette_S3TC<palflags>(pal, dxt1_src);
+
+			// Process the 16 color indexes.
+			uint32_t indexes = le32_to_cpu(dxt1_src->indexes);
+			for (uint32_t &p : tileBuf) {
+				p = pal[indexes & 3].u32;
+				indexes >>= 2;
+			}
+
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
+		}
+	}
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -451,38 +452,39 @@ rp_image_ptr fromDXT3(int width, int height,
 		dxt1_block colors;	// DXT1-style color block.
 	};
 	ASSERT_STRUCT(dxt3_block, 16);
-	const dxt3_block *dxt3_src = reinterpret_cast<const dxt3_block*>(img_buf);
-
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
-
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
-
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, dxt3_src++) {
-		// Decode the DXT3 tile palette.
-		argb32_t pal[4];
-		decode_DXTn_tile_color_palette_S3TC<DXTn_PALETTE_COLOR0_GT_COLOR1>(pal, &dxt3_src->colors);
-
-		// Process the 16 color indexes and apply alpha.
-		uint32_t indexes = le32_to_cpu(dxt3_src->colors.indexes);
-		uint64_t alpha = le64_to_cpu(dxt3_src->alpha);
-		for (uint32_t &p : tileBuf) {
-			argb32_t color = pal[indexes & 3];
-			// TODO: Verify alpha value handling for DXT3.
-			color.a = (alpha & 0xF) | ((alpha & 0xF) << 4);
-			p = color.u32;
-
-			// Next indexes.
-			indexes >>= 2;
-			alpha >>= 4;
-		}
+	const int tilesX = physWidth / 4;
+	const int tilesY = physHeight / 4;
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
-	} }
+#pragma omp parallel for default(none) shared(img_buf, img) firstprivate(tilesX, tilesY) if(tilesX * tilesY >= ImageDecoderPrivate::OMP_MIN_TILES)
+	for (int y = 0; y < tilesY; y++) {
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
+
+		const dxt3_block *dxt3_src = reinterpret_cast<const dxt3_block*>(img_buf) + (y * tilesX);
+		for (int x = 0; x < tilesX; x++, dxt3_src++) {
+			// Decode the DXT3 tile palette.
+			argb32_t pal[4];
+			decode_DXTn_tile_color_palette_S3TC<DXTn_PALETTE_COLOR0_GT_COLOR1>(pal, &dxt3_src->colors);
+
+			// Process the 16 color indexes and apply alpha.
+			uint32_t indexes = le32_to_cpu(dxt3_src->colors.indexes);
+			uint64_t alpha = le64_to_cpu(dxt3_src->alpha);
+			for (uint32_t &p : tileBuf) {
+				argb32_t color = pal[indexes & 3];
+				// TODO: Verify alpha value handling for DXT3.
+				color.a = (alpha & 0xF) | ((alpha & 0xF) << 4);
+				p = color.u32;
+
+				// Next indexes.
+				indexes >>= 2;
+				alpha >>= 4;
+			}
+
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
+		}
+	}
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -567,40 +569,41 @@ rp_image_ptr fromDXT5(int width, int height,
 		dxt1_block colors;	// DXT1-style color block.
 	};
 	ASSERT_STRUCT(dxt5_block, 16);
-	const dxt5_block *dxt5_src = reinterpret_cast<const dxt5_block*>(img_buf);
-
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
-
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
-
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, dxt5_src++) {
-		// Decode the DXT5 tile palette.
-		argb32_t pal[4];
-		decode_DXTn_tile_color_palette_S3TC<0>(pal, &dxt5_src->colors);
-
-		// Get the DXT5 alpha codes.
-		uint64_t alpha48 = extract48(&dxt5_src->alpha);
-
-		// Process the 16 color and alpha indexes.
-		uint32_t indexes = le32_to_cpu(dxt5_src->colors.indexes);
-		for (uint32_t &p : tileBuf) {
-			argb32_t color = pal[indexes & 3];
-			// Decode the alpha channel value.
-			color.a = decode_DXT5_alpha_S3TC(alpha48 & 7, dxt5_src->alpha.values);
-			p = color.u32;
-
-			// Next indexes.
-			indexes >>= 2;
-			alpha48 >>= 3;
-		}
+	const int tilesX = physWidth / 4;
+	const int tilesY = physHeight / 4;
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
-	} }
+#pragma omp parallel for default(none) shared(img_buf, img) firstprivate(tilesX, tilesY) if(tilesX * tilesY >= ImageDecoderPrivate::OMP_MIN_TILES)
+	for (int y = 0; y < tilesY; y++) {
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
+
+		const dxt5_block *dxt5_src = reinterpret_cast<const dxt5_block*>(img_buf) + (y * tilesX);
+		for (int x = 0; x < tilesX; x++, dxt5_src++) {
+			// Decode the DXT5 tile palette.
+			argb32_t pal[4];
+			decode_DXTn_tile_color_palette_S3TC<0>(pal, &dxt5_src->colors);
+
+			// Get the DXT5 alpha codes.
+			uint64_t alpha48 = extract48(&dxt5_src->alpha);
+
+			// Process the 16 color and alpha indexes.
+			uint32_t indexes = le32_to_cpu(dxt5_src->colors.indexes);
+			for (uint32_t &p : tileBuf) {
+				argb32_t color = pal[indexes & 3];
+				// Decode the alpha channel value.
+				color.a = decode_DXT5_alpha_S3TC(alpha48 & 7, dxt5_src->alpha.values);
+				p = color.u32;
+
+				// Next indexes.
+				indexes >>= 2;
+				alpha48 >>= 3;
+			}
+
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
+		}
+	}
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -656,39 +659,40 @@ rp_image_ptr fromBC4(int width, int height,
 		dxt5_alpha red;
 	};
 	ASSERT_STRUCT(bc4_block, 8);
-	const bc4_block *bc4_src = reinterpret_cast<const bc4_block*>(img_buf);
-
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
-
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
+	const int tilesX = physWidth / 4;
+	const int tilesY = physHeight / 4;
 
 	// S3TC version.
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, bc4_src++) {
-		// BC4 colors are determined using DXT5-style alpha interpolation.
-
-		// Get the BC4 color codes.
-		uint64_t red48 = extract48(&bc4_src->red);
-
-		// Process the 16 color indexes.
-		// NOTE: Using red instead of grayscale here.
-		argb32_t color;
-		color.u32 = 0xFF000000U;	// opaque black
-		for (uint32_t &p : tileBuf) {
-			// Decode the red channel value.
-			color.r = decode_DXT5_alpha_S3TC(red48 & 7, bc4_src->red.values);
-			p = color.u32;
-
-			// Next index.
-			red48 >>= 3;
-		}
+#pragma omp parallel for default(none) shared(img_buf, img) firstprivate(tilesX, tilesY) if(tilesX * tilesY >= ImageDecoderPrivate::OMP_MIN_TILES)
+	for (int y = 0; y < tilesY; y++) {
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
-	} }
+		const bc4_block *bc4_src = reinterpret_cast<const bc4_block*>(img_buf) + (y * tilesX);
+		for (int x = 0; x < tilesX; x++, bc4_src++) {
+			// BC4 colors are determined using DXT5-style alpha interpolation.
+
+			// Get the BC4 color codes.
+			uint64_t red48 = extract48(&bc4_src->red);
+
+			// Process the 16 color indexes.
+			// NOTE: Using red instead of grayscale here.
+			argb32_t color;
+			color.u32 = 0xFF000000U;	// opaque black
+			for (uint32_t &p : tileBuf) {
+				// Decode the red channel value.
+				color.r = decode_DXT5_alpha_S3TC(red48 & 7, bc4_src->red.values);
+				p = color.u32;
+
+				// Next index.
+				red48 >>= 3;
+			}
+
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
+		}
+	}
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -747,41 +751,42 @@ rp_image_ptr fromBC5(int width, int height,
 		dxt5_alpha green;
 	};
 	ASSERT_STRUCT(bc5_block, 16);
-	const bc5_block *bc5_src = reinterpret_cast<const bc5_block*>(img_buf);
-
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
-
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
+	const int tilesX = width / 4;
+	const int tilesY = height / 4;
 
 	// S3TC version.
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, bc5_src++) {
-		// BC5 colors are determined using DXT5-style alpha interpolation.
-
-		// Get the BC5 color codes.
-		uint64_t red48   = extract48(&bc5_src->red);
-		uint64_t green48 = extract48(&bc5_src->green);
-
-		// Process the 16 color indexes.
-		argb32_t color;
-		color.u32 = 0xFF000000U;	// opaque black
-		for (uint32_t &p : tileBuf) {
-			// Decode the red and green channel values.
-			color.r = decode_DXT5_alpha_S3TC(red48   & 7, bc5_src->red.values);
-			color.g = decode_DXT5_alpha_S3TC(green48 & 7, bc5_src->green.values);
-			p = color.u32;
-
-			// Next indexes.
-			red48 >>= 3;
-			green48 >>= 3;
-		}
+#pragma omp parallel for default(none) shared(img_buf, img) firstprivate(tilesX, tilesY) if(tilesX * tilesY >= ImageDecoderPrivate::OMP_MIN_TILES)
+	for (int y = 0; y < tilesY; y++) {
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
-	} }
+		const bc5_block *bc5_src = reinterpret_cast<const bc5_block*>(img_buf) + (y * tilesX);
+		for (int x = 0; x < tilesX; x++, bc5_src++) {
+			// BC5 colors are determined using DXT5-style alpha interpolation.
+
+			// Get the BC5 color codes.
+			uint64_t red48   = extract48(&bc5_src->red);
+			uint64_t green48 = extract48(&bc5_src->green);
+
+			// Process the 16 color indexes.
+			argb32_t color;
+			color.u32 = 0xFF000000U;	// opaque black
+			for (uint32_t &p : tileBuf) {
+				// Decode the red and green channel values.
+				color.r = decode_DXT5_alpha_S3TC(red48   & 7, bc5_src->red.values);
+				color.g = decode_DXT5_alpha_S3TC(green48 & 7, bc5_src->green.values);
+				p = color.u32;
+
+				// Next indexes.
+				red48 >>= 3;
+				green48 >>= 3;
+			}
+
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img.get(), tileBuf, x, y);
+		}
+	}
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
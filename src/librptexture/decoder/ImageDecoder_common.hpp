@@ -26,6 +26,10 @@
 #  include "librpcpuid/cpuflags_x86.h"
 #  define IMAGEDECODER_HAS_SSE2 1
 #  define IMAGEDECODER_HAS_SSSE3 1
+#  if !defined(_MSC_VER) || _MSC_VER >= 1800
+// MSVC 2013+ is required for /arch:AVX2.
+#    define IMAGEDECODER_HAS_AVX2 1
+#  endif
 #endif
 #ifdef RP_CPU_AMD64
 #  define IMAGEDECODER_ALWAYS_HAS_SSE2 1
@@ -21,23 +21,31 @@ using namespace LibRpTexture;
 // IFUNC attribute doesn't support C++ name mangling.
 extern "C" {
 
-#ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
 /**
  * IFUNC resolver function for fromLinear16().
  * @return Function pointer.
  */
 __typeof__(&ImageDecoder::fromLinear16_cpp) fromLinear16_resolve(void)
 {
-#ifdef IMAGEDECODER_HAS_SSE2
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear16_avx2;
+	}
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	// amd64 always has SSE2.
+	return &ImageDecoder::fromLinear16_sse2;
+#else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#  ifdef IMAGEDECODER_HAS_SSE2
 	if (RP_CPU_HasSSE2()) {
 		return &ImageDecoder::fromLinear16_sse2;
 	} else
-#endif /* IMAGEDECODER_HAS_SSE2 */
+#  endif /* IMAGEDECODER_HAS_SSE2 */
 	{
 		return &ImageDecoder::fromLinear16_cpp;
 	}
-}
 #endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
 
 /**
  * IFUNC resolver function for fromLinear24().
@@ -45,6 +53,11 @@ __typeof__(&ImageDecoder::fromLinear16_cpp) fromLinear16_resolve(void)
  */
 __typeof__(&ImageDecoder::fromLinear24_cpp) fromLinear24_resolve(void)
 {
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear24_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
 #ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return &ImageDecoder::fromLinear24_ssse3;
@@ -61,6 +74,11 @@ __typeof__(&ImageDecoder::fromLinear24_cpp) fromLinear24_resolve(void)
  */
 __typeof__(&ImageDecoder::fromLinear32_cpp) fromLinear32_resolve(void)
 {
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear32_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
 #ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return &ImageDecoder::fromLinear32_ssse3;
@@ -73,12 +91,10 @@ __typeof__(&ImageDecoder::fromLinear32_cpp) fromLinear32_resolve(void)
 
 }
 
-#ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
 rp_image_ptr ImageDecoder::fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *img_buf, size_t img_siz, int stride)
 	IFUNC_ATTR(fromLinear16_resolve);
-#endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
 
 rp_image_ptr ImageDecoder::fromLinear24(PixelFormat px_format,
 	int width, int height,
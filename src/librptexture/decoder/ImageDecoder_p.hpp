@@ -20,6 +20,24 @@
 
 namespace LibRpTexture { namespace ImageDecoderPrivate {
 
+/**
+ * Minimum number of pixels for multi-threaded decoding.
+ * Tile-based decoders split the image into rows of tiles
+ * using OpenMP. For smaller images, the thread startup
+ * overhead is larger than the decoding time, so they're
+ * decoded on a single thread.
+ * (256x256 pixels)
+ */
+static constexpr int OMP_MIN_PIXELS = 256 * 256;
+
+/**
+ * Minimum number of 4x4 tiles for multi-threaded decoding.
+ * Used by decoders with a fixed 4x4 tile size.
+ * Decoders with variable tile sizes (ASTC) use OMP_MIN_PIXELS.
+ * (4096 4x4 tiles == 256x256 pixels)
+ */
+static constexpr int OMP_MIN_TILES = OMP_MIN_PIXELS / (4 * 4);
+
 /**
  * Blit a tile to an rp_image. (pixel*)
  * NOTE: No bounds checking is done.
@@ -38,6 +38,15 @@ using LibRpText::rp_sprintf;
 #include "decoder/ImageDecoder_PVRTC.hpp"
 #include "decoder/ImageDecoder_ASTC.hpp"
 
+// zstd (supercompression)
+#ifdef HAVE_ZSTD
+#  include <zstd.h>
+#  ifdef _MSC_VER
+// MSVC: Exception handling for /DELAYLOAD.
+#    include "libwin32common/DelayLoadHelper.h"
+#  endif /* _MSC_VER */
+#endif /* HAVE_ZSTD */
+
 // C++ STL classes
 using std::array;
 using std::string;
@@ -49,11 +58,16 @@ using std::vector;
 
 namespace LibRpTexture {
 
+#if defined(HAVE_ZSTD) && defined(_MSC_VER) && defined(ZSTD_IS_DLL)
+// DelayLoad test implementation.
+DELAYLOAD_TEST_FUNCTION_IMPL0(ZSTD_versionNumber);
+#endif /* HAVE_ZSTD && _MSC_VER && ZSTD_IS_DLL */
+
 class KhronosKTX2Private final : public FileFormatPrivate
 {
 	public:
 		KhronosKTX2Private(KhronosKTX2 *q, const IRpFilePtr &file);
-		~KhronosKTX2Private() final = default;
+		~KhronosKTX2Private() final;
 
 	private:
 		typedef FileFormatPrivate super;
@@ -98,6 +112,27 @@ class KhronosKTX2Private final : public FileFormatPrivate
 		// If byte 0 is a literal \0, no KTXswizzle tag was found.
 		char ktx_swizzle[4];
 
+#ifdef HAVE_ZSTD
+		// zstd decompression context and input buffer.
+		// Allocated on first use and reused for all mipmap levels.
+		ZSTD_DCtx *zstd_dctx;
+		rp::uvector<uint8_t> zstd_inbuf;
+
+		/**
+		 * Decompress a Zstandard-supercompressed mipmap level.
+		 * Only the first dest_len bytes of the level are decompressed;
+		 * any remaining faces, layers, and z slices are skipped.
+		 *
+		 * The file must already be positioned at mipinfo.byteOffset.
+		 *
+		 * @param mipinfo	[in] Mipmap level index
+		 * @param pDest		[out] Destination buffer
+		 * @param dest_len	[in] Number of bytes to decompress
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int decompressZstdLevel(const KTX2_Mipmap_Index &mipinfo, uint8_t *pDest, size_t dest_len);
+#endif /* HAVE_ZSTD */
+
 		/**
 		 * Load the image.
 		 * @param mip Mipmap number. (0 == full image)
@@ -140,7 +175,87 @@ KhronosKTX2Private::KhronosKTX2Private(KhronosKTX2 *q, const IRpFilePtr &file)
 	memset(&ktx2Header, 0, sizeof(ktx2Header));
 	memset(invalid_pixel_format, 0, sizeof(invalid_pixel_format));
 	memset(ktx_swizzle, 0, sizeof(ktx_swizzle));
+#ifdef HAVE_ZSTD
+	zstd_dctx = nullptr;
+#endif /* HAVE_ZSTD */
+}
+
+KhronosKTX2Private::~KhronosKTX2Private()
+{
+#ifdef HAVE_ZSTD
+	ZSTD_freeDCtx(zstd_dctx);
+#endif /* HAVE_ZSTD */
+}
+
+#ifdef HAVE_ZSTD
+/**
+ * Decompress a Zstandard-supercompressed mipmap level.
+ * Only the first dest_len bytes of the level are decompressed;
+ * any remaining faces, layers, and z slices are skipped.
+ *
+ * The file must already be positioned at mipinfo.byteOffset.
+ *
+ * @param mipinfo	[in] Mipmap level index
+ * @param pDest		[out] Destination buffer
+ * @param dest_len	[in] Number of bytes to decompress
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int KhronosKTX2Private::decompressZstdLevel(const KTX2_Mipmap_Index &mipinfo, uint8_t *pDest, size_t dest_len)
+{
+#if defined(_MSC_VER) && defined(ZSTD_IS_DLL)
+	// Delay load verification.
+	// TODO: Only if linked with /DELAYLOAD?
+	if (DelayLoad_test_ZSTD_versionNumber() != 0) {
+		// Delay load failed.
+		return -ENOTSUP;
+	}
+#endif /* _MSC_VER && ZSTD_IS_DLL */
+
+	if (!zstd_dctx) {
+		zstd_dctx = ZSTD_createDCtx();
+		if (!zstd_dctx) {
+			return -ENOMEM;
+		}
+		zstd_inbuf.resize(ZSTD_DStreamInSize());
+	} else {
+		// Each mipmap level is a separate zstd frame.
+		ZSTD_DCtx_reset(zstd_dctx, ZSTD_reset_session_only);
+	}
+
+	ZSTD_outBuffer output = {pDest, dest_len, 0};
+	uint64_t remain = mipinfo.byteLength;
+	while (output.pos < output.size) {
+		if (remain == 0) {
+			// Compressed data ended before we got enough output.
+			return -EIO;
+		}
+
+		const size_t to_read = (remain < zstd_inbuf.size())
+			? static_cast<size_t>(remain)
+			: zstd_inbuf.size();
+		const size_t size = file->read(zstd_inbuf.data(), to_read);
+		if (size != to_read) {
+			// Read error.
+			return -EIO;
+		}
+		remain -= size;
+
+		ZSTD_inBuffer input = {zstd_inbuf.data(), size, 0};
+		while (input.pos < input.size && output.pos < output.size) {
+			const size_t ret = ZSTD_decompressStream(zstd_dctx, &output, &input);
+			if (ZSTD_isError(ret)) {
+				// Decompression error.
+				return -EIO;
+			} else if (ret == 0 && output.pos < output.size) {
+				// End of frame, but the mipmap level is incomplete.
+				return -EIO;
+			}
+		}
+	}
+
+	return 0;
 }
+#endif /* HAVE_ZSTD */
 
 /**
  * Load the image.
@@ -176,9 +291,15 @@ rp_image_const_ptr KhronosKTX2Private::loadImage(int mip)
 		return nullptr;
 	}
 
-	// TODO: Support supercompression.
-	if (ktx2Header.supercompressionScheme != 0) {
-		return nullptr;
+	switch (ktx2Header.supercompressionScheme) {
+		case KTX2_SUPERZ_NONE:
+#ifdef HAVE_ZSTD
+		case KTX2_SUPERZ_ZSTD:
+#endif /* HAVE_ZSTD */
+			break;
+		default:
+			// TODO: Support BasisLZ and ZLIB supercompression.
+			return nullptr;
 	}
 
 	// TODO: For VK_FORMAT_UNDEFINED, parse the DFD.
@@ -369,25 +490,51 @@ rp_image_const_ptr KhronosKTX2Private::loadImage(int mip)
 			return nullptr;
 	}
 
-	// Verify mipmap size.
-	if (mipinfo.byteLength < expected_size) {
-		// Mipmap level is too small.
-		// TODO: Should we require the exact size?
-		return nullptr;
-	}
+	if (ktx2Header.supercompressionScheme == KTX2_SUPERZ_NONE) {
+		// Verify mipmap size.
+		if (mipinfo.byteLength < expected_size) {
+			// Mipmap level is too small.
+			// TODO: Should we require the exact size?
+			return nullptr;
+		}
 
-	// Verify file size.
-	if (mipinfo.byteOffset + expected_size > file_sz) {
-		// File is too small.
-		return nullptr;
+		// Verify file size.
+		if (mipinfo.byteOffset + expected_size > file_sz) {
+			// File is too small.
+			return nullptr;
+		}
+	} else {
+		// Supercompressed: byteLength is the compressed size,
+		// and uncompressedByteLength is the decompressed size.
+		if (mipinfo.uncompressedByteLength < expected_size) {
+			// Mipmap level is too small.
+			return nullptr;
+		}
+
+		// Verify file size.
+		if (mipinfo.byteLength == 0 || mipinfo.byteOffset + mipinfo.byteLength > file_sz) {
+			// File is too small.
+			return nullptr;
+		}
 	}
 
 	// Read the texture data.
 	auto buf = aligned_uptr<uint8_t>(16, expected_size);
-	size_t size = file->read(buf.get(), expected_size);
-	if (size != expected_size) {
-		// Read error.
-		return nullptr;
+#ifdef HAVE_ZSTD
+	if (ktx2Header.supercompressionScheme == KTX2_SUPERZ_ZSTD) {
+		// Decompress only the part of the level we need.
+		if (decompressZstdLevel(mipinfo, buf.get(), expected_size) != 0) {
+			// Decompression error.
+			return nullptr;
+		}
+	} else
+#endif /* HAVE_ZSTD */
+	{
+		size_t size = file->read(buf.get(), expected_size);
+		if (size != expected_size) {
+			// Read error.
+			return nullptr;
+		}
 	}
 
 	// TODO: Handle sRGB post-processing? (for e.g. GL_SRGB8)
@@ -25,6 +25,10 @@
 #  define RP_IMAGE_HAS_SSE2 1
 #  define RP_IMAGE_HAS_SSSE3 1
 #  define RP_IMAGE_HAS_SSE41 1
+#  if !defined(_MSC_VER) || _MSC_VER >= 1800
+// MSVC 2013+ is required for /arch:AVX2.
+#    define RP_IMAGE_HAS_AVX2 1
+#  endif
 #endif
 #ifdef RP_CPU_AMD64
 #  define RP_IMAGE_ALWAYS_HAS_SSE2 1
@@ -369,6 +373,94 @@ class rp_image
 			Alignment alignment = AlignDefault,
 			uint32_t bgColor = 0x00000000) const;
 
+		/** scaled() **/
+
+		/**
+		 * Filters for scaled().
+		 */
+		enum class ScaleFilter : uint8_t {
+			// Box filter. When downscaling, this averages all
+			// source pixels covered by each destination pixel.
+			// When upscaling, this is nearest-neighbor.
+			Box,
+
+			// Bilinear (triangle) filter.
+			// The filter is widened when downscaling, so all
+			// source pixels contribute to the destination.
+			Bilinear,
+
+			// Lanczos filter with a = 3.
+			Lanczos3,
+
+			Max
+		};
+
+		/**
+		 * Scale the rp_image.
+		 * Standard version using regular C++ code.
+		 *
+		 * A new ARGB32 rp_image will be created with the specified
+		 * dimensions. CI8 images will be converted to ARGB32.
+		 *
+		 * @param width New width
+		 * @param height New height
+		 * @param filter Scaling filter
+		 * @return New rp_image with a scaled version of the original, or nullptr on error.
+		 */
+		RP_LIBROMDATA_PUBLIC
+		std::shared_ptr<rp_image> scaled_cpp(int width, int height,
+			ScaleFilter filter = ScaleFilter::Bilinear) const;
+
+#ifdef RP_IMAGE_HAS_SSE2
+		/**
+		 * Scale the rp_image.
+		 * SSE2-optimized version.
+		 *
+		 * A new ARGB32 rp_image will be created with the specified
+		 * dimensions. CI8 images will be converted to ARGB32.
+		 *
+		 * @param width New width
+		 * @param height New height
+		 * @param filter Scaling filter
+		 * @return New rp_image with a scaled version of the original, or nullptr on error.
+		 */
+		RP_LIBROMDATA_PUBLIC
+		std::shared_ptr<rp_image> scaled_sse2(int width, int height,
+			ScaleFilter filter = ScaleFilter::Bilinear) const;
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Scale the rp_image.
+		 * AVX2-optimized version.
+		 *
+		 * A new ARGB32 rp_image will be created with the specified
+		 * dimensions. CI8 images will be converted to ARGB32.
+		 *
+		 * @param width New width
+		 * @param height New height
+		 * @param filter Scaling filter
+		 * @return New rp_image with a scaled version of the original, or nullptr on error.
+		 */
+		RP_LIBROMDATA_PUBLIC
+		std::shared_ptr<rp_image> scaled_avx2(int width, int height,
+			ScaleFilter filter = ScaleFilter::Bilinear) const;
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+		/**
+		 * Scale the rp_image.
+		 *
+		 * A new ARGB32 rp_image will be created with the specified
+		 * dimensions. CI8 images will be converted to ARGB32.
+		 *
+		 * @param width New width
+		 * @param height New height
+		 * @param filter Scaling filter
+		 * @return New rp_image with a scaled version of the original, or nullptr on error.
+		 */
+		inline std::shared_ptr<rp_image> scaled(int width, int height,
+			ScaleFilter filter = ScaleFilter::Bilinear) const;
+
 		/**
 		 * Un-premultiply this image.
 		 * Standard version using regular C++ code.
@@ -393,6 +485,19 @@ class rp_image
 		int un_premultiply_sse41(void);
 #endif /* RP_IMAGE_HAS_SSE41 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Un-premultiply this image.
+		 * AVX2-optimized version.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		RP_LIBROMDATA_PUBLIC
+		int un_premultiply_avx2(void);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 		/**
 		 * Un-premultiply this image.
 		 *
@@ -450,6 +555,22 @@ class rp_image
 		int apply_chroma_key_sse2(uint32_t key);
 #endif /* RP_IMAGE_HAS_SSE2 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Convert a chroma-keyed image to standard ARGB32.
+		 * AVX2-optimized version.
+		 *
+		 * This operates on the image itself, and does not return
+		 * a duplicated image with the adjusted image.
+		 *
+		 * NOTE: The image *must* be ARGB32.
+		 *
+		 * @param key Chroma key color.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int apply_chroma_key_avx2(uint32_t key);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 		/**
 		 * Convert a chroma-keyed image to standard ARGB32.
 		 *
@@ -512,6 +633,17 @@ class rp_image
 		int swizzle_ssse3(const char *swz_spec);
 #endif /* RP_IMAGE_HAS_SSSE3 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Swizzle the image channels.
+		 * AVX2-optimized version.
+		 *
+		 * @param swz_spec Swizzle specification: [rgba01]{4} [matches KTX2]
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int swizzle_avx2(const char *swz_spec);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 		/**
 		 * Swizzle the image channels.
 		 *
@@ -542,6 +674,40 @@ class rp_image
 typedef std::shared_ptr<rp_image> rp_image_ptr;
 typedef std::shared_ptr<const rp_image> rp_image_const_ptr;
 
+/**
+ * Scale the rp_image.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. CI8 images will be converted to ARGB32.
+ *
+ * @param width New width
+ * @param height New height
+ * @param filter Scaling filter
+ * @return New rp_image with a scaled version of the original, or nullptr on error.
+ */
+inline rp_image_ptr rp_image::scaled(int width, int height, ScaleFilter filter) const
+{
+	// FIXME: Figure out how to get IFUNC working with C++ member functions.
+#if defined(RP_IMAGE_HAS_AVX2)
+	if (RP_CPU_HasAVX2()) {
+		return scaled_avx2(width, height, filter);
+	}
+#endif /* RP_IMAGE_HAS_AVX2 */
+#if defined(RP_IMAGE_ALWAYS_HAS_SSE2)
+	// amd64 always has SSE2.
+	return scaled_sse2(width, height, filter);
+#else /* !RP_IMAGE_ALWAYS_HAS_SSE2 */
+#  if defined(RP_IMAGE_HAS_SSE2)
+	if (RP_CPU_HasSSE2()) {
+		return scaled_sse2(width, height, filter);
+	} else
+#  endif /* RP_IMAGE_HAS_SSE2 */
+	{
+		return scaled_cpp(width, height, filter);
+	}
+#endif /* RP_IMAGE_ALWAYS_HAS_SSE2 */
+}
+
 /**
  * Un-premultiply this image.
  *
@@ -552,11 +718,16 @@ typedef std::shared_ptr<const rp_image> rp_image_const_ptr;
 inline int rp_image::un_premultiply(void)
 {
 	// FIXME: Figure out how to get IFUNC working with C++ member functions.
+#ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return un_premultiply_avx2();
+	} else
+#endif /* RP_IMAGE_HAS_AVX2 */
 #ifdef RP_IMAGE_HAS_SSE41
 	if (RP_CPU_HasSSE41()) {
 		return un_premultiply_sse41();
 	} else
-#endif /* RP_IMAGE_HAS_SSE2 */
+#endif /* RP_IMAGE_HAS_SSE41 */
 	{
 		return un_premultiply_cpp();
 	}
@@ -576,6 +747,11 @@ inline int rp_image::un_premultiply(void)
 inline int rp_image::apply_chroma_key(uint32_t key)
 {
 	// FIXME: Figure out how to get IFUNC working with C++ member functions.
+#if defined(RP_IMAGE_HAS_AVX2)
+	if (RP_CPU_HasAVX2()) {
+		return apply_chroma_key_avx2(key);
+	}
+#endif /* RP_IMAGE_HAS_AVX2 */
 #if defined(RP_IMAGE_ALWAYS_HAS_SSE2)
 	// amd64 always has SSE2.
 	return apply_chroma_key_sse2(key);
@@ -600,6 +776,11 @@ inline int rp_image::apply_chroma_key(uint32_t key)
 inline int rp_image::swizzle(const char *swz_spec)
 {
 	// FIXME: Figure out how to get IFUNC working with C++ member functions.
+#if defined(RP_IMAGE_HAS_AVX2)
+	if (RP_CPU_HasAVX2()) {
+		return swizzle_avx2(swz_spec);
+	} else
+#endif /* RP_IMAGE_HAS_AVX2 */
 #if defined(RP_IMAGE_HAS_SSSE3)
 	if (RP_CPU_HasSSSE3()) {
 		return swizzle_ssse3(swz_spec);
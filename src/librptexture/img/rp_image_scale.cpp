@@ -0,0 +1,430 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale.cpp: Image class. (scaling)                              *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_scale.hpp"
+
+// C includes (C++ namespace)
+#include <cmath>
+
+// rp_image::scaled() isn't used by libromdata directly,
+// so use some linker hax to force linkage.
+extern "C" {
+	extern unsigned char RP_LibRpTexture_rp_image_scale_ForceLinkage;
+	unsigned char RP_LibRpTexture_rp_image_scale_ForceLinkage;
+}
+
+// C++ STL classes
+using std::unique_ptr;
+using std::vector;
+
+#ifndef M_PI
+#  define M_PI 3.14159265358979323846
+#endif
+
+namespace LibRpTexture { namespace RpImageScale {
+
+/** Filter functions **/
+
+static double filter_box(double x)
+{
+	return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+}
+
+static double filter_bilinear(double x)
+{
+	x = fabs(x);
+	return (x < 1.0) ? (1.0 - x) : 0.0;
+}
+
+static inline double sinc(double x)
+{
+	if (x == 0.0)
+		return 1.0;
+	x *= M_PI;
+	return sin(x) / x;
+}
+
+static double filter_lanczos3(double x)
+{
+	return (x > -3.0 && x < 3.0) ? (sinc(x) * sinc(x / 3.0)) : 0.0;
+}
+
+struct FilterDef {
+	double (*fn)(double x);
+	double support;
+};
+
+static const FilterDef filterDefs[] = {
+	{filter_box,		0.5},	// Box
+	{filter_bilinear,	1.0},	// Bilinear
+	{filter_lanczos3,	3.0},	// Lanczos3
+};
+static_assert(ARRAY_SIZE(filterDefs) == static_cast<size_t>(rp_image::ScaleFilter::Max),
+	"filterDefs[] is missing entries!");
+
+/**
+ * Calculate filter coefficients for one dimension.
+ * @param c		[out] Coefficients
+ * @param in_size	[in] Source size
+ * @param out_size	[in] Destination size
+ * @param filter	[in] Filter definition
+ */
+static void calc_coeffs(Coeffs &c, int in_size, int out_size, const FilterDef &filter)
+{
+	// When downscaling, the filter is widened so that
+	// every source pixel contributes to the destination.
+	const double scale = static_cast<double>(in_size) / static_cast<double>(out_size);
+	const double filterscale = (scale > 1.0) ? scale : 1.0;
+	const double support = filter.support * filterscale;
+
+	const int ksize = static_cast<int>(ceil(support)) * 2 + 1;
+	c.ksize = ksize;
+	c.max_taps = 0;
+	c.bounds.resize(out_size * 2);
+	c.weights.assign(static_cast<size_t>(out_size) * ksize, 0);
+
+	static constexpr int one = (1 << WEIGHT_SHIFT);
+	vector<double> k(ksize);
+	int *pBounds = c.bounds.data();
+	int16_t *pWeights = c.weights.data();
+	for (int xx = 0; xx < out_size; xx++, pBounds += 2, pWeights += ksize) {
+		const double center = (xx + 0.5) * scale;
+		int xmin = static_cast<int>(center - support + 0.5);
+		if (xmin < 0)
+			xmin = 0;
+		int xmax = static_cast<int>(center + support + 0.5);
+		if (xmax > in_size)
+			xmax = in_size;
+		int count = xmax - xmin;
+		if (count > ksize)
+			count = ksize;
+
+		double ww = 0.0;
+		for (int x = 0; x < count; x++) {
+			const double w = filter.fn((x + xmin - center + 0.5) / filterscale);
+			k[x] = w;
+			ww += w;
+		}
+
+		// Convert to fixed-point.
+		int sum = 0, largest = 0;
+		if (ww != 0.0) {
+			for (int x = 0; x < count; x++) {
+				pWeights[x] = static_cast<int16_t>(lrint(k[x] / ww * one));
+				sum += pWeights[x];
+				if (pWeights[x] > pWeights[largest]) {
+					largest = x;
+				}
+			}
+		}
+		if (sum == 0) {
+			// No usable weights. Use the nearest pixel.
+			int x = static_cast<int>(center);
+			if (x >= in_size)
+				x = in_size - 1;
+			xmin = x;
+			count = 1;
+			pWeights[0] = one;
+		} else {
+			// Make sure the weights add up to exactly 1.0 so
+			// solid colors aren't changed by rounding errors.
+			pWeights[largest] += static_cast<int16_t>(one - sum);
+
+			// Remove zero weights from both ends.
+			int first = 0;
+			while (first < count - 1 && pWeights[first] == 0) {
+				first++;
+			}
+			while (count > first + 1 && pWeights[count - 1] == 0) {
+				count--;
+			}
+			if (first > 0) {
+				memmove(pWeights, &pWeights[first], (count - first) * sizeof(*pWeights));
+				memset(&pWeights[count - first], 0, first * sizeof(*pWeights));
+				xmin += first;
+				count -= first;
+			}
+		}
+
+		pBounds[0] = xmin;
+		pBounds[1] = count;
+		if (count > c.max_taps) {
+			c.max_taps = count;
+		}
+	}
+}
+
+/**
+ * Clamp a fixed-point channel value to [0, 255].
+ * @param v Fixed-point value
+ * @return Clamped 8-bit value
+ */
+static inline uint32_t clamp_ch(int v)
+{
+	v >>= WEIGHT_SHIFT;
+	return (v < 0) ? 0 : ((v > 255) ? 255 : static_cast<uint32_t>(v));
+}
+
+/**
+ * Horizontal pass function.
+ * Standard version using regular C++ code.
+ *
+ * @param dest	[out] Destination row (cx.size() pixels)
+ * @param src	[in] Source row
+ * @param cx	[in] Horizontal filter coefficients
+ */
+void hpass_cpp(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src, const Coeffs &cx)
+{
+	static constexpr int rnd = (1 << (WEIGHT_SHIFT - 1));
+	const int *pBounds = cx.bounds.data();
+	const int16_t *pWeights = cx.weights.data();
+	for (int x = cx.size(); x > 0; x--, dest++, pBounds += 2, pWeights += cx.ksize) {
+		const uint32_t *p = &src[pBounds[0]];
+		int b = rnd, g = rnd, r = rnd, a = rnd;
+		for (int i = 0; i < pBounds[1]; i++) {
+			const uint32_t px = p[i];
+			const int w = pWeights[i];
+			b += static_cast<int>( px        & 0xFF) * w;
+			g += static_cast<int>((px >>  8) & 0xFF) * w;
+			r += static_cast<int>((px >> 16) & 0xFF) * w;
+			a += static_cast<int>( px >> 24        ) * w;
+		}
+		*dest = clamp_ch(b) | (clamp_ch(g) << 8) | (clamp_ch(r) << 16) | (clamp_ch(a) << 24);
+	}
+}
+
+/**
+ * Vertical pass function.
+ * Standard version using regular C++ code.
+ *
+ * @param dest		[out] Destination row
+ * @param src		[in] First source row
+ * @param src_stride	[in] Source stride, in pixels
+ * @param width		[in] Width, in pixels
+ * @param weights	[in] Filter weights (count weights)
+ * @param count		[in] Number of source rows
+ */
+void vpass_cpp(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src, ptrdiff_t src_stride,
+	int width, const int16_t *weights, int count)
+{
+	static constexpr int rnd = (1 << (WEIGHT_SHIFT - 1));
+	for (int x = 0; x < width; x++) {
+		const uint32_t *p = &src[x];
+		int b = rnd, g = rnd, r = rnd, a = rnd;
+		for (int i = 0; i < count; i++, p += src_stride) {
+			const uint32_t px = *p;
+			const int w = weights[i];
+			b += static_cast<int>( px        & 0xFF) * w;
+			g += static_cast<int>((px >>  8) & 0xFF) * w;
+			r += static_cast<int>((px >> 16) & 0xFF) * w;
+			a += static_cast<int>( px >> 24        ) * w;
+		}
+		dest[x] = clamp_ch(b) | (clamp_ch(g) << 8) | (clamp_ch(r) << 16) | (clamp_ch(a) << 24);
+	}
+}
+
+/**
+ * Premultiply an ARGB32 image for scaling.
+ *
+ * Unlike rp_image::premultiply(), fully-transparent pixels are
+ * set to 0 so their color values don't affect the scaled image.
+ *
+ * @param img ARGB32 image
+ */
+static void premultiply_for_scaling(rp_image *img)
+{
+	assert(img->format() == rp_image::Format::ARGB32);
+
+	const int width = img->width();
+	const int stride = img->stride();
+	uint8_t *bits = static_cast<uint8_t*>(img->bits());
+	for (int y = img->height(); y > 0; y--, bits += stride) {
+		uint32_t *px = reinterpret_cast<uint32_t*>(bits);
+		for (int x = width; x > 0; x--, px++) {
+			const uint32_t a = (*px >> 24);
+			if (likely(a == 255)) {
+				continue;
+			} else if (a == 0) {
+				*px = 0;
+			} else {
+				*px = rp_image::premultiply_pixel(*px);
+			}
+		}
+	}
+}
+
+/**
+ * Scale an rp_image using the specified pass functions.
+ * @param img		[in] Source image
+ * @param width		[in] New width
+ * @param height	[in] New height
+ * @param filter	[in] Scaling filter
+ * @param hpass		[in] Horizontal pass function
+ * @param vpass		[in] Vertical pass function
+ * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image_ptr scale(const rp_image *img, int width, int height, rp_image::ScaleFilter filter,
+	pfn_hpass_t hpass, pfn_vpass_t vpass)
+{
+	assert(width > 0);
+	assert(height > 0);
+	assert(filter >= rp_image::ScaleFilter::Box && filter < rp_image::ScaleFilter::Max);
+	if (width <= 0 || height <= 0 ||
+	    filter < rp_image::ScaleFilter::Box || filter >= rp_image::ScaleFilter::Max)
+	{
+		// Invalid parameters.
+		return nullptr;
+	}
+	if (!img->isValid()) {
+		// Cannot scale an invalid image.
+		return nullptr;
+	}
+
+	// Save the sBIT metadata, since img may be replaced with a temporary image.
+	rp_image::sBIT_t sBIT;
+	const bool has_sBIT = (img->get_sBIT(&sBIT) == 0);
+
+	const int src_width = img->width();
+	const int src_height = img->height();
+	const bool do_h = (width != src_width);
+	const bool do_v = (height != src_height);
+	if (!do_h && !do_v) {
+		// No scaling is necessary.
+		return img->dup_ARGB32();
+	}
+
+	const FilterDef &filterDef = filterDefs[static_cast<size_t>(filter)];
+	Coeffs cx, cy;
+	if (do_h) {
+		calc_coeffs(cx, src_width, width, filterDef);
+	}
+	if (do_v) {
+		calc_coeffs(cy, src_height, height, filterDef);
+	}
+
+	// If any destination pixel is a blend of multiple source pixels,
+	// the image must be premultiplied first. Otherwise, the colors of
+	// fully-transparent pixels will bleed into the visible pixels.
+	const bool blend = (do_h && cx.max_taps > 1) || (do_v && cy.max_taps > 1);
+
+	rp_image_ptr tmp_img;
+	if (img->format() != rp_image::Format::ARGB32 || blend) {
+		tmp_img = img->dup_ARGB32();
+		if (!tmp_img || !tmp_img->isValid()) {
+			// Could not convert the image.
+			return nullptr;
+		}
+		if (blend) {
+			premultiply_for_scaling(tmp_img.get());
+		}
+		img = tmp_img.get();
+	}
+
+	const uint8_t *const src_bits = static_cast<const uint8_t*>(img->bits());
+	const int src_stride = img->stride();
+
+	rp_image_ptr dest_img = std::make_shared<rp_image>(width, height, rp_image::Format::ARGB32);
+	if (!dest_img->isValid()) {
+		// Could not allocate the image.
+		return nullptr;
+	}
+	uint8_t *const dest_bits = static_cast<uint8_t*>(dest_img->bits());
+	const int dest_stride = dest_img->stride();
+
+	if (do_h && do_v) {
+		// Horizontal pass into a temporary buffer, then vertical pass.
+		// Only the source rows used by the vertical pass are processed.
+		const int first_row = cy.bounds[0];
+		const int last_row = cy.bounds[(height - 1) * 2] + cy.bounds[(height - 1) * 2 + 1];
+		const int rows = last_row - first_row;
+		unique_ptr<uint32_t[]> tmp_buf(new uint32_t[static_cast<size_t>(width) * rows]);
+
+		const uint8_t *src = src_bits + (first_row * src_stride);
+		uint32_t *tmp = tmp_buf.get();
+		for (int y = rows; y > 0; y--, src += src_stride, tmp += width) {
+			hpass(tmp, reinterpret_cast<const uint32_t*>(src), cx);
+		}
+
+		uint8_t *dest = dest_bits;
+		const int *pBounds = cy.bounds.data();
+		const int16_t *pWeights = cy.weights.data();
+		for (int y = height; y > 0; y--, dest += dest_stride, pBounds += 2, pWeights += cy.ksize) {
+			vpass(reinterpret_cast<uint32_t*>(dest),
+				&tmp_buf[static_cast<size_t>(pBounds[0] - first_row) * width],
+				width, width, pWeights, pBounds[1]);
+		}
+	} else if (do_h) {
+		// Horizontal pass only.
+		const uint8_t *src = src_bits;
+		uint8_t *dest = dest_bits;
+		for (int y = height; y > 0; y--, src += src_stride, dest += dest_stride) {
+			hpass(reinterpret_cast<uint32_t*>(dest), reinterpret_cast<const uint32_t*>(src), cx);
+		}
+	} else /*if (do_v)*/ {
+		// Vertical pass only.
+		uint8_t *dest = dest_bits;
+		const int *pBounds = cy.bounds.data();
+		const int16_t *pWeights = cy.weights.data();
+		for (int y = height; y > 0; y--, dest += dest_stride, pBounds += 2, pWeights += cy.ksize) {
+			vpass(reinterpret_cast<uint32_t*>(dest),
+				reinterpret_cast<const uint32_t*>(src_bits + (pBounds[0] * src_stride)),
+				src_stride / static_cast<int>(sizeof(uint32_t)), width, pWeights, pBounds[1]);
+		}
+	}
+
+	if (blend) {
+		// Filters with negative lobes can overshoot the alpha channel.
+		// Clamp the color channels to alpha before un-premultiplying.
+		uint8_t *dest = dest_bits;
+		for (int y = height; y > 0; y--, dest += dest_stride) {
+			argb32_t *px = reinterpret_cast<argb32_t*>(dest);
+			for (int x = width; x > 0; x--, px++) {
+				const uint8_t a = px->a;
+				if (a == 255)
+					continue;
+				if (px->r > a) px->r = a;
+				if (px->g > a) px->g = a;
+				if (px->b > a) px->b = a;
+			}
+		}
+		dest_img->un_premultiply();
+	}
+
+	// Copy sBIT if it's set.
+	if (has_sBIT) {
+		dest_img->set_sBIT(&sBIT);
+	}
+
+	return dest_img;
+}
+
+} }
+
+namespace LibRpTexture {
+
+/**
+ * Scale the rp_image.
+ * Standard version using regular C++ code.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. CI8 images will be converted to ARGB32.
+ *
+ * @param width New width
+ * @param height New height
+ * @param filter Scaling filter
+ * @return New rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image_ptr rp_image::scaled_cpp(int width, int height, ScaleFilter filter) const
+{
+	return RpImageScale::scale(this, width, height, filter,
+		RpImageScale::hpass_cpp, RpImageScale::vpass_cpp);
+}
+
+}
@@ -0,0 +1,102 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale.hpp: Image scaling functions. (internal)                 *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "rp_image.hpp"
+
+// C++ includes
+#include <vector>
+
+namespace LibRpTexture { namespace RpImageScale {
+
+// Filter weights are signed fixed-point values with this many fractional bits.
+// The weights for each destination pixel add up to (1 << WEIGHT_SHIFT).
+static constexpr int WEIGHT_SHIFT = 14;
+
+/**
+ * Filter coefficients for one dimension.
+ */
+struct Coeffs {
+	int ksize;			// Weights stride (maximum number of taps)
+	int max_taps;			// Largest number of taps actually used
+	std::vector<int> bounds;	// Index of the first tap and tap count for each destination pixel
+	std::vector<int16_t> weights;	// ksize weights for each destination pixel
+
+	/**
+	 * Get the number of destination pixels.
+	 * @return Number of destination pixels
+	 */
+	inline int size(void) const
+	{
+		return static_cast<int>(bounds.size() / 2);
+	}
+};
+
+/**
+ * Horizontal pass function.
+ * Scales a single row of ARGB32 pixels.
+ *
+ * @param dest	[out] Destination row (cx.size() pixels)
+ * @param src	[in] Source row
+ * @param cx	[in] Horizontal filter coefficients
+ */
+typedef void (*pfn_hpass_t)(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src, const Coeffs &cx);
+
+/**
+ * Vertical pass function.
+ * Combines count rows of ARGB32 pixels into a single row.
+ *
+ * @param dest		[out] Destination row
+ * @param src		[in] First source row
+ * @param src_stride	[in] Source stride, in pixels
+ * @param width		[in] Width, in pixels
+ * @param weights	[in] Filter weights (count weights)
+ * @param count		[in] Number of source rows
+ */
+typedef void (*pfn_vpass_t)(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src, ptrdiff_t src_stride,
+	int width, const int16_t *weights, int count);
+
+/**
+ * Horizontal pass function.
+ * Standard version using regular C++ code.
+ *
+ * @param dest	[out] Destination row (cx.size() pixels)
+ * @param src	[in] Source row
+ * @param cx	[in] Horizontal filter coefficients
+ */
+void hpass_cpp(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src, const Coeffs &cx);
+
+/**
+ * Vertical pass function.
+ * Standard version using regular C++ code.
+ *
+ * @param dest		[out] Destination row
+ * @param src		[in] First source row
+ * @param src_stride	[in] Source stride, in pixels
+ * @param width		[in] Width, in pixels
+ * @param weights	[in] Filter weights (count weights)
+ * @param count		[in] Number of source rows
+ */
+void vpass_cpp(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src, ptrdiff_t src_stride,
+	int width, const int16_t *weights, int count);
+
+/**
+ * Scale an rp_image using the specified pass functions.
+ * @param img		[in] Source image
+ * @param width		[in] New width
+ * @param height	[in] New height
+ * @param filter	[in] Scaling filter
+ * @param hpass		[in] Horizontal pass function
+ * @param vpass		[in] Vertical pass function
+ * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image_ptr scale(const rp_image *img, int width, int height, rp_image::ScaleFilter filter,
+	pfn_hpass_t hpass, pfn_vpass_t vpass);
+
+} }
@@ -0,0 +1,218 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale_avx2.cpp: Image class. (scaling)                         *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_scale.hpp"
+
+// AVX2 intrinsics
+#include <immintrin.h>
+
+// rp_image::scaled() isn't used by libromdata directly,
+// so use some linker hax to force linkage.
+extern "C" {
+	extern unsigned char RP_LibRpTexture_rp_image_scale_avx2_ForceLinkage;
+	unsigned char RP_LibRpTexture_rp_image_scale_avx2_ForceLinkage;
+}
+
+namespace LibRpTexture {
+
+using RpImageScale::Coeffs;
+using RpImageScale::WEIGHT_SHIFT;
+
+/**
+ * Get a pair of filter weights for _mm_madd_epi16().
+ * @param w Filter weights (two weights)
+ * @return Weights as a 32-bit value: low 16 bits = w[0], high 16 bits = w[1]
+ */
+static FORCEINLINE int weight_pair(const int16_t *w)
+{
+	return static_cast<int>(static_cast<uint16_t>(w[0]) | (static_cast<uint32_t>(static_cast<uint16_t>(w[1])) << 16));
+}
+
+/**
+ * Horizontal pass function.
+ * AVX2-optimized version.
+ *
+ * Processes 8 taps per iteration.
+ *
+ * @param dest	[out] Destination row (cx.size() pixels)
+ * @param src	[in] Source row
+ * @param cx	[in] Horizontal filter coefficients
+ */
+static void hpass_avx2(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src, const Coeffs &cx)
+{
+	const __m256i zero256 = _mm256_setzero_si256();
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rnd = _mm_set1_epi32(1 << (WEIGHT_SHIFT - 1));
+
+	const int *pBounds = cx.bounds.data();
+	const int16_t *pWeights = cx.weights.data();
+	for (int x = cx.size(); x > 0; x--, dest++, pBounds += 2, pWeights += cx.ksize) {
+		const uint32_t *p = &src[pBounds[0]];
+		const int16_t *w = pWeights;
+		int count = pBounds[1];
+		__m128i acc;
+
+		if (count >= 8) {
+			__m256i acc256 = zero256;
+			for (; count >= 8; count -= 8, p += 8, w += 8) {
+				// Interleave the pixels so each 16-bit pair has the
+				// same channel from two taps. (same as SSE2, per lane)
+				// Low lane: taps 0-3; high lane: taps 4-7
+				__m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+				px = _mm256_shuffle_epi32(px, _MM_SHUFFLE(3,1,2,0));
+				px = _mm256_unpacklo_epi8(px, _mm256_unpackhi_epi64(px, px));
+
+				const __m256i px_0145 = _mm256_unpacklo_epi8(px, zero256);
+				const __m256i px_2367 = _mm256_unpackhi_epi8(px, zero256);
+				const int w01 = weight_pair(&w[0]);
+				const int w23 = weight_pair(&w[2]);
+				const int w45 = weight_pair(&w[4]);
+				const int w67 = weight_pair(&w[6]);
+				acc256 = _mm256_add_epi32(acc256, _mm256_madd_epi16(px_0145,
+					_mm256_setr_epi32(w01, w01, w01, w01, w45, w45, w45, w45)));
+				acc256 = _mm256_add_epi32(acc256, _mm256_madd_epi16(px_2367,
+					_mm256_setr_epi32(w23, w23, w23, w23, w67, w67, w67, w67)));
+			}
+			acc = _mm_add_epi32(rnd, _mm_add_epi32(
+				_mm256_castsi256_si128(acc256), _mm256_extracti128_si256(acc256, 1)));
+		} else {
+			acc = rnd;
+		}
+
+		if (count >= 4) {
+			__m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			px = _mm_shuffle_epi32(px, _MM_SHUFFLE(3,1,2,0));
+			px = _mm_unpacklo_epi8(px, _mm_unpackhi_epi64(px, px));
+
+			const __m128i px01 = _mm_unpacklo_epi8(px, zero);
+			const __m128i px23 = _mm_unpackhi_epi8(px, zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px01, _mm_set1_epi32(weight_pair(&w[0]))));
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px23, _mm_set1_epi32(weight_pair(&w[2]))));
+			count -= 4;
+			p += 4;
+			w += 4;
+		}
+		if (count >= 2) {
+			__m128i px = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+			px = _mm_unpacklo_epi8(px, _mm_srli_si128(px, 4));
+			const __m128i px01 = _mm_unpacklo_epi8(px, zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px01, _mm_set1_epi32(weight_pair(w))));
+			count -= 2;
+			p += 2;
+			w += 2;
+		}
+		if (count > 0) {
+			__m128i px = _mm_cvtsi32_si128(static_cast<int>(*p));
+			px = _mm_unpacklo_epi8(px, zero);
+			px = _mm_unpacklo_epi16(px, zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(static_cast<uint16_t>(*w))));
+		}
+
+		acc = _mm_srai_epi32(acc, WEIGHT_SHIFT);
+		acc = _mm_packs_epi32(acc, acc);
+		acc = _mm_packus_epi16(acc, acc);
+		*dest = static_cast<uint32_t>(_mm_cvtsi128_si32(acc));
+	}
+}
+
+/**
+ * Vertical pass function.
+ * AVX2-optimized version.
+ *
+ * Processes 8 pixels per iteration.
+ *
+ * @param dest		[out] Destination row
+ * @param src		[in] First source row
+ * @param src_stride	[in] Source stride, in pixels
+ * @param width		[in] Width, in pixels
+ * @param weights	[in] Filter weights (count weights)
+ * @param count		[in] Number of source rows
+ */
+static void vpass_avx2(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src, ptrdiff_t src_stride,
+	int width, const int16_t *weights, int count)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i rnd = _mm256_set1_epi32(1 << (WEIGHT_SHIFT - 1));
+
+	// NOTE: All unpack and pack instructions operate within 128-bit lanes,
+	// so the pixel order is restored by the final pack.
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m256i acc0 = rnd, acc1 = rnd, acc2 = rnd, acc3 = rnd;
+		const uint32_t *p = &src[x];
+
+		int i = 0;
+		for (; i + 2 <= count; i += 2, p += (src_stride * 2)) {
+			const __m256i row0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			const __m256i row1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + src_stride));
+			const __m256i w = _mm256_set1_epi32(weight_pair(&weights[i]));
+
+			const __m256i px01 = _mm256_unpacklo_epi8(row0, row1);
+			const __m256i px23 = _mm256_unpackhi_epi8(row0, row1);
+			acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi8(px01, zero), w));
+			acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi8(px01, zero), w));
+			acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi8(px23, zero), w));
+			acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi8(px23, zero), w));
+		}
+		if (i < count) {
+			const __m256i row0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			const __m256i w = _mm256_set1_epi32(static_cast<uint16_t>(weights[i]));
+
+			const __m256i px01 = _mm256_unpacklo_epi8(row0, zero);
+			const __m256i px23 = _mm256_unpackhi_epi8(row0, zero);
+			acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi16(px01, zero), w));
+			acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi16(px01, zero), w));
+			acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi16(px23, zero), w));
+			acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi16(px23, zero), w));
+		}
+
+		acc0 = _mm256_packs_epi32(_mm256_srai_epi32(acc0, WEIGHT_SHIFT), _mm256_srai_epi32(acc1, WEIGHT_SHIFT));
+		acc2 = _mm256_packs_epi32(_mm256_srai_epi32(acc2, WEIGHT_SHIFT), _mm256_srai_epi32(acc3, WEIGHT_SHIFT));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&dest[x]), _mm256_packus_epi16(acc0, acc2));
+	}
+
+	// Remaining pixels.
+	const __m128i zero128 = _mm_setzero_si128();
+	for (; x < width; x++) {
+		__m128i acc = _mm256_castsi256_si128(rnd);
+		const uint32_t *p = &src[x];
+		for (int i = 0; i < count; i++, p += src_stride) {
+			__m128i px = _mm_cvtsi32_si128(static_cast<int>(*p));
+			px = _mm_unpacklo_epi8(px, zero128);
+			px = _mm_unpacklo_epi16(px, zero128);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(static_cast<uint16_t>(weights[i]))));
+		}
+
+		acc = _mm_srai_epi32(acc, WEIGHT_SHIFT);
+		acc = _mm_packs_epi32(acc, acc);
+		acc = _mm_packus_epi16(acc, acc);
+		dest[x] = static_cast<uint32_t>(_mm_cvtsi128_si32(acc));
+	}
+}
+
+/**
+ * Scale the rp_image.
+ * AVX2-optimized version.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. CI8 images will be converted to ARGB32.
+ *
+ * @param width New width
+ * @param height New height
+ * @param filter Scaling filter
+ * @return New rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image_ptr rp_image::scaled_avx2(int width, int height, ScaleFilter filter) const
+{
+	return RpImageScale::scale(this, width, height, filter, hpass_avx2, vpass_avx2);
+}
+
+}
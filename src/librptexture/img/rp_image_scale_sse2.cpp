@@ -0,0 +1,189 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale_sse2.cpp: Image class. (scaling)                         *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_scale.hpp"
+
+// SSE2 intrinsics
+#include <emmintrin.h>
+
+// rp_image::scaled() isn't used by libromdata directly,
+// so use some linker hax to force linkage.
+extern "C" {
+	extern unsigned char RP_LibRpTexture_rp_image_scale_sse2_ForceLinkage;
+	unsigned char RP_LibRpTexture_rp_image_scale_sse2_ForceLinkage;
+}
+
+namespace LibRpTexture {
+
+using RpImageScale::Coeffs;
+using RpImageScale::WEIGHT_SHIFT;
+
+/**
+ * Get a pair of filter weights for _mm_madd_epi16().
+ * @param w Filter weights (two weights)
+ * @return Weights as a 32-bit value: low 16 bits = w[0], high 16 bits = w[1]
+ */
+static FORCEINLINE int weight_pair(const int16_t *w)
+{
+	return static_cast<int>(static_cast<uint16_t>(w[0]) | (static_cast<uint32_t>(static_cast<uint16_t>(w[1])) << 16));
+}
+
+/**
+ * Horizontal pass function.
+ * SSE2-optimized version.
+ *
+ * Each channel is multiplied by its weight using pmaddwd,
+ * which handles two taps at a time.
+ *
+ * @param dest	[out] Destination row (cx.size() pixels)
+ * @param src	[in] Source row
+ * @param cx	[in] Horizontal filter coefficients
+ */
+static void hpass_sse2(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src, const Coeffs &cx)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rnd = _mm_set1_epi32(1 << (WEIGHT_SHIFT - 1));
+
+	const int *pBounds = cx.bounds.data();
+	const int16_t *pWeights = cx.weights.data();
+	for (int x = cx.size(); x > 0; x--, dest++, pBounds += 2, pWeights += cx.ksize) {
+		const uint32_t *p = &src[pBounds[0]];
+		const int16_t *w = pWeights;
+		int count = pBounds[1];
+		__m128i acc = rnd;
+
+		for (; count >= 4; count -= 4, p += 4, w += 4) {
+			// Interleave the pixels so each 16-bit pair
+			// has the same channel from two taps.
+			__m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			px = _mm_shuffle_epi32(px, _MM_SHUFFLE(3,1,2,0));
+			px = _mm_unpacklo_epi8(px, _mm_unpackhi_epi64(px, px));
+
+			const __m128i px01 = _mm_unpacklo_epi8(px, zero);
+			const __m128i px23 = _mm_unpackhi_epi8(px, zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px01, _mm_set1_epi32(weight_pair(&w[0]))));
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px23, _mm_set1_epi32(weight_pair(&w[2]))));
+		}
+		if (count >= 2) {
+			__m128i px = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+			px = _mm_unpacklo_epi8(px, _mm_srli_si128(px, 4));
+			const __m128i px01 = _mm_unpacklo_epi8(px, zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px01, _mm_set1_epi32(weight_pair(w))));
+			count -= 2;
+			p += 2;
+			w += 2;
+		}
+		if (count > 0) {
+			__m128i px = _mm_cvtsi32_si128(static_cast<int>(*p));
+			px = _mm_unpacklo_epi8(px, zero);
+			px = _mm_unpacklo_epi16(px, zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(static_cast<uint16_t>(*w))));
+		}
+
+		acc = _mm_srai_epi32(acc, WEIGHT_SHIFT);
+		acc = _mm_packs_epi32(acc, acc);
+		acc = _mm_packus_epi16(acc, acc);
+		*dest = static_cast<uint32_t>(_mm_cvtsi128_si32(acc));
+	}
+}
+
+/**
+ * Vertical pass function.
+ * SSE2-optimized version.
+ *
+ * Processes 4 pixels per iteration.
+ *
+ * @param dest		[out] Destination row
+ * @param src		[in] First source row
+ * @param src_stride	[in] Source stride, in pixels
+ * @param width		[in] Width, in pixels
+ * @param weights	[in] Filter weights (count weights)
+ * @param count		[in] Number of source rows
+ */
+static void vpass_sse2(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src, ptrdiff_t src_stride,
+	int width, const int16_t *weights, int count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rnd = _mm_set1_epi32(1 << (WEIGHT_SHIFT - 1));
+
+	int x = 0;
+	for (; x + 4 <= width; x += 4) {
+		__m128i acc0 = rnd, acc1 = rnd, acc2 = rnd, acc3 = rnd;
+		const uint32_t *p = &src[x];
+
+		int i = 0;
+		for (; i + 2 <= count; i += 2, p += (src_stride * 2)) {
+			const __m128i row0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const __m128i row1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + src_stride));
+			const __m128i w = _mm_set1_epi32(weight_pair(&weights[i]));
+
+			// Interleave the two rows so each 16-bit pair
+			// has the same channel from two taps.
+			const __m128i px01 = _mm_unpacklo_epi8(row0, row1);
+			const __m128i px23 = _mm_unpackhi_epi8(row0, row1);
+			acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(px01, zero), w));
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(px01, zero), w));
+			acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(px23, zero), w));
+			acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(px23, zero), w));
+		}
+		if (i < count) {
+			const __m128i row0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const __m128i w = _mm_set1_epi32(static_cast<uint16_t>(weights[i]));
+
+			const __m128i px01 = _mm_unpacklo_epi8(row0, zero);
+			const __m128i px23 = _mm_unpackhi_epi8(row0, zero);
+			acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(px01, zero), w));
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(px01, zero), w));
+			acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(px23, zero), w));
+			acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(px23, zero), w));
+		}
+
+		acc0 = _mm_packs_epi32(_mm_srai_epi32(acc0, WEIGHT_SHIFT), _mm_srai_epi32(acc1, WEIGHT_SHIFT));
+		acc2 = _mm_packs_epi32(_mm_srai_epi32(acc2, WEIGHT_SHIFT), _mm_srai_epi32(acc3, WEIGHT_SHIFT));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dest[x]), _mm_packus_epi16(acc0, acc2));
+	}
+
+	// Remaining pixels.
+	for (; x < width; x++) {
+		__m128i acc = rnd;
+		const uint32_t *p = &src[x];
+		for (int i = 0; i < count; i++, p += src_stride) {
+			__m128i px = _mm_cvtsi32_si128(static_cast<int>(*p));
+			px = _mm_unpacklo_epi8(px, zero);
+			px = _mm_unpacklo_epi16(px, zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(static_cast<uint16_t>(weights[i]))));
+		}
+
+		acc = _mm_srai_epi32(acc, WEIGHT_SHIFT);
+		acc = _mm_packs_epi32(acc, acc);
+		acc = _mm_packus_epi16(acc, acc);
+		dest[x] = static_cast<uint32_t>(_mm_cvtsi128_si32(acc));
+	}
+}
+
+/**
+ * Scale the rp_image.
+ * SSE2-optimized version.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. CI8 images will be converted to ARGB32.
+ *
+ * @param width New width
+ * @param height New height
+ * @param filter Scaling filter
+ * @return New rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image_ptr rp_image::scaled_sse2(int width, int height, ScaleFilter filter) const
+{
+	return RpImageScale::scale(this, width, height, filter, hpass_sse2, vpass_sse2);
+}
+
+}
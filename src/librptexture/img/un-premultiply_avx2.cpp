@@ -0,0 +1,115 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * un-premultiply_avx2.cpp: Un-premultiply function.                       *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2017-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_p.hpp"
+#include "rp_image_backend.hpp"
+
+// AVX2 intrinsics
+#include <immintrin.h>
+
+// Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
+#define rp_imagePrivate rp_image_private
+
+namespace LibRpTexture {
+
+/**
+ * Un-premultiply an argb32_t pixel. (Standard version)
+ * Used for the remaining pixels in each row.
+ *
+ * @param px	[in/out] argb32_t pixel to un-premultiply, in place.
+ */
+static FORCEINLINE void un_premultiply_pixel(argb32_t &px)
+{
+	const unsigned int alpha = px.a;
+	if (alpha == 255 || alpha == 0)
+		return;
+
+	const unsigned int invAlpha = rp_image::qt_inv_premul_factor[alpha];
+	px.r = (px.r * invAlpha + 0x8000) >> 16;
+	px.g = (px.g * invAlpha + 0x8000) >> 16;
+	px.b = (px.b * invAlpha + 0x8000) >> 16;
+}
+
+/**
+ * Un-premultiply an ARGB32 rp_image.
+ * AVX2-optimized version.
+ *
+ * Processes 8 pixels per iteration, using vpgatherdd to look up
+ * the inverted pre-multiplication factors.
+ *
+ * Image must be ARGB32.
+ *
+ * @return 0 on success; non-zero on error.
+ */
+int rp_image::un_premultiply_avx2(void)
+{
+	RP_D(const rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == rp_image::Format::ARGB32);
+	if (backend->format != rp_image::Format::ARGB32) {
+		// Incorrect format...
+		return -1;
+	}
+
+	const int *const inv_premul = reinterpret_cast<const int*>(qt_inv_premul_factor.data());
+	const __m256i mask_FF = _mm256_set1_epi32(0xFF);
+	const __m256i rnd_8000 = _mm256_set1_epi32(0x8000);
+	const __m256i zero = _mm256_setzero_si256();
+
+	const int width = backend->width;
+	argb32_t *px_dest = static_cast<argb32_t*>(backend->data());
+	const int dest_stride_adj = (backend->stride / sizeof(*px_dest)) - width;
+	for (int y = backend->height; y > 0; y--, px_dest += dest_stride_adj) {
+		int x = width;
+		for (; x > 7; x -= 8, px_dest += 8) {
+			__m256i *const ymm_px = reinterpret_cast<__m256i*>(px_dest);
+			const __m256i px = _mm256_loadu_si256(ymm_px);
+			const __m256i alpha = _mm256_srli_epi32(px, 24);
+
+			// Pixels with alpha == 0 or alpha == 255 are left as-is.
+			const __m256i keep = _mm256_or_si256(
+				_mm256_cmpeq_epi32(alpha, zero),
+				_mm256_cmpeq_epi32(alpha, mask_FF));
+			if (_mm256_movemask_epi8(keep) == -1) {
+				// All 8 pixels are either opaque or fully transparent.
+				continue;
+			}
+
+			// (p*(0x00ff00ff/alpha)) >> 16 == (p*255)/alpha for all p and alpha <= 256.
+			// We add 0x8000 to get even rounding.
+			const __m256i invAlpha = _mm256_i32gather_epi32(inv_premul, alpha, 4);
+			__m256i b = _mm256_and_si256(px, mask_FF);
+			__m256i g = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask_FF);
+			__m256i r = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask_FF);
+			b = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(b, invAlpha), rnd_8000), 16);
+			g = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(g, invAlpha), rnd_8000), 16);
+			r = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(r, invAlpha), rnd_8000), 16);
+
+			// Recombine the channels.
+			// NOTE: Each channel is truncated to 8 bits, same as the C++ version.
+			__m256i res = _mm256_slli_epi32(alpha, 24);
+			res = _mm256_or_si256(res, _mm256_slli_epi32(_mm256_and_si256(r, mask_FF), 16));
+			res = _mm256_or_si256(res, _mm256_slli_epi32(_mm256_and_si256(g, mask_FF), 8));
+			res = _mm256_or_si256(res, _mm256_and_si256(b, mask_FF));
+
+			// Restore the pixels that shouldn't be modified.
+			_mm256_storeu_si256(ymm_px, _mm256_blendv_epi8(res, px, keep));
+		}
+
+		// Remaining pixels.
+		for (; x > 0; x--, px_dest++) {
+			un_premultiply_pixel(*px_dest);
+		}
+	}
+	return 0;
+}
+
+}
@@ -1,6 +1,6 @@
 /***************************************************************************
  * ROM Properties Page shell extension. (librptexture/tests)               *
- * ImageDecoderLinearTest.cpp: Linear image decoding tests with SSSE3.     *
+ * ImageDecoderLinearTest.cpp: Linear image decoding tests with SIMD.      *
  *                                                                         *
  * Copyright (c) 2016-2024 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
@@ -676,8 +676,108 @@ TEST_P(ImageDecoderLinearTest, fromLinear_ssse3_benchmark)
 }
 #endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Test the ImageDecoder::fromLinear*() functions. (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderLinearTest, fromLinear_avx2_test)
+{
+	if (!RP_CPU_HasAVX2() && !GTEST_FLAG_GET(brief)) {
+		fputs("*** AVX2 is not supported on this CPU. Skipping test.\n", stderr);
+		return;
+	}
+
+	// Parameterized test.
+	const ImageDecoderLinearTest_mode &mode = GetParam();
+
+	// Decode the image.
+	switch (mode.bpp) {
+		case 24:
+			// 24-bit image.
+			m_img = ImageDecoder::fromLinear24_avx2(mode.src_pxf, 128, 128,
+				m_img_buf, m_img_buf_len, mode.stride);
+			break;
+
+		case 32:
+			// 32-bit image.
+			m_img = ImageDecoder::fromLinear32_avx2(mode.src_pxf, 128, 128,
+				reinterpret_cast<const uint32_t*>(m_img_buf),
+				m_img_buf_len, mode.stride);
+			break;
+
+		case 15:
+		case 16:
+			// 15/16-bit image.
+			m_img = ImageDecoder::fromLinear16_avx2(mode.src_pxf, 128, 128,
+				reinterpret_cast<const uint16_t*>(m_img_buf),
+				m_img_buf_len, mode.stride);
+			break;
+
+		default:
+			ASSERT_TRUE(false) << "Invalid bpp: " << mode.bpp;
+			return;
+	}
+
+	ASSERT_TRUE((bool)m_img);
+
+	// Validate the image.
+	ASSERT_NO_FATAL_FAILURE(Validate_RpImage(m_img.get(), mode.dest_pixel));
+}
+
+/**
+ * Benchmark the ImageDecoder::fromLinear*() functions. (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderLinearTest, fromLinear_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2() && !GTEST_FLAG_GET(brief)) {
+		fputs("*** AVX2 is not supported on this CPU. Skipping test.\n", stderr);
+		return;
+	}
+
+	// Parameterized test.
+	const ImageDecoderLinearTest_mode &mode = GetParam();
+
+	// Decode the image.
+	switch (mode.bpp) {
+		case 24:
+			// 24-bit image.
+			for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+				m_img = ImageDecoder::fromLinear24_avx2(mode.src_pxf, 128, 128,
+					m_img_buf, m_img_buf_len, mode.stride);
+				m_img.reset();
+			}
+			break;
+
+		case 32:
+			// 32-bit image.
+			for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+				m_img = ImageDecoder::fromLinear32_avx2(mode.src_pxf, 128, 128,
+					reinterpret_cast<const uint32_t*>(m_img_buf),
+					m_img_buf_len, mode.stride);
+				m_img.reset();
+			}
+			break;
+
+		case 15:
+		case 16:
+			// 15/16-bit image.
+			for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+				m_img = ImageDecoder::fromLinear16_avx2(mode.src_pxf, 128, 128,
+					reinterpret_cast<const uint16_t*>(m_img_buf),
+					m_img_buf_len, mode.stride);
+				m_img.reset();
+			}
+			break;
+
+		default:
+			ASSERT_TRUE(false) << "Invalid bpp: " << mode.bpp;
+			return;
+	}
+}
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(IMAGEDECODER_HAS_SSE2) || defined(IMAGEDECODER_HAS_SSSE3)
+#if defined(IMAGEDECODER_HAS_SSE2) || defined(IMAGEDECODER_HAS_SSSE3) || defined(IMAGEDECODER_HAS_AVX2)
 /**
  * Test the ImageDecoder::fromLinear*() dispatch functions.
  */
@@ -765,7 +865,7 @@ TEST_P(ImageDecoderLinearTest, fromLinear_dispatch_benchmark)
 			return;
 	}
 }
-#endif /* IMAGEDECODER_HAS_SSE2 || IMAGEDECODER_HAS_SSSE3 */
+#endif /* IMAGEDECODER_HAS_SSE2 || IMAGEDECODER_HAS_SSSE3 || IMAGEDECODER_HAS_AVX2 */
 
 // Test cases.
 
@@ -0,0 +1,332 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageScaleTest.cpp: Test rp_image::scaled().                            *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+#ifdef _WIN32
+// rp_image backend registration.
+#  include "librptexture/img/RpGdiplusBackend.hpp"
+#endif /* _WIN32 */
+using namespace LibRpTexture;
+
+// C includes
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes (C++ namespace)
+#include <cstring>
+
+// C++ includes
+#include <memory>
+#include <string>
+using std::string;
+
+namespace LibRpTexture { namespace Tests {
+
+class ImageScaleTest : public ::testing::Test
+{
+	protected:
+		ImageScaleTest()
+			: m_img(std::make_shared<rp_image>(1024, 1024, rp_image::Format::ARGB32))
+		{
+#ifdef _WIN32
+			// Register RpGdiplusBackend.
+			// TODO: Static initializer somewhere?
+			rp_image::setBackendCreatorFn(RpGdiplusBackend::creator_fn);
+#endif /* _WIN32 */
+
+			// Initialize the image with a gradient pattern
+			// that has a mix of alpha values.
+			const int stride = m_img->stride();
+			for (int y = 0; y < m_img->height(); y++) {
+				argb32_t *px = reinterpret_cast<argb32_t*>(static_cast<uint8_t*>(m_img->bits()) + (y * stride));
+				for (int x = 0; x < m_img->width(); x++, px++) {
+					px->a = ((x / 64) & 1) ? 255 : static_cast<uint8_t>((x * 3 + y) & 0xFF);
+					px->r = static_cast<uint8_t>(x ^ y);
+					px->g = static_cast<uint8_t>((x * 5) >> 2);
+					px->b = static_cast<uint8_t>(y);
+				}
+			}
+		}
+
+		/**
+		 * Fill an image with a solid color.
+		 * @param img rp_image
+		 * @param color ARGB32 color
+		 */
+		static void fillImage(const rp_image_ptr &img, uint32_t color)
+		{
+			const int stride = img->stride();
+			for (int y = 0; y < img->height(); y++) {
+				uint32_t *px = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(img->bits()) + (y * stride));
+				for (int x = img->width(); x > 0; x--, px++) {
+					*px = color;
+				}
+			}
+		}
+
+		/**
+		 * Compare two images.
+		 * @param expected Expected image
+		 * @param actual Actual image
+		 */
+		static void compareImages(const rp_image_const_ptr &expected, const rp_image_const_ptr &actual)
+		{
+			ASSERT_TRUE((bool)expected);
+			ASSERT_TRUE((bool)actual);
+			ASSERT_EQ(expected->width(), actual->width());
+			ASSERT_EQ(expected->height(), actual->height());
+			ASSERT_EQ(expected->format(), actual->format());
+			for (int y = 0; y < expected->height(); y++) {
+				ASSERT_EQ(0, memcmp(expected->scanLine(y), actual->scanLine(y), expected->row_bytes()))
+					<< "Scanline " << y << " does not match.";
+			}
+		}
+
+	public:
+		// Number of iterations for benchmarks
+		static constexpr unsigned int BENCHMARK_ITERATIONS = 100U;
+
+		// Image
+		rp_image_ptr m_img;
+
+		// Destination sizes for comparison tests
+		struct ScaleSize {
+			int width;
+			int height;
+		};
+		static const ScaleSize scaleSizes[];
+
+		// Filters for comparison tests
+		static const rp_image::ScaleFilter filters[];
+};
+
+const ImageScaleTest::ScaleSize ImageScaleTest::scaleSizes[] = {
+	{256, 256},	// 1024x1024 -> 256x256
+	{1168, 1024},	// SNES 8:7 pixel aspect ratio
+	{97, 301},	// Odd sizes
+	{1024, 33},	// Vertical only
+	{3, 1024},	// Horizontal only
+	{2052, 1030},	// Upscale
+};
+
+const rp_image::ScaleFilter ImageScaleTest::filters[] = {
+	rp_image::ScaleFilter::Box,
+	rp_image::ScaleFilter::Bilinear,
+	rp_image::ScaleFilter::Lanczos3,
+};
+
+/**
+ * Solid colors must not be changed by any filter.
+ */
+TEST_F(ImageScaleTest, scaled_cpp_solidColorTest)
+{
+	rp_image_ptr img = std::make_shared<rp_image>(100, 60, rp_image::Format::ARGB32);
+	ASSERT_TRUE(img->isValid());
+	fillImage(img, 0xFF3366CC);
+
+	for (const rp_image::ScaleFilter filter : filters) {
+		for (const ScaleSize &sz : {ScaleSize{64, 64}, ScaleSize{37, 11}, ScaleSize{256, 150}}) {
+			const rp_image_const_ptr scaled = img->scaled_cpp(sz.width, sz.height, filter);
+			ASSERT_TRUE((bool)scaled);
+			ASSERT_EQ(sz.width, scaled->width());
+			ASSERT_EQ(sz.height, scaled->height());
+			ASSERT_EQ(rp_image::Format::ARGB32, scaled->format());
+			for (int y = 0; y < scaled->height(); y++) {
+				const uint32_t *px = static_cast<const uint32_t*>(scaled->scanLine(y));
+				for (int x = 0; x < scaled->width(); x++) {
+					ASSERT_EQ(0xFF3366CCU, px[x]) << "Pixel (" << x << "," << y << ") does not match; filter == " << static_cast<int>(filter);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Box filter: Integer upscaling is nearest-neighbor.
+ */
+TEST_F(ImageScaleTest, scaled_cpp_boxUpscaleTest)
+{
+	rp_image_ptr img = std::make_shared<rp_image>(2, 2, rp_image::Format::ARGB32);
+	ASSERT_TRUE(img->isValid());
+	static const uint32_t src_px[2][2] = {
+		{0xFF102030, 0x80405060},
+		{0x00000000, 0x12345678},
+	};
+	for (int y = 0; y < 2; y++) {
+		memcpy(static_cast<uint8_t*>(img->bits()) + (y * img->stride()), src_px[y], sizeof(src_px[y]));
+	}
+
+	const rp_image_const_ptr scaled = img->scaled_cpp(6, 4, rp_image::ScaleFilter::Box);
+	ASSERT_TRUE((bool)scaled);
+	for (int y = 0; y < 4; y++) {
+		const uint32_t *px = static_cast<const uint32_t*>(scaled->scanLine(y));
+		for (int x = 0; x < 6; x++) {
+			EXPECT_EQ(src_px[y / 2][x / 3], px[x]) << "Pixel (" << x << "," << y << ") does not match.";
+		}
+	}
+}
+
+/**
+ * Box filter: Downscaling averages the source pixels,
+ * weighted by alpha.
+ */
+TEST_F(ImageScaleTest, scaled_cpp_boxDownscaleTest)
+{
+	rp_image_ptr img = std::make_shared<rp_image>(2, 2, rp_image::Format::ARGB32);
+	ASSERT_TRUE(img->isValid());
+	static const uint32_t src_px[2][2] = {
+		{0xFF000000, 0xFF404040},
+		{0xFF808080, 0xFFC0C0C0},
+	};
+	for (int y = 0; y < 2; y++) {
+		memcpy(static_cast<uint8_t*>(img->bits()) + (y * img->stride()), src_px[y], sizeof(src_px[y]));
+	}
+
+	rp_image_const_ptr scaled = img->scaled_cpp(1, 1, rp_image::ScaleFilter::Box);
+	ASSERT_TRUE((bool)scaled);
+	EXPECT_EQ(0xFF606060U, *static_cast<const uint32_t*>(scaled->scanLine(0)));
+
+	// Fully-transparent pixels must not affect the color.
+	static const uint32_t src_px_alpha[2][2] = {
+		{0xFF804020, 0x00FFFFFF},
+		{0x00FFFFFF, 0xFF804020},
+	};
+	for (int y = 0; y < 2; y++) {
+		memcpy(static_cast<uint8_t*>(img->bits()) + (y * img->stride()), src_px_alpha[y], sizeof(src_px_alpha[y]));
+	}
+	scaled = img->scaled_cpp(1, 1, rp_image::ScaleFilter::Box);
+	ASSERT_TRUE((bool)scaled);
+	const argb32_t px = *static_cast<const argb32_t*>(scaled->scanLine(0));
+	EXPECT_EQ(0x80, px.a);
+	EXPECT_NEAR(0x80, px.r, 1);
+	EXPECT_NEAR(0x40, px.g, 1);
+	EXPECT_NEAR(0x20, px.b, 1);
+}
+
+/**
+ * Benchmark the rp_image::scaled() function. (Standard version)
+ */
+TEST_F(ImageScaleTest, scaled_cpp_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->scaled_cpp(256, 256, rp_image::ScaleFilter::Lanczos3);
+	}
+}
+
+#ifdef RP_IMAGE_HAS_SSE2
+/**
+ * Test the rp_image::scaled() function. (SSE2-optimized version)
+ * The results must be identical to the standard version.
+ */
+TEST_F(ImageScaleTest, scaled_sse2_test)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fputs("*** SSE2 is not supported on this CPU. Skipping test.\n", stderr);
+		return;
+	}
+
+	for (const rp_image::ScaleFilter filter : filters) {
+		for (const ScaleSize &sz : scaleSizes) {
+			SCOPED_TRACE(string("filter ") + std::to_string(static_cast<int>(filter)) +
+				", size " + std::to_string(sz.width) + 'x' + std::to_string(sz.height));
+			compareImages(m_img->scaled_cpp(sz.width, sz.height, filter),
+				m_img->scaled_sse2(sz.width, sz.height, filter));
+		}
+	}
+}
+
+/**
+ * Benchmark the rp_image::scaled() function. (SSE2-optimized version)
+ */
+TEST_F(ImageScaleTest, scaled_sse2_benchmark)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fputs("*** SSE2 is not supported on this CPU. Skipping test.\n", stderr);
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->scaled_sse2(256, 256, rp_image::ScaleFilter::Lanczos3);
+	}
+}
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Test the rp_image::scaled() function. (AVX2-optimized version)
+ * The results must be identical to the standard version.
+ */
+TEST_F(ImageScaleTest, scaled_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fputs("*** AVX2 is not supported on this CPU. Skipping test.\n", stderr);
+		return;
+	}
+
+	for (const rp_image::ScaleFilter filter : filters) {
+		for (const ScaleSize &sz : scaleSizes) {
+			SCOPED_TRACE(string("filter ") + std::to_string(static_cast<int>(filter)) +
+				", size " + std::to_string(sz.width) + 'x' + std::to_string(sz.height));
+			compareImages(m_img->scaled_cpp(sz.width, sz.height, filter),
+				m_img->scaled_avx2(sz.width, sz.height, filter));
+		}
+	}
+}
+
+/**
+ * Benchmark the rp_image::scaled() function. (AVX2-optimized version)
+ */
+TEST_F(ImageScaleTest, scaled_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fputs("*** AVX2 is not supported on this CPU. Skipping test.\n", stderr);
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->scaled_avx2(256, 256, rp_image::ScaleFilter::Lanczos3);
+	}
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+// NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
+#if defined(RP_IMAGE_HAS_SSE2) || defined(RP_IMAGE_HAS_AVX2)
+/**
+ * Benchmark the rp_image::scaled() dispatch function.
+ */
+TEST_F(ImageScaleTest, scaled_dispatch_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->scaled(256, 256, rp_image::ScaleFilter::Lanczos3);
+	}
+}
+#endif /* RP_IMAGE_HAS_SSE2 || RP_IMAGE_HAS_AVX2 */
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fputs("LibRpTexture test suite: rp_image::scaled() tests.\n\n", stderr);
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::ImageScaleTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
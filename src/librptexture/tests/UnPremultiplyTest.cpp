@@ -61,7 +61,8 @@ class UnPremultiplyTest : public ::testing::Test
 };
 
 // TODO: Add actual tests to verify that un-premultiply works.
-// Currently we only have benchmark tests.
+// Currently we only have benchmark tests, plus tests that verify
+// the optimized versions match the standard version.
 
 /**
  * Benchmark the ImageDecoder::un_premultiply() function. (Standard version)
@@ -90,8 +91,66 @@ TEST_F(UnPremultiplyTest, un_premultiply_sse41_benchmark)
 }
 #endif /* RP_IMAGE_HAS_SSE41 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Test the ImageDecoder::un_premultiply() function. (AVX2-optimized version)
+ * The results must be identical to the standard version.
+ */
+TEST_F(UnPremultiplyTest, un_premultiply_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fputs("*** AVX2 is not supported on this CPU. Skipping test.\n", stderr);
+		return;
+	}
+
+	// Fill the image with every possible alpha value, using
+	// color values that are valid for premultiplied alpha.
+	// NOTE: Using an odd width to test the remaining pixels loop.
+	rp_image_ptr img_cpp = std::make_shared<rp_image>(509, 256, rp_image::Format::ARGB32);
+	ASSERT_TRUE(img_cpp->isValid());
+	const int stride = img_cpp->stride();
+	for (int y = 0; y < img_cpp->height(); y++) {
+		argb32_t *px = reinterpret_cast<argb32_t*>(static_cast<uint8_t*>(img_cpp->bits()) + (y * stride));
+		for (int x = 0; x < img_cpp->width(); x++, px++) {
+			const unsigned int a = static_cast<unsigned int>(x + y) & 0xFF;
+			px->a = a;
+			px->r = (a * 7) / 8;
+			px->g = (x * a) / 509;
+			px->b = (y * a) / 256;
+		}
+	}
+	rp_image_ptr img_avx2 = img_cpp->dup();
+	ASSERT_TRUE((bool)img_avx2);
+
+	ASSERT_EQ(0, img_cpp->un_premultiply_cpp());
+	ASSERT_EQ(0, img_avx2->un_premultiply_avx2());
+
+	const rp_image *const c_img_cpp = img_cpp.get();
+	const rp_image *const c_img_avx2 = img_avx2.get();
+	for (int y = 0; y < img_cpp->height(); y++) {
+		ASSERT_EQ(0, memcmp(c_img_cpp->scanLine(y), c_img_avx2->scanLine(y), img_cpp->row_bytes()))
+			<< "Scanline " << y << " does not match.";
+	}
+}
+
+/**
+ * Benchmark the ImageDecoder::un_premultiply() function. (AVX2-optimized version)
+ */
+TEST_F(UnPremultiplyTest, un_premultiply_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fputs("*** AVX2 is not supported on this CPU. Skipping test.\n", stderr);
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->un_premultiply_avx2();
+	}
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(RP_IMAGE_HAS_SSE41)
+#if defined(RP_IMAGE_HAS_SSE41) || defined(RP_IMAGE_HAS_AVX2)
 /**
  * Benchmark the ImageDecoder::un_premultiply() dispatch function.
  */
@@ -101,7 +160,7 @@ TEST_F(UnPremultiplyTest, un_premultiply_dispatch_benchmark)
 		m_img->un_premultiply();
 	}
 }
-#endif /* RP_IMAGE_HAS_SSE41 */
+#endif /* RP_IMAGE_HAS_SSE41 || RP_IMAGE_HAS_AVX2 */
 
 /**
  * Benchmark the ImageDecoder::premultiply() function. (Standard version)
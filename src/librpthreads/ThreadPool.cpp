@@ -0,0 +1,216 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadPool.cpp: Simple thread pool with a FIFO work queue.              *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "config.librpthreads.h"
+#include "ThreadPool.hpp"
+
+#ifdef _WIN32
+#  include <process.h>
+#else /* !_WIN32 */
+#  include <unistd.h>
+#endif /* _WIN32 */
+
+namespace LibRpThreads {
+
+/**
+ * Create a thread pool.
+ * @param threadCount Number of worker threads (0 for idealThreadCount())
+ */
+ThreadPool::ThreadPool(unsigned int threadCount)
+	: m_sem(0)
+	, m_doneSem(0)
+	, m_pending(0)
+	, m_waiters(0)
+{
+	if (threadCount == 0) {
+		threadCount = idealThreadCount();
+	}
+
+	m_threads.reserve(threadCount);
+	for (unsigned int i = 0; i < threadCount; i++) {
+#ifdef _WIN32
+		HANDLE hThread = reinterpret_cast<HANDLE>(
+			_beginthreadex(nullptr, 0, workerThread, this, 0, nullptr));
+		if (!hThread) {
+			// Unable to create the thread.
+			// Use the threads that have been created so far.
+			break;
+		}
+		m_threads.push_back(hThread);
+#else /* !_WIN32 */
+		pthread_t thread;
+		if (pthread_create(&thread, nullptr, workerThread, this) != 0) {
+			// Unable to create the thread.
+			// Use the threads that have been created so far.
+			break;
+		}
+		m_threads.push_back(thread);
+#endif /* _WIN32 */
+	}
+	assert(!m_threads.empty());
+}
+
+/**
+ * Delete the thread pool.
+ * All queued work items will be run before the worker threads exit.
+ */
+ThreadPool::~ThreadPool()
+{
+	// Queue one "stop" item for each worker thread.
+	// Since the queue is FIFO, all previously-queued
+	// work items will be run first.
+	const size_t count = m_threads.size();
+	m_mutex.lock();
+	for (size_t i = 0; i < count; i++) {
+		m_queue.push_back({nullptr, nullptr});
+	}
+	m_mutex.unlock();
+	for (size_t i = 0; i < count; i++) {
+		m_sem.release();
+	}
+
+	// Wait for the worker threads to exit.
+#ifdef _WIN32
+	for (HANDLE hThread : m_threads) {
+		WaitForSingleObject(hThread, INFINITE);
+		CloseHandle(hThread);
+	}
+#else /* !_WIN32 */
+	for (pthread_t thread : m_threads) {
+		pthread_join(thread, nullptr);
+	}
+#endif /* _WIN32 */
+}
+
+/**
+ * Add a work item to the queue.
+ * Work items are started in FIFO order.
+ *
+ * NOTE: There's no per-item completion notification here.
+ * If the caller needs to wait for a specific work item to finish,
+ * the work item should release a Semaphore. To wait for all
+ * work items to finish, use waitForDone().
+ *
+ * @param fn Work item function
+ * @param param User-specified parameter
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ThreadPool::enqueue(WorkFn fn, void *param)
+{
+	assert(fn != nullptr);
+	if (!fn) {
+		return -EINVAL;
+	} else if (m_threads.empty()) {
+		// No worker threads...
+		return -ECHILD;
+	}
+
+	m_mutex.lock();
+	m_queue.push_back({fn, param});
+	m_pending++;
+	m_mutex.unlock();
+	m_sem.release();
+	return 0;
+}
+
+/**
+ * Wait for all queued work items to finish.
+ *
+ * This returns once the work queue is empty and no work items
+ * are running. Work items that are enqueued while waiting will
+ * also be waited for.
+ *
+ * NOTE: This must not be called from a work item.
+ */
+void ThreadPool::waitForDone(void)
+{
+	m_mutex.lock();
+	if (m_pending == 0) {
+		// Nothing to wait for.
+		m_mutex.unlock();
+		return;
+	}
+	m_waiters++;
+	m_mutex.unlock();
+
+	// The last work item to finish will release the semaphore.
+	m_doneSem.obtain();
+}
+
+/**
+ * Get the ideal number of worker threads for this system.
+ * @return Number of online CPUs (minimum 1)
+ */
+unsigned int ThreadPool::idealThreadCount(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	const unsigned int count = si.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	const long ret = sysconf(_SC_NPROCESSORS_ONLN);
+	const unsigned int count = (ret > 0) ? static_cast<unsigned int>(ret) : 1;
+#else
+	// TODO: Other systems.
+	const unsigned int count = 1;
+#endif
+
+	return (count > 0) ? count : 1;
+}
+
+/**
+ * Worker thread function.
+ * @param param ThreadPool
+ */
+#ifdef _WIN32
+unsigned int __stdcall ThreadPool::workerThread(void *param)
+#else /* !_WIN32 */
+void *ThreadPool::workerThread(void *param)
+#endif /* _WIN32 */
+{
+	ThreadPool *const pool = static_cast<ThreadPool*>(param);
+
+	while (true) {
+		// Wait for a work item.
+		pool->m_sem.obtain();
+
+		pool->m_mutex.lock();
+		assert(!pool->m_queue.empty());
+		const WorkItem item = pool->m_queue.front();
+		pool->m_queue.pop_front();
+		pool->m_mutex.unlock();
+
+		if (!item.fn) {
+			// Stop the worker thread.
+			break;
+		}
+		item.fn(item.param);
+
+		// If this was the last pending work item, wake up
+		// any threads that are waiting in waitForDone().
+		pool->m_mutex.lock();
+		assert(pool->m_pending > 0);
+		unsigned int waiters = 0;
+		if (--pool->m_pending == 0) {
+			waiters = pool->m_waiters;
+			pool->m_waiters = 0;
+		}
+		pool->m_mutex.unlock();
+		for (; waiters > 0; waiters--) {
+			pool->m_doneSem.release();
+		}
+	}
+
+#ifdef _WIN32
+	return 0;
+#else /* !_WIN32 */
+	return nullptr;
+#endif /* _WIN32 */
+}
+
+}
@@ -0,0 +1,129 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadPool.hpp: Simple thread pool with a FIFO work queue.              *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "Mutex.hpp"
+#include "Semaphore.hpp"
+
+// C++ includes
+#include <deque>
+#include <vector>
+
+namespace LibRpThreads {
+
+class ThreadPool
+{
+	public:
+		/**
+		 * Create a thread pool.
+		 * @param threadCount Number of worker threads (0 for idealThreadCount())
+		 */
+		explicit ThreadPool(unsigned int threadCount = 0);
+
+		/**
+		 * Delete the thread pool.
+		 * All queued work items will be run before the worker threads exit.
+		 */
+		~ThreadPool();
+
+		// Disable copy/assignment constructors.
+#if __cplusplus >= 201103L
+	public:
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+#else /* __cplusplus < 201103L */
+	private:
+		ThreadPool(const ThreadPool &);
+		ThreadPool &operator=(const ThreadPool &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Work item function.
+		 * @param param User-specified parameter
+		 */
+		typedef void (*WorkFn)(void *param);
+
+		/**
+		 * Add a work item to the queue.
+		 * Work items are started in FIFO order.
+		 *
+		 * NOTE: There's no per-item completion notification here.
+		 * If the caller needs to wait for a specific work item to finish,
+		 * the work item should release a Semaphore. To wait for all
+		 * work items to finish, use waitForDone().
+		 *
+		 * @param fn Work item function
+		 * @param param User-specified parameter
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int enqueue(WorkFn fn, void *param);
+
+		/**
+		 * Wait for all queued work items to finish.
+		 *
+		 * This returns once the work queue is empty and no work items
+		 * are running. Work items that are enqueued while waiting will
+		 * also be waited for.
+		 *
+		 * NOTE: This must not be called from a work item.
+		 */
+		void waitForDone(void);
+
+		/**
+		 * Get the number of worker threads.
+		 * @return Number of worker threads (0 if thread creation failed)
+		 */
+		inline unsigned int threadCount(void) const
+		{
+			return static_cast<unsigned int>(m_threads.size());
+		}
+
+		/**
+		 * Get the ideal number of worker threads for this system.
+		 * @return Number of online CPUs (minimum 1)
+		 */
+		static unsigned int idealThreadCount(void);
+
+	private:
+		/**
+		 * Worker thread function.
+		 * @param param ThreadPool
+		 */
+#ifdef _WIN32
+		static unsigned int __stdcall workerThread(void *param);
+#else /* !_WIN32 */
+		static void *workerThread(void *param);
+#endif /* _WIN32 */
+
+	private:
+		struct WorkItem {
+			WorkFn fn;	// nullptr == stop the worker thread
+			void *param;
+		};
+
+		Mutex m_mutex;		// Protects m_queue, m_pending, and m_waiters.
+		Semaphore m_sem;	// Number of queued work items.
+		std::deque<WorkItem> m_queue;
+
+		// waitForDone() support
+		Semaphore m_doneSem;	// Released once per waiter when m_pending reaches 0.
+		unsigned int m_pending;	// Number of queued and running work items.
+		unsigned int m_waiters;	// Number of threads in waitForDone().
+
+		// Worker threads
+		// NOTE: The system threading headers are included by Mutex.hpp.
+#ifdef _WIN32
+		std::vector<HANDLE> m_threads;
+#else /* !_WIN32 */
+		std::vector<pthread_t> m_threads;
+#endif /* _WIN32 */
+};
+
+}
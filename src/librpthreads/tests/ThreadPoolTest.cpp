@@ -0,0 +1,149 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads/tests)               *
+ * ThreadPoolTest.cpp: ThreadPool test.                                    *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpthreads
+#include "librpthreads/Atomics.h"
+#include "librpthreads/ThreadPool.hpp"
+
+// C includes (C++ namespace)
+#include <cstdio>
+
+// C++ includes
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRpThreads { namespace Tests {
+
+class ThreadPoolTest : public ::testing::Test
+{
+	protected:
+		ThreadPoolTest()
+			: ::testing::Test()
+		{}
+
+	protected:
+		// Number of work items for each test
+		static constexpr unsigned int ITEM_COUNT = 64;
+
+		/**
+		 * Work item parameters.
+		 */
+		struct work_param_t {
+			volatile int *pCounter;		// Shared counter
+			int delay_ms;			// Delay before incrementing the counter
+			bool done;			// Set when the work item finishes
+		};
+
+		/**
+		 * Work item: Wait for delay_ms, then increment the counter.
+		 * @param param work_param_t
+		 */
+		static void incrementCounter(void *param);
+};
+
+/**
+ * Work item: Wait for delay_ms, then increment the counter.
+ * @param param work_param_t
+ */
+void ThreadPoolTest::incrementCounter(void *param)
+{
+	work_param_t *const p = static_cast<work_param_t*>(param);
+	if (p->delay_ms > 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(p->delay_ms));
+	}
+	p->done = true;
+	ATOMIC_INC_FETCH(p->pCounter);
+}
+
+/**
+ * waitForDone() on an idle thread pool must return immediately.
+ */
+TEST_F(ThreadPoolTest, waitForDoneIdle)
+{
+	ThreadPool pool(2);
+	pool.waitForDone();
+	pool.waitForDone();
+}
+
+/**
+ * All submitted work items must have finished once waitForDone() returns.
+ */
+TEST_F(ThreadPoolTest, waitForDone)
+{
+	ThreadPool pool(4);
+	ASSERT_EQ(4U, pool.threadCount());
+
+	volatile int counter = 0;
+	vector<work_param_t> params(ITEM_COUNT);
+	for (unsigned int i = 0; i < ITEM_COUNT; i++) {
+		params[i] = {&counter, static_cast<int>(i % 4), false};
+		ASSERT_EQ(0, pool.enqueue(incrementCounter, &params[i]));
+	}
+
+	pool.waitForDone();
+	EXPECT_EQ(static_cast<int>(ITEM_COUNT), counter);
+	for (unsigned int i = 0; i < ITEM_COUNT; i++) {
+		EXPECT_TRUE(params[i].done) << "work item " << i;
+	}
+
+	// The thread pool can be reused after waitForDone().
+	for (unsigned int i = 0; i < ITEM_COUNT; i++) {
+		params[i].done = false;
+		ASSERT_EQ(0, pool.enqueue(incrementCounter, &params[i]));
+	}
+	pool.waitForDone();
+	EXPECT_EQ(static_cast<int>(ITEM_COUNT * 2), counter);
+}
+
+/**
+ * Destroying the thread pool must run all work items that are still queued.
+ */
+TEST_F(ThreadPoolTest, destroyWithQueuedItems)
+{
+	volatile int counter = 0;
+	vector<work_param_t> params(ITEM_COUNT);
+
+	unique_ptr<ThreadPool> pool(new ThreadPool(1));
+	ASSERT_EQ(1U, pool->threadCount());
+
+	// The first work item is slow, so the rest of them
+	// are still queued when the thread pool is destroyed.
+	params[0] = {&counter, 50, false};
+	ASSERT_EQ(0, pool->enqueue(incrementCounter, &params[0]));
+	for (unsigned int i = 1; i < ITEM_COUNT; i++) {
+		params[i] = {&counter, 0, false};
+		ASSERT_EQ(0, pool->enqueue(incrementCounter, &params[i]));
+	}
+	EXPECT_LT(counter, static_cast<int>(ITEM_COUNT));
+
+	pool.reset();
+	EXPECT_EQ(static_cast<int>(ITEM_COUNT), counter);
+	for (unsigned int i = 0; i < ITEM_COUNT; i++) {
+		EXPECT_TRUE(params[i].done) << "work item " << i;
+	}
+}
+
+} }
+
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fputs("LibRpThreads test suite: ThreadPool tests.\n\n", stderr);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
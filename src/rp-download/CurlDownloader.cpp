@@ -12,23 +12,30 @@
 // C++ STL classes.
 using std::string;
 
-// cURL for network access.
-#include <curl/curl.h>
-
 namespace RpDownload {
 
 CurlDownloader::CurlDownloader()
 	: super()
+	, m_curl(nullptr)
 {}
 
 CurlDownloader::CurlDownloader(const TCHAR *url)
 	: super(url)
+	, m_curl(nullptr)
 {}
 
 CurlDownloader::CurlDownloader(const tstring &url)
 	: super(url)
+	, m_curl(nullptr)
 {}
 
+CurlDownloader::~CurlDownloader()
+{
+	if (m_curl) {
+		curl_easy_cleanup(m_curl);
+	}
+}
+
 /**
  * Internal cURL data write function.
  * @param ptr Data to write.
@@ -151,10 +158,15 @@ size_t CurlDownloader::parse_header(char *ptr, size_t size, size_t nitems, void
 }
 
 /**
- * Download the file.
- * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+ * Prepare the cURL easy handle for the current URL.
+ *
+ * The easy handle is kept alive between downloads, so the caller
+ * should add it to a cURL multi handle in order to reuse connections.
+ * Call finish() once the multi handle reports the transfer as done.
+ *
+ * @return cURL easy handle, or nullptr on error.
  */
-int CurlDownloader::download(void)
+CURL *CurlDownloader::prepare(void)
 {
 	// References:
 	// - http://stackoverflow.com/questions/1636333/download-file-using-libcurl-in-c-c
@@ -166,10 +178,17 @@ int CurlDownloader::download(void)
 	m_mtime = -1;
 
 	// Initialize cURL.
-	CURL *curl = curl_easy_init();
-	if (!curl) {
-		// Could not initialize cURL.
-		return -ENOMEM;	// TODO: Better error?
+	// NOTE: curl_easy_reset() keeps live connections and the DNS cache.
+	CURL *curl = m_curl;
+	if (curl) {
+		curl_easy_reset(curl);
+	} else {
+		curl = curl_easy_init();
+		if (!curl) {
+			// Could not initialize cURL.
+			return nullptr;
+		}
+		m_curl = curl;
 	}
 
 	// Proxy settings should be set by the calling application
@@ -219,15 +238,25 @@ int CurlDownloader::download(void)
 	// Set the User-Agent.
 	curl_easy_setopt(curl, CURLOPT_USERAGENT, m_userAgent.c_str());
 
-	// Download the file.
+	return curl;
+}
+
+/**
+ * Finish a download that was started with prepare().
+ * @param res cURL result code
+ * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+ */
+int CurlDownloader::finish(CURLcode res)
+{
+	assert(m_curl != nullptr);
+
 	int ret;
-	CURLcode res = curl_easy_perform(curl);
 	switch (res) {
 		case CURLE_OK:
 			// If the file is empty, check for a 304.
 			if (m_data.empty() && m_if_modified_since >= 0) {
 				long unmet = 0;
-				if (!curl_easy_getinfo(curl, CURLINFO_CONDITION_UNMET, &unmet) && unmet) {
+				if (!curl_easy_getinfo(m_curl, CURLINFO_CONDITION_UNMET, &unmet) && unmet) {
 					// HTTP 304 Not Modified
 					ret = 304;
 					break;
@@ -243,12 +272,12 @@ int CurlDownloader::download(void)
 			ret = -ETIMEDOUT;
 			break;
 
-		default:
+		default: {
 			// Some other error downloading the file.
 			// Check if we have an HTTP response code.
 			// NOTE: GameTDB sometimes returns nothing instead of 404...
 			long response_code = 0;
-			curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+			curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &response_code);
 			if (response_code <= 0) {
 				// No HTTP response code.
 				// TODO: Return a cURL error code and/or message...
@@ -256,9 +285,9 @@ int CurlDownloader::download(void)
 			}
 			ret = (int)response_code;
 			break;
+		}
 	}
 
-	curl_easy_cleanup(curl);
 	if (ret != 0) {
 		return ret;
 	}
@@ -273,4 +302,20 @@ int CurlDownloader::download(void)
 	return 0;
 }
 
+/**
+ * Download the file.
+ * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+ */
+int CurlDownloader::download(void)
+{
+	CURL *const curl = prepare();
+	if (!curl) {
+		// Could not initialize cURL.
+		return -ENOMEM;	// TODO: Better error?
+	}
+
+	// Download the file.
+	return finish(curl_easy_perform(curl));
+}
+
 } //namespace RpDownload
@@ -10,6 +10,9 @@
 
 #include "IDownloader.hpp"
 
+// cURL for network access.
+#include <curl/curl.h>
+
 namespace RpDownload {
 
 class CurlDownloader final : public IDownloader
@@ -18,6 +21,7 @@ public:
 	CurlDownloader();
 	explicit CurlDownloader(const TCHAR *url);
 	explicit CurlDownloader(const std::tstring &url);
+	~CurlDownloader() final;
 
 private:
 	typedef IDownloader super;
@@ -50,6 +54,30 @@ public:
 	 * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
 	 */
 	int download(void) final;
+
+public:
+	/** Multi interface (used by the rp-download worker mode) **/
+
+	/**
+	 * Prepare the cURL easy handle for the current URL.
+	 *
+	 * The easy handle is kept alive between downloads, so the caller
+	 * should add it to a cURL multi handle in order to reuse connections.
+	 * Call finish() once the multi handle reports the transfer as done.
+	 *
+	 * @return cURL easy handle, or nullptr on error.
+	 */
+	CURL *prepare(void);
+
+	/**
+	 * Finish a download that was started with prepare().
+	 * @param res cURL result code
+	 * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+	 */
+	int finish(CURLcode res);
+
+private:
+	CURL *m_curl;	// cURL easy handle (reused between downloads)
 };
 
 } //namespace RpDownload
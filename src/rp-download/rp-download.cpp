@@ -36,7 +36,11 @@
 #include <cstdio>
 
 // C++ includes.
+#include <algorithm>
+#include <deque>
 #include <memory>
+#include <string>
+#include <vector>
 using std::string;
 using std::tstring;
 using std::unique_ptr;
@@ -78,12 +82,23 @@ using namespace RpDownload;
 static const TCHAR *argv0 = nullptr;
 static bool verbose = false;
 
+#ifdef RP_DOWNLOAD_ENABLE_BASE_URL_OVERRIDE
+// Base URL override. (RP_DOWNLOAD_BASE_URL)
+// If set, this replaces the scheme and hostname of all URLs.
+// Only enabled in the test suite's build, which downloads
+// from a local HTTP server.
+static const TCHAR *base_url = nullptr;
+#endif /* RP_DOWNLOAD_ENABLE_BASE_URL_OVERRIDE */
+
 /**
  * Show command usage.
  */
 static void show_usage(void)
 {
 	_ftprintf(stderr, _T("Syntax: %s [-v] [-f] cache_key\n"), argv0);
+#ifndef _WIN32
+	_ftprintf(stderr, _T("        %s [-v] -s\n"), argv0);
+#endif /* !_WIN32 */
 }
 
 /**
@@ -291,191 +306,31 @@ static int rmkdir(const tstring &path, int mode)
 }
 
 /**
- * rp-download: Download an image from a supported online database.
- * @param cache_key Cache key, e.g. "ds/cover/US/ADAE.png"
- * @return 0 on success; non-zero on error.
- *
- * TODO:
- * - More error codes based on the error.
+ * Download request.
+ * Initialized by init_request().
  */
-int RP_C_API _tmain(int argc, TCHAR *argv[])
-{
-	// Create a downloader based on OS:
-	// - Linux: CurlDownloader
-	// - Windows: WinInetDownloader
-
-	// Syntax: rp-download cache_key
-	// Example: rp-download ds/coverM/US/ADAE.png
-
-	// If http_proxy or https_proxy are set, they will be used
-	// by the downloader code if supported.
-
-	// Restrict DLL lookups.
-	rp_secure_restrict_dll_lookups();
-	// Reduce process integrity, if available.
-	rp_secure_reduce_integrity();
-
-	// Set OS-specific security options.
-	rp_secure_param_t param;
-#if defined(_WIN32)
-	param.bHighSec = FALSE;
-#elif defined(HAVE_SECCOMP)
-	static constexpr int syscall_wl[] = {
-		// Syscalls used by rp-download.
-		// TODO: Add more syscalls.
-		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
-		// defined in earlier versions, including Ubuntu 14.04.
-		SCMP_SYS(clock_gettime),
-#if defined(__SNR_clock_gettime64) || defined(__NR_clock_gettime64)
-		SCMP_SYS(clock_gettime64),
-#endif /* __SNR_clock_gettime64 || __NR_clock_gettime64 */
-		SCMP_SYS(close),
-		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
-		SCMP_SYS(fsetxattr),
-		SCMP_SYS(fstat),     SCMP_SYS(fstat64),		// __GI___fxstat() [printf()]
-		SCMP_SYS(fstatat64), SCMP_SYS(newfstatat),	// Ubuntu 19.10 (32-bit)
-		SCMP_SYS(futex),
-		SCMP_SYS(getdents), SCMP_SYS(getdents64),
-		SCMP_SYS(getppid),	// for bubblewrap verification
-		SCMP_SYS(getrusage),
-		SCMP_SYS(gettimeofday),	// 32-bit only?
-		SCMP_SYS(getuid),	// TODO: Only use geteuid()?
-		SCMP_SYS(lseek), SCMP_SYS(_llseek),
-		//SCMP_SYS(lstat), SCMP_SYS(lstat64),	// Not sure if used?
-		SCMP_SYS(mkdir), SCMP_SYS(mmap), SCMP_SYS(mmap2),
-		SCMP_SYS(munmap),
-		SCMP_SYS(open),		// Ubuntu 16.04
-		SCMP_SYS(openat),	// glibc-2.31
-#if defined(__SNR_openat2)
-		SCMP_SYS(openat2),	// Linux 5.6
-#elif defined(__NR_openat2)
-		__NR_openat2,		// Linux 5.6
-#endif /* __SNR_openat2 || __NR_openat2 */
-		SCMP_SYS(poll), SCMP_SYS(select),
-		SCMP_SYS(stat), SCMP_SYS(stat64),
-		SCMP_SYS(unlink),	// to delete expired cache files
-		SCMP_SYS(utimensat),
-
-#if defined(__SNR_statx) || defined(__NR_statx)
-		SCMP_SYS(getcwd),	// called by glibc's statx()
-		SCMP_SYS(statx),
-#endif /* __SNR_statx || __NR_statx */
-
-		// glibc ncsd
-		// TODO: Restrict connect() to AF_UNIX.
-		SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
-		SCMP_SYS(sendmmsg),	// getaddrinfo() (32-bit only?)
-		SCMP_SYS(ioctl),	// getaddrinfo() (32-bit only?) [FIXME: Filter for FIONREAD]
-		SCMP_SYS(recvfrom),	// getaddrinfo() (32-bit only?)
-
-		// Needed for network access on Kubuntu 20.04 for some reason.
-		SCMP_SYS(getpid), SCMP_SYS(uname),
-
-		// cURL and OpenSSL
-		SCMP_SYS(bind),		// getaddrinfo() [curl_thread_create_thunk(), curl-7.68.0]
-#ifdef __SNR_getrandom
-		SCMP_SYS(getrandom),
-#endif /* __SNR_getrandom */
-		SCMP_SYS(getpeername), SCMP_SYS(getsockname),
-		SCMP_SYS(getsockopt), SCMP_SYS(madvise), SCMP_SYS(mprotect),
-		SCMP_SYS(setsockopt), SCMP_SYS(socket),
-		SCMP_SYS(socketcall),	// FIXME: Enhanced filtering? [cURL+GnuTLS only?]
-		SCMP_SYS(socketpair), SCMP_SYS(sysinfo),
-		SCMP_SYS(rt_sigprocmask),	// Ubuntu 20.04: __GI_getaddrinfo() ->
-						// gaih_inet() ->
-						// _nss_myhostname_gethostbyname4_r()
-
-		// libnss_resolve.so (systemd-resolved)
-		SCMP_SYS(geteuid),
-		SCMP_SYS(sendmsg),	// libpthread.so [_nss_resolve_gethostbyname4_r() from libnss_resolve.so]
-
-		// FIXME: Manjaro is using these syscalls for some reason...
-		SCMP_SYS(prctl), SCMP_SYS(mremap), SCMP_SYS(ppoll),
-
-		// cURL's "easy" functions use multi internally, which uses pipe().
-		// Some update, either cURL 8.4.0 -> 8.5.0 or glibc 2.38 -> 2.39,
-		// is now using the pipe2() syscall.
-		SCMP_SYS(pipe2),
-
-		// Needed on 32-bit Ubuntu 16.04 (glibc-2.23, cURL 7.47.0) for some reason...
-		// (called from getaddrinfo())
-		SCMP_SYS(time),
-
-		-1	// End of whitelist
-	};
-	param.syscall_wl = syscall_wl;
-	param.threading = true;		// libcurl uses multi-threading.
-#elif defined(HAVE_PLEDGE)
-	// Promises:
-	// - stdio: General stdio functionality.
-	// - rpath: Read from ~/.config/rom-properties/ and ~/.cache/rom-properties/
-	// - wpath: Write to ~/.cache/rom-properties/
-	// - cpath: Create ~/.cache/rom-properties/ if it doesn't exist.
-	// - inet: Internet access.
-	// - fattr: Modify file attributes, e.g. mtime.
-	// - dns: Resolve hostnames.
-	// - getpw: Get user's home directory if HOME is empty.
-	param.promises = "stdio rpath wpath cpath inet fattr dns getpw";
-#elif defined(HAVE_TAME)
-	// NOTE: stdio includes fattr, e.g. utimes().
-	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH |
-	                   TAME_INET | TAME_DNS | TAME_GETPW;
-#else
-	param.dummy = 0;
-#endif
-	rp_secure_enable(param);
+struct DownloadRequest {
+	tstring cache_key;	// Cache key
+	tstring cache_filename;	// Cache filename
+	tstring full_url;	// Full URL
+	time_t filemtime;	// mtime of the existing cache file, or -1 if none
+	bool check_newer;	// If true, only download if newer
+};
 
-#ifdef __GLIBC__
-	// Reduce /etc/localtime stat() calls.
-	// References:
-	// - https://lwn.net/Articles/944499/
-	// - https://gitlab.com/procps-ng/procps/-/merge_requests/119
-	setenv("TZ", ":/etc/localtime", 0);
-#endif /* __GLIBC__ */
-
-	// Store argv[0] globally.
-	argv0 = argv[0];
-
-	if (argc < 2) {
-		show_usage();
-		return EXIT_FAILURE;
-	}
-
-	// Check for arguments. (simple non-getopt version)
-	bool force = false;
-	int optind = 1;
-	for (; optind < argc; optind++) {
-		if (!argv[optind] || argv[optind][0] != '-') {
-			// End of options.
-			break;
-		}
-
-		// Allow multiple options in one argument, e.g. '-vf'.
-		for (int i = 1; argv[optind][i] != '\0'; i++) {
-			switch (argv[optind][i]) {
-				case 'v':
-					// Verbose mode is enabled.
-					verbose = true;
-					break;
-				case 'f':
-					// Force download is enabled.
-					force = true;
-					break;
-				default:
-					// Invalid parameter.
-					show_error(_T("Unrecognized option: %c"), argv[optind][i]);
-					show_usage();
-					return EXIT_FAILURE;
-			}
-		}
-	}
+// init_request() return value if the file needs to be downloaded.
+static constexpr int NEED_DOWNLOAD = -1;
 
-	if (optind >= argc) {
-		show_error(_T("No cache key specified."));
-		show_usage();
-		return EXIT_FAILURE;
-	}
-	const TCHAR *const cache_key = argv[optind];
+/**
+ * Initialize a download request.
+ * This checks the cache key and the cache file.
+ * @param req		[out] Download request
+ * @param cache_key	[in] Cache key, e.g. "ds/cover/US/ADAE.png"
+ * @param force		[in] If true, redownload the file even if it's cached.
+ * @return NEED_DOWNLOAD if the file needs to be downloaded; otherwise, the exit code.
+ */
+static int init_request(DownloadRequest &req, const TCHAR *cache_key, bool force)
+{
+	req.cache_key = cache_key;
 
 	// Check the cache key prefix. The prefix indicates the system
 	// and identifies the online database used.
@@ -555,7 +410,8 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 
 	// Determine the full URL based on the cache key.
 	bool ok = false;
-	bool check_newer = false;	// for [sys]: always check, but only download if newer
+	bool &check_newer = req.check_newer;	// for [sys]: always check, but only download if newer
+	check_newer = false;
 	TCHAR full_url[256];
 	if ((prefix_len == 3 && (!_tcsncmp(cache_key, _T("wii"), 3) || !_tcsncmp(cache_key, _T("3ds"), 3))) ||
 	    (prefix_len == 4 && !_tcsncmp(cache_key, _T("wiiu"), 4)) ||
@@ -646,8 +502,26 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		return EXIT_FAILURE;
 	}
 
+	req.full_url = full_url;
+#ifdef RP_DOWNLOAD_ENABLE_BASE_URL_OVERRIDE
+	if (base_url) {
+		// Base URL override: Replace the scheme and hostname.
+		const TCHAR *path = _tcsstr(full_url, _T("://"));
+		if (path) {
+			path = _tcschr(path + 3, _T('/'));
+		}
+		if (!path) {
+			// Shouldn't happen...
+			SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
+			return EXIT_FAILURE;
+		}
+		req.full_url = base_url;
+		req.full_url += path;
+	}
+#endif /* RP_DOWNLOAD_ENABLE_BASE_URL_OVERRIDE */
+
 	if (verbose) {
-		_ftprintf(stderr, _T("URL: %s\n"), full_url);
+		_ftprintf(stderr, _T("URL: %s\n"), req.full_url.c_str());
 	}
 
 	// Make sure we have a valid cache directory.
@@ -660,7 +534,8 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 	}
 
 	// Get the cache filename.
-	tstring cache_filename = LibCacheCommon::getCacheFilename(cache_key);
+	tstring &cache_filename = req.cache_filename;
+	cache_filename = LibCacheCommon::getCacheFilename(cache_key);
 	if (cache_filename.empty()) {
 		// Invalid cache filename.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
@@ -678,7 +553,8 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 
 	// Get the cache file information.
 	off64_t filesize = 0;
-	time_t filemtime = -1;
+	time_t &filemtime = req.filemtime;
+	filemtime = -1;
 	int ret = get_file_size_and_mtime(cache_filename.c_str(), &filesize, &filemtime);
 	if (ret == 0) {
 		// Check if the file is 0 bytes.
@@ -735,36 +611,52 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		return EXIT_FAILURE;
 	}
 
-	// Attempt to download the file.
-	// TODO: IDownloaderFactory?
-#ifdef _WIN32
-	unique_ptr<IDownloader> m_downloader(new WinInetDownloader());
-#else /* !_WIN32 */
-	unique_ptr<IDownloader> m_downloader(new CurlDownloader());
-#endif /* _WIN32 */
+	// The file needs to be downloaded.
+	return NEED_DOWNLOAD;
+}
 
+/**
+ * Set up a downloader for a download request.
+ * @param downloader	[in] Downloader
+ * @param req		[in] Download request
+ */
+static void setup_downloader(IDownloader *downloader, const DownloadRequest &req)
+{
 	// TODO: Configure this somewhere?
-	m_downloader->setMaxSize(4*1024*1024);
+	downloader->setMaxSize(4*1024*1024);
 
-	if (check_newer && filemtime >= 0) {
+	if (req.check_newer && req.filemtime >= 0) {
 		// Only download if the file on the server is newer than
 		// what's in our cache directory.
-		m_downloader->setIfModifiedSince(filemtime);
+		downloader->setIfModifiedSince(req.filemtime);
+	} else {
+		downloader->setIfModifiedSince(-1);
 	}
 
-	m_downloader->setUrl(full_url);
-	ret = m_downloader->download();
+	downloader->setUrl(req.full_url);
+}
+
+/**
+ * Finish a download request.
+ * This writes the downloaded file to the cache directory.
+ * @param req		[in] Download request
+ * @param downloader	[in] Downloader
+ * @param ret		[in] Return value from the downloader
+ * @return Exit code.
+ */
+static int finish_request(const DownloadRequest &req, IDownloader *downloader, int ret)
+{
 	if (ret != 0) {
 		// Error downloading the file.
 		if (ret < 0) {
 			// POSIX error code
 			SHOW_ERROR(_T("Error downloading file: %s"), _tcserror(-ret));
 			// Create a 0-byte file to indicate an error occurred.
-			FILE *f_out = _tfopen(cache_filename.c_str(), _T("wb"));
+			FILE *f_out = _tfopen(req.cache_filename.c_str(), _T("wb"));
 			if (f_out) {
 				fclose(f_out);
 			}
-		} else if (ret == 304 && check_newer) {
+		} else if (ret == 304 && req.check_newer) {
 			// HTTP 304 Not Modified
 			SHOW_ERROR(_T("File has not been modified on the server. Not redownloading."));
 			return EXIT_SUCCESS;
@@ -779,7 +671,7 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 				}
 			}
 			// Create a 0-byte file to indicate an error occurred.
-			FILE *f_out = _tfopen(cache_filename.c_str(), _T("wb"));
+			FILE *f_out = _tfopen(req.cache_filename.c_str(), _T("wb"));
 			if (f_out) {
 				fclose(f_out);
 			}
@@ -787,13 +679,13 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		return EXIT_FAILURE;
 	}
 
-	if (m_downloader->dataSize() <= 0) {
+	if (downloader->dataSize() <= 0) {
 		// No data downloaded...
 		SHOW_ERROR(_T("Error downloading file: 0 bytes received"));
 		return EXIT_FAILURE;
 	}
 
-	FILE *f_out = _tfopen(cache_filename.c_str(), _T("wb"));
+	FILE *f_out = _tfopen(req.cache_filename.c_str(), _T("wb"));
 	if (!f_out) {
 		// Error opening the cache file.
 		SHOW_ERROR(_T("Error writing to cache file: %s"), _tcserror(errno));
@@ -802,22 +694,468 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 
 	// Write the file to the cache.
 	// TODO: Verify the size.
-	const size_t dataSize = m_downloader->dataSize();
-	size_t size = fwrite(m_downloader->data(), 1, dataSize, f_out);
+	const size_t dataSize = downloader->dataSize();
+	size_t size = fwrite(downloader->data(), 1, dataSize, f_out);
 	fflush(f_out);
 
 	// Save the file origin information.
 #ifdef _WIN32
 	// TODO: Figure out how to setFileOriginInfo() on Windows using an open file handle.
-	setFileOriginInfo(f_out, cache_filename.c_str(), full_url, m_downloader->mtime());
+	setFileOriginInfo(f_out, req.cache_filename.c_str(), req.full_url.c_str(), downloader->mtime());
 #else /* !_WIN32 */
-	setFileOriginInfo(f_out, full_url, m_downloader->mtime());
+	setFileOriginInfo(f_out, req.full_url.c_str(), downloader->mtime());
 #endif /* _WIN32 */
 	fclose(f_out);
 
 	// Success.
 	SHOW_INFO(_T("Downloaded cache file for '%s': %u byte%s."),
-		cache_key, static_cast<unsigned int>(dataSize),
+		req.cache_key.c_str(), static_cast<unsigned int>(dataSize),
 		unlikely(dataSize == 1) ? "" : "s");
 	return EXIT_SUCCESS;
 }
+
+#ifndef _WIN32
+/** Worker mode **/
+
+// Maximum number of simultaneous downloads in worker mode.
+// TODO: Configure this somewhere?
+static constexpr size_t WORKER_MAX_ACTIVE = 4;
+
+// Worker mode idle timeout, in milliseconds.
+// If no cache keys are received in this time, the worker exits.
+static constexpr int WORKER_IDLE_TIMEOUT = 60*1000;
+
+/**
+ * Worker mode: Active download.
+ */
+struct WorkerJob {
+	DownloadRequest req;
+	unique_ptr<CurlDownloader> downloader;
+	CURL *curl;	// cURL easy handle, owned by the downloader
+};
+
+/**
+ * Worker mode: Send a reply for a cache key.
+ * @param cache_key Cache key
+ * @param status Exit code for this cache key
+ */
+static void worker_reply(const tstring &cache_key, int status)
+{
+	// Reply format: "OK cache_key\n" or "ERR cache_key\n"
+	_ftprintf(stdout, _T("%s %s\n"),
+		(status == EXIT_SUCCESS) ? _T("OK") : _T("ERR"), cache_key.c_str());
+	fflush(stdout);
+}
+
+/**
+ * Worker mode: Download cache keys received on stdin.
+ *
+ * Cache keys are read from stdin, one per line. Once a cache key has
+ * been processed, a reply line is written to stdout. Replies may be
+ * written in a different order than the cache keys were received.
+ *
+ * Downloads use a single cURL multi handle, so connections to the
+ * same server are kept alive, and several files can be downloaded
+ * at the same time.
+ *
+ * The worker exits once stdin is closed and all downloads have
+ * finished, or if it has been idle for WORKER_IDLE_TIMEOUT.
+ *
+ * @return Exit code.
+ */
+static int worker_main(void)
+{
+	CURLM *const multi = curl_multi_init();
+	if (!multi) {
+		SHOW_ERROR(_T("Unable to initialize cURL."));
+		return EXIT_FAILURE;
+	}
+
+	std::deque<tstring> queue;		// Queued cache keys
+	std::vector<unique_ptr<WorkerJob> > active;	// Active downloads
+	std::vector<unique_ptr<CurlDownloader> > pool;	// Idle downloaders
+	string linebuf;
+	bool eof = false;
+
+	while (!eof || !queue.empty() || !active.empty()) {
+		// Start downloads for queued cache keys.
+		while (!queue.empty() && active.size() < WORKER_MAX_ACTIVE) {
+			unique_ptr<WorkerJob> job(new WorkerJob);
+			int ret = init_request(job->req, queue.front().c_str(), false);
+			queue.pop_front();
+			if (ret != NEED_DOWNLOAD) {
+				// Cache key is invalid, or the file is already cached.
+				worker_reply(job->req.cache_key, ret);
+				continue;
+			}
+
+			// Reuse an idle downloader if one is available.
+			// This keeps the cURL easy handles alive.
+			if (!pool.empty()) {
+				job->downloader = std::move(pool.back());
+				pool.pop_back();
+			} else {
+				job->downloader.reset(new CurlDownloader());
+			}
+			setup_downloader(job->downloader.get(), job->req);
+
+			job->curl = job->downloader->prepare();
+			if (!job->curl || curl_multi_add_handle(multi, job->curl) != CURLM_OK) {
+				SHOW_ERROR(_T("Unable to initialize cURL."));
+				worker_reply(job->req.cache_key, EXIT_FAILURE);
+				continue;
+			}
+			active.push_back(std::move(job));
+		}
+
+		if (eof && active.empty()) {
+			// No more downloads.
+			break;
+		}
+
+		// Process downloads.
+		int running = 0;
+		curl_multi_perform(multi, &running);
+
+		// Check for completed downloads.
+		bool completed = false;
+		int msgs_left = 0;
+		CURLMsg *msg;
+		while ((msg = curl_multi_info_read(multi, &msgs_left)) != nullptr) {
+			if (msg->msg != CURLMSG_DONE)
+				continue;
+
+			CURL *const curl = msg->easy_handle;
+			const CURLcode res = msg->data.result;
+			curl_multi_remove_handle(multi, curl);
+
+			for (auto iter = active.begin(); iter != active.end(); ++iter) {
+				WorkerJob *const job = iter->get();
+				if (job->curl != curl)
+					continue;
+
+				CurlDownloader *const downloader = job->downloader.get();
+				const int ret = downloader->finish(res);
+				worker_reply(job->req.cache_key, finish_request(job->req, downloader, ret));
+
+				// Return the downloader to the pool.
+				downloader->clear();
+				pool.push_back(std::move(job->downloader));
+				active.erase(iter);
+				completed = true;
+				break;
+			}
+		}
+		if (completed) {
+			// Start more downloads, if any are queued.
+			continue;
+		}
+
+		// Wait for activity on stdin or the cURL sockets.
+		const bool idle = (active.empty() && queue.empty());
+		struct curl_waitfd wfd;
+		wfd.fd = STDIN_FILENO;
+		wfd.events = CURL_WAIT_POLLIN;
+		wfd.revents = 0;
+		int numfds = 0;
+		if (curl_multi_wait(multi, (eof ? nullptr : &wfd), (eof ? 0 : 1),
+		                    (idle ? WORKER_IDLE_TIMEOUT : 1000), &numfds) != CURLM_OK)
+		{
+			SHOW_ERROR(_T("curl_multi_wait() failed."));
+			break;
+		}
+
+		if (wfd.revents == 0) {
+			if (idle && !eof) {
+				// Idle timeout.
+				SHOW_INFO(_T("Worker has been idle for %d seconds; exiting."), WORKER_IDLE_TIMEOUT / 1000);
+				eof = true;
+			}
+			continue;
+		}
+
+		// Read cache keys from stdin.
+		char buf[1024];
+		const ssize_t size = read(STDIN_FILENO, buf, sizeof(buf));
+		if (size <= 0) {
+			if (size < 0 && (errno == EINTR || errno == EAGAIN)) {
+				continue;
+			}
+			// End of file, or an error occurred.
+			eof = true;
+			continue;
+		}
+		linebuf.append(buf, static_cast<size_t>(size));
+
+		size_t nl_pos;
+		while ((nl_pos = linebuf.find('\n')) != string::npos) {
+			tstring cache_key(linebuf, 0, nl_pos);
+			linebuf.erase(0, nl_pos + 1);
+			if (!cache_key.empty() && cache_key.back() == '\r') {
+				cache_key.resize(cache_key.size() - 1);
+			}
+			if (cache_key.empty()) {
+				continue;
+			}
+
+			// Ignore the cache key if it's already queued or active.
+			// It will be replied to once.
+			bool found = (std::find(queue.cbegin(), queue.cend(), cache_key) != queue.cend());
+			for (auto iter = active.cbegin(); !found && iter != active.cend(); ++iter) {
+				found = ((*iter)->req.cache_key == cache_key);
+			}
+			if (!found) {
+				queue.push_back(std::move(cache_key));
+			}
+		}
+	}
+
+	// Clean up any remaining downloads.
+	for (const auto &job : active) {
+		curl_multi_remove_handle(multi, job->curl);
+	}
+	active.clear();
+	pool.clear();
+	curl_multi_cleanup(multi);
+	return EXIT_SUCCESS;
+}
+#endif /* !_WIN32 */
+
+/**
+ * rp-download: Download an image from a supported online database.
+ * @param cache_key Cache key, e.g. "ds/cover/US/ADAE.png"
+ * @return 0 on success; non-zero on error.
+ *
+ * TODO:
+ * - More error codes based on the error.
+ */
+int RP_C_API _tmain(int argc, TCHAR *argv[])
+{
+	// Create a downloader based on OS:
+	// - Linux: CurlDownloader
+	// - Windows: WinInetDownloader
+
+	// Syntax: rp-download cache_key
+	// Example: rp-download ds/coverM/US/ADAE.png
+
+	// Worker mode: rp-download -s
+	// Cache keys are read from stdin, one per line.
+	// See worker_main() for more information.
+
+	// If http_proxy or https_proxy are set, they will be used
+	// by the downloader code if supported.
+
+	// Restrict DLL lookups.
+	rp_secure_restrict_dll_lookups();
+	// Reduce process integrity, if available.
+	rp_secure_reduce_integrity();
+
+	// Set OS-specific security options.
+	rp_secure_param_t param;
+#if defined(_WIN32)
+	param.bHighSec = FALSE;
+#elif defined(HAVE_SECCOMP)
+	static constexpr int syscall_wl[] = {
+		// Syscalls used by rp-download.
+		// TODO: Add more syscalls.
+		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
+		// defined in earlier versions, including Ubuntu 14.04.
+		SCMP_SYS(clock_gettime),
+#if defined(__SNR_clock_gettime64) || defined(__NR_clock_gettime64)
+		SCMP_SYS(clock_gettime64),
+#endif /* __SNR_clock_gettime64 || __NR_clock_gettime64 */
+		SCMP_SYS(close),
+		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
+		SCMP_SYS(fsetxattr),
+		SCMP_SYS(fstat),     SCMP_SYS(fstat64),		// __GI___fxstat() [printf()]
+		SCMP_SYS(fstatat64), SCMP_SYS(newfstatat),	// Ubuntu 19.10 (32-bit)
+		SCMP_SYS(futex),
+		SCMP_SYS(getdents), SCMP_SYS(getdents64),
+		SCMP_SYS(getppid),	// for bubblewrap verification
+		SCMP_SYS(getrusage),
+		SCMP_SYS(gettimeofday),	// 32-bit only?
+		SCMP_SYS(getuid),	// TODO: Only use geteuid()?
+		SCMP_SYS(lseek), SCMP_SYS(_llseek),
+		//SCMP_SYS(lstat), SCMP_SYS(lstat64),	// Not sure if used?
+		SCMP_SYS(mkdir), SCMP_SYS(mmap), SCMP_SYS(mmap2),
+		SCMP_SYS(munmap),
+		SCMP_SYS(open),		// Ubuntu 16.04
+		SCMP_SYS(openat),	// glibc-2.31
+#if defined(__SNR_openat2)
+		SCMP_SYS(openat2),	// Linux 5.6
+#elif defined(__NR_openat2)
+		__NR_openat2,		// Linux 5.6
+#endif /* __SNR_openat2 || __NR_openat2 */
+		SCMP_SYS(poll), SCMP_SYS(select),
+		SCMP_SYS(stat), SCMP_SYS(stat64),
+		SCMP_SYS(unlink),	// to delete expired cache files
+		SCMP_SYS(utimensat),
+
+#if defined(__SNR_statx) || defined(__NR_statx)
+		SCMP_SYS(getcwd),	// called by glibc's statx()
+		SCMP_SYS(statx),
+#endif /* __SNR_statx || __NR_statx */
+
+		// glibc ncsd
+		// TODO: Restrict connect() to AF_UNIX.
+		SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
+		SCMP_SYS(sendmmsg),	// getaddrinfo() (32-bit only?)
+		SCMP_SYS(ioctl),	// getaddrinfo() (32-bit only?) [FIXME: Filter for FIONREAD]
+		SCMP_SYS(recvfrom),	// getaddrinfo() (32-bit only?)
+
+		// Needed for network access on Kubuntu 20.04 for some reason.
+		SCMP_SYS(getpid), SCMP_SYS(uname),
+
+		// cURL and OpenSSL
+		SCMP_SYS(bind),		// getaddrinfo() [curl_thread_create_thunk(), curl-7.68.0]
+#ifdef __SNR_getrandom
+		SCMP_SYS(getrandom),
+#endif /* __SNR_getrandom */
+		SCMP_SYS(getpeername), SCMP_SYS(getsockname),
+		SCMP_SYS(getsockopt), SCMP_SYS(madvise), SCMP_SYS(mprotect),
+		SCMP_SYS(setsockopt), SCMP_SYS(socket),
+		SCMP_SYS(socketcall),	// FIXME: Enhanced filtering? [cURL+GnuTLS only?]
+		SCMP_SYS(socketpair), SCMP_SYS(sysinfo),
+		SCMP_SYS(rt_sigprocmask),	// Ubuntu 20.04: __GI_getaddrinfo() ->
+						// gaih_inet() ->
+						// _nss_myhostname_gethostbyname4_r()
+
+		// libnss_resolve.so (systemd-resolved)
+		SCMP_SYS(geteuid),
+		SCMP_SYS(sendmsg),	// libpthread.so [_nss_resolve_gethostbyname4_r() from libnss_resolve.so]
+
+		// FIXME: Manjaro is using these syscalls for some reason...
+		SCMP_SYS(prctl), SCMP_SYS(mremap), SCMP_SYS(ppoll),
+
+		// cURL's "easy" functions use multi internally, which uses pipe().
+		// Some update, either cURL 8.4.0 -> 8.5.0 or glibc 2.38 -> 2.39,
+		// is now using the pipe2() syscall.
+		SCMP_SYS(pipe2),
+
+		// Needed on 32-bit Ubuntu 16.04 (glibc-2.23, cURL 7.47.0) for some reason...
+		// (called from getaddrinfo())
+		SCMP_SYS(time),
+
+		-1	// End of whitelist
+	};
+	param.syscall_wl = syscall_wl;
+	param.threading = true;		// libcurl uses multi-threading.
+#elif defined(HAVE_PLEDGE)
+	// Promises:
+	// - stdio: General stdio functionality.
+	// - rpath: Read from ~/.config/rom-properties/ and ~/.cache/rom-properties/
+	// - wpath: Write to ~/.cache/rom-properties/
+	// - cpath: Create ~/.cache/rom-properties/ if it doesn't exist.
+	// - inet: Internet access.
+	// - fattr: Modify file attributes, e.g. mtime.
+	// - dns: Resolve hostnames.
+	// - getpw: Get user's home directory if HOME is empty.
+	param.promises = "stdio rpath wpath cpath inet fattr dns getpw";
+#elif defined(HAVE_TAME)
+	// NOTE: stdio includes fattr, e.g. utimes().
+	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH |
+	                   TAME_INET | TAME_DNS | TAME_GETPW;
+#else
+	param.dummy = 0;
+#endif
+	rp_secure_enable(param);
+
+#ifdef __GLIBC__
+	// Reduce /etc/localtime stat() calls.
+	// References:
+	// - https://lwn.net/Articles/944499/
+	// - https://gitlab.com/procps-ng/procps/-/merge_requests/119
+	setenv("TZ", ":/etc/localtime", 0);
+#endif /* __GLIBC__ */
+
+	// Store argv[0] globally.
+	argv0 = argv[0];
+
+#ifdef RP_DOWNLOAD_ENABLE_BASE_URL_OVERRIDE
+	// Check for a base URL override.
+	base_url = _tgetenv(_T("RP_DOWNLOAD_BASE_URL"));
+	if (base_url && base_url[0] == _T('\0')) {
+		base_url = nullptr;
+	}
+#endif /* RP_DOWNLOAD_ENABLE_BASE_URL_OVERRIDE */
+
+	if (argc < 2) {
+		show_usage();
+		return EXIT_FAILURE;
+	}
+
+	// Check for arguments. (simple non-getopt version)
+	bool force = false;
+#ifndef _WIN32
+	bool worker = false;
+#endif /* !_WIN32 */
+	int optind = 1;
+	for (; optind < argc; optind++) {
+		if (!argv[optind] || argv[optind][0] != '-') {
+			// End of options.
+			break;
+		}
+
+		// Allow multiple options in one argument, e.g. '-vf'.
+		for (int i = 1; argv[optind][i] != '\0'; i++) {
+			switch (argv[optind][i]) {
+				case 'v':
+					// Verbose mode is enabled.
+					verbose = true;
+					break;
+				case 'f':
+					// Force download is enabled.
+					force = true;
+					break;
+#ifndef _WIN32
+				case 's':
+					// Worker mode is enabled.
+					worker = true;
+					break;
+#endif /* !_WIN32 */
+				default:
+					// Invalid parameter.
+					show_error(_T("Unrecognized option: %c"), argv[optind][i]);
+					show_usage();
+					return EXIT_FAILURE;
+			}
+		}
+	}
+
+#ifndef _WIN32
+	if (worker) {
+		// Worker mode. Cache keys are read from stdin.
+		if (optind < argc || force) {
+			show_error(_T("Worker mode does not take a cache key."));
+			show_usage();
+			return EXIT_FAILURE;
+		}
+		return worker_main();
+	}
+#endif /* !_WIN32 */
+
+	if (optind >= argc) {
+		show_error(_T("No cache key specified."));
+		show_usage();
+		return EXIT_FAILURE;
+	}
+
+	DownloadRequest req;
+	int ret = init_request(req, argv[optind], force);
+	if (ret != NEED_DOWNLOAD) {
+		// Cache key is invalid, or the file is already cached.
+		return ret;
+	}
+
+	// Attempt to download the file.
+	// TODO: IDownloaderFactory?
+#ifdef _WIN32
+	unique_ptr<IDownloader> downloader(new WinInetDownloader());
+#else /* !_WIN32 */
+	unique_ptr<IDownloader> downloader(new CurlDownloader());
+#endif /* _WIN32 */
+
+	setup_downloader(downloader.get(), req);
+	ret = downloader->download();
+	return finish_request(req, downloader.get(), ret);
+}
@@ -0,0 +1,543 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-download/tests)                *
+ * WorkerModeTest.cpp: rp-download worker mode test.                       *
+ *                                                                         *
+ * Copyright (c) 2016-2024 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "common.h"
+#include "tcharx.h"
+
+// OS-specific includes
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// C includes (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace RpDownload { namespace Tests {
+
+/**
+ * Minimal HTTP/1.1 server with keep-alive support.
+ * This is a stand-in for the online databases.
+ */
+class LocalHttpServer
+{
+public:
+	LocalHttpServer()
+		: m_listenFd(-1)
+		, m_port(0)
+		, m_connections(0)
+		, m_requests(0)
+	{}
+
+	~LocalHttpServer()
+	{
+		stop();
+	}
+
+public:
+	/**
+	 * Start the server on an ephemeral port.
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int start(void)
+	{
+		m_listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (m_listenFd < 0) {
+			return -errno;
+		}
+		const int one = 1;
+		setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+		struct sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+		if (bind(m_listenFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+		    listen(m_listenFd, 16) != 0)
+		{
+			return -errno;
+		}
+
+		socklen_t addrlen = sizeof(addr);
+		getsockname(m_listenFd, reinterpret_cast<struct sockaddr*>(&addr), &addrlen);
+		m_port = ntohs(addr.sin_port);
+
+		m_acceptThread = std::thread(&LocalHttpServer::acceptThread, this);
+		return 0;
+	}
+
+	/**
+	 * Stop the server.
+	 * Connection threads will exit once the client closes the connection.
+	 */
+	void stop(void)
+	{
+		if (m_listenFd >= 0) {
+			shutdown(m_listenFd, SHUT_RDWR);
+			if (m_acceptThread.joinable()) {
+				m_acceptThread.join();
+			}
+			close(m_listenFd);
+			m_listenFd = -1;
+		}
+		for (std::thread &thread : m_connThreads) {
+			thread.join();
+		}
+		m_connThreads.clear();
+	}
+
+	/**
+	 * Add a file to the server.
+	 * @param path Path, e.g. "/wii/cover/US/RMGE01.png"
+	 * @param data File data
+	 */
+	void addFile(const string &path, const string &data)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_files[path] = data;
+	}
+
+	/**
+	 * Get the base URL.
+	 * @return Base URL
+	 */
+	string baseUrl(void) const
+	{
+		return "http://127.0.0.1:" + std::to_string(m_port);
+	}
+
+	unsigned int connections(void) const { return m_connections; }
+	unsigned int requests(void) const { return m_requests; }
+
+private:
+	void acceptThread(void)
+	{
+		for (;;) {
+			const int fd = accept(m_listenFd, nullptr, nullptr);
+			if (fd < 0) {
+				if (errno == EINTR)
+					continue;
+				break;
+			}
+			m_connections++;
+			m_connThreads.emplace_back(&LocalHttpServer::connThread, this, fd);
+		}
+	}
+
+	void connThread(int fd)
+	{
+		string buf;
+		char rdbuf[1024];
+		for (;;) {
+			// Read a complete request header.
+			size_t hdr_end;
+			while ((hdr_end = buf.find("\r\n\r\n")) == string::npos) {
+				const ssize_t size = read(fd, rdbuf, sizeof(rdbuf));
+				if (size <= 0) {
+					close(fd);
+					return;
+				}
+				buf.append(rdbuf, static_cast<size_t>(size));
+			}
+			const string request = buf.substr(0, hdr_end);
+			buf.erase(0, hdr_end + 4);
+			m_requests++;
+
+			// Request line: "GET /path HTTP/1.1"
+			string path;
+			const size_t sp1 = request.find(' ');
+			const size_t sp2 = (sp1 != string::npos ? request.find(' ', sp1 + 1) : string::npos);
+			if (sp2 != string::npos) {
+				path = request.substr(sp1 + 1, sp2 - sp1 - 1);
+			}
+
+			string response;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				auto iter = m_files.find(path);
+				if (iter != m_files.end()) {
+					response = "HTTP/1.1 200 OK\r\n"
+						"Content-Type: application/octet-stream\r\n"
+						"Content-Length: " + std::to_string(iter->second.size()) + "\r\n"
+						"\r\n" + iter->second;
+				} else {
+					static const char body[] = "Not Found";
+					response = "HTTP/1.1 404 Not Found\r\n"
+						"Content-Type: text/plain\r\n"
+						"Content-Length: " + std::to_string(sizeof(body)-1) + "\r\n"
+						"\r\n" + body;
+				}
+			}
+
+			const char *p = response.data();
+			size_t size = response.size();
+			while (size > 0) {
+				const ssize_t ret = send(fd, p, size, MSG_NOSIGNAL);
+				if (ret <= 0) {
+					close(fd);
+					return;
+				}
+				p += ret;
+				size -= ret;
+			}
+		}
+	}
+
+private:
+	int m_listenFd;
+	uint16_t m_port;
+	std::atomic<unsigned int> m_connections;
+	std::atomic<unsigned int> m_requests;
+
+	std::mutex m_mutex;
+	map<string, string> m_files;
+
+	std::thread m_acceptThread;
+	vector<std::thread> m_connThreads;
+};
+
+class WorkerModeTest : public ::testing::Test
+{
+protected:
+	WorkerModeTest()
+		: m_pid(-1)
+		, m_fd(-1)
+	{}
+
+	void SetUp(void) final;
+	void TearDown(void) final;
+
+public:
+	/**
+	 * Send a cache key to rp-download.
+	 * @param cache_key Cache key
+	 */
+	void sendKey(const string &cache_key);
+
+	/**
+	 * Read a reply line from rp-download.
+	 * @param line	[out] Reply line (without the newline)
+	 * @return True on success; false on timeout or EOF.
+	 */
+	bool readReply(string &line);
+
+	/**
+	 * Read a file from the cache directory.
+	 * @param cache_key	[in] Cache key
+	 * @param data		[out] File data
+	 * @return True if the file exists; false if not.
+	 */
+	bool readCacheFile(const string &cache_key, string &data);
+
+	/**
+	 * Close rp-download's stdin and wait for it to exit.
+	 * @return Exit status, or -1 on error.
+	 */
+	int closeAndWait(void);
+
+public:
+	LocalHttpServer m_server;
+	string m_cacheDir;
+	pid_t m_pid;
+	int m_fd;
+	string m_linebuf;
+};
+
+void WorkerModeTest::SetUp(void)
+{
+	// Temporary cache directory.
+	char tmpl[] = "/tmp/rp-download-test.XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(tmpl));
+	m_cacheDir = tmpl;
+
+	// Test files
+	m_server.addFile("/wii/cover/US/RMGE01.png", string(1000, 'A'));
+	m_server.addFile("/wii/cover/US/RSBE01.png", string(2000, 'B'));
+	m_server.addFile("/wii/cover/US/SMNE01.png", string(3000, 'C'));
+	m_server.addFile("/3ds/cover/US/AREE.png", string(4000, 'D'));
+	m_server.addFile("/ds/cover/US/ADAE.png", string(5000, 'E'));
+	m_server.addFile("/gba/title/AGSE.png", string(6000, 'F'));
+	ASSERT_EQ(0, m_server.start());
+
+	// Start rp-download in worker mode.
+	int sv[2];
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv));
+
+	const string env_xdg = "XDG_CACHE_HOME=" + m_cacheDir;
+	const string env_home = "HOME=" + m_cacheDir;
+	const string env_base_url = "RP_DOWNLOAD_BASE_URL=" + m_server.baseUrl();
+	const char *const envp[] = {
+		env_xdg.c_str(), env_home.c_str(), env_base_url.c_str(), nullptr
+	};
+	const char *const argv[] = {RP_DOWNLOAD_EXE, "-s", nullptr};
+
+	posix_spawn_file_actions_t file_actions;
+	posix_spawn_file_actions_init(&file_actions);
+	posix_spawn_file_actions_adddup2(&file_actions, sv[1], STDIN_FILENO);
+	posix_spawn_file_actions_adddup2(&file_actions, sv[1], STDOUT_FILENO);
+	int ret = posix_spawn(&m_pid, RP_DOWNLOAD_EXE, &file_actions, nullptr,
+		(char *const *)argv, (char *const *)envp);
+	posix_spawn_file_actions_destroy(&file_actions);
+	close(sv[1]);
+	if (ret != 0) {
+		m_pid = -1;
+		close(sv[0]);
+		FAIL() << "posix_spawn() failed: " << strerror(ret);
+	}
+	m_fd = sv[0];
+}
+
+void WorkerModeTest::TearDown(void)
+{
+	if (m_pid > 0) {
+		kill(m_pid, SIGTERM);
+		closeAndWait();
+	}
+	m_server.stop();
+
+	if (!m_cacheDir.empty()) {
+		// Remove the temporary cache directory.
+		const string cmd = "rm -rf '" + m_cacheDir + "'";
+		if (system(cmd.c_str()) != 0) {
+			fprintf(stderr, "*** WARNING: Unable to remove %s\n", m_cacheDir.c_str());
+		}
+	}
+}
+
+/**
+ * Send a cache key to rp-download.
+ * @param cache_key Cache key
+ */
+void WorkerModeTest::sendKey(const string &cache_key)
+{
+	const string line = cache_key + '\n';
+	ASSERT_EQ(static_cast<ssize_t>(line.size()), send(m_fd, line.data(), line.size(), MSG_NOSIGNAL));
+}
+
+/**
+ * Read a reply line from rp-download.
+ * @param line	[out] Reply line (without the newline)
+ * @return True on success; false on timeout or EOF.
+ */
+bool WorkerModeTest::readReply(string &line)
+{
+	size_t nl_pos;
+	while ((nl_pos = m_linebuf.find('\n')) == string::npos) {
+		struct pollfd pfd;
+		pfd.fd = m_fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, 15*1000) <= 0) {
+			return false;
+		}
+
+		char buf[256];
+		const ssize_t size = read(m_fd, buf, sizeof(buf));
+		if (size <= 0) {
+			return false;
+		}
+		m_linebuf.append(buf, static_cast<size_t>(size));
+	}
+
+	line = m_linebuf.substr(0, nl_pos);
+	m_linebuf.erase(0, nl_pos + 1);
+	return true;
+}
+
+/**
+ * Read a file from the cache directory.
+ * @param cache_key	[in] Cache key
+ * @param data		[out] File data
+ * @return True if the file exists; false if not.
+ */
+bool WorkerModeTest::readCacheFile(const string &cache_key, string &data)
+{
+	const string filename = m_cacheDir + "/rom-properties/" + cache_key;
+	FILE *f = fopen(filename.c_str(), "rb");
+	if (!f) {
+		return false;
+	}
+
+	data.clear();
+	char buf[4096];
+	size_t size;
+	while ((size = fread(buf, 1, sizeof(buf), f)) > 0) {
+		data.append(buf, size);
+	}
+	fclose(f);
+	return true;
+}
+
+/**
+ * Close rp-download's stdin and wait for it to exit.
+ * @return Exit status, or -1 on error.
+ */
+int WorkerModeTest::closeAndWait(void)
+{
+	if (m_fd >= 0) {
+		close(m_fd);
+		m_fd = -1;
+	}
+	if (m_pid <= 0) {
+		return -1;
+	}
+
+	int wstatus = 0;
+	const pid_t wpid = waitpid(m_pid, &wstatus, 0);
+	m_pid = -1;
+	if (wpid < 0 || !WIFEXITED(wstatus)) {
+		return -1;
+	}
+	return WEXITSTATUS(wstatus);
+}
+
+/**
+ * Sequential downloads should reuse the same connection.
+ */
+TEST_F(WorkerModeTest, connectionReuse)
+{
+	static const char *const keys[] = {
+		"wii/cover/US/RMGE01.png",
+		"wii/cover/US/RSBE01.png",
+		"wii/cover/US/SMNE01.png",
+	};
+
+	for (const char *key : keys) {
+		sendKey(key);
+		string line;
+		ASSERT_TRUE(readReply(line));
+		EXPECT_EQ(string("OK ") + key, line);
+	}
+
+	string data;
+	ASSERT_TRUE(readCacheFile(keys[0], data));
+	EXPECT_EQ(string(1000, 'A'), data);
+	ASSERT_TRUE(readCacheFile(keys[1], data));
+	EXPECT_EQ(string(2000, 'B'), data);
+	ASSERT_TRUE(readCacheFile(keys[2], data));
+	EXPECT_EQ(string(3000, 'C'), data);
+
+	EXPECT_EQ(0, closeAndWait());
+	EXPECT_EQ(3U, m_server.requests());
+	EXPECT_EQ(1U, m_server.connections());
+}
+
+/**
+ * Batched cache keys should all be replied to.
+ * Files that aren't on the server should get a negative cache file.
+ */
+TEST_F(WorkerModeTest, batchedRequests)
+{
+	static const char *const keys[] = {
+		"wii/cover/US/RMGE01.png",
+		"wii/cover/US/RSBE01.png",
+		"wii/cover/US/SMNE01.png",
+		"3ds/cover/US/AREE.png",
+		"ds/cover/US/ADAE.png",
+		"gba/title/AGSE.png",
+		"wii/cover/US/NOPE01.png",
+	};
+
+	// Send all of the cache keys at once, plus a duplicate.
+	string batch;
+	for (const char *key : keys) {
+		batch += key;
+		batch += '\n';
+	}
+	batch += keys[0];
+	batch += '\n';
+	ASSERT_EQ(static_cast<ssize_t>(batch.size()), send(m_fd, batch.data(), batch.size(), MSG_NOSIGNAL));
+
+	// Replies may be received in any order.
+	set<string> replies;
+	for (size_t i = 0; i < ARRAY_SIZE(keys); i++) {
+		string line;
+		ASSERT_TRUE(readReply(line));
+		replies.insert(line);
+	}
+	for (size_t i = 0; i < ARRAY_SIZE(keys) - 1; i++) {
+		EXPECT_EQ(1U, replies.count(string("OK ") + keys[i])) << keys[i];
+	}
+	EXPECT_EQ(1U, replies.count(string("ERR ") + keys[ARRAY_SIZE(keys) - 1]));
+
+	// Negative cache file
+	string data;
+	ASSERT_TRUE(readCacheFile(keys[ARRAY_SIZE(keys) - 1], data));
+	EXPECT_TRUE(data.empty());
+	ASSERT_TRUE(readCacheFile(keys[5], data));
+	EXPECT_EQ(string(6000, 'F'), data);
+
+	EXPECT_EQ(0, closeAndWait());
+	EXPECT_LE(m_server.connections(), 4U);
+}
+
+/**
+ * Cached files and invalid cache keys shouldn't be downloaded.
+ */
+TEST_F(WorkerModeTest, cachedAndInvalidKeys)
+{
+	const string key = "wii/cover/US/RMGE01.png";
+	string line;
+
+	sendKey(key);
+	ASSERT_TRUE(readReply(line));
+	EXPECT_EQ("OK " + key, line);
+
+	// Already cached.
+	sendKey(key);
+	ASSERT_TRUE(readReply(line));
+	EXPECT_EQ("OK " + key, line);
+
+	// Invalid cache key.
+	sendKey("invalid");
+	ASSERT_TRUE(readReply(line));
+	EXPECT_EQ("ERR invalid", line);
+
+	EXPECT_EQ(0, closeAndWait());
+	EXPECT_EQ(1U, m_server.requests());
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "rp-download test suite: Worker mode tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
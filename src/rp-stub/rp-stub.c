@@ -55,6 +55,8 @@ static bool is_debug = false;
  */
 typedef enum {
 	RPCT_FLAG_NO_XDG_THUMBNAIL_METADATA	= (1U << 0),	/*< Don't add XDG thumbnail metadata */
+	RPCT_FLAG_FAST_PNG			= (1U << 1),	/*< Favor PNG encoding speed over file size */
+	RPCT_FLAG_SMALL_PNG			= (1U << 2),	/*< Favor PNG file size over encoding speed */
 } RpCreateThumbnailFlags;
 
 /**
@@ -127,6 +129,7 @@ static void show_help(const char *argv0)
 			{"  -a, --autoext",	NOP_C_("rp-stub|Help", "Generate the output filename based on the source filename.")},
 			{"               ",	NOP_C_("rp-stub|Help", "(WARNING: May overwrite an existing file without prompting.)")},
 			{"  -n, --noxdg",	NOP_C_("rp-stub|Help", "Don't include XDG thumbnail metadata.")},
+			{"  -p, --png-profile",	NOP_C_("rp-stub|Help", "PNG encode profile: fastest, balanced (default), smallest")},
 		};
 		static const struct opt_t *const thumb_opts_end = &thumb_opts[ARRAY_SIZE(thumb_opts)];
 
@@ -262,6 +265,7 @@ int main(int argc, char *argv[])
 		{"size",	required_argument,	NULL, 's'},
 		{"autoext",	no_argument,		NULL, 'a'},
 		{"noxdg",	no_argument,		NULL, 'n'},
+		{"png-profile",	required_argument,	NULL, 'p'},
 		{"config",	no_argument,		NULL, 'c'},
 		{"RomDataView",	no_argument,		NULL, 'R'},
 		{"debug",	no_argument,		NULL, 'd'},
@@ -277,7 +281,7 @@ int main(int argc, char *argv[])
 	unsigned int flags = 0;
 	bool autoext = false;
 	int c, option_index;
-	while ((c = getopt_long(argc, argv, "s:acdnhRV", long_options, &option_index)) != -1) {
+	while ((c = getopt_long(argc, argv, "s:acdnp:hRV", long_options, &option_index)) != -1) {
 		switch (c) {
 			case 's': {
 				char *endptr = NULL;
@@ -318,6 +322,19 @@ int main(int argc, char *argv[])
 				flags |= RPCT_FLAG_NO_XDG_THUMBNAIL_METADATA;
 				break;
 
+			case 'p':
+				// PNG encode profile.
+				flags &= ~(RPCT_FLAG_FAST_PNG | RPCT_FLAG_SMALL_PNG);
+				if (!strcmp(optarg, "fastest")) {
+					flags |= RPCT_FLAG_FAST_PNG;
+				} else if (!strcmp(optarg, "smallest")) {
+					flags |= RPCT_FLAG_SMALL_PNG;
+				} else if (strcmp(optarg, "balanced") != 0) {
+					print_opt_error(argv[0], C_("rp-stub", "invalid PNG profile '%s'"), optarg);
+					return EXIT_FAILURE;
+				}
+				break;
+
 			case 'R':
 				// Show the RomDataView test dialog.
 				mode = MODE_ROMDATAVIEW;
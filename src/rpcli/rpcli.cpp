@@ -51,6 +51,12 @@ using namespace LibRomData;
 #endif /* _WIN32 */
 using namespace LibRpTexture;
 
+// librpthreads
+#include "librpthreads/Semaphore.hpp"
+#include "librpthreads/ThreadPool.hpp"
+using LibRpThreads::Semaphore;
+using LibRpThreads::ThreadPool;
+
 #ifdef ENABLE_DECRYPTION
 #  include "verifykeys.hpp"
 #endif /* ENABLE_DECRYPTION */
@@ -67,10 +73,15 @@ using namespace LibRpTexture;
 #include "tcharx.h"
 
 // C++ STL classes
+#include <deque>
+#include <sstream>
 using std::cout;
 using std::cerr;
+using std::deque;
 using std::locale;
 using std::ofstream;
+using std::ostream;
+using std::ostringstream;
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
@@ -117,11 +128,14 @@ struct ExtractParam {
 	const TCHAR *filename;	// Target filename. Can be null due to argv[argc]
 	int imageType;		// Image Type. -1 = iconAnimData, MUST be between -1 and IMG_INT_MAX
 	int mipmapLevel;	// Mipmap level. (IMG_INT_IMAGE only) -1 = use default; 0 or higher = mipmap level
+	RpPngWriter::Profile pngProfile;	// PNG encode profile
 
-	ExtractParam(const TCHAR *filename, int imageType, int mipmapLevel = -1)
+	ExtractParam(const TCHAR *filename, int imageType, int mipmapLevel = -1,
+		RpPngWriter::Profile pngProfile = RpPngWriter::Profile::Balanced)
 		: filename(filename)
 		, imageType(imageType)
 		, mipmapLevel(mipmapLevel)
+		, pngProfile(pngProfile)
 	{}
 };
 
@@ -129,8 +143,9 @@ struct ExtractParam {
 * Extracts images from romdata
 * @param romData RomData containing the images
 * @param extract Vector of image extraction parameters
+* @param es Output stream for status messages (usually cerr)
 */
-static void ExtractImages(const RomData *romData, const vector<ExtractParam> &extract)
+static void ExtractImages(const RomData *romData, const vector<ExtractParam> &extract, ostream &es)
 {
 	const uint32_t supported = romData->supportedImageTypes();
 	for (const ExtractParam &p : extract) {
@@ -155,82 +170,145 @@ static void ExtractImages(const RomData *romData, const vector<ExtractParam> &ex
 			if (image && image->isValid()) {
 				found = true;
 				if (likely(!isMipmap)) {
-					cerr << "-- " <<
+					es << "-- " <<
 						// tr: %1$s == image type name, %2$s == output filename
 						rp_sprintf_p(C_("rpcli", "Extracting %1$s into '%2$s'"),
 							RomData::getImageTypeName(imageType),
 							T2U8c(p.filename)) << '\n';
 				} else {
-					cerr << "-- " <<
+					es << "-- " <<
 						// tr: %s == output filename
 						rp_sprintf_p(C_("rpcli", "Extracting mipmap level %d into '%s'"),
 							p.mipmapLevel, T2U8c(p.filename)) << '\n';
 				}
-				cerr.flush();
-				int errcode = RpPng::save(p.filename, image);
+				es.flush();
+				int errcode = RpPng::save(p.filename, image, p.pngProfile);
 				if (errcode != 0) {
 					// tr: %1$s == filename, %2%s == error message
-					cerr << rp_sprintf_p(C_("rpcli", "Couldn't create file '%1$s': %2$s"),
+					es << rp_sprintf_p(C_("rpcli", "Couldn't create file '%1$s': %2$s"),
 						T2U8c(p.filename), strerror(-errcode)) << '\n';
 				} else {
-					cerr << "   " << C_("rpcli", "Done") << '\n';
+					es << "   " << C_("rpcli", "Done") << '\n';
 				}
-				cerr.flush();
+				es.flush();
 			}
 		} else if (p.imageType == -1) {
 			// iconAnimData image
 			auto iconAnimData = romData->iconAnimData();
 			if (iconAnimData && iconAnimData->count != 0 && iconAnimData->seq_count != 0) {
 				found = true;
-				cerr << "-- " << rp_sprintf(C_("rpcli", "Extracting animated icon into '%s'"), T2U8c(p.filename)) << '\n';
-				cerr.flush();
-				int errcode = RpPng::save(p.filename, iconAnimData);
+				es << "-- " << rp_sprintf(C_("rpcli", "Extracting animated icon into '%s'"), T2U8c(p.filename)) << '\n';
+				es.flush();
+				int errcode = RpPng::save(p.filename, iconAnimData, p.pngProfile);
 				if (errcode == -ENOTSUP) {
-					cerr << "   " << C_("rpcli", "APNG not supported, extracting only the first frame") << '\n';
-					cerr.flush();
+					es << "   " << C_("rpcli", "APNG not supported, extracting only the first frame") << '\n';
+					es.flush();
 					// falling back to outputting the first frame
-					errcode = RpPng::save(p.filename, iconAnimData->frames[iconAnimData->seq_index[0]]);
+					errcode = RpPng::save(p.filename, iconAnimData->frames[iconAnimData->seq_index[0]], p.pngProfile);
 				}
 				if (errcode != 0) {
-					cerr << "   " <<
+					es << "   " <<
 						rp_sprintf_p(C_("rpcli", "Couldn't create file '%1$s': %2$s"),
 							T2U8c(p.filename), strerror(-errcode)) << '\n';
 				} else {
-					cerr << "   " << C_("rpcli", "Done") << '\n';
+					es << "   " << C_("rpcli", "Done") << '\n';
 				}
-				cerr.flush();
+				es.flush();
 			}
 		}
 
 		if (!found) {
 			// TODO: Return an error code?
 			if (p.imageType == -1) {
-				cerr << "-- " << C_("rpcli", "Animated icon not found") << '\n';
+				es << "-- " << C_("rpcli", "Animated icon not found") << '\n';
 			} else if (p.mipmapLevel >= 0) {
-				cerr << "-- " <<
+				es << "-- " <<
 					rp_sprintf(C_("rpcli", "Mipmap level %d not found"), p.mipmapLevel) << '\n';
 			} else {
 				const RomData::ImageType imageType =
 					static_cast<RomData::ImageType>(p.imageType);
-				cerr << "-- " <<
+				es << "-- " <<
 					rp_sprintf(C_("rpcli", "Image '%s' not found"),
 						RomData::getImageTypeName(imageType)) << '\n';
 			}
-			cerr.flush();
+			es.flush();
 		}
 	}
 }
 
+/**
+ * Print verification progress to stderr. (RomOpParams::ProgressFn)
+ * @param userdata	[in/out] Last percentage printed (int)
+ * @param done		[in] Amount of work done
+ * @param total		[in] Total amount of work
+ * @return True to continue.
+ */
+static bool VerifyProgress(void *userdata, uint64_t done, uint64_t total)
+{
+	int *const pLastPct = static_cast<int*>(userdata);
+	const int pct = (total > 0) ? static_cast<int>((done * 100) / total) : 100;
+	if (pct != *pLastPct) {
+		*pLastPct = pct;
+		cerr << "\r-- " << rp_sprintf(C_("rpcli", "Verifying: %d%%"), pct);
+		cerr.flush();
+	}
+	return true;
+}
+
+/**
+ * Run verification ROM operations. (-V)
+ * Results are added to the ROM's fields.
+ * @param romData RomData object
+ * @param es Output stream for status messages (usually cerr)
+ */
+static void VerifyRomData(RomData *romData, ostream &es)
+{
+	const vector<RomData::RomOp> ops = romData->romOps();
+	int id = 0;
+	for (const RomData::RomOp &op : ops) {
+		if ((op.flags & (RomData::RomOp::ROF_ENABLED | RomData::RomOp::ROF_VERIFY)) !=
+		              (RomData::RomOp::ROF_ENABLED | RomData::RomOp::ROF_VERIFY))
+		{
+			id++;
+			continue;
+		}
+
+		es << "-- " << C_("rpcli", "Verifying ROM image...") << '\n';
+		es.flush();
+
+		RomData::RomOpParams params;
+		int lastPct = -1;
+		if (&es == &cerr) {
+			// Not buffered, so progress can be shown.
+			params.progressFn = VerifyProgress;
+			params.progressUserData = &lastPct;
+		}
+		const int ret = romData->doRomOp(id, &params);
+		if (lastPct >= 0) {
+			// Finish the progress line.
+			es << '\n';
+		}
+		if (ret != 0) {
+			es << "-- " << rp_sprintf(C_("rpcli", "Verification failed: %s"), params.msg.c_str()) << '\n';
+			es.flush();
+		}
+		id++;
+	}
+}
+
 /**
  * Shows info about file
  * @param filename ROM filename
  * @param json Is program running in json mode?
  * @param extract Vector of image extraction parameters
+ * @param os Output stream for ROM information (usually cout)
+ * @param es Output stream for status messages (usually cerr)
  * @param lc Language code (0 for default)
  * @param flags ROMOutput flags (see OutputFlags)
+ * @param verify If true, run verification ROM operations before output
  */
 static void DoFile(const TCHAR *filename, bool json, const vector<ExtractParam> &extract,
-	uint32_t lc = 0, unsigned int flags = 0)
+	ostream &os, ostream &es, uint32_t lc = 0, unsigned int flags = 0, bool verify = false)
 {
 	RomDataPtr romData;
 
@@ -238,21 +316,17 @@ static void DoFile(const TCHAR *filename, bool json, const vector<ExtractParam>
 		// File: Open the file and call RomDataFactory::create() with the opened file.
 
 		// FIXME: Make T2U8c() unnecessary here.
-		fputs("== ", stderr);
-		fprintf(stderr, C_("rpcli", "Reading file '%s'..."), T2U8c(filename));
-		fputc('\n', stderr);
-		fflush(stderr);
+		es << "== " << rp_sprintf(C_("rpcli", "Reading file '%s'..."), T2U8c(filename)) << '\n';
+		es.flush();
 
 		shared_ptr<RpFile> file = std::make_shared<RpFile>(filename, RpFile::FM_OPEN_READ_GZ);
 		if (!file->isOpen()) {
 			// TODO: Return an error code?
-			fputs("-- ", stderr);
-			fprintf(stderr, C_("rpcli", "Couldn't open file: %s"), strerror(file->lastError()));
-			fputc('\n', stderr);
-			fflush(stderr);
+			es << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(file->lastError())) << '\n';
+			es.flush();
 			if (json) {
-				printf("{\"error\":\"couldn't open file\",\"code\":%d}\n", file->lastError());
-				fflush(stdout);
+				os << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}\n";
+				os.flush();
 			}
 			return;
 		}
@@ -262,40 +336,81 @@ static void DoFile(const TCHAR *filename, bool json, const vector<ExtractParam>
 		// Directory: Call RomDataFactory::create() with the filename.
 
 		// FIXME: Make T2U8c() unnecessary here.
-		fputs("== ", stderr);
-		fprintf(stderr, C_("rpcli", "Reading directory '%s'..."), T2U8c(filename));
-		fputc('\n', stderr);
-		fflush(stderr);
+		es << "== " << rp_sprintf(C_("rpcli", "Reading directory '%s'..."), T2U8c(filename)) << '\n';
+		es.flush();
 
 		romData = RomDataFactory::create(filename);
 	}
 
 	if (romData) {
+		if (verify) {
+			VerifyRomData(romData.get(), es);
+		}
+
 		if (json) {
-			fputs("-- ", stderr);
-			fputs(C_("rpcli", "Outputting JSON data"), stderr);
-			fputc('\n', stderr);
-			fflush(stderr);
+			es << "-- " << C_("rpcli", "Outputting JSON data") << '\n';
+			es.flush();
 
-			cout << JSONROMOutput(romData.get(), lc, flags) << '\n';
+			os << JSONROMOutput(romData.get(), lc, flags) << '\n';
 		} else {
-			cout << ROMOutput(romData.get(), lc, flags) << '\n';
+			os << ROMOutput(romData.get(), lc, flags) << '\n';
 		}
-		cout.flush();
-		ExtractImages(romData.get(), extract);
+		os.flush();
+		ExtractImages(romData.get(), extract, es);
 	} else {
-		fputs("-- ", stderr);
-		fputs(C_("rpcli", "ROM is not supported"), stderr);
-		fputc('\n', stderr);
-		fflush(stderr);
+		es << "-- " << C_("rpcli", "ROM is not supported") << '\n';
+		es.flush();
 
 		if (json) {
-			fputs("{\"error\":\"rom is not supported\"}\n", stdout);
-			fflush(stdout);
+			os << "{\"error\":\"rom is not supported\"}\n";
+			os.flush();
 		}
 	}
 }
 
+/**
+ * Batch job for parallel mode. (-P)
+ * DoFile() output is buffered so it can be written in input order.
+ */
+struct BatchJob {
+	const TCHAR *filename;
+	vector<ExtractParam> extract;
+	uint32_t lc;
+	unsigned int flags;
+	bool json;
+	bool verify;
+
+	ostringstream os;	// ROM information (stdout)
+	ostringstream es;	// Status messages (stderr)
+	Semaphore done;		// Released once the job has finished.
+
+	BatchJob(const TCHAR *filename, bool json, vector<ExtractParam> &&extract,
+		uint32_t lc, unsigned int flags, bool verify)
+		: filename(filename)
+		, extract(std::move(extract))
+		, lc(lc)
+		, flags(flags)
+		, json(json)
+		, verify(verify)
+		, done(0)
+	{
+		// Use the same locale as the standard streams.
+		os.imbue(cout.getloc());
+		es.imbue(cerr.getloc());
+	}
+
+	/**
+	 * Run a batch job. (ThreadPool::WorkFn)
+	 * @param param BatchJob
+	 */
+	static void run(void *param)
+	{
+		BatchJob *const job = static_cast<BatchJob*>(param);
+		DoFile(job->filename, job->json, job->extract, job->os, job->es, job->lc, job->flags, job->verify);
+		job->done.release();
+	}
+};
+
 /**
  * Print the system region information.
  */
@@ -476,15 +591,37 @@ static void DoAtaIdentifyDevice(const TCHAR *filename, bool json, bool packet)
 }
 #endif /* RP_OS_SCSI_SUPPORTED */
 
+/**
+ * Parse a thread count for parallel mode (-P).
+ * NOTE: The thread count's range is not checked here.
+ * @param s_threads	[in] Thread count string
+ * @param pNum		[out] Thread count
+ * @return True if s_threads is a number; false if not.
+ */
+static bool ParseThreadCount(const TCHAR *s_threads, long *pNum)
+{
+	if (!s_threads || s_threads[0] == _T('\0')) {
+		return false;
+	}
+
+	TCHAR *endptr = nullptr;
+	const long num = _tcstol(s_threads, &endptr, 10);
+	if (*endptr != _T('\0')) {
+		return false;
+	}
+	*pNum = num;
+	return true;
+}
+
 static void ShowUsage(void)
 {
 	// TODO: Use argv[0] instead of hard-coding 'rpcli'?
 
 #ifdef ENABLE_DECRYPTION	
-	fputs(C_("rpcli", "Usage: rpcli [-k] [-c] [-p] [-j] [-l lang] [[-xN outfile]... [-mN outfile]... [-a apngoutfile] filename]..."), stderr);
+	fputs(C_("rpcli", "Usage: rpcli [-k] [-c] [-p] [-j] [-V] [-P N] [-l lang] [-z profile] [[-xN outfile]... [-mN outfile]... [-a apngoutfile] filename]..."), stderr);
 	fputc('\n', stderr);
 #else /* !ENABLE_DECRYPTION */
-	fputs(C_("rpcli", "Usage: rpcli [-c] [-p] [-j] [-l lang] [[-xN outfile]... [-mN outfile]... [-a apngoutfile] filename]..."), stderr);
+	fputs(C_("rpcli", "Usage: rpcli [-c] [-p] [-j] [-V] [-P N] [-l lang] [-z profile] [[-xN outfile]... [-mN outfile]... [-a apngoutfile] filename]..."), stderr);
 	fputc('\n', stderr);
 #endif /* ENABLE_DECRYPTION */
 
@@ -501,8 +638,11 @@ static void ShowUsage(void)
 		{"  -c:  ", NOP_C_("rpcli", "Print system region information.")},
 		{"  -p:  ", NOP_C_("rpcli", "Print system path information.")},
 		{"  -d:  ", NOP_C_("rpcli", "Skip ListData fields with more than 10 items. [text only]")},
+		{"  -V:  ", NOP_C_("rpcli", "Verify ROM checksums. (reads the entire file)")},
 		{"  -j:  ", NOP_C_("rpcli", "Use JSON output format.")},
+		{"  -P:  ", NOP_C_("rpcli", "Process files using N worker threads. (0 = one per CPU)")},
 		{"  -l:  ", NOP_C_("rpcli", "Retrieve the specified language from the ROM image.")},
+		{"  -z:  ", NOP_C_("rpcli", "PNG encode profile for extracted images: fastest, balanced (default), smallest")},
 		{"  -xN: ", NOP_C_("rpcli", "Extract image N to outfile in PNG format.")},
 		{"  -mN: ", NOP_C_("rpcli", "Extract mipmap level N to outfile in PNG format.")},
 		{"  -a:  ", NOP_C_("rpcli", "Extract the animated icon to outfile in APNG format.")},
@@ -625,15 +765,39 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 	unsigned int flags = 0;	// OutputFlags
 	// DoFile parameters
 	bool json = false;
+	bool verify = false;
 	vector<ExtractParam> extract;
+	RpPngWriter::Profile pngProfile = RpPngWriter::Profile::Balanced;
 
-	for (int i = 1; i < argc; i++) { // figure out the json mode in advance
+	// Parallel mode (-P): Number of worker threads.
+	// 1 == process files sequentially. (default)
+	unsigned int threadCount = 1;
+
+	for (int i = 1; i < argc; i++) { // figure out the json and parallel modes in advance
 		if (argv[i][0] == _T('-')) {
 			if (argv[i][1] == _T('j')) {
 				json = true;
 			} else if (argv[i][1] == _T('J')) {
 				json = true;
 				flags |= OF_JSON_NoPrettyPrint;
+			} else if (argv[i][1] == _T('P')) {
+				// NOTE: Thread count may be immediately after 'P',
+				// or it might be a completely separate argument.
+				const TCHAR *s_threads = (argv[i][2] == _T('\0')) ? argv[i+1] : &argv[i][2];
+				if (!s_threads) {
+					break;
+				}
+				long num;
+				if (!ParseThreadCount(s_threads, &num) || num < 0 || num > 1024) {
+					// NOTE: If the thread count was a separate argument
+					// and isn't a number, it won't be skipped later,
+					// since it might be a filename.
+					fprintf(stderr, C_("rpcli", "Warning: ignoring invalid thread count '%s'"), T2U8c(s_threads));
+					fputc('\n', stderr);
+					fflush(stderr);
+					continue;
+				}
+				threadCount = (num == 0) ? ThreadPool::idealThreadCount() : static_cast<unsigned int>(num);
 			}
 		}
 	}
@@ -662,8 +826,52 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 	uint32_t lc = 0;
 	bool first = true;
 	int ret = 0;
+
+	// Parallel mode: Worker threads and pending jobs, in input order.
+	// NOTE: Output is written in input order, so the number of pending jobs
+	// is limited in order to avoid buffering too much output if one file
+	// takes a long time to process.
+	unique_ptr<ThreadPool> pool;
+	if (threadCount > 1) {
+		pool.reset(new ThreadPool(threadCount));
+	}
+	const size_t maxPendingJobs = static_cast<size_t>(threadCount) * 4;
+	deque<unique_ptr<BatchJob>> pendingJobs;
+
+	// Write the output of pending jobs until at most maxPending jobs are left.
+	// This must be called before anything else is written to stdout.
+	auto flushPendingJobs = [&](size_t maxPending) {
+		while (pendingJobs.size() > maxPending) {
+			BatchJob *const job = pendingJobs.front().get();
+			job->done.obtain();
+
+			if (first) {
+				first = false;
+			} else if (json) {
+				cout << ",\n";
+			}
+			cerr << job->es.str();
+			cerr.flush();
+			cout << job->os.str();
+			cout.flush();
+
+			pendingJobs.pop_front();
+		}
+	};
+
 	for (int i = 1; i < argc; i++){
 		if (argv[i][0] == _T('-')){
+			if (!pendingJobs.empty()) {
+				switch (argv[i][1]) {
+					case _T('k'): case _T('c'): case _T('p'):
+						// These commands write to stdout immediately.
+						flushPendingJobs(0);
+						break;
+					default:
+						break;
+				}
+			}
+
 			switch (argv[i][1]) {
 #ifdef ENABLE_DECRYPTION
 			case _T('k'): {
@@ -719,11 +927,46 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 				lc = new_lc;
 				break;
 			}
+			case _T('z'): {
+				// PNG encode profile.
+				// NOTE: Profile name may be immediately after 'z',
+				// or it might be a completely separate argument.
+				// NOTE 2: The profile affects images extracted *after* it.
+				const TCHAR *s_profile;
+				if (argv[i][2] == _T('\0')) {
+					// Separate argument.
+					s_profile = argv[i+1];
+					i++;
+				} else {
+					// Same argument.
+					s_profile = &argv[i][2];
+				}
+				if (!s_profile) {
+					break;
+				}
+
+				if (!_tcscmp(s_profile, _T("fastest"))) {
+					pngProfile = RpPngWriter::Profile::Fastest;
+				} else if (!_tcscmp(s_profile, _T("balanced"))) {
+					pngProfile = RpPngWriter::Profile::Balanced;
+				} else if (!_tcscmp(s_profile, _T("smallest"))) {
+					pngProfile = RpPngWriter::Profile::Smallest;
+				} else {
+					fprintf(stderr, C_("rpcli", "Warning: ignoring invalid PNG profile '%s'"), T2U8c(s_profile));
+					fputc('\n', stderr);
+					fflush(stderr);
+				}
+				break;
+			}
 			case _T('K'): {
 				// Skip internal images. (NOTE: Not documented.)
 				flags |= LibRpBase::OF_SkipInternalImages;
 				break;
 			}
+			case _T('V'):
+				// Verify ROM checksums.
+				verify = true;
+				break;
 			case _T('d'): {
 				// Skip RFT_LISTDATA with more than 10 items. (Text only)
 				flags |= LibRpBase::OF_SkipListDataMoreThan10;
@@ -738,7 +981,7 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 					fflush(stderr);
 					i++; continue;
 				}
-				extract.emplace_back(argv[++i], num);
+				extract.emplace_back(argv[++i], num, -1, pngProfile);
 				break;
 			}
 			case _T('m'): {
@@ -750,15 +993,24 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 					fflush(stderr);
 					i++; continue;
 				}
-				extract.emplace_back(argv[++i], RomData::IMG_INT_IMAGE, num);
+				extract.emplace_back(argv[++i], RomData::IMG_INT_IMAGE, num, pngProfile);
 				break;
 			}
 			case _T('a'):
-				extract.emplace_back(argv[++i], -1);
+				extract.emplace_back(argv[++i], -1, -1, pngProfile);
 				break;
 			case _T('j'): // do nothing
 			case _T('J'): // still do nothing
 				break;
+			case _T('P'): {
+				// Parallel mode. (handled above)
+				// Skip the separate argument only if it's a number.
+				long num;
+				if (argv[i][2] == _T('\0') && ParseThreadCount(argv[i+1], &num)) {
+					i++;
+				}
+				break;
+			}
 #ifdef RP_OS_SCSI_SUPPORTED
 			case _T('i'):
 				// These commands take precedence over the usual rpcli functionality.
@@ -797,6 +1049,25 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 				break;
 			}
 		} else {
+#ifdef RP_OS_SCSI_SUPPORTED
+			const bool inq_any = (inq_scsi || inq_ata || inq_ata_packet);
+#else /* !RP_OS_SCSI_SUPPORTED */
+			static constexpr bool inq_any = false;
+#endif /* RP_OS_SCSI_SUPPORTED */
+
+			if (pool && pool->threadCount() > 0 && !inq_any) {
+				// Parallel mode: Process the file on a worker thread.
+				// Output will be written by flushPendingJobs().
+				BatchJob *const job = new BatchJob(argv[i], json, std::move(extract), lc, flags, verify);
+				pendingJobs.emplace_back(job);
+				pool->enqueue(BatchJob::run, job);
+				flushPendingJobs(maxPendingJobs);
+				extract.clear();
+				continue;
+			}
+
+			// Sequential mode. Write the output of any pending jobs first.
+			flushPendingJobs(0);
 			if (first) {
 				first = false;
 			} else if (json) {
@@ -819,7 +1090,7 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 #endif /* RP_OS_SCSI_SUPPORTED */
 			{
 				// Regular file.
-				DoFile(argv[i], json, extract, lc, flags);
+				DoFile(argv[i], json, extract, cout, cerr, lc, flags, verify);
 			}
 
 #ifdef RP_OS_SCSI_SUPPORTED
@@ -830,6 +1101,11 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 			extract.clear();
 		}
 	}
+
+	// Write the output of any remaining jobs.
+	flushPendingJobs(0);
+	pool.reset();
+
 	if (json) {
 		cout << "]\n";
 		cout.flush();
@@ -57,9 +57,19 @@ int rpcli_do_security_options(void)
 #endif /* __SNR_openat2 || __NR_openat2 */
 		SCMP_SYS(readlink),	// realpath() [LibRpBase::FileSystem::resolve_symlink()]
 
+		// LibRpFile::RpFile::prefetch()
+		// NOTE: madvise() is also listed under parallel mode.
+		SCMP_SYS(fadvise64), SCMP_SYS(fadvise64_64),	// posix_fadvise()
+		SCMP_SYS(arm_fadvise64_64),	// posix_fadvise() [32-bit ARM]
+
+		// Parallel mode (-P)
+		SCMP_SYS(madvise),		// glibc: pthread exit [advise_stack_range()]; posix_madvise() [RpFile::prefetch()]
+		SCMP_SYS(sched_getaffinity),	// glibc: sysconf(_SC_NPROCESSORS_ONLN)
+
 		// KeyManager (keys.conf)
 		SCMP_SYS(access),	// LibUnixCommon::isWritableDirectory()
 		SCMP_SYS(stat), SCMP_SYS(stat64),	// LibUnixCommon::isWritableDirectory()
+		SCMP_SYS(statfs), SCMP_SYS(statfs64),	// LibRpFile::FileSystem::isOnBadFS() [RpFile mmap()]
 		// ConfReader checks timestamps between rpcli runs.
 		// NOTE: Only seems to get triggered on PowerPC...
 		SCMP_SYS(clock_gettime),
@@ -87,7 +97,7 @@ int rpcli_do_security_options(void)
 		-1	// End of whitelist
 	};
 	param.syscall_wl = syscall_wl;
-	param.threading = true;		// FIXME: Only if OpenMP is enabled?
+	param.threading = true;		// Needed for OpenMP and parallel mode (-P).
 #elif defined(HAVE_PLEDGE)
 	// Promises:
 	// - stdio: General stdio functionality.
@@ -62,6 +62,7 @@ typedef char TCHAR;
 #define _tcsnicmp(s1, s2)		strncasecmp((s1), (s2), (n))
 #define _tcstol(nptr, endptr, base)	strtol((nptr), (endptr), (base))
 #define _tcstoul(nptr, endptr, base)	strtoul((nptr), (endptr), (base))
+#define _tgetenv(name)			getenv(name)
 #define _tputenv(envstring)		putenv(envstring)
 #define _ttol(nptr)			atol(nptr)
 
@@ -74,6 +75,7 @@ typedef char TCHAR;
 #define _tcslen(s)			strlen(s)
 #define _tcsncmp(s1, s2, n)		strncmp((s1), (s2), (n))
 #define _tcsrchr(s, c)			strrchr((s), (c))
+#define _tcsstr(haystack, needle)	strstr((haystack), (needle))
 
 // direct.h (unistd.h)
 #define _tgetcwd(buf, size)		getcwd((buf), (size))
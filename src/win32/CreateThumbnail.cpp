@@ -71,32 +71,6 @@ HBITMAP CreateThumbnail::rpImageToImgClass(const rp_image_const_ptr &img) const
 	return hbmp;
 }
 
-/**
- * Rescale an ImgClass using the specified scaling method.
- * @param imgClass ImgClass object.
- * @param sz New size.
- * @param method Scaling method.
- * @return Rescaled ImgClass.
- */
-HBITMAP CreateThumbnail::rescaleImgClass(const HBITMAP &imgClass, ImgSize sz, ScalingMethod method) const
-{
-	// Convert the HBITMAP to rp_image.
-	const rp_image_const_ptr img = RpImageWin32::fromHBITMAP(imgClass);
-	if (!img) {
-		// Error converting to rp_image.
-		return nullptr;
-	}
-
-	// IExtractIcon and IThumbnailProvider both support alpha transparency.
-	// We're returning HBITMAP here, which works for IThumbnailProvider.
-	// Our IExtractIcon implementation converts it to HICON later.
-
-	// Resize the image.
-	const SIZE win_sz = {sz.width, sz.height};
-	HBITMAP hbmp = RpImageWin32::toHBITMAP_alpha(img, win_sz, (method == ScalingMethod::Nearest));
-	return hbmp;
-}
-
 /**
  * Get the size of the specified ImgClass.
  * @param imgClass	[in] ImgClass object.
@@ -162,33 +136,3 @@ HBITMAP CreateThumbnailNoAlpha::rpImageToImgClass(const rp_image_const_ptr &img)
 		LibWin32UI::GetSysColor_ARGB32(COLOR_WINDOW));
 	return hbmp;
 }
-
-/**
- * Rescale an ImgClass using the specified scaling method.
- * @param imgClass ImgClass object.
- * @param sz New size.
- * @param method Scaling method.
- * @return Rescaled ImgClass.
- */
-HBITMAP CreateThumbnailNoAlpha::rescaleImgClass(const HBITMAP &imgClass, ImgSize sz, ScalingMethod method) const
-{
-	// Convert the HBITMAP to rp_image.
-	const rp_image_const_ptr img = RpImageWin32::fromHBITMAP(imgClass);
-	if (!img) {
-		// Error converting to rp_image.
-		return nullptr;
-	}
-
-	// NOTE: IExtractImage doesn't support alpha transparency,
-	// so blend the image with COLOR_WINDOW. This works for the
-	// most part, at least with Windows Explorer, but the cached
-	// Thumbs.db images won't reflect color scheme changes.
-
-	// Resize the image.
-	// TODO: "nearest" parameter.
-	const SIZE win_sz = {sz.width, sz.height};
-	HBITMAP hbmp = RpImageWin32::toHBITMAP(img,
-		LibWin32UI::GetSysColor_ARGB32(COLOR_WINDOW),
-		win_sz, (method == ScalingMethod::Nearest));
-	return hbmp;
-}
@@ -65,15 +65,6 @@ public:
 		DeleteBitmap(imgClass);
 	}
 
-	/**
-	 * Rescale an ImgClass using the specified scaling method.
-	 * @param imgClass ImgClass object.
-	 * @param sz New size.
-	 * @param method Scaling method.
-	 * @return Rescaled ImgClass.
-	 */
-	HBITMAP rescaleImgClass(const HBITMAP &imgClass, ImgSize sz, ScalingMethod method = ScalingMethod::Nearest) const override;
-
 	/**
 	 * Get the size of the specified ImgClass.
 	 * @param imgClass	[in] ImgClass object.
@@ -162,13 +153,4 @@ public:
 	 * @return ImgClass
 	 */
 	HBITMAP rpImageToImgClass(const LibRpTexture::rp_image_const_ptr &img) const final;
-
-	/**
-	 * Rescale an ImgClass using the specified scaling method.
-	 * @param imgClass ImgClass object.
-	 * @param sz New size.
-	 * @param method Scaling method.
-	 * @return Rescaled ImgClass.
-	 */
-	HBITMAP rescaleImgClass(const HBITMAP &imgClass, ImgSize sz, ScalingMethod method = ScalingMethod::Nearest) const final;
 };
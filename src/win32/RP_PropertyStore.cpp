@@ -240,7 +240,7 @@ IFACEMETHODIMP RP_PropertyStore::Initialize(_In_ IStream *pstream, DWORD grfMode
 
 	// Attempt to create a RomData object.
 	// TODO: Do we need to keep it open?
-	d->romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_METADATA);
+	d->romData = RomDataFactory::create(file, RomDataFactory::RDA_METADATA_ONLY);
 	if (!d->romData) {
 		// No RomData.
 		return E_FAIL;